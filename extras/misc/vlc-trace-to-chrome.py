@@ -0,0 +1,143 @@
+#!/usr/bin/env python3
+#
+# Converts traces written by the VLC binary tracer (--tracer=binary_tracer)
+# to the Chrome trace-event JSON format, which can be loaded in
+# chrome://tracing, https://ui.perfetto.dev or speedscope.
+#
+# Usage: vlc-trace-to-chrome.py [--counters] vlc-trace.bin > trace.json
+#
+# Every trace becomes an instant event named after its "type" (and "stream")
+# entries, with all entries as arguments. With --counters, integer entries
+# (pts, dts, pcr, ...) are also emitted as counter tracks, one track per
+# type and id, so that their evolution can be plotted along the timeline.
+#
+# Copyright (C) 2021 VLC authors and VideoLAN
+#
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 2 of the License, or
+# (at your option) any later version.
+
+import argparse
+import json
+import struct
+import sys
+
+MAGIC = b"VLCTRACE"
+RECORD_TRACE = 0
+RECORD_DROPPED = 1
+TRACER_INT = 0
+TRACER_STRING = 1
+
+
+def read_records(data):
+    if data[:8] != MAGIC:
+        raise ValueError("not a VLC binary trace")
+
+    # The byte order mark tells the endianness of the recording host
+    if struct.unpack_from("<I", data, 12)[0] == 0x01020304:
+        order = "<"
+    elif struct.unpack_from(">I", data, 12)[0] == 0x01020304:
+        order = ">"
+    else:
+        raise ValueError("invalid byte order mark")
+
+    version, _, freq = struct.unpack_from(order + "IIq", data, 8)
+    if version != 1:
+        raise ValueError("unsupported trace version %d" % version)
+
+    pos = 24
+    while pos + 16 <= len(data):
+        size, kind, count, tid, ts = struct.unpack_from(order + "HBBIq",
+                                                        data, pos)
+        if size < 16 or pos + size > len(data):
+            break  # truncated file
+        end = pos + size
+        pos += 16
+
+        if kind == RECORD_DROPPED:
+            (dropped,) = struct.unpack_from(order + "q", data, pos)
+            yield kind, tid, ts * 1e6 / freq, {"dropped": dropped}
+            pos = end
+            continue
+
+        entries = {}
+        for _ in range(count):
+            etype, keylen = struct.unpack_from("BB", data, pos)
+            pos += 2
+            key = data[pos:pos + keylen].decode("utf-8", "replace")
+            pos += keylen
+            if etype == TRACER_INT:
+                (value,) = struct.unpack_from(order + "q", data, pos)
+                pos += 8
+            else:
+                strlen = data[pos]
+                pos += 1
+                value = data[pos:pos + strlen].decode("utf-8", "replace")
+                pos += strlen
+            entries[key] = value
+
+        yield kind, tid, ts * 1e6 / freq, entries
+        pos = end
+
+
+def convert(data, counters):
+    events = []
+    threads = set()
+
+    for kind, tid, ts, entries in read_records(data):
+        threads.add(tid)
+
+        if kind == RECORD_DROPPED:
+            events.append({"name": "dropped traces", "ph": "C", "ts": ts,
+                           "pid": 0, "tid": tid, "args": entries})
+            continue
+
+        name = " ".join(str(entries[k]) for k in ("type", "stream")
+                        if k in entries) or "trace"
+        events.append({"name": name, "cat": entries.get("type", "trace"),
+                       "ph": "i", "s": "t", "ts": ts, "pid": 0, "tid": tid,
+                       "args": entries})
+
+        if counters:
+            # Timestamps are traced in nanoseconds; plot them in milliseconds
+            values = {k: v / 1e6 for k, v in entries.items()
+                      if isinstance(v, int)}
+            if values:
+                track = " ".join(str(entries[k]) for k in ("type", "id")
+                                 if k in entries)
+                events.append({"name": track or "values", "ph": "C",
+                               "ts": ts, "pid": 0, "args": values})
+
+    for tid in sorted(threads):
+        events.append({"name": "thread_name", "ph": "M", "pid": 0,
+                       "tid": tid, "args": {"name": "thread %d" % tid}})
+
+    events.append({"name": "process_name", "ph": "M", "pid": 0,
+                   "args": {"name": "vlc"}})
+    return {"traceEvents": events, "displayTimeUnit": "ms"}
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Convert a VLC binary trace to Chrome trace-event JSON")
+    parser.add_argument("input", help="binary trace file")
+    parser.add_argument("-o", "--output", help="output file (default: stdout)")
+    parser.add_argument("--counters", action="store_true",
+                        help="also emit integer values as counter tracks")
+    args = parser.parse_args()
+
+    with open(args.input, "rb") as f:
+        data = f.read()
+
+    result = convert(data, args.counters)
+
+    if args.output:
+        with open(args.output, "w") as f:
+            json.dump(result, f)
+    else:
+        json.dump(result, sys.stdout)
+
+
+if __name__ == "__main__":
+    main()
@@ -65,6 +65,20 @@ VLC_API stream_t *vlc_access_NewMRL(vlc_object_t *obj, const char *mrl);
  */
 VLC_API int access_vaDirectoryControlHelper( stream_t *p_access, int i_query, va_list args );
 
+/**
+ * Reports the reception state of a datagram access.
+ *
+ * This is accounted in the statistics of the input of the access, if any.
+ *
+ * \param access access stream
+ * \param lost number of datagrams dropped by the network stack since the
+ *             previous report, before the access could read them
+ * \param delay time spent in the network stack by the oldest datagram just
+ *              read, or VLC_TICK_INVALID if unknown
+ */
+VLC_API void vlc_access_ReportReceive(stream_t *access, uint64_t lost,
+                                      vlc_tick_t delay);
+
 #define ACCESS_SET_CALLBACKS( read, block, control, seek ) \
     do { \
         p_access->pf_read = (read); \
@@ -129,6 +129,8 @@ struct block_t
     vlc_tick_t  i_dts;
     vlc_tick_t  i_length;
 
+    struct vlc_frame_trace trace; /**< Pipeline latency tracing */
+
     const struct vlc_block_callbacks *cbs;
 };
 
@@ -163,6 +165,28 @@ VLC_API block_t *block_Init(block_t *block,
  */
 VLC_API block_t *block_Alloc(size_t size) VLC_USED VLC_MALLOC;
 
+/**
+ * Block pool statistics.
+ *
+ * Blocks allocated with block_Alloc() are recycled through a per-thread
+ * cached pool, unless the size is too large or the pool is disabled (this is
+ * the case with AddressSanitizer builds, or if the VLC_BLOCK_POOL environment
+ * variable is set to 0).
+ */
+struct block_pool_stats
+{
+    uint64_t hits; /**< Allocations served from the pool */
+    uint64_t misses; /**< Poolable allocations that fell back to malloc() */
+    size_t resident; /**< Bytes currently held by free pooled blocks */
+};
+
+/**
+ * Gets block pool statistics.
+ *
+ * @param stats structure to fill with a snapshot of the pool counters
+ */
+VLC_API void block_PoolGetStats(struct block_pool_stats *stats);
+
 VLC_API block_t *block_TryRealloc(block_t *, ssize_t pre, size_t body) VLC_USED;
 
 /**
@@ -209,6 +233,7 @@ static inline void block_CopyProperties( block_t *dst, const block_t *src )
     dst->i_dts     = src->i_dts;
     dst->i_pts     = src->i_pts;
     dst->i_length  = src->i_length;
+    dst->trace     = src->trace;
 }
 
 /**
@@ -502,6 +527,7 @@ static inline block_t *block_ChainGather( block_t *p_list )
     block_ChainExtract( p_list, g->p_buffer, g->i_buffer );
 
     g->i_flags = p_list->i_flags;
+    g->trace   = p_list->trace;
     g->i_pts   = p_list->i_pts;
     g->i_dts   = p_list->i_dts;
     g->i_length = i_length;
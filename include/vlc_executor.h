@@ -31,6 +31,19 @@ extern "C" {
 /** Executor type (opaque) */
 typedef struct vlc_executor vlc_executor_t;
 
+/**
+ * Priority of a runnable.
+ *
+ * Pending runnables of higher priority are started first. Runnables of the
+ * same priority are started in submission order (per queue).
+ */
+enum vlc_executor_priority
+{
+    VLC_EXECUTOR_PRIORITY_LOW,
+    VLC_EXECUTOR_PRIORITY_NORMAL,
+    VLC_EXECUTOR_PRIORITY_HIGH,
+};
+
 /**
  * A Runnable encapsulates a task to be run from an executor thread.
  */
@@ -60,6 +73,8 @@ struct vlc_runnable {
 
     /* Private data used by the vlc_executor_t (do not touch) */
     struct vlc_list node;
+    void *queue;
+    enum vlc_executor_priority priority;
 };
 
 /**
@@ -71,6 +86,21 @@ struct vlc_runnable {
 VLC_API vlc_executor_t *
 vlc_executor_New(unsigned max_threads);
 
+/**
+ * Create a new executor on the process-wide shared pool.
+ *
+ * The returned executor behaves like one created by vlc_executor_New(), but
+ * its runnables are executed by threads shared with all the other shared
+ * executors, instead of threads of its own. Runnables from all shared
+ * executors are scheduled according to their priority.
+ *
+ * \param quota the maximum number of runnables from this executor running at
+ *              the same time
+ * \return a pointer to a new executor, or NULL if an error occurred
+ */
+VLC_API vlc_executor_t *
+vlc_executor_NewShared(unsigned quota);
+
 /**
  * Delete an executor.
  *
@@ -145,6 +175,22 @@ vlc_executor_Delete(vlc_executor_t *executor);
 VLC_API void
 vlc_executor_Submit(vlc_executor_t *executor, struct vlc_runnable *runnable);
 
+/**
+ * Submit a runnable for execution with a given priority.
+ *
+ * This is the same as vlc_executor_Submit(), except that pending runnables of
+ * higher priority are started before those of lower priority.
+ * vlc_executor_Submit() uses VLC_EXECUTOR_PRIORITY_NORMAL.
+ *
+ * \param executor the executor
+ * \param runnable the task to run
+ * \param priority the priority of the task
+ */
+VLC_API void
+vlc_executor_SubmitPriority(vlc_executor_t *executor,
+                            struct vlc_runnable *runnable,
+                            enum vlc_executor_priority priority);
+
 /**
  * Cancel a runnable previously submitted.
  *
@@ -136,6 +136,18 @@ struct vlc_filter_operations
     int (*video_mouse)(filter_t *, struct vlc_mouse_t *,
                        const struct vlc_mouse_t *p_old);
 
+    /** Filter a horizontal band of a picture (video filter).
+     *
+     * If non-NULL, the filter declares itself slice-safe: the output lines
+     * of a band only depend on the input picture, and bands of the same
+     * picture may be filtered concurrently from different threads.
+     * This is called from filter_SliceVideo().
+     *
+     * The band is given in lines of the first input plane, see
+     * filter_GetSliceLines() for the other planes. */
+    void (*filter_slice)(filter_t *, picture_t *dst, const picture_t *src,
+                         unsigned first, unsigned count);
+
     /** Close the filter and release its resources. */
     void (*close)(filter_t *);
 };
@@ -270,6 +282,47 @@ static inline picture_t *filter_NewPicture( filter_t *p_filter )
     return pic;
 }
 
+/**
+ * Filters a picture band by band.
+ *
+ * This runs the filter_slice operation of a slice-safe filter over the whole
+ * picture, in parallel if the filter owner allows it, and returns once all
+ * the bands are filtered. It is meant to be called from the filter_video
+ * operation, after the output picture is allocated.
+ *
+ * \param p_filter filter_t object
+ * \param dst output picture
+ * \param src input picture
+ */
+VLC_API void filter_SliceVideo( filter_t *p_filter, picture_t *dst,
+                                const picture_t *src );
+
+/**
+ * Gets the lines of a picture plane covered by a band.
+ *
+ * \param pic picture
+ * \param plane plane index
+ * \param first first line of the band, in lines of the first plane
+ * \param count number of lines of the band, in lines of the first plane
+ * \param start first line of the plane in the band [OUT]
+ * \param end line of the plane after the band [OUT]
+ */
+static inline void filter_GetSliceLines( const picture_t *pic, int plane,
+                                         unsigned first, unsigned count,
+                                         unsigned *start, unsigned *end )
+{
+    const unsigned lines = pic->p[0].i_visible_lines;
+    const unsigned plane_lines = pic->p[plane].i_visible_lines;
+
+    if( lines == 0 )
+    {
+        *start = *end = 0;
+        return;
+    }
+    *start = (uint64_t)first * plane_lines / lines;
+    *end = (uint64_t)(first + count) * plane_lines / lines;
+}
+
 /**
  * Flush a filter
  *
@@ -437,6 +490,33 @@ VLC_API void filter_DeleteBlend( vlc_blender_t * );
         .filter_video = name ## _Filter, .close = close_cb,             \
     };
 
+/**
+ * Same as VIDEO_FILTER_WRAPPER_CLOSE, for slice-safe filters
+ *
+ * The filter function handles the band of lines given by its last two
+ * parameters, and may be run concurrently on other bands of the picture.
+ */
+#define VIDEO_FILTER_WRAPPER_SLICE( name, close_cb )                    \
+    static void name (filter_t *, picture_t *, const picture_t *,       \
+                      unsigned, unsigned);                              \
+    static void close_cb (filter_t *);                                  \
+    static picture_t *name ## _Filter ( filter_t *p_filter,             \
+                                        picture_t *p_pic )              \
+    {                                                                   \
+        picture_t *p_outpic = filter_NewPicture( p_filter );            \
+        if( p_outpic )                                                  \
+        {                                                               \
+            filter_SliceVideo( p_filter, p_outpic, p_pic );             \
+            picture_CopyProperties( p_outpic, p_pic );                  \
+        }                                                               \
+        picture_Release( p_pic );                                       \
+        return p_outpic;                                                \
+    }                                                                   \
+    static const struct vlc_filter_operations name ## _ops = {          \
+        .filter_video = name ## _Filter, .filter_slice = name,          \
+        .close = close_cb,                                              \
+    };
+
 #define VIDEO_FILTER_WRAPPER_CLOSE( name, close_cb )                    \
     static void name (filter_t *, picture_t *, picture_t *);            \
     static void close_cb (filter_t *);                                  \
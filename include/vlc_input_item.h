@@ -503,12 +503,49 @@ VLC_API void libvlc_MetadataCancel( libvlc_int_t *, void * );
 /******************
  * Input stats
  ******************/
+
+/**
+ * Video pipeline stages, whose latency is measured for every displayed
+ * picture. Each stage ends where the next one starts.
+ */
+enum input_latency_stage
+{
+    INPUT_LATENCY_DEMUX, /**< from the demuxer output to the decoder input */
+    INPUT_LATENCY_DECODE, /**< from the decoder input to its output */
+    INPUT_LATENCY_FILTER, /**< from the decoder output to the video filters
+                               output, including the video output queue */
+    INPUT_LATENCY_DISPLAY, /**< from the video filters output to the display,
+                                including the wait for the presentation date */
+    INPUT_LATENCY_TOTAL, /**< from the demuxer output to the display */
+};
+#define INPUT_LATENCY_STAGE_COUNT (INPUT_LATENCY_TOTAL + 1)
+
+/**
+ * Latency distribution of a pipeline stage
+ */
+struct input_latency_stats
+{
+    vlc_tick_t p50; /**< median, VLC_TICK_INVALID if count is 0 */
+    vlc_tick_t p99; /**< 99th percentile */
+    vlc_tick_t max; /**< maximum */
+    int64_t count; /**< number of samples */
+};
+
 struct input_stats_t
 {
     /* Input */
     int64_t i_read_packets;
     int64_t i_read_bytes;
     float f_input_bitrate;
+    /* Packets dropped by the network stack before the access read them */
+    int64_t i_lost_packets;
+    /* Time spent by the packets in the network stack */
+    struct input_latency_stats receive_delay;
+    /* Reads served from, or missing in, the stream read-ahead buffer */
+    int64_t i_readahead_hits;
+    int64_t i_readahead_misses;
+    /* Time spent waiting for the read-ahead on misses */
+    struct input_latency_stats readahead_stall;
 
     /* Demux */
     int64_t i_demux_read_packets;
@@ -525,6 +562,8 @@ struct input_stats_t
     int64_t i_displayed_pictures;
     int64_t i_late_pictures;
     int64_t i_lost_pictures;
+    /* Latency of the video pipeline, since the input start */
+    struct input_latency_stats latency[INPUT_LATENCY_STAGE_COUNT];
 
     /* Aout */
     int64_t i_played_abuffers;
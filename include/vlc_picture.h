@@ -136,6 +136,7 @@ struct picture_t
     vlc_tick_t      date;                                  /**< display date */
     bool            b_force;
     bool            b_still;
+    struct vlc_frame_trace trace;            /**< pipeline latency tracing */
     /**@}*/
 
     /** \name Picture dynamic properties
@@ -160,6 +160,7 @@ enum stream_query_e
     STREAM_GET_SIGNAL,      /**< arg1=double *pf_quality, arg2=double *pf_strength   res=can fail */
     STREAM_GET_TAGS,        /**< arg1=const block_t ** res=can fail */
     STREAM_GET_TYPE,        /**< arg1=int*             res=can fail */
+    STREAM_GET_MAPPED_BLOCK, /**< arg1= uint64_t offset, arg2= size_t length, arg3= block_t ** res=can fail */
 
     STREAM_SET_PAUSE_STATE = 0x200, /**< arg1= bool        res=can fail */
     STREAM_SET_TITLE,       /**< arg1= int          res=can fail */
@@ -168,11 +169,23 @@ enum stream_query_e
     /* XXX only data read through vlc_stream_Read/Block will be recorded */
     STREAM_SET_RECORD_STATE,     /**< arg1=bool, arg2=const char *psz_ext (if arg1 is true)  res=can fail */
 
+    STREAM_SET_ACCESS_HINT, /**< arg1= int (stream_access_hint_e) res=can fail */
+
     STREAM_SET_PRIVATE_ID_STATE = 0x1000, /* arg1= int i_private_data, bool b_selected    res=can fail */
     STREAM_SET_PRIVATE_ID_CA,             /* arg1= void * */
     STREAM_GET_PRIVATE_ID_STATE,          /* arg1=int i_private_data arg2=bool *          res=can fail */
 };
 
+/**
+ * Expected access patterns, for STREAM_SET_ACCESS_HINT
+ */
+enum stream_access_hint_e
+{
+    STREAM_ACCESS_NORMAL,
+    STREAM_ACCESS_SEQUENTIAL, /**< data is read in order, read ahead */
+    STREAM_ACCESS_RANDOM, /**< data is read out of order, do not read ahead */
+};
+
 /**
  * Reads data from a byte stream.
  *
@@ -302,6 +315,21 @@ static inline int vlc_stream_Control(stream_t *s, int query, ...)
 }
 
 VLC_API block_t *vlc_stream_Block(stream_t *s, size_t);
+
+/**
+ * Reads a block of data, referencing the source memory if possible.
+ *
+ * This function is equivalent to vlc_stream_Block(), except that if the
+ * stream supports STREAM_GET_MAPPED_BLOCK, e.g. a local file mapped in memory,
+ * the returned block references the source pages rather than a copy.
+ * Small blocks are copied anyway, as that is cheaper. Stream filters which
+ * transform or record the data refuse the query, and their data is copied.
+ *
+ * \param s stream to read from
+ * \param size number of bytes to read
+ * \return a block of at most size bytes, or NULL on error or end-of-stream
+ */
+VLC_API block_t *vlc_stream_BlockMapped(stream_t *s, size_t size) VLC_USED;
 VLC_API char *vlc_stream_ReadLine(stream_t *);
 
 /**
@@ -332,6 +360,17 @@ VLC_USED static inline int vlc_stream_GetSize( stream_t *s, uint64_t *size )
     return vlc_stream_Control( s, STREAM_GET_SIZE, size );
 }
 
+/**
+ * Tells the stream how its data is going to be read.
+ *
+ * Accesses may use this to tune read-ahead. This is only a hint.
+ */
+static inline int vlc_stream_SetAccessHint(stream_t *s,
+                                           enum stream_access_hint_e hint)
+{
+    return vlc_stream_Control(s, STREAM_SET_ACCESS_HINT, (int)hint);
+}
+
 static inline int64_t stream_Size( stream_t *s )
 {
     uint64_t i_pos;
@@ -492,6 +531,17 @@ VLC_API void vlc_stream_fifo_Close(vlc_stream_fifo_t *s);
  **/
 VLC_API stream_t* vlc_stream_FilterNew( stream_t *p_source, const char *psz_stream_filter );
 
+/**
+ * Reports the outcome of a read from a read-ahead buffer.
+ *
+ * This is accounted in the statistics of the input of the stream, if any.
+ *
+ * \param s stream filter
+ * \param stall zero if the data was already buffered (hit), otherwise the
+ *              time spent waiting for it (miss)
+ */
+VLC_API void vlc_stream_ReportReadAhead(stream_t *s, vlc_tick_t stall);
+
 /**
  * @}
  */
@@ -297,6 +297,28 @@ VLC_API vlc_tick_t date_Decrement(date_t *restrict date, uint32_t count);
 
 /** @} */
 
+/**
+ * Pipeline trace context
+ *
+ * System dates (as returned by vlc_tick_now()) at which a frame went through
+ * each stage of the playback pipeline. Stages that were not (yet) reached are
+ * set to VLC_TICK_INVALID. This context travels with blocks and pictures and
+ * is used to measure the per-stage latency up to the display.
+ */
+struct vlc_frame_trace
+{
+    vlc_tick_t demux; /**< output from the demuxer */
+    vlc_tick_t decode; /**< input to the decoder */
+    vlc_tick_t decoded; /**< output from the decoder */
+    vlc_tick_t filtered; /**< output from the video filters */
+};
+
+static inline void vlc_frame_trace_Init(struct vlc_frame_trace *trace)
+{
+    trace->demux = trace->decode = trace->decoded = trace->filtered =
+        VLC_TICK_INVALID;
+}
+
 /**
  * @return NTP 64-bits timestamp in host byte order.
  */
@@ -52,6 +52,9 @@
 #   include <unistd.h>
 #endif
 #include <dirent.h>
+#ifdef HAVE_MMAP
+#   include <sys/mman.h>
+#endif
 
 #include <vlc_common.h>
 #include "fs.h"
@@ -62,12 +65,33 @@
 #include <vlc_fs.h>
 #include <vlc_url.h>
 #include <vlc_interrupt.h>
+#include <vlc_atomic.h>
+#include <vlc_block.h>
+
+#ifdef HAVE_MMAP
+/* Read-only view of the whole file, shared by the access and its blocks */
+struct file_map
+{
+    vlc_atomic_rc_t rc;
+    void *addr;
+    size_t length;
+};
+
+struct file_map_block
+{
+    block_t block;
+    struct file_map *map;
+};
+#endif
 
 typedef struct
 {
     int fd;
 
     bool b_pace_control;
+#ifdef HAVE_MMAP
+    struct file_map *map;
+#endif
 } access_sys_t;
 
 #if !defined (_WIN32) && !defined (__OS2__)
@@ -130,6 +154,73 @@ static ssize_t Read (stream_t *, void *, size_t);
 static int FileSeek (stream_t *, uint64_t);
 static int FileControl (stream_t *, int, va_list);
 
+#ifdef HAVE_MMAP
+static struct file_map *FileMapNew (int fd, size_t length)
+{
+    struct file_map *map = malloc (sizeof (*map));
+    if (unlikely(map == NULL))
+        return NULL;
+
+    /* Private writable mapping, as block_File(): blocks are writable */
+    map->addr = mmap (NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE,
+                      fd, 0);
+    if (map->addr == MAP_FAILED)
+    {
+        free (map);
+        return NULL;
+    }
+    map->length = length;
+    vlc_atomic_rc_init (&map->rc);
+    return map;
+}
+
+static void FileMapRelease (struct file_map *map)
+{
+    if (vlc_atomic_rc_dec (&map->rc))
+    {
+        munmap (map->addr, map->length);
+        free (map);
+    }
+}
+
+static void FileMapBlockRelease (block_t *block)
+{
+    struct file_map_block *mb = container_of(block, struct file_map_block,
+                                             block);
+
+    FileMapRelease (mb->map);
+    free (mb);
+}
+
+static const struct vlc_block_callbacks file_map_block_cbs =
+{
+    FileMapBlockRelease,
+};
+
+static block_t *FileMapBlock (struct file_map *map, uint64_t offset,
+                              size_t length)
+{
+    if (offset > map->length || length > map->length - offset)
+        return NULL; /* beyond the mapping, e.g. the file has grown */
+
+    struct file_map_block *mb = malloc (sizeof (*mb));
+    if (unlikely(mb == NULL))
+        return NULL;
+
+    uint8_t *addr = (uint8_t *)map->addr + offset;
+
+    /* Page the data in now, rather than fault page by page in the decoder */
+    uintptr_t page_mask = sysconf (_SC_PAGESIZE) - 1;
+    uint8_t *start = (uint8_t *)((uintptr_t)addr & ~page_mask);
+    madvise (start, addr + length - start, MADV_WILLNEED);
+
+    vlc_atomic_rc_inc (&map->rc);
+    mb->map = map;
+    block_Init (&mb->block, &file_map_block_cbs, addr, length);
+    return &mb->block;
+}
+#endif
+
 /*****************************************************************************
  * FileOpen: open the file
  *****************************************************************************/
@@ -213,6 +304,9 @@ int FileOpen( vlc_object_t *p_this )
     p_access->pf_control = FileControl;
     p_access->p_sys = p_sys;
     p_sys->fd = fd;
+#ifdef HAVE_MMAP
+    p_sys->map = NULL;
+#endif
 
     if (S_ISREG (st.st_mode) || S_ISBLK (st.st_mode))
     {
@@ -231,6 +325,17 @@ int FileOpen( vlc_object_t *p_this )
             fcntl (fd, F_RDAHEAD, 0);
         else
             fcntl (fd, F_RDAHEAD, 1);
+#endif
+#ifdef HAVE_MMAP
+        if (S_ISREG (st.st_mode) && st.st_size > 0
+         && (uintmax_t)st.st_size < SIZE_MAX
+         && var_InheritBool (p_access, "file-mmap"))
+        {
+            p_sys->map = FileMapNew (fd, st.st_size);
+            if (p_sys->map == NULL)
+                msg_Warn (p_access, "cannot map file: %s",
+                          vlc_strerror_c(errno));
+        }
 #endif
     }
     else
@@ -261,6 +366,11 @@ void FileClose (vlc_object_t * p_this)
 
     access_sys_t *p_sys = p_access->p_sys;
 
+#ifdef HAVE_MMAP
+    /* Blocks still in use keep the mapping alive */
+    if (p_sys->map != NULL)
+        FileMapRelease (p_sys->map);
+#endif
     vlc_close (p_sys->fd);
 }
 
@@ -346,6 +456,53 @@ static int FileControl( stream_t *p_access, int i_query, va_list args )
             /* Nothing to do */
             break;
 
+#ifdef HAVE_MMAP
+        case STREAM_GET_MAPPED_BLOCK:
+        {
+            uint64_t offset = va_arg( args, uint64_t );
+            size_t length = va_arg( args, size_t );
+            block_t **pp_block = va_arg( args, block_t ** );
+
+            if (p_sys->map == NULL)
+                return VLC_EGENERIC;
+            *pp_block = FileMapBlock (p_sys->map, offset, length);
+            if (*pp_block == NULL)
+                return VLC_EGENERIC;
+            break;
+        }
+#endif
+
+        case STREAM_SET_ACCESS_HINT:
+        {
+            int hint = va_arg( args, int );
+
+            if (p_access->pf_seek == NULL)
+                return VLC_EGENERIC;
+#ifdef HAVE_POSIX_FADVISE
+            static const int fadv[] = {
+                [STREAM_ACCESS_NORMAL] = POSIX_FADV_NORMAL,
+                [STREAM_ACCESS_SEQUENTIAL] = POSIX_FADV_SEQUENTIAL,
+                [STREAM_ACCESS_RANDOM] = POSIX_FADV_RANDOM,
+            };
+            if ((unsigned)hint >= ARRAY_SIZE(fadv))
+                return VLC_EGENERIC;
+            posix_fadvise (p_sys->fd, 0, 0, fadv[hint]);
+#endif
+#ifdef HAVE_MMAP
+            static const int madv[] = {
+                [STREAM_ACCESS_NORMAL] = MADV_NORMAL,
+                [STREAM_ACCESS_SEQUENTIAL] = MADV_SEQUENTIAL,
+                [STREAM_ACCESS_RANDOM] = MADV_RANDOM,
+            };
+            if ((unsigned)hint >= ARRAY_SIZE(madv))
+                return VLC_EGENERIC;
+            if (p_sys->map != NULL)
+                madvise (p_sys->map->addr, p_sys->map->length, madv[hint]);
+#endif
+            (void) hint;
+            break;
+        }
+
         default:
             return VLC_EGENERIC;
 
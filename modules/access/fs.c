@@ -38,6 +38,12 @@ vlc_module_begin ()
     set_capability( "access", 50 )
     add_shortcut( "file", "fd", "stream" )
     set_callbacks( FileOpen, FileClose )
+#ifdef HAVE_MMAP
+    add_bool("file-mmap", false, N_("Map files in memory"),
+             N_("Map local files in memory, so that demuxers can pass their "
+                "data without copies. Truncating a file while it is being "
+                "played crashes VLC."))
+#endif
 
     add_submodule()
     set_section( N_("Directory" ), NULL )
@@ -96,6 +96,11 @@ static char *vlc_http_proxy_find(const char *hostname, unsigned port,
 }
 
 
+/* A shared manager can be used from several threads at once. The lock
+ * protects the credentials and the connection, but is not held while waiting
+ * for the network, so that requests multiplexed on an HTTP/2 connection do
+ * not wait for each other. HTTP/1 connections serve one request at a time,
+ * so a shared manager does not keep them for reuse. */
 struct vlc_http_mgr
 {
     struct vlc_logger *logger;
@@ -103,6 +108,11 @@ struct vlc_http_mgr
     vlc_tls_client_t *creds;
     struct vlc_http_cookie_jar_t *jar;
     struct vlc_http_conn *conn;
+    bool multiplexed; /* conn is HTTP/2 */
+    bool shared; /* used by several threads */
+    bool connecting; /* a thread is establishing a connection */
+    vlc_mutex_t lock;
+    vlc_cond_t wait;
 };
 
 static struct vlc_http_conn *vlc_http_mgr_find(struct vlc_http_mgr *mgr,
@@ -117,32 +127,78 @@ static void vlc_http_mgr_release(struct vlc_http_mgr *mgr,
 {
     assert(mgr->conn == conn);
     mgr->conn = NULL;
+    mgr->multiplexed = false;
 
     vlc_http_conn_release(conn);
 }
 
-static
-struct vlc_http_msg *vlc_http_mgr_reuse(struct vlc_http_mgr *mgr,
-                                        const char *host, unsigned port,
-                                        const struct vlc_http_msg *req,
-                                        bool payload)
+static void vlc_http_mgr_set(struct vlc_http_mgr *mgr,
+                             struct vlc_http_conn *conn, bool multiplexed)
 {
-    struct vlc_http_conn *conn = vlc_http_mgr_find(mgr, host, port);
-    if (conn == NULL)
-        return NULL;
+    if (mgr->conn != NULL)
+        vlc_http_mgr_release(mgr, mgr->conn);
 
+    mgr->conn = conn;
+    mgr->multiplexed = multiplexed;
+}
+
+/* Must be called with the lock held, which is released on return */
+static
+struct vlc_http_msg *vlc_http_mgr_send(struct vlc_http_mgr *mgr,
+                                       struct vlc_http_conn *conn,
+                                       const struct vlc_http_msg *req,
+                                       bool payload)
+{
     struct vlc_http_stream *stream = vlc_http_stream_open(conn, req, payload);
+    vlc_mutex_unlock(&mgr->lock);
+
     if (stream != NULL)
     {
         struct vlc_http_msg *m = vlc_http_msg_get_initial(stream);
         if (m != NULL)
             return m;
     }
-    /* Get rid of closing or reset connection */
-    vlc_http_mgr_release(mgr, conn);
+    /* Get rid of closing or reset connection, unless already replaced */
+    vlc_mutex_lock(&mgr->lock);
+    if (mgr->conn == conn)
+        vlc_http_mgr_release(mgr, conn);
+    vlc_mutex_unlock(&mgr->lock);
     return NULL;
 }
 
+/* Sends a request on a connection that is not kept for reuse */
+static
+struct vlc_http_msg *vlc_http_mgr_send_once(struct vlc_http_conn *conn,
+                                            const struct vlc_http_msg *req,
+                                            bool payload)
+{
+    struct vlc_http_stream *stream = vlc_http_stream_open(conn, req, payload);
+    struct vlc_http_msg *m = NULL;
+
+    if (stream != NULL)
+        m = vlc_http_msg_get_initial(stream);
+    /* The connection is closed once the stream is */
+    vlc_http_conn_release(conn);
+    return m;
+}
+
+static
+struct vlc_http_msg *vlc_http_mgr_reuse(struct vlc_http_mgr *mgr,
+                                        const char *host, unsigned port,
+                                        const struct vlc_http_msg *req,
+                                        bool payload)
+{
+    vlc_mutex_lock(&mgr->lock);
+    struct vlc_http_conn *conn = vlc_http_mgr_find(mgr, host, port);
+    if (conn == NULL)
+    {
+        vlc_mutex_unlock(&mgr->lock);
+        return NULL;
+    }
+
+    return vlc_http_mgr_send(mgr, conn, req, payload);
+}
+
 static struct vlc_http_msg *vlc_https_request(struct vlc_http_mgr *mgr,
                                               const char *host, unsigned port,
                                               const struct vlc_http_msg *req,
@@ -151,17 +207,25 @@ static struct vlc_http_msg *vlc_https_request(struct vlc_http_mgr *mgr,
     vlc_tls_t *tls;
     bool http2 = true;
 
+    vlc_mutex_lock(&mgr->lock);
     if (mgr->creds == NULL && mgr->conn != NULL)
+    {
+        vlc_mutex_unlock(&mgr->lock);
         return NULL; /* switch from HTTP to HTTPS not implemented */
+    }
 
     if (mgr->creds == NULL)
     {   /* First TLS connection: load x509 credentials */
         mgr->creds = vlc_tls_ClientCreate(mgr->obj);
         if (mgr->creds == NULL)
+        {
+            vlc_mutex_unlock(&mgr->lock);
             return NULL;
+        }
     }
+    vlc_mutex_unlock(&mgr->lock);
 
-    if (idempotent)
+    while (idempotent)
     {   /* If the request is idempotent, try to reuse an existing connection.
          * Otherwise, it is possible but unadvisable as we would not know if
          * the nonidempotent request was processed if the connection fails
@@ -171,6 +235,20 @@ static struct vlc_http_msg *vlc_https_request(struct vlc_http_mgr *mgr,
                                                        payload);
         if (resp != NULL)
             return resp; /* existing connection reused */
+
+        /* If another thread is already connecting, wait for its connection
+         * rather than opening another one in parallel. */
+        vlc_mutex_lock(&mgr->lock);
+        bool wait = mgr->connecting;
+        if (wait)
+            while (mgr->connecting)
+                vlc_cond_wait(&mgr->wait, &mgr->lock);
+        else
+            mgr->connecting = true;
+        vlc_mutex_unlock(&mgr->lock);
+
+        if (!wait)
+            break;
     }
 
     char *proxy = vlc_http_proxy_find(host, port, true);
@@ -183,10 +261,10 @@ static struct vlc_http_msg *vlc_https_request(struct vlc_http_mgr *mgr,
     else
         tls = vlc_https_connect(mgr->creds, host, port, &http2);
 
-    if (tls == NULL)
-        return NULL;
+    struct vlc_http_conn *conn = NULL;
 
-    struct vlc_http_conn *conn;
+    if (tls == NULL)
+        goto out;
 
     /* For HTTPS, TLS-ALPN determines whether HTTP version 2.0 ("h2") or 1.1
      * ("http/1.1") is used.
@@ -201,16 +279,31 @@ static struct vlc_http_msg *vlc_https_request(struct vlc_http_mgr *mgr,
         conn = vlc_h1_conn_create(mgr->logger, tls, false);
 
     if (unlikely(conn == NULL))
-    {
         vlc_tls_Close(tls);
+
+out:
+    vlc_mutex_lock(&mgr->lock);
+    if (idempotent)
+    {
+        mgr->connecting = false;
+        vlc_cond_broadcast(&mgr->wait);
+    }
+
+    if (conn == NULL)
+    {
+        vlc_mutex_unlock(&mgr->lock);
         return NULL;
     }
 
-    if (mgr->conn != NULL)
-        vlc_http_mgr_release(mgr, mgr->conn);
+    if (!http2 && mgr->shared)
+    {   /* Other threads must not send requests on this connection */
+        vlc_mutex_unlock(&mgr->lock);
+        return vlc_http_mgr_send_once(conn, req, payload);
+    }
 
-    mgr->conn = conn;
-    return vlc_http_mgr_reuse(mgr, host, port, req, payload);
+    vlc_http_mgr_set(mgr, conn, http2);
+    /* Send on the new connection before any other thread can use it */
+    return vlc_http_mgr_send(mgr, conn, req, payload);
 }
 
 static struct vlc_http_msg *vlc_http_request(struct vlc_http_mgr *mgr,
@@ -218,7 +311,11 @@ static struct vlc_http_msg *vlc_http_request(struct vlc_http_mgr *mgr,
                                              const struct vlc_http_msg *req,
                                              bool idempotent, bool payload)
 {
-    if (mgr->creds != NULL && mgr->conn != NULL)
+    vlc_mutex_lock(&mgr->lock);
+    bool secure = mgr->creds != NULL && mgr->conn != NULL;
+    vlc_mutex_unlock(&mgr->lock);
+
+    if (secure)
         return NULL; /* switch from HTTPS to HTTP not implemented */
 
     if (idempotent)
@@ -257,16 +354,15 @@ static struct vlc_http_msg *vlc_http_request(struct vlc_http_mgr *mgr,
         return NULL;
 
     struct vlc_http_msg *resp = vlc_http_msg_get_initial(stream);
-    if (resp == NULL)
-    {
+    if (resp == NULL || mgr->shared)
+    {   /* HTTP/1 connections are not reused by shared managers */
         vlc_http_conn_release(conn);
-        return NULL;
+        return resp;
     }
 
-    if (mgr->conn != NULL)
-        vlc_http_mgr_release(mgr, mgr->conn);
-
-    mgr->conn = conn;
+    vlc_mutex_lock(&mgr->lock);
+    vlc_http_mgr_set(mgr, conn, false);
+    vlc_mutex_unlock(&mgr->lock);
     return resp;
 }
 
@@ -287,8 +383,17 @@ struct vlc_http_cookie_jar_t *vlc_http_mgr_get_jar(struct vlc_http_mgr *mgr)
     return mgr->jar;
 }
 
-struct vlc_http_mgr *vlc_http_mgr_create(vlc_object_t *obj,
-                                         struct vlc_http_cookie_jar_t *jar)
+bool vlc_http_mgr_is_multiplexed(struct vlc_http_mgr *mgr)
+{
+    vlc_mutex_lock(&mgr->lock);
+    bool multiplexed = mgr->multiplexed;
+    vlc_mutex_unlock(&mgr->lock);
+    return multiplexed;
+}
+
+static struct vlc_http_mgr *vlc_http_mgr_new(vlc_object_t *obj,
+                                             struct vlc_http_cookie_jar_t *jar,
+                                             bool shared)
 {
     struct vlc_http_mgr *mgr = malloc(sizeof (*mgr));
     if (unlikely(mgr == NULL))
@@ -299,9 +404,26 @@ struct vlc_http_mgr *vlc_http_mgr_create(vlc_object_t *obj,
     mgr->creds = NULL;
     mgr->jar = jar;
     mgr->conn = NULL;
+    mgr->multiplexed = false;
+    mgr->shared = shared;
+    mgr->connecting = false;
+    vlc_mutex_init(&mgr->lock);
+    vlc_cond_init(&mgr->wait);
     return mgr;
 }
 
+struct vlc_http_mgr *vlc_http_mgr_create(vlc_object_t *obj,
+                                         struct vlc_http_cookie_jar_t *jar)
+{
+    return vlc_http_mgr_new(obj, jar, false);
+}
+
+struct vlc_http_mgr *vlc_http_mgr_create_shared(vlc_object_t *obj,
+                                                struct vlc_http_cookie_jar_t *jar)
+{
+    return vlc_http_mgr_new(obj, jar, true);
+}
+
 void vlc_http_mgr_destroy(struct vlc_http_mgr *mgr)
 {
     if (mgr->conn != NULL)
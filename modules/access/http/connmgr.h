@@ -57,10 +57,19 @@ struct vlc_http_msg *vlc_http_mgr_request(struct vlc_http_mgr *mgr, bool https,
 
 struct vlc_http_cookie_jar_t *vlc_http_mgr_get_jar(struct vlc_http_mgr *);
 
+/**
+ * Checks whether requests are multiplexed
+ *
+ * @return true if the manager is connected with HTTP/2, in which case
+ * concurrent requests share the same connection.
+ */
+bool vlc_http_mgr_is_multiplexed(struct vlc_http_mgr *);
+
 /**
  * Creates an HTTP connection manager
  *
- * Allocates an HTTP client connections manager.
+ * Allocates an HTTP client connections manager. The manager must not be used
+ * by several threads at the same time.
  *
  * @param obj parent VLC object
  * @param jar HTTP cookies jar (NULL to disable cookies)
@@ -68,6 +77,19 @@ struct vlc_http_cookie_jar_t *vlc_http_mgr_get_jar(struct vlc_http_mgr *);
 struct vlc_http_mgr *vlc_http_mgr_create(vlc_object_t *obj,
                                          struct vlc_http_cookie_jar_t *jar);
 
+/**
+ * Creates a shared HTTP connection manager
+ *
+ * Allocates an HTTP client connections manager that can be used by several
+ * threads at once. Concurrent requests share HTTP/2 connections. HTTP/1.x
+ * connections are not reused: each request gets its own.
+ *
+ * @param obj parent VLC object
+ * @param jar HTTP cookies jar (NULL to disable cookies)
+ */
+struct vlc_http_mgr *vlc_http_mgr_create_shared(vlc_object_t *obj,
+                                                struct vlc_http_cookie_jar_t *jar);
+
 /**
  * Destroys an HTTP connection manager
  *
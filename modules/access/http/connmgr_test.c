@@ -0,0 +1,255 @@
+/*****************************************************************************
+ * connmgr_test.c: HTTP connections manager test
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#undef NDEBUG
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <sys/types.h>
+#include <unistd.h>
+#ifdef HAVE_SYS_SOCKET_H
+#include <sys/socket.h>
+#endif
+#ifndef SOCK_CLOEXEC
+# define SOCK_CLOEXEC 0
+# define accept4(a,b,c,d) accept(a,b,c)
+#endif
+#ifdef _WIN32
+# include <winsock2.h>
+#else
+# include <netinet/in.h>
+#endif
+#ifdef HAVE_ARPA_INET_H
+#include <arpa/inet.h>
+#endif
+
+#include <vlc_common.h>
+#include <vlc_block.h>
+#include <vlc_network.h>
+#include "connmgr.h"
+#include "message.h"
+
+const char vlc_module_name[] = "test_http_connmgr";
+
+#define THREADS  8
+#define REQUESTS 16
+#define MAX_CONNECTIONS (THREADS * REQUESTS + 1)
+
+static const char body[] = "Hello world!";
+
+/* Serves HTTP/1.1 requests on a connection until the client closes it */
+static void *server_conn_thread(void *data)
+{
+    int fd = (intptr_t)data;
+    char buf[1024];
+    size_t buflen = 0;
+
+    for (;;)
+    {
+        char *eoh;
+
+        while ((eoh = strnstr(buf, "\r\n\r\n", buflen)) == NULL)
+        {
+            ssize_t val = recv(fd, buf + buflen, sizeof (buf) - buflen - 1,
+                               0);
+            if (val <= 0)
+            {
+                vlc_close(fd);
+                return NULL;
+            }
+            buflen += val;
+        }
+
+        assert(!strncmp(buf, "GET / HTTP/1.1\r\n", 16));
+
+        char resp[256];
+        int len = snprintf(resp, sizeof (resp), "HTTP/1.1 200 OK\r\n"
+                           "Content-Length: %zu\r\n\r\n%s",
+                           strlen(body), body);
+        assert(len > 0 && (size_t)len < sizeof (resp));
+        ssize_t val = send(fd, resp, len, 0);
+        assert(val == len);
+
+        eoh += 4;
+        buflen -= eoh - buf;
+        memmove(buf, eoh, buflen);
+    }
+}
+
+static vlc_thread_t conn_threads[MAX_CONNECTIONS];
+static unsigned connection_count = 0;
+
+static void *server_thread(void *data)
+{
+    int *lfd = data;
+
+    for (;;)
+    {
+        int cfd = accept4(*lfd, NULL, NULL, SOCK_CLOEXEC);
+        if (cfd == -1)
+            continue;
+
+        int canc = vlc_savecancel();
+        assert(connection_count < MAX_CONNECTIONS);
+        if (vlc_clone(&conn_threads[connection_count], server_conn_thread,
+                      (void *)(intptr_t)cfd, VLC_THREAD_PRIORITY_LOW))
+            assert(!"Thread error");
+        connection_count++;
+        vlc_restorecancel(canc);
+    }
+    vlc_assert_unreachable();
+}
+
+static int server_socket(unsigned *port)
+{
+    int fd = socket(PF_INET, SOCK_STREAM|SOCK_CLOEXEC, IPPROTO_TCP);
+    if (fd == -1)
+        return -1;
+
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+#ifdef HAVE_SA_LEN
+        .sin_len = sizeof (addr),
+#endif
+        .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+    };
+    socklen_t addrlen = sizeof (addr);
+
+    if (bind(fd, (struct sockaddr *)&addr, addrlen)
+     || getsockname(fd, (struct sockaddr *)&addr, &addrlen)
+     || listen(fd, 255))
+    {
+        vlc_close(fd);
+        return -1;
+    }
+
+    *port = ntohs(addr.sin_port);
+    return fd;
+}
+
+static struct vlc_http_mgr *mgr;
+static unsigned port;
+
+static void request(void)
+{
+    char authority[32];
+
+    snprintf(authority, sizeof (authority), "127.0.0.1:%u", port);
+
+    struct vlc_http_msg *req = vlc_http_req_create("GET", "http", authority,
+                                                   "/");
+    assert(req != NULL);
+
+    struct vlc_http_msg *m = vlc_http_mgr_request(mgr, false, "127.0.0.1",
+                                                  port, req, true, false);
+    assert(m != NULL);
+    vlc_http_msg_destroy(req);
+
+    m = vlc_http_msg_get_final(m);
+    assert(m != NULL);
+    assert(vlc_http_msg_get_status(m) == 200);
+
+    char buf[sizeof (body)];
+    size_t len = 0;
+    block_t *b;
+
+    while ((b = vlc_http_msg_read(m)) != NULL)
+    {
+        assert(b != vlc_http_error);
+        assert(len + b->i_buffer < sizeof (buf));
+        memcpy(buf + len, b->p_buffer, b->i_buffer);
+        len += b->i_buffer;
+        block_Release(b);
+    }
+    assert(len == strlen(body));
+    assert(!memcmp(buf, body, len));
+    vlc_http_msg_destroy(m);
+}
+
+static void *client_thread(void *data)
+{
+    (void) data;
+
+    for (unsigned i = 0; i < REQUESTS; i++)
+        request();
+    return NULL;
+}
+
+int main(void)
+{
+    /* Dummy object: the managers only use its logger */
+    vlc_object_t obj = { .logger = NULL };
+
+    int *lfd = malloc(sizeof (int));
+    assert(lfd != NULL);
+    *lfd = server_socket(&port);
+    if (*lfd == -1)
+    {
+        free(lfd);
+        return 77;
+    }
+
+    vlc_thread_t th;
+    if (vlc_clone(&th, server_thread, lfd, VLC_THREAD_PRIORITY_LOW))
+        assert(!"Thread error");
+
+    /* Test HTTP/1.1 connection reuse by sequential requests */
+    mgr = vlc_http_mgr_create(&obj, NULL);
+    assert(mgr != NULL);
+    for (unsigned i = 0; i < REQUESTS; i++)
+        request();
+    assert(!vlc_http_mgr_is_multiplexed(mgr));
+    vlc_http_mgr_destroy(mgr);
+
+    /* Test concurrent requests against an HTTP/1.1 server */
+    mgr = vlc_http_mgr_create_shared(&obj, NULL);
+    assert(mgr != NULL);
+
+    vlc_thread_t clients[THREADS];
+
+    for (unsigned i = 0; i < THREADS; i++)
+        if (vlc_clone(&clients[i], client_thread, NULL,
+                      VLC_THREAD_PRIORITY_LOW))
+            assert(!"Thread error");
+    for (unsigned i = 0; i < THREADS; i++)
+        vlc_join(clients[i], NULL);
+
+    assert(!vlc_http_mgr_is_multiplexed(mgr));
+    vlc_http_mgr_destroy(mgr);
+
+    vlc_cancel(th);
+    vlc_join(th, NULL);
+
+    /* One connection for the sequential requests, one per shared request */
+    assert(connection_count == MAX_CONNECTIONS);
+    for (unsigned i = 0; i < connection_count; i++)
+        vlc_join(conn_threads[i], NULL);
+
+    vlc_close(*lfd);
+    free(lfd);
+    return 0;
+}
@@ -47,19 +47,49 @@
 #ifdef HAVE_SYS_UIO_H
 # include <sys/uio.h>
 #endif
+#ifdef HAVE_RECVMMSG
+# include <time.h>
+# include <sys/socket.h>
+# include <netinet/udp.h>
+#endif
 
 /* Buffer can be max theoretical datagram content minus anticipated MTU.
  * IPv6 headers are larger than IPv4, ignore IPv6 jumbograms.
  */
 #define MRU 65507u
 
+#ifdef HAVE_RECVMMSG
+/* Number of datagrams received per system call */
+# define BATCH 32
+/* Room for a datagram, or for a train of datagrams coalesced by GRO */
+# define SLOT 65536u
+#endif
+
 typedef struct {
     int fd;
     int timeout;
 
+#ifdef HAVE_RECVMMSG
+    /* Datagrams of the last batch, read from slot[index] + offset */
+    struct mmsghdr msgs[BATCH];
+    struct iovec iovs[BATCH];
+    union {
+        char buf[CMSG_SPACE(sizeof (struct timespec))
+               + CMSG_SPACE(sizeof (uint32_t))
+               + CMSG_SPACE(sizeof (int))];
+        struct cmsghdr align;
+    } control[BATCH];
+    unsigned count;
+    unsigned index;
+    size_t offset;
+
+    uint32_t drops; /* datagrams dropped by the kernel so far */
+    uint8_t *slab; /* BATCH slots of SLOT bytes, only touched pages are used */
+#else
     size_t length;
     char *offset;
     char buf[MRU];
+#endif
 } access_sys_t;
 
 static int Control(stream_t *access, int query, va_list args)
@@ -83,6 +113,99 @@ static int Control(stream_t *access, int query, va_list args)
     return VLC_SUCCESS;
 }
 
+#ifdef HAVE_RECVMMSG
+/* Accounts the kernel drop counter and receive timestamp of a batch */
+static void ReportReceive(stream_t *access)
+{
+    access_sys_t *sys = access->p_sys;
+    vlc_tick_t delay = VLC_TICK_INVALID;
+    uint32_t drops = sys->drops;
+
+    for (unsigned i = 0; i < sys->count; i++) {
+        struct msghdr *msg = &sys->msgs[i].msg_hdr;
+
+        for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(msg); cmsg != NULL;
+             cmsg = CMSG_NXTHDR(msg, cmsg)) {
+            if (cmsg->cmsg_level != SOL_SOCKET)
+                continue;
+#ifdef SO_RXQ_OVFL
+            if (cmsg->cmsg_type == SO_RXQ_OVFL)
+                memcpy(&drops, CMSG_DATA(cmsg), sizeof (drops));
+#endif
+#ifdef SCM_TIMESTAMPNS
+            /* The first datagram is the one that waited the longest */
+            if (cmsg->cmsg_type == SCM_TIMESTAMPNS && i == 0) {
+                struct timespec ts, now;
+
+                memcpy(&ts, CMSG_DATA(cmsg), sizeof (ts));
+                if (clock_gettime(CLOCK_REALTIME, &now) == 0)
+                    delay = vlc_tick_from_timespec(&now)
+                          - vlc_tick_from_timespec(&ts);
+            }
+#endif
+        }
+    }
+
+    /* The kernel counter is cumulative, and wraps around */
+    vlc_access_ReportReceive(access, (uint32_t)(drops - sys->drops), delay);
+    sys->drops = drops;
+}
+
+static ssize_t Read(stream_t *access, void *buf, size_t len)
+{
+    access_sys_t *sys = access->p_sys;
+
+    if (sys->index >= sys->count) {
+        struct pollfd ufd[1];
+
+        ufd[0].fd = sys->fd;
+        ufd[0].events = POLLIN;
+
+        switch (vlc_poll_i11e(ufd, 1, sys->timeout)) {
+            case 0:
+                msg_Err(access, "receive time-out");
+                return 0;
+            case -1:
+                return -1;
+        }
+
+        for (unsigned i = 0; i < BATCH; i++)
+            sys->msgs[i].msg_hdr.msg_controllen = sizeof (sys->control[i]);
+
+        int val = recvmmsg(sys->fd, sys->msgs, BATCH, MSG_DONTWAIT, NULL);
+        if (val <= 0)
+            return -1;
+
+        sys->count = val;
+        sys->index = 0;
+        sys->offset = 0;
+        ReportReceive(access);
+    }
+
+    /* Copy as many datagrams as fit */
+    size_t copied = 0;
+
+    while (sys->index < sys->count && copied < len) {
+        const uint8_t *p = sys->iovs[sys->index].iov_base;
+        size_t length = sys->msgs[sys->index].msg_len - sys->offset;
+
+        p += sys->offset;
+        if (length > len - copied) {
+            length = len - copied;
+            sys->offset += length;
+        } else {
+            sys->index++;
+            sys->offset = 0;
+        }
+
+        memcpy((uint8_t *)buf + copied, p, length);
+        copied += length;
+    }
+
+    /* empty (0 bytes) payloads do *not* mean EOF here */
+    return copied > 0 ? (ssize_t)copied : -1;
+}
+#else
 static ssize_t Read(stream_t *access, void *buf, size_t len)
 {
     access_sys_t *sys = access->p_sys;
@@ -131,6 +254,7 @@ static ssize_t Read(stream_t *access, void *buf, size_t len)
 
     return val;
 }
+#endif
 
 /*****************************************************************************
  * Open: open the socket
@@ -147,7 +271,26 @@ static int Open( vlc_object_t *p_this )
     if( unlikely( sys == NULL ) )
         return VLC_ENOMEM;
 
+#ifdef HAVE_RECVMMSG
+    sys->slab = malloc(BATCH * SLOT);
+    if( unlikely(sys->slab == NULL) )
+        return VLC_ENOMEM;
+
+    for( unsigned i = 0; i < BATCH; i++ )
+    {
+        sys->iovs[i].iov_base = sys->slab + i * SLOT;
+        sys->iovs[i].iov_len = SLOT;
+        memset( &sys->msgs[i], 0, sizeof( sys->msgs[i] ) );
+        sys->msgs[i].msg_hdr.msg_iov = &sys->iovs[i];
+        sys->msgs[i].msg_hdr.msg_iovlen = 1;
+        sys->msgs[i].msg_hdr.msg_control = sys->control[i].buf;
+    }
+    sys->count = sys->index = 0;
+    sys->offset = 0;
+    sys->drops = 0;
+#else
     sys->length = 0;
+#endif
     p_access->p_sys = sys;
     p_access->pf_read = Read;
     p_access->pf_block = NULL;
@@ -160,7 +303,7 @@ static int Open( vlc_object_t *p_this )
     int  i_bind_port = 1234, i_server_port = 0;
 
     if( unlikely(psz_name == NULL) )
-        return VLC_ENOMEM;
+        goto error;
 
     /* Parse psz_name syntax :
      * [serveraddr[:serverport]][@[bindaddr]:[bindport]] */
@@ -210,14 +353,35 @@ static int Open( vlc_object_t *p_this )
     if( sys->fd == -1 )
     {
         msg_Err( p_access, "cannot open socket" );
-        return VLC_EGENERIC;
+        goto error;
     }
 
+#ifdef HAVE_RECVMMSG
+    /* Kernel receive timestamps and drop counters */
+# ifdef SO_TIMESTAMPNS
+    setsockopt( sys->fd, SOL_SOCKET, SO_TIMESTAMPNS, &(int){ 1 }, sizeof (int) );
+# endif
+# ifdef SO_RXQ_OVFL
+    setsockopt( sys->fd, SOL_SOCKET, SO_RXQ_OVFL, &(int){ 1 }, sizeof (int) );
+# endif
+# ifdef UDP_GRO
+    /* Datagrams are read as a byte stream, so the kernel can as well
+     * coalesce them: fewer, larger receives */
+    setsockopt( sys->fd, IPPROTO_UDP, UDP_GRO, &(int){ 1 }, sizeof (int) );
+# endif
+#endif
+
     sys->timeout = var_InheritInteger( p_access, "udp-timeout");
     if( sys->timeout > 0)
         sys->timeout *= 1000;
 
     return VLC_SUCCESS;
+
+error:
+#ifdef HAVE_RECVMMSG
+    free( sys->slab );
+#endif
+    return VLC_EGENERIC;
 }
 
 /*****************************************************************************
@@ -229,6 +393,9 @@ static void Close( vlc_object_t *p_this )
     access_sys_t *sys = p_access->p_sys;
 
     net_Close( sys->fd );
+#ifdef HAVE_RECVMMSG
+    free( sys->slab );
+#endif
 }
 
 #define TIMEOUT_TEXT N_("UDP Source timeout (sec)")
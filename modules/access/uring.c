@@ -0,0 +1,778 @@
+/*****************************************************************************
+ * uring.c: io_uring file input
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+#include <errno.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <sys/vfs.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <linux/io_uring.h>
+#include <linux/magic.h>
+
+#include <vlc_common.h>
+#include <vlc_access.h>
+#include <vlc_atomic.h>
+#include <vlc_block.h>
+#include <vlc_fs.h>
+#include <vlc_plugin.h>
+
+/* Alignment of the offsets, sizes and buffers of direct reads */
+#define DIRECT_ALIGN 4096
+
+/*
+ * Reads are issued in file order into a fixed pool of buffers, used as a
+ * ring: the buffer of the oldest read is returned first, as a block_t
+ * referencing the pool memory. It is read into again once the block has
+ * been released, possibly by another thread.
+ */
+struct uring_buf
+{
+    block_t block;
+    struct uring_pool *pool;
+    uint8_t *base;
+    uint64_t offset; /**< file offset of the read */
+    ssize_t result; /**< bytes read, or negative error code */
+    enum { BUF_FREE, BUF_QUEUED, BUF_READY, BUF_LENT } state;
+};
+
+struct uring_pool
+{
+    vlc_atomic_rc_t rc;
+    vlc_mutex_t lock; /**< protects the state of lent buffers */
+    uint8_t *memory;
+    size_t size; /**< size of each buffer */
+    unsigned count;
+    struct uring_buf bufs[];
+};
+
+typedef struct
+{
+    int fd;
+    int ring;
+    bool registered;
+    size_t align;
+
+    uint64_t size; /**< last known file size */
+    uint64_t offset; /**< stream offset */
+    uint64_t next; /**< file offset of the next read to queue */
+    unsigned head; /**< buffer of the oldest queued read */
+    unsigned queued; /**< number of queued reads */
+    bool random; /**< do not read ahead */
+
+    struct uring_pool *pool;
+
+    struct
+    {
+        unsigned *head;
+        unsigned *tail;
+        const unsigned *mask;
+        unsigned *array;
+        struct io_uring_sqe *sqes;
+        unsigned pending; /**< entries not yet submitted */
+        void *map;
+        size_t map_size;
+        size_t sqes_size;
+    } sq;
+    struct
+    {
+        unsigned *head;
+        const unsigned *tail;
+        const unsigned *mask;
+        const struct io_uring_cqe *cqes;
+        void *map;
+        size_t map_size;
+    } cq;
+} access_sys_t;
+
+static int uring_setup(unsigned entries, struct io_uring_params *params)
+{
+    return syscall(__NR_io_uring_setup, entries, params);
+}
+
+static int uring_enter(int ring, unsigned to_submit, unsigned min_complete,
+                       unsigned flags)
+{
+    return syscall(__NR_io_uring_enter, ring, to_submit, min_complete, flags,
+                   NULL, 0);
+}
+
+static int uring_register(int ring, unsigned opcode, const void *arg,
+                          unsigned count)
+{
+    return syscall(__NR_io_uring_register, ring, opcode, arg, count);
+}
+
+/* The rings are shared with the kernel */
+static unsigned LoadAcquire(const unsigned *p)
+{
+    return atomic_load_explicit((const _Atomic unsigned *)p,
+                                memory_order_acquire);
+}
+
+static void StoreRelease(unsigned *p, unsigned value)
+{
+    atomic_store_explicit((_Atomic unsigned *)p, value, memory_order_release);
+}
+
+static void PoolRelease(struct uring_pool *pool)
+{
+    if (vlc_atomic_rc_dec(&pool->rc))
+    {
+        free(pool->memory);
+        free(pool);
+    }
+}
+
+static void BufRelease(block_t *block)
+{
+    struct uring_buf *buf = container_of(block, struct uring_buf, block);
+    struct uring_pool *pool = buf->pool;
+
+    vlc_mutex_lock(&pool->lock);
+    assert(buf->state == BUF_LENT);
+    buf->state = BUF_FREE;
+    vlc_mutex_unlock(&pool->lock);
+    PoolRelease(pool);
+}
+
+static const struct vlc_block_callbacks uring_buf_cbs =
+{
+    BufRelease,
+};
+
+static struct uring_pool *PoolNew(unsigned count, size_t size, size_t align)
+{
+    struct uring_pool *pool = malloc(sizeof (*pool)
+                                     + count * sizeof (pool->bufs[0]));
+    if (unlikely(pool == NULL))
+        return NULL;
+
+    pool->memory = aligned_alloc(align, count * size);
+    if (unlikely(pool->memory == NULL))
+    {
+        free(pool);
+        return NULL;
+    }
+
+    vlc_atomic_rc_init(&pool->rc);
+    vlc_mutex_init(&pool->lock);
+    pool->size = size;
+    pool->count = count;
+
+    for (unsigned i = 0; i < count; i++)
+    {
+        struct uring_buf *buf = &pool->bufs[i];
+
+        buf->pool = pool;
+        buf->base = pool->memory + i * size;
+        buf->state = BUF_FREE;
+    }
+    return pool;
+}
+
+static int RingMap(access_sys_t *sys, const struct io_uring_params *params)
+{
+    size_t sq_size = params->sq_off.array
+                   + params->sq_entries * sizeof (unsigned);
+    size_t cq_size = params->cq_off.cqes
+                   + params->cq_entries * sizeof (struct io_uring_cqe);
+
+    if (params->features & IORING_FEAT_SINGLE_MMAP)
+        sq_size = cq_size = __MAX(sq_size, cq_size);
+
+    sys->sq.map = mmap(NULL, sq_size, PROT_READ | PROT_WRITE,
+                       MAP_SHARED | MAP_POPULATE, sys->ring,
+                       IORING_OFF_SQ_RING);
+    if (sys->sq.map == MAP_FAILED)
+        return -1;
+    sys->sq.map_size = sq_size;
+
+    if (params->features & IORING_FEAT_SINGLE_MMAP)
+        sys->cq.map = sys->sq.map;
+    else
+    {
+        sys->cq.map = mmap(NULL, cq_size, PROT_READ | PROT_WRITE,
+                           MAP_SHARED | MAP_POPULATE, sys->ring,
+                           IORING_OFF_CQ_RING);
+        if (sys->cq.map == MAP_FAILED)
+            goto error;
+    }
+    sys->cq.map_size = cq_size;
+
+    sys->sq.sqes_size = params->sq_entries * sizeof (struct io_uring_sqe);
+    sys->sq.sqes = mmap(NULL, sys->sq.sqes_size, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_POPULATE, sys->ring,
+                        IORING_OFF_SQES);
+    if (sys->sq.sqes == MAP_FAILED)
+    {
+        if (sys->cq.map != sys->sq.map)
+            munmap(sys->cq.map, cq_size);
+        goto error;
+    }
+
+    uint8_t *sq = sys->sq.map, *cq = sys->cq.map;
+
+    sys->sq.head = (unsigned *)(sq + params->sq_off.head);
+    sys->sq.tail = (unsigned *)(sq + params->sq_off.tail);
+    sys->sq.mask = (const unsigned *)(sq + params->sq_off.ring_mask);
+    sys->sq.array = (unsigned *)(sq + params->sq_off.array);
+    sys->sq.pending = 0;
+    sys->cq.head = (unsigned *)(cq + params->cq_off.head);
+    sys->cq.tail = (const unsigned *)(cq + params->cq_off.tail);
+    sys->cq.mask = (const unsigned *)(cq + params->cq_off.ring_mask);
+    sys->cq.cqes = (const struct io_uring_cqe *)(cq + params->cq_off.cqes);
+    return 0;
+
+error:
+    munmap(sys->sq.map, sq_size);
+    return -1;
+}
+
+static void RingUnmap(access_sys_t *sys)
+{
+    munmap(sys->sq.sqes, sys->sq.sqes_size);
+    if (sys->cq.map != sys->sq.map)
+        munmap(sys->cq.map, sys->cq.map_size);
+    munmap(sys->sq.map, sys->sq.map_size);
+}
+
+static void Submit(stream_t *access)
+{
+    access_sys_t *sys = access->p_sys;
+
+    while (sys->sq.pending > 0)
+    {
+        int val = uring_enter(sys->ring, sys->sq.pending, 0, 0);
+        if (val < 0)
+        {
+            if (errno == EINTR || errno == EAGAIN || errno == EBUSY)
+                continue;
+            /* Only invalid entries could be rejected, none should be */
+            msg_Err(access, "submission error: %s", vlc_strerror_c(errno));
+            break;
+        }
+        sys->sq.pending -= val;
+    }
+}
+
+static void Queue(stream_t *access, struct uring_buf *buf)
+{
+    access_sys_t *sys = access->p_sys;
+    struct uring_pool *pool = sys->pool;
+    unsigned tail = *sys->sq.tail;
+    unsigned index = tail & *sys->sq.mask;
+    struct io_uring_sqe *sqe = &sys->sq.sqes[index];
+
+    memset(sqe, 0, sizeof (*sqe));
+    sqe->opcode = sys->registered ? IORING_OP_READ_FIXED : IORING_OP_READ;
+    sqe->fd = sys->fd;
+    sqe->off = sys->next;
+    sqe->addr = (uintptr_t)buf->base;
+    sqe->len = pool->size;
+    sqe->buf_index = buf - pool->bufs;
+    sqe->user_data = buf - pool->bufs;
+    sys->sq.array[index] = index;
+    StoreRelease(sys->sq.tail, tail + 1);
+    sys->sq.pending++;
+
+    buf->offset = sys->next;
+    buf->state = BUF_QUEUED;
+    sys->next += pool->size;
+    sys->queued++;
+}
+
+/**
+ * Queues as many reads as there are free buffers, in file order.
+ */
+static void Fill(stream_t *access)
+{
+    access_sys_t *sys = access->p_sys;
+    struct uring_pool *pool = sys->pool;
+
+    if (sys->next >= sys->size)
+    {   /* The file might have grown */
+        struct stat st;
+
+        if (fstat(sys->fd, &st) == 0)
+            sys->size = st.st_size;
+    }
+
+    unsigned count = sys->random ? 1 : pool->count;
+
+    vlc_mutex_lock(&pool->lock);
+    while (sys->queued < count && sys->next < sys->size)
+    {
+        struct uring_buf *buf =
+            &pool->bufs[(sys->head + sys->queued) % pool->count];
+
+        if (buf->state != BUF_FREE)
+            break; /* still lent */
+        Queue(access, buf);
+    }
+    vlc_mutex_unlock(&pool->lock);
+
+    Submit(access);
+}
+
+/**
+ * Reaps completions, waiting for the oldest queued read if requested.
+ */
+static int Reap(stream_t *access, bool wait)
+{
+    access_sys_t *sys = access->p_sys;
+    struct uring_pool *pool = sys->pool;
+
+    for (;;)
+    {
+        unsigned head = *sys->cq.head;
+        unsigned tail = LoadAcquire(sys->cq.tail);
+
+        while (head != tail)
+        {
+            const struct io_uring_cqe *cqe =
+                &sys->cq.cqes[head & *sys->cq.mask];
+            struct uring_buf *buf = &pool->bufs[cqe->user_data];
+
+            assert(buf->state == BUF_QUEUED);
+            buf->result = cqe->res;
+            buf->state = BUF_READY;
+            head++;
+        }
+        StoreRelease(sys->cq.head, head);
+
+        if (!wait || sys->queued == 0
+         || pool->bufs[sys->head].state == BUF_READY)
+            return 0;
+
+        if (uring_enter(sys->ring, 0, 1, IORING_ENTER_GETEVENTS) < 0
+         && errno != EINTR)
+        {
+            msg_Err(access, "completion error: %s", vlc_strerror_c(errno));
+            return -1;
+        }
+    }
+}
+
+/**
+ * Discards the oldest queued read, once completed.
+ */
+static int Drop(stream_t *access)
+{
+    access_sys_t *sys = access->p_sys;
+    struct uring_pool *pool = sys->pool;
+
+    assert(sys->queued > 0);
+    if (Reap(access, true))
+        return -1;
+
+    pool->bufs[sys->head].state = BUF_FREE;
+    sys->head = (sys->head + 1) % pool->count;
+    sys->queued--;
+    return 0;
+}
+
+static void Drain(stream_t *access)
+{
+    access_sys_t *sys = access->p_sys;
+
+    while (sys->queued > 0)
+        if (Drop(access))
+            break;
+    sys->next = sys->offset & ~(uint64_t)(sys->align - 1);
+}
+
+/**
+ * Reads synchronously, if all the buffers are lent or at the end of file.
+ */
+static block_t *ReadSync(stream_t *access, bool *restrict eof)
+{
+    access_sys_t *sys = access->p_sys;
+    size_t size = sys->pool->size;
+    uint64_t start = sys->offset & ~(uint64_t)(sys->align - 1);
+    size_t skip = sys->offset - start;
+
+    block_t *block = block_Alloc(size + sys->align);
+    if (unlikely(block == NULL))
+        return NULL;
+
+    uint8_t *base = (uint8_t *)(((uintptr_t)block->p_buffer + sys->align - 1)
+                                & ~(uintptr_t)(sys->align - 1));
+    ssize_t val = pread(sys->fd, base, size, start);
+    if (val < 0)
+    {
+        block_Release(block);
+        if (errno == EINTR || errno == EAGAIN)
+            return NULL;
+        msg_Err(access, "read error: %s", vlc_strerror_c(errno));
+        *eof = true;
+        return NULL;
+    }
+
+    if ((size_t)val <= skip)
+    {
+        block_Release(block);
+        *eof = true;
+        return NULL;
+    }
+
+    block->p_buffer = base + skip;
+    block->i_buffer = val - skip;
+    sys->offset = start + val;
+    if (sys->queued == 0)
+        sys->next = sys->offset & ~(uint64_t)(sys->align - 1);
+    return block;
+}
+
+static block_t *Block(stream_t *access, bool *restrict eof)
+{
+    access_sys_t *sys = access->p_sys;
+    struct uring_pool *pool = sys->pool;
+
+    Fill(access);
+    if (sys->queued == 0)
+        return ReadSync(access, eof);
+
+    if (Reap(access, true))
+    {
+        *eof = true;
+        return NULL;
+    }
+
+    struct uring_buf *buf = &pool->bufs[sys->head];
+    ssize_t result = buf->result;
+
+    assert(buf->state == BUF_READY);
+    assert(sys->offset >= buf->offset);
+
+    if (result < 0)
+    {
+        msg_Err(access, "read error: %s", vlc_strerror_c(-result));
+        Drop(access);
+        Drain(access);
+        *eof = true;
+        return NULL;
+    }
+
+    size_t skip = sys->offset - buf->offset;
+
+    if ((size_t)result <= skip)
+    {   /* Short read: end of file, or the file was truncated */
+        Drop(access);
+        Drain(access);
+        return ReadSync(access, eof);
+    }
+
+    block_t *block = block_Init(&buf->block, &uring_buf_cbs, buf->base,
+                                pool->size);
+    block->p_buffer += skip;
+    block->i_buffer = result - skip;
+
+    vlc_atomic_rc_inc(&pool->rc);
+    buf->state = BUF_LENT;
+    sys->head = (sys->head + 1) % pool->count;
+    sys->queued--;
+    sys->offset = buf->offset + result;
+
+    if ((size_t)result < pool->size) /* Do not leave a hole */
+        Drain(access);
+
+    /* Keep the other buffers busy while the block is being processed */
+    Fill(access);
+    return block;
+}
+
+static int Seek(stream_t *access, uint64_t offset)
+{
+    access_sys_t *sys = access->p_sys;
+    struct uring_pool *pool = sys->pool;
+
+    /* Keep the queued reads from the one covering the new offset onward */
+    while (sys->queued > 0)
+    {
+        const struct uring_buf *buf = &pool->bufs[sys->head];
+
+        if (offset >= buf->offset && offset < buf->offset + pool->size)
+            break;
+        if (Drop(access))
+            return VLC_EGENERIC;
+    }
+
+    sys->offset = offset;
+    if (sys->queued == 0)
+        sys->next = offset & ~(uint64_t)(sys->align - 1);
+    return VLC_SUCCESS;
+}
+
+static int Control(stream_t *access, int query, va_list args)
+{
+    access_sys_t *sys = access->p_sys;
+
+    switch (query)
+    {
+        case STREAM_CAN_SEEK:
+        case STREAM_CAN_FASTSEEK:
+        case STREAM_CAN_PAUSE:
+        case STREAM_CAN_CONTROL_PACE:
+            *va_arg(args, bool *) = true;
+            break;
+
+        case STREAM_GET_SIZE:
+        {
+            struct stat st;
+
+            if (fstat(sys->fd, &st))
+                return VLC_EGENERIC;
+            sys->size = st.st_size;
+            *va_arg(args, uint64_t *) = st.st_size;
+            break;
+        }
+
+        case STREAM_GET_PTS_DELAY:
+            *va_arg(args, vlc_tick_t *) =
+                VLC_TICK_FROM_MS(var_InheritInteger(access, "file-caching"));
+            break;
+
+        case STREAM_SET_PAUSE_STATE:
+            break;
+
+        case STREAM_SET_ACCESS_HINT:
+            switch (va_arg(args, int))
+            {
+                case STREAM_ACCESS_NORMAL:
+                    posix_fadvise(sys->fd, 0, 0, POSIX_FADV_NORMAL);
+                    sys->random = false;
+                    break;
+                case STREAM_ACCESS_SEQUENTIAL:
+                    posix_fadvise(sys->fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+                    sys->random = false;
+                    break;
+                case STREAM_ACCESS_RANDOM:
+                    posix_fadvise(sys->fd, 0, 0, POSIX_FADV_RANDOM);
+                    sys->random = true;
+                    break;
+                default:
+                    return VLC_EGENERIC;
+            }
+            break;
+
+        default:
+            return VLC_EGENERIC;
+    }
+    return VLC_SUCCESS;
+}
+
+static bool IsRemote(int fd)
+{
+    struct statfs stf;
+
+    if (fstatfs(fd, &stf))
+        return false;
+
+    switch ((unsigned long)stf.f_type)
+    {
+        case AFS_SUPER_MAGIC:
+        case CODA_SUPER_MAGIC:
+        case NCP_SUPER_MAGIC:
+        case NFS_SUPER_MAGIC:
+        case SMB_SUPER_MAGIC:
+        case 0xFF534D42 /*CIFS_MAGIC_NUMBER*/:
+            return true;
+    }
+    return false;
+}
+
+static int OpenFile(stream_t *access, bool *direct)
+{
+    const int flags = O_RDONLY | O_NONBLOCK;
+    int fd = -1;
+
+    if (*direct)
+    {
+        fd = vlc_open(access->psz_filepath, flags | O_DIRECT);
+        if (fd == -1 && errno == EINVAL)
+        {
+            msg_Dbg(access, "direct I/O not supported");
+            *direct = false;
+        }
+    }
+    if (fd == -1 && !*direct)
+        fd = vlc_open(access->psz_filepath, flags);
+    if (fd == -1)
+        return -1;
+
+    /* Only regular local files; others are left to the file input */
+    struct stat st;
+    if (fstat(fd, &st) || !S_ISREG(st.st_mode) || IsRemote(fd))
+    {
+        vlc_close(fd);
+        return -1;
+    }
+
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) & ~O_NONBLOCK);
+    return fd;
+}
+
+static void Close(vlc_object_t *obj)
+{
+    stream_t *access = (stream_t *)obj;
+    access_sys_t *sys = access->p_sys;
+
+    Drain(access);
+    vlc_close(sys->ring);
+    RingUnmap(sys);
+    vlc_close(sys->fd);
+    PoolRelease(sys->pool);
+}
+
+static int Open(vlc_object_t *obj)
+{
+    stream_t *access = (stream_t *)obj;
+
+    if (access->psz_filepath == NULL || !var_InheritBool(obj, "uring"))
+        return VLC_EGENERIC;
+    /* Preparsing reads little, the ring and its buffers are not worth it */
+    if (access->b_preparsing)
+        return VLC_EGENERIC;
+    /* Mapped files are read by the file input */
+    if (var_InheritBool(obj, "file-mmap"))
+        return VLC_EGENERIC;
+
+    access_sys_t *sys = vlc_obj_malloc(obj, sizeof (*sys));
+    if (unlikely(sys == NULL))
+        return VLC_ENOMEM;
+
+    bool direct = var_InheritBool(obj, "uring-direct");
+
+    sys->fd = OpenFile(access, &direct);
+    if (sys->fd == -1)
+        return VLC_EGENERIC;
+
+    unsigned depth = var_InheritInteger(obj, "uring-depth");
+    size_t size = var_InheritInteger(obj, "uring-block-size") << 10;
+    struct io_uring_params params;
+
+    memset(&params, 0, sizeof (params));
+    sys->ring = uring_setup(depth, &params);
+    if (sys->ring == -1)
+    {
+        msg_Dbg(access, "io_uring not available: %s", vlc_strerror_c(errno));
+        goto error;
+    }
+
+    if (!(params.features & IORING_FEAT_RW_CUR_POS)) /* Linux < 5.6 */
+    {
+        msg_Dbg(access, "io_uring lacks plain reads");
+        goto error;
+    }
+
+    if (RingMap(sys, &params))
+    {
+        msg_Err(access, "cannot map io_uring: %s", vlc_strerror_c(errno));
+        goto error;
+    }
+
+    sys->align = direct ? DIRECT_ALIGN : 1;
+    sys->pool = PoolNew(depth, size, DIRECT_ALIGN);
+    if (unlikely(sys->pool == NULL))
+    {
+        RingUnmap(sys);
+        goto error;
+    }
+
+    /* Registered buffers spare the kernel mapping them for every read. This
+     * may fail if the locked memory limit is too low, but is not required. */
+    struct iovec *iov = vlc_alloc(depth, sizeof (*iov));
+    if (likely(iov != NULL))
+    {
+        for (unsigned i = 0; i < depth; i++)
+        {
+            iov[i].iov_base = sys->pool->bufs[i].base;
+            iov[i].iov_len = size;
+        }
+        sys->registered = uring_register(sys->ring, IORING_REGISTER_BUFFERS,
+                                         iov, depth) == 0;
+        if (!sys->registered)
+            msg_Dbg(access, "cannot register buffers: %s",
+                    vlc_strerror_c(errno));
+        free(iov);
+    }
+    else
+        sys->registered = false;
+
+    struct stat st;
+    sys->size = (fstat(sys->fd, &st) == 0) ? (uint64_t)st.st_size : 0;
+    sys->offset = 0;
+    sys->next = 0;
+    sys->head = 0;
+    sys->queued = 0;
+    sys->random = false;
+
+    access->pf_read = NULL;
+    access->pf_block = Block;
+    access->pf_seek = Seek;
+    access->pf_control = Control;
+    access->p_sys = sys;
+
+    msg_Dbg(access, "%u reads of %zu KiB in flight%s%s", depth, size >> 10,
+            direct ? ", direct" : "", sys->registered ? ", registered" : "");
+    return VLC_SUCCESS;
+
+error:
+    if (sys->ring != -1)
+        vlc_close(sys->ring);
+    vlc_close(sys->fd);
+    return VLC_EGENERIC;
+}
+
+vlc_module_begin()
+    set_shortname(N_("io_uring"))
+    set_description(N_("io_uring file input"))
+    set_category(CAT_INPUT)
+    set_subcategory(SUBCAT_INPUT_ACCESS)
+    set_capability("access", 60)
+    add_shortcut("file")
+    set_callbacks(Open, Close)
+
+    add_bool("uring", false, N_("Use io_uring"),
+             N_("Read local files through io_uring, if the kernel "
+                "supports it, instead of the regular file input. This "
+                "keeps several large reads in flight for each file."))
+    add_integer("uring-depth", 4, N_("Reads in flight"),
+                N_("Number of reads kept in flight for each file."))
+        change_integer_range(2, 64)
+    add_integer("uring-block-size", 1024, N_("Read size"),
+                N_("Size of each read (KiB)."))
+        change_integer_range(64, 16384)
+    add_bool("uring-direct", false, N_("Direct I/O"),
+             N_("Bypass the page cache. This spares memory bandwidth and "
+                "cache pollution with high bitrate files read only once."))
+vlc_module_end()
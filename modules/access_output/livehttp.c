@@ -178,6 +178,8 @@ typedef struct
     char *psz_cursegPath;
     char *psz_indexPath;
     char *psz_indexUrl;
+    char *psz_initPath;
+    char *psz_initUri;
     char *psz_keyfile;
     vlc_tick_t i_keyfile_modification;
     vlc_tick_t segment_max_length;
@@ -196,6 +198,7 @@ typedef struct
     bool b_caching;
     bool b_generate_iv;
     bool b_segment_has_data;
+    bool b_fmp4;
     uint8_t aes_ivs[16];
     gcry_cipher_hd_t aes_ctx;
     char *key_uri;
@@ -209,6 +212,7 @@ static int CryptSetup( sout_access_out_t *p_access, char *keyfile );
 static int CheckSegmentChange( sout_access_out_t *p_access, block_t *p_buffer );
 static ssize_t writeSegment( sout_access_out_t *p_access );
 static ssize_t openNextFile( sout_access_out_t *p_access, sout_access_out_sys_t *p_sys );
+static int writeInitSegment( sout_access_out_t *p_access, block_t *p_block );
 /*****************************************************************************
  * Open: open the file
  *****************************************************************************/
@@ -499,6 +503,27 @@ static char *formatSegmentPath( char *psz_path, uint32_t i_seg )
     return psz_result;
 }
 
+/*****************************************************************************
+ * formatInitPath: create the init segment path name, replacing the seg #
+ *****************************************************************************/
+static char *formatInitPath( char *psz_path )
+{
+    char *psz_result;
+    char *psz_init;
+
+    if ( ! ( psz_result = vlc_strftime( psz_path ) ) )
+        return NULL;
+
+    size_t i_prefix = strcspn( psz_result, SEG_NUMBER_PLACEHOLDER );
+    size_t i_cnt = strspn( psz_result + i_prefix, SEG_NUMBER_PLACEHOLDER );
+
+    if ( asprintf( &psz_init, "%.*sinit%s", (int)i_prefix, psz_result,
+                   psz_result + i_prefix + i_cnt ) < 0 )
+        psz_init = NULL;
+    free( psz_result );
+    return psz_init;
+}
+
 static void destroySegment( output_segment_t *segment )
 {
     free( segment->psz_filename );
@@ -588,8 +613,10 @@ static int updateIndexAndDel( sout_access_out_t *p_access, sout_access_out_sys_t
             return -1;
         }
 
-        if ( fprintf( fp, "#EXTM3U\n#EXT-X-TARGETDURATION:%.0f\n#EXT-X-VERSION:3\n#EXT-X-ALLOW-CACHE:%s"
+        /* EXT-X-MAP requires version 6 */
+        if ( fprintf( fp, "#EXTM3U\n#EXT-X-TARGETDURATION:%.0f\n#EXT-X-VERSION:%d\n#EXT-X-ALLOW-CACHE:%s"
                           "%s\n#EXT-X-MEDIA-SEQUENCE:%"PRIu32"\n%s", ceil(secf_from_vlc_tick( p_sys->segment_max_length )) ,
+                          p_sys->b_fmp4 ? 6 : 3,
                           p_sys->b_caching ? "YES" : "NO",
                           p_sys->i_numsegs > 0 ? "" : b_isend ? "\n#EXT-X-PLAYLIST-TYPE:VOD" : "\n#EXT-X-PLAYLIST-TYPE:EVENT",
                           i_firstseg, ((p_sys->i_initial_segment > 1) && (p_sys->i_initial_segment == i_firstseg)) ? "#EXT-X-DISCONTINUITY\n" : ""
@@ -599,6 +626,14 @@ static int updateIndexAndDel( sout_access_out_t *p_access, sout_access_out_sys_t
             fclose( fp );
             return -1;
         }
+
+        if ( p_sys->b_fmp4 &&
+             fprintf( fp, "#EXT-X-MAP:URI=\"%s\"\n", p_sys->psz_initUri ) < 0 )
+        {
+            free( psz_idxTmp );
+            fclose( fp );
+            return -1;
+        }
         char *psz_current_uri=NULL;
 
 
@@ -812,6 +847,11 @@ static void Close( vlc_object_t * p_this )
         destroySegment( segment );
     }
 
+    if( p_sys->b_delsegs && p_sys->i_numsegs && p_sys->psz_initPath )
+        vlc_unlink( p_sys->psz_initPath );
+
+    free( p_sys->psz_initPath );
+    free( p_sys->psz_initUri );
     free( p_sys->psz_indexUrl );
     free( p_sys->psz_indexPath );
     free( p_sys );
@@ -911,7 +951,9 @@ static int CheckSegmentChange( sout_access_out_t *p_access, block_t *p_buffer )
     block_ChainProperties( p_sys->full_segments, NULL, NULL, &current_length );
     block_ChainProperties( p_sys->ongoing_segment, NULL, NULL, &ongoing_length );
 
-    if( p_sys->i_handle > 0 &&
+    /* Only close segments on a split point, even if a keyframe interval
+       is longer than the segment length */
+    if( p_sys->i_handle > 0 && p_sys->full_segments &&
        (( p_buffer->i_length + current_length + ongoing_length ) >= p_sys->segment_max_length ) )
     {
         writevalue = writeSegment( p_access );
@@ -1006,6 +1048,80 @@ static ssize_t writeSegment( sout_access_out_t *p_access )
     return i_write;
 }
 
+/*****************************************************************************
+ * writeInitSegment: write the fragmented MP4 header to its own file
+ *****************************************************************************/
+static int writeInitSegment( sout_access_out_t *p_access, block_t *p_block )
+{
+    sout_access_out_sys_t *p_sys = p_access->p_sys;
+    int i_ret = -1;
+
+    if( p_sys->key_uri )
+    {
+        msg_Err( p_access, "encryption of fragmented MP4 segments is not supported" );
+        goto end;
+    }
+
+    if( !p_sys->psz_initPath )
+    {
+        char *psz_idxFormat = p_sys->psz_indexUrl ? p_sys->psz_indexUrl : p_access->psz_path;
+        p_sys->psz_initPath = formatInitPath( p_access->psz_path );
+        p_sys->psz_initUri = formatInitPath( psz_idxFormat );
+        if( unlikely( !p_sys->psz_initPath || !p_sys->psz_initUri ) )
+        {
+            FREENULL( p_sys->psz_initPath );
+            FREENULL( p_sys->psz_initUri );
+            goto end;
+        }
+    }
+
+    int fd = vlc_open( p_sys->psz_initPath, O_WRONLY | O_CREAT | O_LARGEFILE |
+                       O_TRUNC, 0666 );
+    if ( fd == -1 )
+    {
+        msg_Err( p_access, "cannot open `%s' (%s)", p_sys->psz_initPath,
+                 vlc_strerror_c(errno) );
+        goto end;
+    }
+
+    size_t i_done = 0;
+    while( i_done < p_block->i_buffer )
+    {
+        ssize_t val = vlc_write( fd, &p_block->p_buffer[i_done],
+                                 p_block->i_buffer - i_done );
+        if ( val == -1 )
+        {
+            if ( errno == EINTR )
+                continue;
+            msg_Err( p_access, "cannot write `%s' (%s)", p_sys->psz_initPath,
+                     vlc_strerror_c(errno) );
+            break;
+        }
+        i_done += val;
+    }
+    vlc_close( fd );
+
+    if( i_done == p_block->i_buffer )
+    {
+        msg_Dbg( p_access, "Wrote fragmented MP4 init segment: %s", p_sys->psz_initPath );
+        p_sys->b_fmp4 = true;
+        i_ret = 0;
+    }
+end:
+    block_Release( p_block );
+    return i_ret;
+}
+
+/*****************************************************************************
+ * isInitSegment: check for a fragmented MP4 header, from ftyp to moov
+ *****************************************************************************/
+static bool isInitSegment( const block_t *p_buffer )
+{
+    return ( p_buffer->i_flags & BLOCK_FLAG_HEADER ) &&
+           p_buffer->i_buffer >= 8 &&
+           !memcmp( &p_buffer->p_buffer[4], "ftyp", 4 );
+}
+
 /*****************************************************************************
  * Write: standard write on a file descriptor.
  *****************************************************************************/
@@ -1015,10 +1131,30 @@ static ssize_t Write( sout_access_out_t *p_access, block_t *p_buffer )
     sout_access_out_sys_t *p_sys = p_access->p_sys;
     while( p_buffer )
     {
+        /* The fragmented MP4 header goes to the init segment, referenced by
+           the playlist, and the segments start on the fragments instead */
+        if( isInitSegment( p_buffer ) )
+        {
+            block_t *p_temp = p_buffer->p_next;
+            p_buffer->p_next = NULL;
+            if( writeInitSegment( p_access, p_buffer ) < 0 )
+            {
+                block_ChainRelease( p_temp );
+                return -1;
+            }
+            p_buffer = p_temp;
+            continue;
+        }
+
+        /* Fragmented MP4 can only be split before a moof */
+        bool b_split = p_sys->b_fmp4 ? ( p_buffer->i_flags & BLOCK_FLAG_TYPE_I )
+                                     : ( p_sys->b_splitanywhere ||
+                                         ( p_buffer->i_flags & BLOCK_FLAG_HEADER ) );
+
         /* Check if current block is already past segment-length
             and we want to write gathered blocks into segment
             and update playlist */
-        if( p_sys->ongoing_segment && ( p_sys->b_splitanywhere  || ( p_buffer->i_flags & BLOCK_FLAG_HEADER ) ) )
+        if( p_sys->ongoing_segment && b_split )
         {
             msg_Dbg( p_access, "Moving ongoing segment to full segments-queue" );
             block_ChainLastAppend( &p_sys->full_segments_end, p_sys->ongoing_segment );
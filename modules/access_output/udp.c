@@ -46,11 +46,33 @@
 #elif defined (HAVE_SYS_SOCKET_H)
 #   include <sys/socket.h>
 #endif
+#ifdef HAVE_SENDMMSG
+#   include <time.h>
+#   include <sys/uio.h>
+#   include <netinet/in.h>
+#   include <netinet/udp.h>
+#   ifdef SO_TXTIME
+#       include <linux/net_tstamp.h>
+#   endif
+#endif
 
 #include <vlc_network.h>
 
 #define MAX_EMPTY_BLOCKS 200
 
+/* Number of packets sent at once */
+#define BATCH 64
+
+#ifdef HAVE_SENDMMSG
+/* Largest train of packets coalesced by segmentation offload */
+# define GSO_SEGMENTS 64
+# define GSO_MAX_SIZE 65000u
+#endif
+
+/* Packets are handed to the kernel up to this long before their departure
+ * time, when it paces them */
+#define PACING_LEAD VLC_TICK_FROM_MS(5)
+
 /*****************************************************************************
  * Module descriptor
  *****************************************************************************/
@@ -71,6 +93,13 @@ static void Close( vlc_object_t * );
                           "helps reducing the scheduling load on " \
                           "heavily-loaded systems." )
 
+#define PACING_TEXT N_("Kernel pacing")
+#define PACING_LONGTEXT N_("Hand packets to the kernel slightly ahead of " \
+                           "time, along with their departure time. This " \
+                           "requires the fq queuing discipline on the " \
+                           "output interface, otherwise packets are sent " \
+                           "in bursts. Packets are not grouped then." )
+
 vlc_module_begin ()
     set_description( N_("UDP stream output") )
     set_shortname( "UDP" )
@@ -78,6 +107,7 @@ vlc_module_begin ()
     set_subcategory( SUBCAT_SOUT_ACO )
     add_integer( SOUT_CFG_PREFIX "caching", DEFAULT_PTS_DELAY / 1000, CACHING_TEXT, CACHING_LONGTEXT )
     add_integer( SOUT_CFG_PREFIX "group", 1, GROUP_TEXT, GROUP_LONGTEXT )
+    add_bool( SOUT_CFG_PREFIX "pacing", false, PACING_TEXT, PACING_LONGTEXT )
 
     set_capability( "sout access", 0 )
     add_shortcut( "udp" )
@@ -91,6 +121,7 @@ vlc_module_end ()
 static const char *const ppsz_sout_options[] = {
     "caching",
     "group",
+    "pacing",
     NULL
 };
 
@@ -113,6 +144,8 @@ typedef struct
     int           i_handle;
     bool          b_mtu_warning;
     bool          dead;
+    bool          b_gso;    /* UDP segmentation offload is supported */
+    bool          b_txtime; /* the kernel paces packets (SO_TXTIME) */
     size_t        i_mtu;
 
     vlc_queue_t   queue;
@@ -208,6 +241,31 @@ static int Open( vlc_object_t *p_this )
     p_sys->i_mtu = var_CreateGetInteger( p_this, "mtu" );
     p_sys->b_mtu_warning = false;
     p_sys->dead = false;
+    p_sys->b_gso = false;
+    p_sys->b_txtime = false;
+#if defined (HAVE_SENDMMSG) && defined (UDP_SEGMENT)
+    int val;
+    socklen_t len = sizeof (val);
+
+    p_sys->b_gso = getsockopt( i_handle, IPPROTO_UDP, UDP_SEGMENT,
+                               &val, &len ) == 0;
+#endif
+    if( var_GetBool( p_access, SOUT_CFG_PREFIX "pacing" ) )
+    {
+#if defined (HAVE_SENDMMSG) && defined (SO_TXTIME)
+        /* The fq queuing discipline uses the monotonic clock,
+         * the same as vlc_tick_now() */
+        const struct sock_txtime txtime = { .clockid = CLOCK_MONOTONIC };
+
+        p_sys->b_txtime = setsockopt( i_handle, SOL_SOCKET, SO_TXTIME,
+                                      &txtime, sizeof (txtime) ) == 0;
+        if( !p_sys->b_txtime )
+            msg_Warn( p_access, "kernel pacing not available: %s",
+                      vlc_strerror_c(errno) );
+#else
+        msg_Warn( p_access, "kernel pacing not supported" );
+#endif
+    }
     vlc_queue_Init(&p_sys->queue, offsetof (block_t, p_next));
     p_sys->p_buffer = NULL;
 
@@ -345,6 +403,161 @@ static ssize_t Write( sout_access_out_t *p_access, block_t *p_buffer )
     return i_len;
 }
 
+/*****************************************************************************
+ * Batch: packets due for sending
+ *****************************************************************************/
+struct udp_batch
+{
+    block_t      *blocks[BATCH];
+    vlc_tick_t    dates[BATCH];
+    unsigned      count;
+#ifdef HAVE_SENDMMSG
+    struct mmsghdr msgs[BATCH];
+    struct iovec   iovs[BATCH];
+    union {
+        char buf[CMSG_SPACE(sizeof (uint64_t))
+               + CMSG_SPACE(sizeof (uint16_t))];
+        struct cmsghdr align;
+    } control[BATCH];
+#endif
+};
+
+#ifdef HAVE_SENDMMSG
+/* Builds the messages for the packets from the given one onward, and
+ * returns how many. With segmentation offload, a train of packets of the
+ * same size (except for the last one) and departure time is coalesced into
+ * a single message. */
+static unsigned BatchPrepare( sout_access_out_sys_t *p_sys,
+                              struct udp_batch *b, unsigned i )
+{
+    unsigned count = 0;
+
+    while( i < b->count )
+    {
+        struct msghdr *msg = &b->msgs[count].msg_hdr;
+        const size_t size = b->blocks[i]->i_buffer;
+        size_t total = size;
+        unsigned n = 1;
+
+        b->iovs[i].iov_base = b->blocks[i]->p_buffer;
+        b->iovs[i].iov_len = size;
+
+        while( p_sys->b_gso && size > 0 && i + n < b->count
+            && n < GSO_SEGMENTS
+            && b->blocks[i + n - 1]->i_buffer == size
+            && b->blocks[i + n]->i_buffer <= size
+            && total + b->blocks[i + n]->i_buffer <= GSO_MAX_SIZE
+            && (!p_sys->b_txtime || b->dates[i + n] == b->dates[i]) )
+        {
+            b->iovs[i + n].iov_base = b->blocks[i + n]->p_buffer;
+            b->iovs[i + n].iov_len = b->blocks[i + n]->i_buffer;
+            total += b->blocks[i + n]->i_buffer;
+            n++;
+        }
+
+        memset( msg, 0, sizeof (*msg) );
+        msg->msg_iov = &b->iovs[i];
+        msg->msg_iovlen = n;
+        msg->msg_control = b->control[count].buf;
+        msg->msg_controllen = sizeof (b->control[count].buf);
+
+        struct cmsghdr *cmsg = CMSG_FIRSTHDR( msg );
+        size_t controllen = 0;
+#ifdef SO_TXTIME
+        if( p_sys->b_txtime )
+        {
+            uint64_t txtime = NS_FROM_VLC_TICK( b->dates[i] );
+
+            cmsg->cmsg_level = SOL_SOCKET;
+            cmsg->cmsg_type = SCM_TXTIME;
+            cmsg->cmsg_len = CMSG_LEN( sizeof (txtime) );
+            memcpy( CMSG_DATA( cmsg ), &txtime, sizeof (txtime) );
+            controllen += CMSG_SPACE( sizeof (txtime) );
+            cmsg = CMSG_NXTHDR( msg, cmsg );
+        }
+#endif
+#ifdef UDP_SEGMENT
+        if( n > 1 )
+        {
+            uint16_t segment = size;
+
+            cmsg->cmsg_level = IPPROTO_UDP;
+            cmsg->cmsg_type = UDP_SEGMENT;
+            cmsg->cmsg_len = CMSG_LEN( sizeof (segment) );
+            memcpy( CMSG_DATA( cmsg ), &segment, sizeof (segment) );
+            controllen += CMSG_SPACE( sizeof (segment) );
+        }
+#endif
+        msg->msg_controllen = controllen;
+        if( controllen == 0 )
+            msg->msg_control = NULL;
+
+        i += n;
+        count++;
+    }
+    return count;
+}
+#endif
+
+static void BatchSend( sout_access_out_t *p_access, struct udp_batch *b )
+{
+    sout_access_out_sys_t *p_sys = p_access->p_sys;
+
+    if( b->count == 0 )
+        return;
+
+#ifdef HAVE_SENDMMSG
+    unsigned first = 0;
+
+    while( first < b->count )
+    {
+        unsigned count = BatchPrepare( p_sys, b, first );
+        unsigned done = 0;
+
+        while( done < count )
+        {
+            int val = sendmmsg( p_sys->i_handle, b->msgs + done,
+                                count - done, 0 );
+            if( val > 0 )
+            {
+                done += val;
+                continue;
+            }
+
+            if( p_sys->b_gso && b->msgs[done].msg_hdr.msg_iovlen > 1
+             && (errno == EIO || errno == EINVAL) )
+            {   /* No checksum offload, or segments larger than the MTU */
+                msg_Warn( p_access, "segmentation offload failed (%s), "
+                          "disabling", vlc_strerror_c(errno) );
+                p_sys->b_gso = false;
+                break;
+            }
+            msg_Warn( p_access, "send error: %s", vlc_strerror_c(errno) );
+            done++;
+        }
+
+        if( done < count )
+            first = b->msgs[done].msg_hdr.msg_iov - b->iovs;
+        else
+            first = b->count;
+    }
+#else
+    for( unsigned i = 0; i < b->count; i++ )
+        if( send( p_sys->i_handle, b->blocks[i]->p_buffer,
+                  b->blocks[i]->i_buffer, 0 ) == -1 )
+            msg_Warn( p_access, "send error: %s", vlc_strerror_c(errno) );
+#endif
+
+    vlc_tick_t i_late = vlc_tick_now() - b->dates[0];
+    if( i_late > VLC_TICK_FROM_MS(20) )
+        msg_Dbg( p_access, "packet has been sent too late (%"PRId64 ")",
+                 i_late );
+
+    for( unsigned i = 0; i < b->count; i++ )
+        block_Release( b->blocks[i] );
+    b->count = 0;
+}
+
 /*****************************************************************************
  * ThreadWrite: Write a packet on the network at the good time.
  *****************************************************************************/
@@ -357,11 +570,38 @@ static void* ThreadWrite( void *data )
                                              SOUT_CFG_PREFIX "group" );
     int i_to_send = i_group;
     unsigned i_dropped_packets = 0;
-    block_t *p_pk;
+    vlc_tick_t i_horizon = VLC_TICK_INVALID;
+    struct udp_batch batch;
+    block_t *p_pending = NULL;
 
-    while ((p_pk = vlc_queue_DequeueKillable(&p_sys->queue,
-                                             &p_sys->dead)) != NULL)
+    batch.count = 0;
+
+    for( ;; )
     {
+        block_t *p_pk = p_pending;
+
+        if( p_pk == NULL )
+        {
+            if( batch.count > 0 )
+            {   /* Only add the packets that are already queued */
+                p_pk = vlc_queue_DequeueAll( &p_sys->queue );
+                if( p_pk == NULL )
+                {
+                    BatchSend( p_access, &batch );
+                    continue;
+                }
+            }
+            else
+            {
+                p_pk = vlc_queue_DequeueKillable( &p_sys->queue,
+                                                  &p_sys->dead );
+                if( p_pk == NULL )
+                    break;
+            }
+        }
+        p_pending = p_pk->p_next;
+        p_pk->p_next = NULL;
+
         vlc_tick_t    i_date;
 
         i_date = p_sys->i_caching + p_pk->i_dts;
@@ -387,14 +627,37 @@ static void* ThreadWrite( void *data )
             }
         }
 
-        i_to_send--;
-        if( !i_to_send || (p_pk->i_flags & BLOCK_FLAG_CLOCK) )
+        vlc_tick_t i_deadline = VLC_TICK_INVALID;
+
+        if( p_sys->b_txtime )
+        {   /* Wake up once per lead time, and let the kernel hold the
+             * packets due until the next wake-up */
+            if( i_date > i_horizon )
+            {
+                i_deadline = i_date - PACING_LEAD;
+                i_horizon = i_date + PACING_LEAD;
+            }
+        }
+        else
         {
-            vlc_tick_wait( i_date );
-            i_to_send = i_group;
+            i_to_send--;
+            if( !i_to_send || (p_pk->i_flags & BLOCK_FLAG_CLOCK) )
+            {
+                i_deadline = i_date;
+                i_to_send = i_group;
+            }
+        }
+
+        if( i_deadline != VLC_TICK_INVALID && i_deadline > vlc_tick_now() )
+        {   /* Send what is due before sleeping */
+            BatchSend( p_access, &batch );
+            vlc_tick_wait( i_deadline );
         }
-        if ( send( p_sys->i_handle, p_pk->p_buffer, p_pk->i_buffer, 0 ) == -1 )
-            msg_Warn( p_access, "send error: %s", vlc_strerror_c(errno) );
+
+        batch.blocks[batch.count] = p_pk;
+        batch.dates[batch.count] = i_date;
+        if( ++batch.count == BATCH )
+            BatchSend( p_access, &batch );
 
         if( i_dropped_packets )
         {
@@ -403,18 +666,6 @@ static void* ThreadWrite( void *data )
         }
 
         i_date_last = i_date;
-
-#if 1
-        i_date = vlc_tick_now() - i_date;
-        if ( i_date > VLC_TICK_FROM_MS(20) )
-        {
-            msg_Dbg( p_access, "packet has been sent too late (%"PRId64 ")",
-                     i_date );
-        }
-#endif
-
-        block_Release( p_pk );
-
     }
     return NULL;
 }
@@ -23,6 +23,8 @@
 #endif
 
 #include "SegmentTracker.hpp"
+#include "SharedResources.hpp"
+#include "http/HTTPConnectionManager.h"
 #include "playlist/BasePlaylist.hpp"
 #include "playlist/BaseRepresentation.h"
 #include "playlist/BaseAdaptationSet.h"
@@ -412,11 +414,35 @@ ChunkInterface * SegmentTracker::getNextChunk(bool switch_allowed,
         notify(DiscontinuityEvent());
 
     if(!b_gap)
+    {
         ++next;
+        prefetchChunks(switch_allowed, chunk.pos, connManager);
+    }
 
     return returnedChunk;
 }
 
+void SegmentTracker::prefetchChunks(bool switch_allowed, const Position &from,
+                                    AbstractConnectionManager *connManager)
+{
+    const bool b_live = adaptationSet->getPlaylist()->isLive();
+    while(chunkssequence.size() < bufferingLogic->getPrefetchCount())
+    {
+        Position pos = chunkssequence.empty() ? from : chunkssequence.back().pos;
+        /* Don't request segments that are not published yet */
+        if(b_live && pos.rep->getMinAheadTime(pos.number) == 0)
+            break;
+        ++pos;
+        ChunkEntry chunk = prepareChunk(switch_allowed, pos, connManager);
+        if(!chunk.isValid())
+        {
+            delete chunk.chunk;
+            break;
+        }
+        chunkssequence.push_back(chunk);
+    }
+}
+
 bool SegmentTracker::setPositionByTime(vlc_tick_t time, bool restarted, bool tryonly)
 {
     Position pos = Position(current.rep, current.number);
@@ -534,6 +560,7 @@ void SegmentTracker::notifyBufferingLevel(vlc_tick_t min, vlc_tick_t max,
                                           vlc_tick_t current, vlc_tick_t target) const
 {
     notify(BufferingLevelChangedEvent(adaptationSet->getID(), min, max, current, target));
+    resources->getConnManager()->updateBufferingLevel(adaptationSet->getID(), current);
 }
 
 void SegmentTracker::registerListener(SegmentTrackerListenerInterface *listener)
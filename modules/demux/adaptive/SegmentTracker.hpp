@@ -217,6 +217,7 @@ namespace adaptive
             std::list<ChunkEntry> chunkssequence;
             ChunkEntry prepareChunk(bool switch_allowed, Position pos,
                                     AbstractConnectionManager *connManager) const;
+            void prefetchChunks(bool, const Position &, AbstractConnectionManager *);
             void resetChunksSequence();
             void setAdaptationLogic(AbstractAdaptationLogic *);
             void notify(const TrackerEvent &) const;
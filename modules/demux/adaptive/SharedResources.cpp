@@ -64,7 +64,8 @@ SharedResources * SharedResources::createDefault(vlc_object_t *obj,
 {
     AuthStorage *auth = new AuthStorage(obj);
     Keyring *keyring = new Keyring(obj);
-    HTTPConnectionManager *m = new HTTPConnectionManager(obj);
+    int64_t maxconnections = var_InheritInteger(obj, "adaptive-maxconnections");
+    HTTPConnectionManager *m = new HTTPConnectionManager(obj, maxconnections > 0 ? maxconnections : 1);
     if(!var_InheritBool(obj, "adaptive-use-access")) /* only use http from access */
         m->addFactory(new LibVLCHTTPConnectionFactory(auth));
     m->addFactory(new StreamUrlConnectionFactory());
@@ -308,6 +308,11 @@ bool HTTPChunkSource::prepare()
     return false;
 }
 
+std::string HTTPChunkSource::getHostname() const
+{
+    return params.getHostname();
+}
+
 block_t * HTTPChunkSource::readBlock()
 {
     return read(HTTPChunkSource::CHUNK_SIZE);
@@ -391,14 +396,11 @@ void HTTPChunkBufferedSource::bufferize(size_t readsize)
         return;
     }
 
-    struct
-    {
-        size_t size;
-        vlc_tick_t time;
-        vlc_tick_t latency;
-    } rate = {0,0,0};
-
-    ssize_t ret = connection->read(p_block->p_buffer, readsize);
+    /* Segments still being produced are delivered in small chunks
+     * that must be handed over as soon as they arrive */
+    const bool b_partial = (type == ChunkType::PartialSegment);
+    ssize_t ret = b_partial ? connection->readPartial(p_block->p_buffer, readsize)
+                            : connection->read(p_block->p_buffer, readsize);
     if(ret <= 0)
     {
         block_Release(p_block);
@@ -406,9 +408,6 @@ void HTTPChunkBufferedSource::bufferize(size_t readsize)
         mutex_locker locker {lock};
         done = true;
         downloadEndTime = vlc_tick_now();
-        rate.size = buffered + consumed;
-        rate.time = downloadEndTime - requestStartTime;
-        rate.latency = responseTime - requestStartTime;
     }
     else
     {
@@ -416,23 +415,31 @@ void HTTPChunkBufferedSource::bufferize(size_t readsize)
         mutex_locker locker {lock};
         buffered += p_block->i_buffer;
         block_ChainLastAppend(&pp_tail, p_block);
-        if((size_t) ret < readsize)
+        if(b_partial ? (contentLength && buffered + consumed >= contentLength)
+                     : (size_t) ret < readsize)
         {
             done = true;
             downloadEndTime = vlc_tick_now();
-            rate.size = buffered + consumed;
-            rate.time = downloadEndTime - requestStartTime;
-            rate.latency = responseTime - requestStartTime;
         }
     }
 
-    if(rate.size && rate.time && type == ChunkType::Segment)
+    avail.signal();
+}
+
+void HTTPChunkBufferedSource::notifyDownloadRate(vlc_tick_t time)
+{
+    size_t size;
+    vlc_tick_t latency;
     {
-        connManager->updateDownloadRate(sourceid, rate.size,
-                                        rate.time, rate.latency);
+        mutex_locker locker {lock};
+        if(!prepared)
+            return;
+        size = buffered + consumed;
+        latency = responseTime - requestStartTime;
     }
 
-    avail.signal();
+    if(size && time && type == ChunkType::Segment)
+        connManager->updateDownloadRate(sourceid, size, time, latency);
 }
 
 bool HTTPChunkBufferedSource::hasMoreData() const
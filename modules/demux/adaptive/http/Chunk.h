@@ -46,6 +46,7 @@ namespace adaptive
         enum class ChunkType
         {
             Segment,
+            PartialSegment, /* delivered as it is produced */
             Init,
             Index,
             Playlist,
@@ -132,6 +133,7 @@ namespace adaptive
                                 bool = false);
 
                 virtual bool        prepare();
+                std::string         getHostname() const;
                 AbstractConnection    *connection;
                 AbstractConnectionManager *connManager;
                 mutable vlc::threads::mutex lock;
@@ -164,6 +166,7 @@ namespace adaptive
                                         const ID &, ChunkType, const BytesRange &,
                                         bool = false);
                 void               bufferize(size_t);
+                void               notifyDownloadRate(vlc_tick_t);
                 bool               isDone() const;
                 void               hold();
                 void               release();
@@ -25,43 +25,63 @@
 
 #include <vlc_threads.h>
 
-#include <atomic>
+#include <algorithm>
 
 using namespace adaptive::http;
 
-Downloader::Downloader()
+/*
+ * Chunks are downloaded by a pool of threads, with at most maxperhost
+ * simultaneous transfers from a given host. The next chunk is taken from the
+ * stream with the lowest buffering level, in scheduling order otherwise.
+ *
+ * As concurrent transfers share the link, each one is timed in shared time,
+ * where a tick lasts as many real ticks as there are running transfers. The
+ * rates reported to the observer then add up to the link throughput.
+ */
+Downloader::Transfer::Transfer(HTTPChunkBufferedSource *source_,
+                               const std::string &host_, vlc_tick_t start)
+{
+    source = source_;
+    host = host_;
+    starttime = start;
+    cancelled = false;
+}
+
+Downloader::Downloader(unsigned threads_, unsigned perhost)
 {
     killed = false;
-    thread_handle_valid = false;
-    current = nullptr;
-    cancel_current = false;
+    maxthreads = std::max(threads_, 1u);
+    maxperhost = std::max(perhost, 1u);
+    sharedtime = 0;
+    sharedtime_date = VLC_TICK_INVALID;
 }
 
 bool Downloader::start()
 {
-    if(!thread_handle_valid &&
-       vlc_clone(&thread_handle, downloaderThread,
-                 static_cast<void *>(this), VLC_THREAD_PRIORITY_INPUT))
+    while(threads.size() < maxthreads)
     {
-        return false;
+        vlc_thread_t th;
+        if(vlc_clone(&th, downloaderThread,
+                     static_cast<void *>(this), VLC_THREAD_PRIORITY_INPUT))
+            break;
+        threads.push_back(th);
     }
-    thread_handle_valid = true;
-    return true;
+    return !threads.empty();
 }
 
 Downloader::~Downloader()
 {
     kill();
 
-    if(thread_handle_valid)
-        vlc_join(thread_handle, nullptr);
+    for(vlc_thread_t th : threads)
+        vlc_join(th, nullptr);
 }
 
 void Downloader::kill()
 {
     vlc::threads::mutex_locker locker {lock};
     killed = true;
-    wait_cond.signal();
+    wait_cond.broadcast();
 }
 
 void Downloader::schedule(HTTPChunkBufferedSource *source)
@@ -75,9 +95,11 @@ void Downloader::schedule(HTTPChunkBufferedSource *source)
 void Downloader::cancel(HTTPChunkBufferedSource *source)
 {
     vlc::threads::mutex_locker locker {lock};
-    while (current == source)
+    while (isActive(source))
     {
-        cancel_current = true;
+        for(Transfer &t : transfers)
+            if(t.source == source)
+                t.cancelled = true;
         updated_cond.wait(lock);
     }
 
@@ -88,6 +110,58 @@ void Downloader::cancel(HTTPChunkBufferedSource *source)
     }
 }
 
+void Downloader::updateBufferingLevel(const ID &id, vlc_tick_t level)
+{
+    vlc::threads::mutex_locker locker {lock};
+    levels[id] = level;
+}
+
+bool Downloader::isActive(const HTTPChunkBufferedSource *source) const
+{
+    for(const Transfer &t : transfers)
+        if(t.source == source)
+            return true;
+    return false;
+}
+
+unsigned Downloader::getHostTransfers(const std::string &host) const
+{
+    unsigned count = 0;
+    for(const Transfer &t : transfers)
+        if(t.host == host)
+            count++;
+    return count;
+}
+
+std::list<HTTPChunkBufferedSource *>::iterator Downloader::getNext()
+{
+    auto next = chunks.end();
+    vlc_tick_t nextlevel = 0;
+
+    for(auto it = chunks.begin(); it != chunks.end(); ++it)
+    {
+        if(getHostTransfers((*it)->getHostname()) >= maxperhost)
+            continue;
+
+        auto lit = levels.find((*it)->sourceid);
+        const vlc_tick_t level = (lit != levels.end()) ? lit->second : 0;
+        if(next == chunks.end() || level < nextlevel)
+        {
+            next = it;
+            nextlevel = level;
+        }
+    }
+    return next;
+}
+
+void Downloader::updateSharedTime()
+{
+    const vlc_tick_t now = vlc_tick_now();
+    if(!transfers.empty())
+        sharedtime += (now - sharedtime_date) / transfers.size();
+    sharedtime_date = now;
+}
+
 void * Downloader::downloaderThread(void *opaque)
 {
     Downloader *instance = static_cast<Downloader *>(opaque);
@@ -97,31 +171,44 @@ void * Downloader::downloaderThread(void *opaque)
 
 void Downloader::Run()
 {
+    vlc::threads::mutex_locker locker {lock};
+
     while(1)
     {
-        lock.lock();
-
-        while(chunks.empty() && !killed)
+        auto next = chunks.end();
+        while(!killed && (next = getNext()) == chunks.end())
             wait_cond.wait(lock);
 
         if(killed)
+            break;
+
+        HTTPChunkBufferedSource *source = *next;
+        chunks.erase(next);
+        updateSharedTime();
+        auto transfer = transfers.emplace(transfers.end(), source,
+                                          source->getHostname(), sharedtime);
+
+        while(!transfer->cancelled && !source->isDone())
         {
             lock.unlock();
-            break;
+            source->bufferize(HTTPChunkSource::CHUNK_SIZE);
+            lock.lock();
         }
 
-        current = chunks.front();
-        lock.unlock();
-        current->bufferize(HTTPChunkSource::CHUNK_SIZE);
-        lock.lock();
-        if(current->isDone() || cancel_current)
+        updateSharedTime();
+        /* might have been cancelled by the reader once completed */
+        const bool b_completed = source->isDone();
+        const vlc_tick_t elapsed = sharedtime - transfer->starttime;
+        transfers.erase(transfer);
+
+        if(b_completed)
         {
-            chunks.pop_front();
-            current->release();
+            lock.unlock();
+            source->notifyDownloadRate(elapsed);
+            lock.lock();
         }
-        cancel_current = false;
-        current = nullptr;
-        updated_cond.signal();
-        lock.unlock();
+        source->release();
+        updated_cond.broadcast();
+        wait_cond.broadcast(); /* a host slot is available */
     }
 }
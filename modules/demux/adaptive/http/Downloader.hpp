@@ -25,6 +25,9 @@
 #include <vlc_common.h>
 #include <vlc_cxx_helpers.hpp>
 #include <list>
+#include <map>
+#include <string>
+#include <vector>
 
 namespace adaptive
 {
@@ -35,25 +38,42 @@ namespace adaptive
         class Downloader
         {
             public:
-                Downloader();
+                Downloader(unsigned = 1, unsigned = 1);
                 ~Downloader();
                 bool start();
                 void schedule(HTTPChunkBufferedSource *);
                 void cancel(HTTPChunkBufferedSource *);
+                void updateBufferingLevel(const ID &, vlc_tick_t);
 
             private:
+                class Transfer
+                {
+                    public:
+                        Transfer(HTTPChunkBufferedSource *, const std::string &, vlc_tick_t);
+                        HTTPChunkBufferedSource *source;
+                        std::string host;
+                        vlc_tick_t  starttime; /* in shared time */
+                        bool        cancelled;
+                };
                 static void * downloaderThread(void *);
                 void Run();
                 void kill();
-                vlc_thread_t thread_handle;
+                std::list<HTTPChunkBufferedSource *>::iterator getNext();
+                unsigned getHostTransfers(const std::string &) const;
+                bool isActive(const HTTPChunkBufferedSource *) const;
+                void updateSharedTime();
+                std::vector<vlc_thread_t> threads;
                 vlc::threads::mutex lock;
                 vlc::threads::condition_variable wait_cond;
                 vlc::threads::condition_variable updated_cond;
-                bool         thread_handle_valid;
+                unsigned     maxthreads;
+                unsigned     maxperhost;
                 bool         killed;
-                bool         cancel_current;
                 std::list<HTTPChunkBufferedSource *> chunks;
-                HTTPChunkBufferedSource *current;
+                std::list<Transfer> transfers;
+                std::map<ID, vlc_tick_t> levels;
+                vlc_tick_t   sharedtime;
+                vlc_tick_t   sharedtime_date;
         };
 
     }
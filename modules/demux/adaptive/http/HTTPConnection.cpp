@@ -63,6 +63,11 @@ bool AbstractConnection::prepare(const ConnectionParams &params_)
     return true;
 }
 
+ssize_t AbstractConnection::readPartial(void *p_buffer, size_t len)
+{
+    return read(p_buffer, len);
+}
+
 size_t AbstractConnection::getContentLength() const
 {
     return contentLength;
@@ -191,12 +196,14 @@ class adaptive::http::LibVLCHTTPSource : public adaptive::AbstractSource
     public:
         struct vlc_http_resource *http_res;
         int create(const char *uri,const std::string &ua,
-                   const std::string &ref, const BytesRange &range)
+                   const std::string &ref, const BytesRange &range,
+                   struct vlc_http_mgr *shared_mgr)
         {
             struct restuple *tpl = new struct restuple;
             tpl->source = this;
             this->range = range;
-            if (vlc_http_res_init(&tpl->resource, &this->callbacks, http_mgr, uri,
+            if (vlc_http_res_init(&tpl->resource, &this->callbacks,
+                                  shared_mgr ? shared_mgr : http_mgr, uri,
                                   ua.empty() ? nullptr : ua.c_str(),
                                   ref.empty() ? nullptr : ref.c_str()))
             {
@@ -235,9 +242,11 @@ const struct vlc_http_resource_cbs LibVLCHTTPSource::callbacks =
     LibVLCHTTPSource::validateresponse_handler,
 };
 
-LibVLCHTTPConnection::LibVLCHTTPConnection(vlc_object_t *p_object_, AuthStorage *auth)
+LibVLCHTTPConnection::LibVLCHTTPConnection(vlc_object_t *p_object_, AuthStorage *auth,
+                                           LibVLCHTTPConnectionFactory *factory_)
     : AbstractConnection( p_object_ )
 {
+    factory = factory_;
     source = new adaptive::http::LibVLCHTTPSource(p_object_, auth->getJar());
     sourceStream = new ChunksSourceStream(p_object, source);
     stream = nullptr;
@@ -303,7 +312,10 @@ RequestStatus LibVLCHTTPConnection::request(const std::string &path,
     else
         msg_Dbg(p_object, "Retrieving %s", params.getUrl().c_str());
 
-    if(source->create(params.getUrl().c_str(), useragent,referer, range))
+    /* Multiplex on the connection shared with other requests to that server */
+    struct vlc_http_mgr *shared_mgr = factory ? factory->getSharedManager(p_object, params)
+                                              : nullptr;
+    if(source->create(params.getUrl().c_str(), useragent,referer, range, shared_mgr))
         return RequestStatus::GenericError;
 
     struct vlc_credential crd;
@@ -364,6 +376,14 @@ RequestStatus LibVLCHTTPConnection::request(const std::string &path,
     vlc_UrlClean(&crd_url);
     free(psz_realm);
 
+    /* Without HTTP/2, concurrent requests need their own connections */
+    if(shared_mgr && !vlc_http_mgr_is_multiplexed(shared_mgr))
+    {
+        msg_Dbg(p_object, "%s does not support HTTP/2 multiplexing",
+                params.getHostname().c_str());
+        factory->setSharedManagerUsable(params, false);
+    }
+
     if (status >= 400)
         return RequestStatus::GenericError;
 
@@ -413,6 +433,13 @@ ssize_t LibVLCHTTPConnection::read(void *p_buffer, size_t len)
     return read;
 }
 
+ssize_t LibVLCHTTPConnection::readPartial(void *p_buffer, size_t len)
+{
+    ssize_t read = vlc_stream_ReadPartial(stream, p_buffer, len);
+    bytesRead = source->totalRead;
+    return read;
+}
+
 void LibVLCHTTPConnection::setUsed( bool b )
 {
     available = !b;
@@ -500,6 +527,16 @@ RequestStatus StreamUrlConnection::request(const std::string &path,
 }
 
 ssize_t StreamUrlConnection::read(void *p_buffer, size_t len)
+{
+    return read(p_buffer, len, false);
+}
+
+ssize_t StreamUrlConnection::readPartial(void *p_buffer, size_t len)
+{
+    return read(p_buffer, len, true);
+}
+
+ssize_t StreamUrlConnection::read(void *p_buffer, size_t len, bool b_partial)
 {
     if( !p_streamurl )
         return VLC_EGENERIC;
@@ -514,11 +551,13 @@ ssize_t StreamUrlConnection::read(void *p_buffer, size_t len)
     if(len > toRead)
         len = toRead;
 
-    ssize_t ret = vlc_stream_Read(p_streamurl, p_buffer, len);
+    ssize_t ret = b_partial ? vlc_stream_ReadPartial(p_streamurl, p_buffer, len)
+                            : vlc_stream_Read(p_streamurl, p_buffer, len);
     if(ret >= 0)
         bytesRead += ret;
 
-    if(ret < 0 || (size_t)ret < len || /* set EOF */
+    /* partial reads only return short when data is late */
+    if(ret < 0 || (b_partial ? ret == 0 : (size_t)ret < len) || /* set EOF */
        contentLength == bytesRead )
     {
         reset();
@@ -535,19 +574,63 @@ void StreamUrlConnection::setUsed( bool b )
        reset();
 }
 
+LibVLCHTTPConnectionFactory::SharedManager::SharedManager()
+{
+    mgr = nullptr;
+    usable = true;
+}
+
 LibVLCHTTPConnectionFactory::LibVLCHTTPConnectionFactory( AuthStorage *auth )
     : AbstractConnectionFactory()
 {
     authStorage = auth;
 }
 
+LibVLCHTTPConnectionFactory::~LibVLCHTTPConnectionFactory()
+{
+    for(auto &it : sharedManagers)
+        if(it.second.mgr)
+            vlc_http_mgr_destroy(it.second.mgr);
+}
+
+static std::string OriginOf(const ConnectionParams &params)
+{
+    return params.getScheme() + "://" + params.getHostname() + ":" +
+           std::to_string(params.getPort());
+}
+
+struct vlc_http_mgr * LibVLCHTTPConnectionFactory::getSharedManager(vlc_object_t *p_object,
+                                                                   const ConnectionParams &params)
+{
+    /* HTTP/2 is only negotiated over TLS */
+    if(params.getScheme() != "https")
+        return nullptr;
+
+    vlc::threads::mutex_locker locker {lock};
+    SharedManager &shared = sharedManagers[OriginOf(params)];
+    if(shared.usable && !shared.mgr)
+    {
+        shared.mgr = vlc_http_mgr_create_shared(p_object, authStorage->getJar());
+        if(!shared.mgr)
+            shared.usable = false;
+    }
+    return shared.usable ? shared.mgr : nullptr;
+}
+
+void LibVLCHTTPConnectionFactory::setSharedManagerUsable(const ConnectionParams &params,
+                                                         bool b)
+{
+    vlc::threads::mutex_locker locker {lock};
+    sharedManagers[OriginOf(params)].usable = b;
+}
+
 AbstractConnection * LibVLCHTTPConnectionFactory::createConnection(vlc_object_t *p_object,
                                                                   const ConnectionParams &params)
 {
     if((params.getScheme() != "http" && params.getScheme() != "https") ||
        params.getHostname().empty())
         return nullptr;
-    return new LibVLCHTTPConnection(p_object, authStorage);
+    return new LibVLCHTTPConnection(p_object, authStorage, this);
 }
 
 StreamUrlConnectionFactory::StreamUrlConnectionFactory()
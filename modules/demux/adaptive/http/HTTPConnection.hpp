@@ -28,8 +28,12 @@
 #include "ConnectionParams.hpp"
 #include "BytesRange.hpp"
 #include <vlc_common.h>
+#include <vlc_cxx_helpers.hpp>
+#include <map>
 #include <string>
 
+struct vlc_http_mgr;
+
 namespace adaptive
 {
     class ChunksSourceStream;
@@ -52,6 +56,7 @@ namespace adaptive
                 virtual RequestStatus request(const std::string& path,
                                               const BytesRange & = BytesRange()) = 0;
                 virtual ssize_t read        (void *p_buffer, size_t len) = 0;
+                virtual ssize_t readPartial (void *p_buffer, size_t len);
 
                 virtual size_t  getContentLength() const;
                 virtual size_t  getBytesRead() const;
@@ -71,16 +76,19 @@ namespace adaptive
         };
 
        class LibVLCHTTPSource;
+       class LibVLCHTTPConnectionFactory;
 
        class LibVLCHTTPConnection : public AbstractConnection
        {
             public:
-               LibVLCHTTPConnection(vlc_object_t *, AuthStorage *);
+               LibVLCHTTPConnection(vlc_object_t *, AuthStorage *,
+                                    LibVLCHTTPConnectionFactory * = nullptr);
                virtual ~LibVLCHTTPConnection();
                virtual bool    canReuse     (const ConnectionParams &) const override;
                virtual RequestStatus request(const std::string& path,
                                              const BytesRange & = BytesRange()) override;
                virtual ssize_t read         (void *p_buffer, size_t len) override;
+               virtual ssize_t readPartial  (void *p_buffer, size_t len) override;
                virtual void    setUsed      ( bool ) override;
 
             private:
@@ -90,6 +98,7 @@ namespace adaptive
                LibVLCHTTPSource *source;
                ChunksSourceStream *sourceStream;
                stream_t *stream;
+               LibVLCHTTPConnectionFactory *factory;
        };
 
        class StreamUrlConnection : public AbstractConnection
@@ -103,11 +112,13 @@ namespace adaptive
                 virtual RequestStatus request(const std::string& path,
                                               const BytesRange & = BytesRange()) override;
                 virtual ssize_t read        (void *p_buffer, size_t len) override;
+                virtual ssize_t readPartial (void *p_buffer, size_t len) override;
 
                 virtual void    setUsed( bool ) override;
 
             protected:
                 void reset();
+                ssize_t read(void *p_buffer, size_t len, bool b_partial);
                 stream_t *p_streamurl;
        };
 
@@ -123,10 +134,21 @@ namespace adaptive
        {
            public:
                LibVLCHTTPConnectionFactory( AuthStorage * );
-               virtual ~LibVLCHTTPConnectionFactory() = default;
+               virtual ~LibVLCHTTPConnectionFactory();
                virtual AbstractConnection * createConnection(vlc_object_t *, const ConnectionParams &) override;
+               struct vlc_http_mgr * getSharedManager(vlc_object_t *, const ConnectionParams &);
+               void setSharedManagerUsable(const ConnectionParams &, bool);
            private:
+               class SharedManager
+               {
+                   public:
+                       SharedManager();
+                       struct vlc_http_mgr *mgr;
+                       bool usable;
+               };
                AuthStorage *authStorage;
+               vlc::threads::mutex lock;
+               std::map<std::string, SharedManager> sharedManagers; /* per origin */
        };
 
        class StreamUrlConnectionFactory : public AbstractConnectionFactory
@@ -70,12 +70,14 @@ void AbstractConnectionManager::deleteSource(AbstractChunkSource *source)
     delete source;
 }
 
-HTTPConnectionManager::HTTPConnectionManager    (vlc_object_t *p_object_)
+HTTPConnectionManager::HTTPConnectionManager    (vlc_object_t *p_object_,
+                                                 unsigned maxconnections)
     : AbstractConnectionManager( p_object_ ),
       localAllowed(false)
 {
     vlc_mutex_init(&lock);
-    downloader = new Downloader();
+    /* Leave room for as many transfers from another host (audio/subtitles CDN) */
+    downloader = new Downloader(2 * maxconnections, maxconnections);
     downloaderhp = new Downloader();
     downloader->start();
     downloaderhp->start();
@@ -167,6 +169,7 @@ AbstractChunkSource *HTTPConnectionManager::makeSource(const std::string &url,
         case ChunkType::Init:
         case ChunkType::Index:
         case ChunkType::Segment:
+        case ChunkType::PartialSegment:
 
         case ChunkType::Key:
         case ChunkType::Playlist:
@@ -187,6 +190,7 @@ Downloader * HTTPConnectionManager::getDownloadQueue(const AbstractChunkSource *
         case ChunkType::Init:
         case ChunkType::Index:
         case ChunkType::Segment:
+        case ChunkType::PartialSegment:
             return downloader;
         case ChunkType::Key:
         case ChunkType::Playlist:
@@ -209,6 +213,11 @@ void HTTPConnectionManager::cancel(AbstractChunkSource *source)
         getDownloadQueue(src)->cancel(src);
 }
 
+void HTTPConnectionManager::updateBufferingLevel(const ID &id, vlc_tick_t level)
+{
+    downloader->updateBufferingLevel(id, level);
+}
+
 void HTTPConnectionManager::setLocalConnectionsAllowed()
 {
     localAllowed = true;
@@ -62,6 +62,7 @@ namespace adaptive
 
                 virtual void updateDownloadRate(const ID &, size_t,
                                                 vlc_tick_t, vlc_tick_t) override;
+                virtual void updateBufferingLevel(const ID &, vlc_tick_t) = 0;
                 void setDownloadRateObserver(IDownloadRateObserver *);
 
             protected:
@@ -75,7 +76,8 @@ namespace adaptive
         class HTTPConnectionManager : public AbstractConnectionManager
         {
             public:
-                HTTPConnectionManager           (vlc_object_t *p_object);
+                HTTPConnectionManager           (vlc_object_t *p_object,
+                                                 unsigned maxconnections = 1);
                 virtual ~HTTPConnectionManager  ();
 
                 virtual void    closeAllConnections ()  override;
@@ -87,6 +89,7 @@ namespace adaptive
 
                 virtual void start(AbstractChunkSource *)  override;
                 virtual void cancel(AbstractChunkSource *)  override;
+                virtual void updateBufferingLevel(const ID &, vlc_tick_t) override;
                 void         setLocalConnectionsAllowed();
                 void         addFactory(AbstractConnectionFactory *);
 
@@ -47,6 +47,7 @@ AbstractBufferingLogic::AbstractBufferingLogic()
     userMinBuffering = 0;
     userMaxBuffering = 0;
     userLiveDelay = 0;
+    userPrefetchCount = 0;
 }
 
 void AbstractBufferingLogic::setLowDelay(bool b)
@@ -69,6 +70,16 @@ void AbstractBufferingLogic::setUserLiveDelay(vlc_tick_t v)
     userLiveDelay = v;
 }
 
+void AbstractBufferingLogic::setUserPrefetchCount(unsigned v)
+{
+    userPrefetchCount = v;
+}
+
+unsigned AbstractBufferingLogic::getPrefetchCount() const
+{
+    return userPrefetchCount;
+}
+
 /* Try to never buffer up to really end */
 /* Enforce no overlap for demuxers segments 3.0.0 */
 /* FIXME: check duration instead ? */
@@ -115,7 +126,7 @@ vlc_tick_t DefaultBufferingLogic::getMinBuffering(const BasePlaylist *p) const
 vlc_tick_t DefaultBufferingLogic::getMaxBuffering(const BasePlaylist *p) const
 {
     if(isLowLatency(p))
-        return getMinBuffering(p);
+        return getLiveDelay(p);
 
     vlc_tick_t buffering = userMaxBuffering ? userMaxBuffering
                                             : DEFAULT_MAX_BUFFERING;
@@ -129,7 +140,13 @@ vlc_tick_t DefaultBufferingLogic::getMaxBuffering(const BasePlaylist *p) const
 vlc_tick_t DefaultBufferingLogic::getLiveDelay(const BasePlaylist *p) const
 {
     if(isLowLatency(p))
-        return getMinBuffering(p);
+    {
+        /* Stay at the advertised latency, only buffering what
+         * keeps playback running */
+        vlc_tick_t delay = userLiveDelay ? userLiveDelay
+                                         : p->targetLatency.Get();
+        return std::max(delay, getMinBuffering(p));
+    }
     vlc_tick_t delay = userLiveDelay ? userLiveDelay
                                      : DEFAULT_LIVE_BUFFERING;
     if(p->suggestedPresentationDelay.Get())
@@ -243,6 +260,9 @@ uint64_t DefaultBufferingLogic::getLiveStartSegmentNumber(BaseRepresentation *re
             /* Compute playback offset and effective finished segment from wall time */
             vlc_tick_t now = vlc_tick_from_sec(time(nullptr));
             vlc_tick_t playbacktime = now - i_buffering;
+            /* chunked segments can be joined while being produced */
+            if(isLowLatency(playlist))
+                playbacktime += rep->inheritAvailabilityTimeOffset();
             vlc_tick_t minavailtime = playlist->availabilityStartTime.Get() + rep->getPeriodStart();
             const uint64_t startnumber = mediaSegmentTemplate->inheritStartNumber();
             const Timescale timescale = mediaSegmentTemplate->inheritTimescale();
@@ -316,9 +336,12 @@ uint64_t DefaultBufferingLogic::getLiveStartSegmentNumber(BaseRepresentation *re
             }
         }
 
+        /* the segment being produced already is the edge */
+        uint64_t safeedgeoffset = SAFETY_BUFFERING_EDGE_OFFSET;
+        if(back->incomplete && isLowLatency(playlist))
+            safeedgeoffset = 0;
         uint64_t safeedgenumber = back->getSequenceNumber() -
-                        std::min((uint64_t)list.size() - 1,
-                                 (uint64_t)SAFETY_BUFFERING_EDGE_OFFSET);
+                        std::min((uint64_t)list.size() - 1, safeedgeoffset);
         uint64_t safestartnumber = availableliststartnumber;
 
         for(unsigned i=0; i<SAFETY_EXPURGING_OFFSET; i++)
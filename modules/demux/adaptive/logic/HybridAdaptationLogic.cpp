@@ -0,0 +1,277 @@
+/*
+ * HybridAdaptationLogic.cpp
+ *****************************************************************************
+ * Copyright (C) 2026 - VideoLAN Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "HybridAdaptationLogic.hpp"
+#include "Representationselectors.hpp"
+
+#include "../playlist/BaseAdaptationSet.h"
+#include "../playlist/BaseRepresentation.h"
+#include "../playlist/BasePeriod.h"
+#include "../tools/Debug.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace adaptive::logic;
+using namespace adaptive;
+
+/*
+ * Throughput rule while the buffer is low, BOLA once it has filled up,
+ * as the dash.js DYNAMIC strategy.
+ * BOLA: Near-Optimal Bitrate Adaptation for Online Videos
+ * http://arxiv.org/abs/1601.06748
+ */
+
+#define minimumBufferS VLC_TICK_FROM_SEC(6)  /* Qmin */
+#define bufferTargetS  VLC_TICK_FROM_SEC(12) /* Qmax */
+
+/* Only use that share of the estimated throughput */
+#define SAFETY_FACTOR_NUM 9
+#define SAFETY_FACTOR_DEN 10
+
+HybridContext::HybridContext()
+    : buffering_min( minimumBufferS )
+    , buffering_level( 0 )
+    , buffering_target( bufferTargetS )
+    , last_duration( VLC_TICK_FROM_SEC(2) )
+    , buffer_based( false )
+    , last_download_rate( 0 )
+{ }
+
+HybridAdaptationLogic::HybridAdaptationLogic(vlc_object_t *obj)
+    : AbstractAdaptationLogic(obj)
+    , currentBps( 0 )
+    , usedBps( 0 )
+{
+    vlc_mutex_init(&lock);
+}
+
+HybridAdaptationLogic::~HybridAdaptationLogic()
+{
+}
+
+BaseRepresentation *
+HybridAdaptationLogic::getBufferBasedRepresentation(BaseAdaptationSet *adaptSet,
+                                                    RepresentationSelector &selector,
+                                                    const HybridContext &ctx)
+{
+    BaseRepresentation *lowest = selector.lowest(adaptSet);
+    BaseRepresentation *highest = selector.highest(adaptSet);
+
+    /* utilities are log bitrates, shifted so that the lowest one is 1 */
+    const float Smin = lowest->getBandwidth();
+    const float umax = std::log(highest->getBandwidth() / Smin) + 1.0;
+    const float Qmin = secf_from_vlc_tick(ctx.buffering_min);
+    const float Qmax = secf_from_vlc_tick(ctx.buffering_target);
+    const float gammaP = (umax - 1.0) / (Qmax / Qmin - 1.0);
+    const float Vp = Qmin / gammaP;
+    const float Q = secf_from_vlc_tick(ctx.buffering_level);
+
+    BaseRepresentation *ret = nullptr;
+    BaseRepresentation *prev = nullptr;
+    float argmax = 0;
+    for(BaseRepresentation *rep = lowest; rep && rep != prev; rep = selector.higher(adaptSet, rep))
+    {
+        const float u = std::log(rep->getBandwidth() / Smin) + 1.0;
+        const float arg = (Vp * (u + gammaP) - Q) / rep->getBandwidth();
+        if(ret == nullptr || argmax <= arg)
+        {
+            ret = rep;
+            argmax = arg;
+        }
+        prev = rep;
+    }
+    return ret;
+}
+
+BaseRepresentation *HybridAdaptationLogic::getNextRepresentation(BaseAdaptationSet *adaptSet, BaseRepresentation *prevRep)
+{
+    RepresentationSelector selector(maxwidth, maxheight);
+
+    BaseRepresentation *lowest = selector.lowest(adaptSet);
+    BaseRepresentation *highest = selector.highest(adaptSet);
+    if(lowest == nullptr || highest == nullptr)
+        return nullptr;
+
+    if(lowest == highest)
+        return lowest;
+
+    vlc_mutex_lock(&lock);
+
+    std::map<ID, HybridContext>::iterator it = streams.find(adaptSet->getID());
+    if(it == streams.end())
+    {
+        vlc_mutex_unlock(&lock);
+        return lowest;
+    }
+    HybridContext ctxcopy = (*it).second;
+
+    const unsigned bps = getAvailableBw(currentBps, prevRep);
+
+    vlc_mutex_unlock(&lock);
+
+    BaseRepresentation *m = selector.select(adaptSet, (uint64_t) bps * SAFETY_FACTOR_NUM
+                                                                    / SAFETY_FACTOR_DEN);
+    if(prevRep != nullptr && ctxcopy.buffer_based &&
+       ctxcopy.buffering_target > ctxcopy.buffering_min)
+    {
+        BaseRepresentation *bola = getBufferBasedRepresentation(adaptSet, selector, ctxcopy);
+        if(bola->getBandwidth() > m->getBandwidth())
+        {
+            /* Never step up past what the throughput can sustain, as a full
+             * buffer would otherwise hide a bandwidth drop */
+            if(bola->getBandwidth() > prevRep->getBandwidth())
+                bola = (m->getBandwidth() > prevRep->getBandwidth()) ? m : prevRep;
+            /* Nor keep a bitrate whose download would drain the buffer */
+            const vlc_tick_t drain = ctxcopy.last_duration *
+                                     ((float) bola->getBandwidth() / std::max(bps, 1U) - 1.0);
+            if(ctxcopy.buffering_level - drain < ctxcopy.buffering_min)
+                bola = m;
+        }
+        m = bola;
+    }
+
+    BwDebug( msg_Info(p_obj, "%s buffering level %.2f%% rep %" PRIu64 " kBps %u kBps",
+             ctxcopy.buffer_based ? "BOLA" : "throughput",
+             (float) 100 * ctxcopy.buffering_level / ctxcopy.buffering_target,
+             m->getBandwidth()/8000, bps / 8000); );
+
+    return m;
+}
+
+unsigned HybridAdaptationLogic::getAvailableBw(unsigned i_bw, const BaseRepresentation *curRep) const
+{
+    unsigned i_remain = i_bw;
+    if(i_remain > usedBps)
+        i_remain -= usedBps;
+    else
+        i_remain = 0;
+    if(curRep)
+        i_remain += curRep->getBandwidth();
+    return i_remain > i_bw ? i_bw : i_remain;
+}
+
+unsigned HybridAdaptationLogic::getMaxCurrentBw() const
+{
+    unsigned i_max_bitrate = 0;
+    for(std::map<ID, HybridContext>::const_iterator it = streams.begin();
+                                                    it != streams.end(); ++it)
+        i_max_bitrate = std::max(i_max_bitrate, ((*it).second).last_download_rate);
+    return i_max_bitrate;
+}
+
+void HybridAdaptationLogic::updateDownloadRate(const ID &id, size_t dlsize,
+                                               vlc_tick_t time, vlc_tick_t)
+{
+    if(unlikely(time == 0))
+        return;
+    vlc_mutex_lock(&lock);
+    std::map<ID, HybridContext>::iterator it = streams.find(id);
+    if(it != streams.end())
+    {
+        HybridContext &ctx = (*it).second;
+        /* follow drops immediately, increases only on average */
+        const unsigned rate = CLOCK_FREQ * dlsize * 8 / time;
+        ctx.last_download_rate = std::min(ctx.average.push(rate), rate);
+    }
+    currentBps = getMaxCurrentBw();
+    vlc_mutex_unlock(&lock);
+}
+
+void HybridAdaptationLogic::trackerEvent(const TrackerEvent &ev)
+{
+    switch(ev.getType())
+    {
+    case TrackerEvent::Type::RepresentationSwitch:
+        {
+            const RepresentationSwitchEvent &event =
+                    static_cast<const RepresentationSwitchEvent &>(ev);
+            vlc_mutex_lock(&lock);
+            if(event.prev)
+                usedBps -= event.prev->getBandwidth();
+            if(event.next)
+                usedBps += event.next->getBandwidth();
+            vlc_mutex_unlock(&lock);
+        }
+        break;
+
+    case TrackerEvent::Type::BufferingStateUpdate:
+        {
+            const BufferingStateUpdatedEvent &event =
+                    static_cast<const BufferingStateUpdatedEvent &>(ev);
+            const ID &id = *event.id;
+            vlc_mutex_lock(&lock);
+            if(event.enabled)
+            {
+                if(streams.find(id) == streams.end())
+                {
+                    HybridContext ctx;
+                    streams.insert(std::pair<ID, HybridContext>(id, ctx));
+                }
+            }
+            else
+            {
+                std::map<ID, HybridContext>::iterator it = streams.find(id);
+                if(it != streams.end())
+                    streams.erase(it);
+            }
+            vlc_mutex_unlock(&lock);
+        }
+        break;
+
+    case TrackerEvent::Type::SegmentChange:
+        {
+            const SegmentChangedEvent &event =
+                    static_cast<const SegmentChangedEvent &>(ev);
+            vlc_mutex_lock(&lock);
+            std::map<ID, HybridContext>::iterator it = streams.find(*event.id);
+            if(it != streams.end() && event.duration != VLC_TICK_INVALID)
+                (*it).second.last_duration = event.duration;
+            vlc_mutex_unlock(&lock);
+        }
+        break;
+
+    case TrackerEvent::Type::BufferingLevelChange:
+        {
+            const BufferingLevelChangedEvent &event =
+                    static_cast<const BufferingLevelChangedEvent &>(ev);
+            const ID &id = *event.id;
+            vlc_mutex_lock(&lock);
+            HybridContext &ctx = streams[id];
+            ctx.buffering_min = event.minimum;
+            ctx.buffering_level = event.current;
+            ctx.buffering_target = event.target;
+            /* Hysteresis between the two rules */
+            if(!ctx.buffer_based &&
+               ctx.buffering_level >= (ctx.buffering_min + ctx.buffering_target) / 2)
+                ctx.buffer_based = true;
+            else if(ctx.buffer_based && ctx.buffering_level < ctx.buffering_min)
+                ctx.buffer_based = false;
+            vlc_mutex_unlock(&lock);
+        }
+        break;
+
+    default:
+            break;
+    }
+}
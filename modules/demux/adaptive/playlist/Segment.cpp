@@ -50,6 +50,7 @@ ISegment::ISegment(const ICanonicalUrl *parent):
     sequence = 0;
     templated = false;
     discontinuity = false;
+    incomplete = false;
     displayTime = VLC_TICK_INVALID;
 }
 
@@ -87,6 +88,8 @@ SegmentChunk* ISegment::toChunk(SharedResources *res, AbstractConnectionManager
         chunkType = ChunkType::Init;
     else if(dynamic_cast<IndexSegment *>(this))
         chunkType = ChunkType::Index;
+    else if(incomplete || !rep->inheritAvailabilityTimeComplete())
+        chunkType = ChunkType::PartialSegment;
     else
         chunkType = ChunkType::Segment;
     AbstractChunkSource *source = connManager->makeSource(url,
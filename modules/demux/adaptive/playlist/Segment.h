@@ -80,6 +80,7 @@ namespace adaptive
                 Property<stime_t>       startTime;
                 Property<stime_t>       duration;
                 bool                    discontinuity;
+                bool                    incomplete; /* still being produced */
 
             protected:
                 virtual bool                            prepareChunk    (SharedResources *,
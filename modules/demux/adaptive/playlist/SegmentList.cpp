@@ -95,7 +95,7 @@ void SegmentList::updateWith(AbstractMultipleSegmentBaseType *updated_,
     if(!updated || updated->segments.empty())
         return;
 
-    const Segment * lastSegment = (segments.empty()) ? nullptr : segments.back();
+    Segment * lastSegment = (segments.empty()) ? nullptr : segments.back();
     const Segment * prevSegment = lastSegment;
 
     uint64_t firstnumber = updated->segments.front()->getSequenceNumber();
@@ -119,7 +119,16 @@ void SegmentList::updateWith(AbstractMultipleSegmentBaseType *updated_,
             addSegment(cur);
         }
         else
+        {
+            /* The segment at the live edge grows until complete */
+            if(lastSegment->incomplete && lastSegment->compare(cur) == 0)
+            {
+                totalLength += cur->duration.Get() - lastSegment->duration.Get();
+                lastSegment->duration.Set(cur->duration.Get());
+                lastSegment->incomplete = cur->incomplete;
+            }
             delete cur;
+        }
     }
     updated->segments.clear();
 
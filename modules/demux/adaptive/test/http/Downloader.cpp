@@ -0,0 +1,260 @@
+/*****************************************************************************
+ *
+ *****************************************************************************
+ * Copyright (C) 2021 VideoLabs, VideoLAN and VLC Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "../../http/HTTPConnectionManager.h"
+#include "../../http/HTTPConnection.hpp"
+#include "../../http/Chunk.h"
+
+#include "../test.hpp"
+
+#include <vlc_arrays.h>
+#include <vlc_block.h>
+#include <vlc_cxx_helpers.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace adaptive;
+using namespace adaptive::http;
+
+static const size_t SEGMENT_SIZE = 1000;
+
+/* Records what the fake server sees */
+class TestServer
+{
+    public:
+        TestServer() : blocked(false) {}
+
+        void begin(const std::string &host, const std::string &path)
+        {
+            vlc::threads::mutex_locker locker {lock};
+            requests.push_back(path);
+            peak[host] = std::max(peak[host], ++active[host]);
+            cond.broadcast();
+            while(blocked && path == "/block")
+                cond.wait(lock);
+        }
+
+        void end(const std::string &host)
+        {
+            vlc::threads::mutex_locker locker {lock};
+            active[host]--;
+        }
+
+        void waitRequest(const std::string &path)
+        {
+            vlc::threads::mutex_locker locker {lock};
+            while(std::find(requests.begin(), requests.end(), path) == requests.end())
+                cond.wait(lock);
+        }
+
+        void unblock()
+        {
+            vlc::threads::mutex_locker locker {lock};
+            blocked = false;
+            cond.broadcast();
+        }
+
+        vlc::threads::mutex lock;
+        vlc::threads::condition_variable cond;
+        std::vector<std::string> requests;
+        std::map<std::string, unsigned> active;
+        std::map<std::string, unsigned> peak;
+        bool blocked;
+};
+
+class TestConnection : public AbstractConnection
+{
+    public:
+        TestConnection(TestServer *server_) : AbstractConnection(nullptr)
+        {
+            server = server_;
+            used = false;
+        }
+        virtual ~TestConnection() {}
+
+        virtual bool canReuse(const ConnectionParams &p) const override
+        {
+            return !used && p.getHostname() == params.getHostname();
+        }
+
+        virtual RequestStatus request(const std::string &path,
+                                      const BytesRange & = BytesRange()) override
+        {
+            server->begin(params.getHostname(), path);
+            /* some server latency */
+            vlc_tick_wait(vlc_tick_now() + VLC_TICK_FROM_MS(20));
+            contentLength = SEGMENT_SIZE;
+            bytesRead = 0;
+            return RequestStatus::Success;
+        }
+
+        virtual ssize_t read(void *p_buffer, size_t len) override
+        {
+            len = std::min(len, contentLength - bytesRead);
+            memset(p_buffer, 0, len);
+            bytesRead += len;
+            if(len && bytesRead == contentLength)
+                server->end(params.getHostname());
+            return len;
+        }
+
+        virtual void setUsed(bool b) override { used = b; }
+
+    private:
+        TestServer *server;
+        bool used;
+};
+
+class TestConnectionFactory : public AbstractConnectionFactory
+{
+    public:
+        TestConnectionFactory(TestServer *server_) { server = server_; }
+        virtual ~TestConnectionFactory() {}
+        virtual AbstractConnection * createConnection(vlc_object_t *,
+                                                      const ConnectionParams &) override
+        {
+            return new TestConnection(server);
+        }
+
+    private:
+        TestServer *server;
+};
+
+class TestRateObserver : public IDownloadRateObserver
+{
+    public:
+        TestRateObserver() : count(0) {}
+        virtual void updateDownloadRate(const ID &, size_t size,
+                                        vlc_tick_t time, vlc_tick_t) override
+        {
+            if(size == SEGMENT_SIZE && time > 0)
+                count++;
+        }
+        std::atomic<unsigned> count;
+};
+
+static size_t ReadChunk(HTTPChunk *chunk)
+{
+    size_t total = 0;
+    block_t *b;
+    while((b = chunk->readBlock()))
+    {
+        const size_t size = b->i_buffer;
+        block_Release(b);
+        if(size == 0)
+            break;
+        total += size;
+    }
+    return total;
+}
+
+static int Downloader_test_perhost()
+{
+    TestServer server;
+    TestRateObserver observer;
+    std::list<HTTPChunk *> chunks;
+    {
+        HTTPConnectionManager manager(nullptr, 2);
+        manager.addFactory(new TestConnectionFactory(&server));
+        manager.setDownloadRateObserver(&observer);
+        try
+        {
+            for(unsigned i=0; i<6; i++)
+            {
+                const std::string num = std::to_string(i);
+                chunks.push_back(new HTTPChunk("http://a/" + num, &manager, ID("a"),
+                                               ChunkType::Segment, BytesRange()));
+                chunks.push_back(new HTTPChunk("http://b/" + num, &manager, ID("b"),
+                                               ChunkType::Segment, BytesRange()));
+            }
+
+            for(HTTPChunk *chunk : chunks)
+                Expect(ReadChunk(chunk) == SEGMENT_SIZE);
+
+            Expect(server.requests.size() == 12);
+            /* transfers are parallel, but bounded per host */
+            Expect(server.peak["a"] == 2);
+            Expect(server.peak["b"] == 2);
+
+            /* rates are reported before the sources are released */
+            vlc_delete_all(chunks);
+            Expect(observer.count == 12);
+        } catch(...) {
+            vlc_delete_all(chunks);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static int Downloader_test_priority()
+{
+    TestServer server;
+    std::list<HTTPChunk *> chunks;
+    {
+        HTTPConnectionManager manager(nullptr, 1);
+        manager.addFactory(new TestConnectionFactory(&server));
+        try
+        {
+            /* stream a is well buffered, stream b is about to underrun */
+            manager.updateBufferingLevel(ID("a"), VLC_TICK_FROM_SEC(10));
+            manager.updateBufferingLevel(ID("b"), VLC_TICK_FROM_MS(500));
+
+            /* keep the only host slot busy while the others are queued */
+            server.blocked = true;
+            chunks.push_back(new HTTPChunk("http://host/block", &manager, ID("a"),
+                                           ChunkType::Segment, BytesRange()));
+            server.waitRequest("/block");
+            chunks.push_back(new HTTPChunk("http://host/a1", &manager, ID("a"),
+                                           ChunkType::Segment, BytesRange()));
+            chunks.push_back(new HTTPChunk("http://host/a2", &manager, ID("a"),
+                                           ChunkType::Segment, BytesRange()));
+            chunks.push_back(new HTTPChunk("http://host/b1", &manager, ID("b"),
+                                           ChunkType::Segment, BytesRange()));
+            server.unblock();
+
+            for(HTTPChunk *chunk : chunks)
+                Expect(ReadChunk(chunk) == SEGMENT_SIZE);
+
+            const std::vector<std::string> expected = { "/block", "/b1", "/a1", "/a2" };
+            Expect(server.requests == expected);
+            Expect(server.peak["host"] == 1);
+        } catch(...) {
+            server.unblock();
+            vlc_delete_all(chunks);
+            return 1;
+        }
+        vlc_delete_all(chunks);
+    }
+    return 0;
+}
+
+int Downloader_test()
+{
+    return Downloader_test_perhost() || Downloader_test_priority();
+}
@@ -0,0 +1,106 @@
+/*****************************************************************************
+ *
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLabs, VideoLAN and VLC Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "../../logic/AlwaysBestAdaptationLogic.h"
+#include "../../logic/AlwaysLowestAdaptationLogic.hpp"
+#include "../../logic/HybridAdaptationLogic.hpp"
+#include "../simulator/AdaptationSimulator.hpp"
+
+#include "../test.hpp"
+
+#include <sstream>
+
+using namespace adaptive;
+using namespace adaptive::logic;
+using namespace adaptive::simulator;
+
+int AdaptationLogic_test()
+{
+    const std::vector<uint64_t> bitrates = { 250000, 750000, 1500000, 3000000, 6000000 };
+    AbstractAdaptationLogic *logic = nullptr;
+    try
+    {
+        /* trace replay */
+        BandwidthTrace trace;
+        Expect(!trace.isValid());
+        std::istringstream is("# comment\n"
+                              "1000 1000\n"
+                              "1000 0 # outage\n");
+        Expect(trace.load(is));
+        Expect(trace.getTransferTime(0, 125000) == VLC_TICK_FROM_SEC(1));
+        Expect(trace.getTransferTime(VLC_TICK_FROM_MS(500), 125000) == VLC_TICK_FROM_SEC(2));
+        Expect(trace.getTransferTime(VLC_TICK_FROM_SEC(2), 250000) == VLC_TICK_FROM_SEC(3));
+
+        std::istringstream steadyis("10000 2000\n");
+        BandwidthTrace steady;
+        Expect(steady.load(steadyis));
+        std::istringstream stepis("60000 8000\n60000 1000\n");
+        BandwidthTrace step;
+        Expect(step.load(stepis));
+
+        AdaptationSimulator simulator(bitrates);
+        Expect(simulator.isValid());
+
+        logic = new AlwaysLowestAdaptationLogic(nullptr);
+        SimulationResults res = simulator.run(logic, steady, 60);
+        delete logic;
+        logic = nullptr;
+        Expect(res.segments == 60);
+        Expect(res.averageBitrate == bitrates.front());
+        Expect(res.switches == 0);
+        Expect(res.rebuffering == 0);
+        Expect(res.startup > 0);
+
+        logic = new AlwaysBestAdaptationLogic(nullptr);
+        res = simulator.run(logic, steady, 60);
+        delete logic;
+        logic = nullptr;
+        Expect(res.averageBitrate == bitrates.back());
+        Expect(res.stalls > 0);
+        Expect(res.rebuffering > 0);
+
+        /* throughput at start, buffer based once filled up */
+        logic = new HybridAdaptationLogic(nullptr);
+        res = simulator.run(logic, steady, 60);
+        delete logic;
+        logic = nullptr;
+        Expect(res.rebuffering == 0);
+        Expect(res.averageBitrate > bitrates.front());
+        Expect(res.averageBitrate <= 2000000);
+        Expect(res.switches <= 2);
+
+        logic = new HybridAdaptationLogic(nullptr);
+        res = simulator.run(logic, step, 60);
+        delete logic;
+        logic = nullptr;
+        Expect(res.rebuffering == 0);
+        Expect(res.averageBitrate > 1000000);
+    }
+    catch(...)
+    {
+        delete logic;
+        return 1;
+    }
+
+    return 0;
+}
@@ -382,6 +382,51 @@ int M3U8Playlist_test()
         return 1;
     }
 
+    /* Manifest 5 */
+    const char manifest5[] =
+    "#EXTM3U\n"
+    "#EXT-X-TARGETDURATION:4\n"
+    "#EXT-X-SERVER-CONTROL:CAN-BLOCK-RELOAD=YES,PART-HOLD-BACK=3.0\n"
+    "#EXT-X-PART-INF:PART-TARGET=1.0\n"
+    "#EXT-X-MEDIA-SEQUENCE:10\n"
+    "#EXTINF:4\n"
+    "foobar.mp4\n"
+    "#EXTINF:4\n"
+    "foobar2.mp4\n"
+    "#EXT-X-PART:DURATION=1.0,URI=\"foobar3.mp4\",BYTERANGE=20000@0\n"
+    "#EXT-X-PART:DURATION=1.0,URI=\"foobar3.mp4\",BYTERANGE=20000@20000\n"
+    "#EXT-X-PRELOAD-HINT:TYPE=PART,URI=\"foobar3.mp4\",BYTERANGE-START=40000\n";
+
+    m3u = ParseM3U8(obj, manifest5, sizeof(manifest5));
+    try
+    {
+        Expect(m3u);
+        Expect(m3u->isLive());
+        Expect(m3u->isLowLatency());
+        Expect(m3u->targetLatency.Get() == vlc_tick_from_sec(3));
+        BaseRepresentation *rep = m3u->getFirstPeriod()->getAdaptationSets().front()->
+                                  getRepresentations().front();
+        /* segment being produced is the live edge */
+        Segment *seg = rep->getMediaSegment(12);
+        Expect(seg);
+        Expect(seg->incomplete);
+        Expect(seg->duration.Get() == vlc_tick_from_sec(2));
+        seg = rep->getMediaSegment(11);
+        Expect(seg);
+        Expect(!seg->incomplete);
+        Expect(static_cast<HLSRepresentation *>(rep)->getPlaylistUpdateUrl().find(
+                   "?_HLS_msn=12&_HLS_part=2") != std::string::npos);
+
+        Expect(bufferingLogic.getLiveDelay(m3u) == vlc_tick_from_sec(3));
+        Expect(bufferingLogic.getStartSegmentNumber(rep) == 11);
+
+        delete m3u;
+    }
+    catch (...)
+    {
+        delete m3u;
+        return 1;
+    }
 
     return 0;
 }
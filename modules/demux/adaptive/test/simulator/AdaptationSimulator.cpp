@@ -0,0 +1,265 @@
+/*****************************************************************************
+ *
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLabs, VideoLAN and VLC Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "AdaptationSimulator.hpp"
+
+#include "../../playlist/BasePlaylist.hpp"
+#include "../../playlist/BasePeriod.h"
+#include "../../playlist/BaseAdaptationSet.h"
+#include "../../playlist/BaseRepresentation.h"
+#include "../../logic/AbstractAdaptationLogic.h"
+#include "../../logic/BufferingLogic.hpp"
+#include "../../SegmentTracker.hpp"
+
+#include <sstream>
+#include <string>
+
+using namespace adaptive;
+using namespace adaptive::simulator;
+
+BandwidthTrace::BandwidthTrace()
+{
+    total = 0;
+    hasBandwidth = false;
+}
+
+void BandwidthTrace::add(vlc_tick_t duration, uint64_t bps)
+{
+    if(duration <= 0)
+        return;
+    samples.push_back(std::pair<vlc_tick_t, uint64_t>(duration, bps));
+    total += duration;
+    if(bps)
+        hasBandwidth = true;
+}
+
+bool BandwidthTrace::load(std::istream &is)
+{
+    std::string line;
+    while(std::getline(is, line))
+    {
+        std::string::size_type pos = line.find('#');
+        if(pos != std::string::npos)
+            line.erase(pos);
+        std::istringstream ls(line);
+        ls.imbue(std::locale("C"));
+        double ms, kbps;
+        if(!(ls >> ms))
+            continue;
+        if(!(ls >> kbps) || ms < 0 || kbps < 0)
+            return false;
+        add(VLC_TICK_FROM_MS(ms), kbps * 1000);
+    }
+    return isValid();
+}
+
+bool BandwidthTrace::isValid() const
+{
+    return hasBandwidth;
+}
+
+vlc_tick_t BandwidthTrace::getTransferTime(vlc_tick_t start, uint64_t size) const
+{
+    if(!hasBandwidth)
+        return VLC_TICK_MAX;
+
+    /* locate start in the looped trace */
+    vlc_tick_t offset = start % total;
+    auto it = samples.cbegin();
+    while(offset >= it->first)
+    {
+        offset -= it->first;
+        ++it;
+    }
+
+    uint64_t remaining = size * 8; /* bits */
+    vlc_tick_t elapsed = 0;
+    for(;;)
+    {
+        const vlc_tick_t available = it->first - offset;
+        const uint64_t bps = it->second;
+        const uint64_t bits = bps * available / CLOCK_FREQ;
+        if(bps && bits >= remaining)
+            return elapsed + (remaining * CLOCK_FREQ + bps - 1) / bps;
+        remaining -= bits;
+        elapsed += available;
+        offset = 0;
+        if(++it == samples.cend())
+            it = samples.cbegin();
+    }
+}
+
+SimulationResults::SimulationResults()
+{
+    startup = 0;
+    rebuffering = 0;
+    stalls = 0;
+    averageBitrate = 0;
+    switches = 0;
+    segments = 0;
+}
+
+AdaptationSimulator::AdaptationSimulator(const std::vector<uint64_t> &bitrates)
+{
+    playlist = nullptr;
+    adaptSet = nullptr;
+    segmentDuration = VLC_TICK_FROM_SEC(4);
+    minBuffering = AbstractBufferingLogic::DEFAULT_MIN_BUFFERING;
+    maxBuffering = AbstractBufferingLogic::DEFAULT_MAX_BUFFERING;
+    targetBuffering = minBuffering * 2;
+    requestLatency = VLC_TICK_FROM_MS(50);
+
+    playlist = new (std::nothrow) BasePlaylist(nullptr);
+    if(!playlist)
+        return;
+    BasePeriod *period = new (std::nothrow) BasePeriod(playlist);
+    if(!period)
+        return;
+    playlist->addPeriod(period);
+    BaseAdaptationSet *set = new (std::nothrow) BaseAdaptationSet(period);
+    if(!set)
+        return;
+    period->addAdaptationSet(set);
+    set->setID(ID("simulated"));
+    for(uint64_t bitrate : bitrates)
+    {
+        BaseRepresentation *rep = new (std::nothrow) BaseRepresentation(set);
+        if(!rep)
+            return;
+        rep->setBandwidth(bitrate);
+        set->addRepresentation(rep);
+    }
+    if(!bitrates.empty())
+        adaptSet = set;
+}
+
+AdaptationSimulator::~AdaptationSimulator()
+{
+    delete playlist;
+}
+
+bool AdaptationSimulator::isValid() const
+{
+    return adaptSet != nullptr;
+}
+
+void AdaptationSimulator::setSegmentDuration(vlc_tick_t d)
+{
+    segmentDuration = d;
+}
+
+void AdaptationSimulator::setBuffering(vlc_tick_t min, vlc_tick_t max, vlc_tick_t target)
+{
+    minBuffering = min;
+    maxBuffering = max;
+    targetBuffering = target;
+}
+
+void AdaptationSimulator::setRequestLatency(vlc_tick_t l)
+{
+    requestLatency = l;
+}
+
+/*
+ * Segments are downloaded one after the other and played as soon as
+ * the minimum buffering is reached, as the playlist manager does.
+ * Downloads pause while the buffer is above the maximum.
+ */
+SimulationResults AdaptationSimulator::run(AbstractAdaptationLogic *logic,
+                                           const BandwidthTrace &trace,
+                                           unsigned count)
+{
+    SimulationResults results;
+    if(!adaptSet || !trace.isValid())
+        return results;
+
+    const ID &id = adaptSet->getID();
+    vlc_tick_t now = 0;
+    vlc_tick_t buffering = 0;
+    bool started = false;
+    bool playing = false;
+    uint64_t bitratesum = 0;
+    BaseRepresentation *prev = nullptr;
+
+    logic->trackerEvent(BufferingStateUpdatedEvent(id, true));
+    logic->trackerEvent(BufferingLevelChangedEvent(id, minBuffering, maxBuffering,
+                                                   buffering, targetBuffering));
+
+    for(unsigned i = 0; i < count; i++)
+    {
+        BaseRepresentation *rep = logic->getNextRepresentation(adaptSet, prev);
+        if(!rep)
+            break;
+        if(rep != prev)
+        {
+            if(prev)
+                results.switches++;
+            logic->trackerEvent(RepresentationSwitchEvent(prev, rep));
+            prev = rep;
+        }
+        logic->trackerEvent(SegmentChangedEvent(id, segmentDuration * i, segmentDuration));
+
+        const uint64_t size = rep->getBandwidth() * segmentDuration / CLOCK_FREQ / 8;
+        const vlc_tick_t transfer = requestLatency +
+                                    trace.getTransferTime(now + requestLatency, size);
+        now += transfer;
+
+        vlc_tick_t elapsed = transfer;
+        if(playing && elapsed > buffering)
+        {
+            elapsed -= buffering;
+            buffering = 0;
+            playing = false;
+            results.stalls++;
+        }
+        if(playing)
+            buffering -= elapsed;
+        else if(started)
+            results.rebuffering += elapsed;
+        else
+            results.startup += elapsed;
+
+        buffering += segmentDuration;
+        if(!playing && buffering >= minBuffering)
+            playing = started = true;
+
+        logic->updateDownloadRate(id, size, transfer, requestLatency);
+        logic->trackerEvent(BufferingLevelChangedEvent(id, minBuffering, maxBuffering,
+                                                       buffering, targetBuffering));
+
+        if(playing && buffering > maxBuffering)
+        {
+            now += buffering - maxBuffering;
+            buffering = maxBuffering;
+        }
+
+        bitratesum += rep->getBandwidth();
+        results.segments++;
+    }
+
+    logic->trackerEvent(BufferingStateUpdatedEvent(id, false));
+
+    if(results.segments)
+        results.averageBitrate = bitratesum / results.segments;
+    return results;
+}
@@ -0,0 +1,102 @@
+/*****************************************************************************
+ *
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLabs, VideoLAN and VLC Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifndef ADAPTATIONSIMULATOR_HPP
+#define ADAPTATIONSIMULATOR_HPP
+
+#include <vlc_common.h>
+
+#include <istream>
+#include <utility>
+#include <vector>
+
+namespace adaptive
+{
+    namespace playlist
+    {
+        class BasePlaylist;
+        class BaseAdaptationSet;
+    }
+
+    namespace logic
+    {
+        class AbstractAdaptationLogic;
+    }
+
+    namespace simulator
+    {
+        using namespace playlist;
+        using namespace logic;
+
+        /* Piecewise constant bandwidth, replayed in a loop */
+        class BandwidthTrace
+        {
+            public:
+                BandwidthTrace();
+                void add(vlc_tick_t, uint64_t);
+                /* lines of "<duration ms> <bandwidth kbit/s>", # comments */
+                bool load(std::istream &);
+                bool isValid() const;
+                vlc_tick_t getTransferTime(vlc_tick_t, uint64_t) const;
+
+            private:
+                std::vector<std::pair<vlc_tick_t, uint64_t>> samples;
+                vlc_tick_t total;
+                bool hasBandwidth;
+        };
+
+        class SimulationResults
+        {
+            public:
+                SimulationResults();
+
+                vlc_tick_t startup;
+                vlc_tick_t rebuffering;
+                unsigned stalls;
+                uint64_t averageBitrate;
+                unsigned switches;
+                unsigned segments;
+        };
+
+        class AdaptationSimulator
+        {
+            public:
+                AdaptationSimulator(const std::vector<uint64_t> &);
+                ~AdaptationSimulator();
+
+                bool isValid() const;
+                void setSegmentDuration(vlc_tick_t);
+                void setBuffering(vlc_tick_t, vlc_tick_t, vlc_tick_t);
+                void setRequestLatency(vlc_tick_t);
+                SimulationResults run(AbstractAdaptationLogic *,
+                                      const BandwidthTrace &, unsigned);
+
+            private:
+                BasePlaylist *playlist;
+                BaseAdaptationSet *adaptSet;
+                vlc_tick_t segmentDuration;
+                vlc_tick_t minBuffering;
+                vlc_tick_t maxBuffering;
+                vlc_tick_t targetBuffering;
+                vlc_tick_t requestLatency;
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,196 @@
+/*****************************************************************************
+ * simulator.cpp: replays bandwidth traces against the adaptation logics
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLabs, VideoLAN and VLC Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc_common.h>
+
+#include "AdaptationSimulator.hpp"
+
+#include "../../logic/AlwaysBestAdaptationLogic.h"
+#include "../../logic/AlwaysLowestAdaptationLogic.hpp"
+#include "../../logic/RateBasedAdaptationLogic.h"
+#include "../../logic/PredictiveAdaptationLogic.hpp"
+#include "../../logic/NearOptimalAdaptationLogic.hpp"
+#include "../../logic/HybridAdaptationLogic.hpp"
+#include "../../logic/BufferingLogic.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+
+extern const char vlc_module_name[] = "simulator";
+
+using namespace adaptive;
+using namespace adaptive::logic;
+using namespace adaptive::simulator;
+
+static const char *const logics[] = {
+    "lowest", "highest", "rate", "predictive", "nearoptimal", "hybrid",
+};
+
+static AbstractAdaptationLogic *createLogic(const char *name)
+{
+    if(!strcmp(name, "lowest"))
+        return new AlwaysLowestAdaptationLogic(nullptr);
+    if(!strcmp(name, "highest"))
+        return new AlwaysBestAdaptationLogic(nullptr);
+    if(!strcmp(name, "rate"))
+        return new RateBasedAdaptationLogic(nullptr);
+    if(!strcmp(name, "predictive"))
+        return new PredictiveAdaptationLogic(nullptr);
+    if(!strcmp(name, "nearoptimal"))
+        return new NearOptimalAdaptationLogic(nullptr);
+    if(!strcmp(name, "hybrid"))
+        return new HybridAdaptationLogic(nullptr);
+    return nullptr;
+}
+
+static bool parseBitrates(const char *psz, std::vector<uint64_t> &bitrates)
+{
+    std::istringstream is(psz);
+    std::string kbps;
+    bitrates.clear();
+    while(std::getline(is, kbps, ','))
+    {
+        uint64_t v = strtoull(kbps.c_str(), nullptr, 10);
+        if(v == 0)
+            return false;
+        bitrates.push_back(v * 1000);
+    }
+    return !bitrates.empty();
+}
+
+static void usage(const char *name)
+{
+    std::cerr << "usage: " << name << " [-l logic] [-b kbps,kbps,...] [-d segment duration s]"
+                 " [-n segments] [-m min buffering s] [-M max buffering s] trace..." << std::endl
+              << "  trace lines: <duration ms> <bandwidth kbit/s>" << std::endl
+              << "  logics: all";
+    for(const char *logic : logics)
+        std::cerr << ", " << logic;
+    std::cerr << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+    const char *logicname = "all";
+    std::vector<uint64_t> bitrates = { 250000, 750000, 1500000, 3000000, 6000000 };
+    vlc_tick_t segmentDuration = VLC_TICK_FROM_SEC(4);
+    vlc_tick_t minBuffering = AbstractBufferingLogic::DEFAULT_MIN_BUFFERING;
+    vlc_tick_t maxBuffering = AbstractBufferingLogic::DEFAULT_MAX_BUFFERING;
+    unsigned count = 150;
+
+    int i = 1;
+    for(; i < argc && argv[i][0] == '-'; i++)
+    {
+        if(i + 1 >= argc || argv[i][2] != '\0')
+        {
+            usage(argv[0]);
+            return 1;
+        }
+        const char *val = argv[++i];
+        switch(argv[i - 1][1])
+        {
+            case 'l':
+                logicname = val;
+                break;
+            case 'b':
+                if(!parseBitrates(val, bitrates))
+                {
+                    usage(argv[0]);
+                    return 1;
+                }
+                break;
+            case 'd':
+                segmentDuration = vlc_tick_from_sec(atof(val));
+                break;
+            case 'n':
+                count = atoi(val);
+                break;
+            case 'm':
+                minBuffering = vlc_tick_from_sec(atof(val));
+                break;
+            case 'M':
+                maxBuffering = vlc_tick_from_sec(atof(val));
+                break;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+
+    bool b_known = !strcmp(logicname, "all");
+    for(const char *name : logics)
+        b_known |= !strcmp(logicname, name);
+
+    if(!b_known || i == argc || segmentDuration <= 0 ||
+       minBuffering <= 0 || maxBuffering < minBuffering)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    AdaptationSimulator simulator(bitrates);
+    if(!simulator.isValid())
+        return 1;
+    simulator.setSegmentDuration(segmentDuration);
+    simulator.setBuffering(minBuffering, maxBuffering, std::min(minBuffering * 2, maxBuffering));
+
+    std::cout << std::left << std::setw(24) << "trace" << std::setw(14) << "logic"
+              << std::right << std::setw(10) << "startup" << std::setw(12) << "rebuffer"
+              << std::setw(8) << "stalls" << std::setw(12) << "avg kbps"
+              << std::setw(10) << "switches" << std::endl;
+    std::cout << std::fixed << std::setprecision(2);
+
+    for(; i < argc; i++)
+    {
+        std::ifstream file(argv[i]);
+        BandwidthTrace trace;
+        if(!file.is_open() || !trace.load(file))
+        {
+            std::cerr << "can't load trace " << argv[i] << std::endl;
+            return 1;
+        }
+
+        for(const char *name : logics)
+        {
+            if(strcmp(logicname, "all") && strcmp(logicname, name))
+                continue;
+            AbstractAdaptationLogic *logic = createLogic(name);
+            SimulationResults res = simulator.run(logic, trace, count);
+            delete logic;
+
+            std::cout << std::left << std::setw(24) << argv[i] << std::setw(14) << name
+                      << std::right << std::setw(10) << secf_from_vlc_tick(res.startup)
+                      << std::setw(12) << secf_from_vlc_tick(res.rebuffering)
+                      << std::setw(8) << res.stalls
+                      << std::setw(12) << res.averageBitrate / 1000
+                      << std::setw(10) << res.switches << std::endl;
+        }
+    }
+
+    return 0;
+}
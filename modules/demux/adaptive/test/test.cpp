@@ -45,7 +45,9 @@ int main()
     TEST(Conversions) ||
     TEST(TemplatedUri) ||
     TEST(BufferingLogic) ||
+    TEST(AdaptationLogic) ||
     TEST(CommandsQueue) ||
+    TEST(Downloader) ||
     TEST(M3U8MasterPlaylist) ||
     TEST(M3U8Playlist);
 }
@@ -98,6 +98,7 @@ MPD * IsoffMainParser::parse()
     {
         parseMPDAttributes(mpd, root);
         parseProgramInformation(DOMHelper::getFirstChildElementByName(root, "ProgramInformation"), mpd);
+        parseServiceDescription(DOMHelper::getFirstChildElementByName(root, "ServiceDescription"), mpd);
         parseMPDBaseUrl(mpd, root);
         parsePeriods(mpd, root);
         mpd->debug();
@@ -576,6 +577,21 @@ void IsoffMainParser::parseProgramInformation(Node * node, MPD *mpd)
     }
 }
 
+void IsoffMainParser::parseServiceDescription(Node *node, MPD *mpd)
+{
+    if(!node)
+        return;
+
+    Node *latency = DOMHelper::getFirstChildElementByName(node, "Latency");
+    if(latency && latency->hasAttribute("target"))
+    {
+        /* milliseconds */
+        uint64_t target = Integer<uint64_t>(latency->getAttributeValue("target"));
+        if(target)
+            mpd->targetLatency.Set(VLC_TICK_FROM_MS(target));
+    }
+}
+
 Profile IsoffMainParser::getProfile() const
 {
     Profile res(Profile::Name::Unknown);
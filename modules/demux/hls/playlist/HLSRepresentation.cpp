@@ -34,6 +34,7 @@
 
 #include <ctime>
 #include <limits>
+#include <sstream>
 #include <cassert>
 
 using namespace hls;
@@ -46,7 +47,12 @@ HLSRepresentation::HLSRepresentation  ( BaseAdaptationSet *set ) :
     b_loaded = false;
     b_failed = false;
     lastUpdateTime = 0;
+    lastReloadTime = 0;
     targetDuration = 0;
+    partTarget = 0;
+    b_canBlockReload = false;
+    partialSequence = 0;
+    partialCount = 0;
     streamFormat = StreamFormat::Type::Unknown;
 }
 
@@ -64,6 +70,11 @@ bool HLSRepresentation::isLive() const
     return b_live;
 }
 
+bool HLSRepresentation::isLowLatency() const
+{
+    return partTarget > 0;
+}
+
 bool HLSRepresentation::initialized() const
 {
     return b_loaded;
@@ -89,6 +100,20 @@ Url HLSRepresentation::getPlaylistUrl() const
     }
 }
 
+std::string HLSRepresentation::getPlaylistUpdateUrl() const
+{
+    std::string url = getPlaylistUrl().toString();
+    if(!b_loaded || !isLive() || !isLowLatency() || !b_canBlockReload)
+        return url;
+
+    /* Have the server hold the response until the next part is published */
+    std::ostringstream os;
+    os.imbue(std::locale("C"));
+    os << url << ((url.find('?') == std::string::npos) ? '?' : '&')
+       << "_HLS_msn=" << partialSequence << "&_HLS_part=" << partialCount;
+    return os.str();
+}
+
 void HLSRepresentation::debug(vlc_object_t *obj, int indent) const
 {
     BaseRepresentation::debug(obj, indent);
@@ -134,10 +159,16 @@ bool HLSRepresentation::needsUpdate(uint64_t number) const
     if(isLive())
     {
         const vlc_tick_t now = vlc_tick_now();
-        const vlc_tick_t elapsed = now - lastUpdateTime;
-        const vlc_tick_t duration = targetDuration
-                                  ? vlc_tick_from_sec(targetDuration)
-                                  : VLC_TICK_FROM_SEC(2);
+        const vlc_tick_t elapsed = now - std::max(lastUpdateTime, lastReloadTime);
+        vlc_tick_t duration = targetDuration
+                            ? vlc_tick_from_sec(targetDuration)
+                            : VLC_TICK_FROM_SEC(2);
+        if(isLowLatency())
+        {
+            /* New parts are published every part target duration. Blocking
+             * reloads return as soon as one is, so they can be issued earlier */
+            duration = b_canBlockReload ? partTarget / 2 : partTarget;
+        }
         if(elapsed < duration)
             return false;
 
@@ -158,6 +189,7 @@ bool HLSRepresentation::runLocalUpdates(SharedResources *res)
         b_failed = true;
     else
         b_loaded = true;
+    lastReloadTime = vlc_tick_now();
     return true;
 }
 
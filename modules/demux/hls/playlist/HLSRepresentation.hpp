@@ -45,7 +45,9 @@ namespace hls
 
                 void setPlaylistUrl(const std::string &);
                 Url getPlaylistUrl() const;
+                std::string getPlaylistUpdateUrl() const;
                 bool isLive() const;
+                bool isLowLatency() const;
                 bool initialized() const;
                 virtual void scheduleNextUpdate(uint64_t, bool) override;
                 virtual bool needsUpdate(uint64_t) const override;
@@ -60,7 +62,12 @@ namespace hls
                 bool b_loaded;
                 bool b_failed;
                 vlc_tick_t lastUpdateTime;
+                vlc_tick_t lastReloadTime;
                 time_t targetDuration;
+                vlc_tick_t partTarget;
+                bool b_canBlockReload;
+                uint64_t partialSequence; /* segment being produced */
+                unsigned partialCount; /* its parts already published */
                 Url playlistUrl;
         };
     }
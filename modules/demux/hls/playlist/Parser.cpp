@@ -162,7 +162,7 @@ void M3U8Parser::createAndFillRepresentation(vlc_object_t *p_obj, BaseAdaptation
 
 bool M3U8Parser::appendSegmentsFromPlaylistURI(vlc_object_t *p_obj, HLSRepresentation *rep)
 {
-    block_t *p_block = Retrieve::HTTP(resources, ChunkType::Playlist, rep->getPlaylistUrl().toString());
+    block_t *p_block = Retrieve::HTTP(resources, ChunkType::Playlist, rep->getPlaylistUpdateUrl());
     if(p_block)
     {
         stream_t *substream = vlc_stream_MemoryNew(p_obj, p_block->p_buffer, p_block->i_buffer, true);
@@ -234,6 +234,15 @@ void M3U8Parser::parseSegments(vlc_object_t *, HLSRepresentation *rep, const std
     CommonEncryption encryption;
     const ValuesListTag *ctx_extinf = nullptr;
 
+    /* Parts of the segment being produced, which follow the last segment.
+     * It can only be fetched before completion if all its parts are ranges
+     * of a single resource, delivered progressively. */
+    std::string partialUrl;
+    vlc_tick_t partialDuration = 0;
+    unsigned partialCount = 0;
+    bool partialStreamable = true;
+    const AttributesTag *ctx_preloadhint = nullptr;
+
     std::list<HLSSegment *> segmentstoappend;
 
     std::list<Tag *>::const_iterator it;
@@ -258,6 +267,13 @@ void M3U8Parser::parseSegments(vlc_object_t *, HLSRepresentation *rep, const std
             case SingleValueTag::URI:
             {
                 const SingleValueTag *uritag = static_cast<const SingleValueTag *>(tag);
+                /* Previous parts were this segment's */
+                partialUrl.clear();
+                partialDuration = 0;
+                partialCount = 0;
+                partialStreamable = true;
+                ctx_preloadhint = nullptr;
+
                 if(uritag->getValue().value.empty())
                 {
                     ctx_extinf = nullptr;
@@ -373,6 +389,51 @@ void M3U8Parser::parseSegments(vlc_object_t *, HLSRepresentation *rep, const std
             }
             break;
 
+            case AttributesTag::EXTXSERVERCONTROL:
+            {
+                const AttributesTag *controltag = static_cast<const AttributesTag *>(tag);
+                const Attribute *attr = controltag->getAttributeByName("CAN-BLOCK-RELOAD");
+                rep->b_canBlockReload = (attr && attr->value == "YES");
+                attr = controltag->getAttributeByName("PART-HOLD-BACK");
+                if(attr)
+                    rep->getPlaylist()->targetLatency.Set(vlc_tick_from_sec(attr->floatingPoint()));
+            }
+            break;
+
+            case AttributesTag::EXTXPARTINF:
+            {
+                const Attribute *attr = static_cast<const AttributesTag *>(tag)->getAttributeByName("PART-TARGET");
+                if(attr)
+                    rep->partTarget = vlc_tick_from_sec(attr->floatingPoint());
+            }
+            break;
+
+            case AttributesTag::EXTXPART:
+            {
+                const AttributesTag *parttag = static_cast<const AttributesTag *>(tag);
+                const Attribute *uriAttr = parttag->getAttributeByName("URI");
+                if(!uriAttr)
+                    break;
+                const std::string uri = uriAttr->quotedString();
+                if(partialCount++ == 0)
+                    partialUrl = uri;
+                if(uri != partialUrl || !parttag->getAttributeByName("BYTERANGE"))
+                    partialStreamable = false;
+                const Attribute *durAttr = parttag->getAttributeByName("DURATION");
+                if(durAttr)
+                    partialDuration += vlc_tick_from_sec(durAttr->floatingPoint());
+            }
+            break;
+
+            case AttributesTag::EXTXPRELOADHINT:
+            {
+                const AttributesTag *hinttag = static_cast<const AttributesTag *>(tag);
+                const Attribute *typeAttr = hinttag->getAttributeByName("TYPE");
+                if(typeAttr && typeAttr->value == "PART" && hinttag->getAttributeByName("URI"))
+                    ctx_preloadhint = hinttag;
+            }
+            break;
+
             case Tag::EXTXDISCONTINUITY:
                 discontinuity  = true;
                 break;
@@ -383,6 +444,40 @@ void M3U8Parser::parseSegments(vlc_object_t *, HLSRepresentation *rep, const std
         }
     }
 
+    rep->partialSequence = sequenceNumber;
+    rep->partialCount = partialCount;
+
+    /* The next part might only be announced, as a byte range being produced */
+    if(ctx_preloadhint)
+    {
+        const std::string uri = ctx_preloadhint->getAttributeByName("URI")->quotedString();
+        if(partialCount == 0)
+            partialUrl = uri;
+        if(uri != partialUrl || !ctx_preloadhint->getAttributeByName("BYTERANGE-START"))
+            partialStreamable = false;
+    }
+
+    if(rep->isLive() && !partialUrl.empty() && partialStreamable)
+    {
+        HLSSegment *segment = new (std::nothrow) HLSSegment(rep, sequenceNumber);
+        if(segment)
+        {
+            segment->setSourceUrl(partialUrl);
+            segment->incomplete = true;
+            /* only what is already available, so that it can be the live edge */
+            vlc_tick_t nzDuration = partialCount ? partialDuration : rep->partTarget;
+            segment->duration.Set(timescale.ToScaled(nzDuration));
+            segment->startTime.Set(timescale.ToScaled(nzStartTime));
+            if(absReferenceTime != VLC_TICK_INVALID)
+                segment->setDisplayTime(absReferenceTime);
+            if(discontinuity)
+                segment->discontinuity = true;
+            if(encryption.method != CommonEncryption::Method::None)
+                segment->setEncryption(encryption);
+            segmentstoappend.push_back(segment);
+        }
+    }
+
     for(HLSSegment *seg : segmentstoappend)
         segmentList->addSegment(seg);
     segmentstoappend.clear();
@@ -348,54 +348,6 @@ static es_out_id_t * MP4_CreateES( es_out_t *out, const es_format_t *p_fmt,
     return p_es;
 }
 
-static int MP4_ChunkAllocDtsEntries( mp4_chunk_t *ck )
-{
-    size_t entries = ck->i_entries_dts;
-
-    if( entries <= ARRAY_SIZE(ck->small_dts_buf) / 2 )
-    {
-        ck->p_sample_count_dts = ck->small_dts_buf;
-        ck->p_sample_delta_dts = ck->small_dts_buf + entries;
-        return 0;
-    }
-
-    uint32_t *buf = calloc( entries, sizeof( buf[0] ) * 2 );
-    if( unlikely(buf == NULL) )
-        return VLC_ENOMEM;
-
-    ck->p_sample_count_dts = buf;
-    ck->p_sample_delta_dts = buf + entries;
-    return 0;
-}
-
-static int MP4_ChunkAllocPtsEntries( mp4_chunk_t *ck )
-{
-    size_t entries = ck->i_entries_pts;
-
-    if( entries <= ARRAY_SIZE(ck->small_pts_buf) / 2 )
-    {
-        ck->p_sample_count_pts = ck->small_pts_buf;
-        ck->p_sample_offset_pts = ck->small_pts_buf + entries;
-        return 0;
-    }
-
-    uint32_t *buf = calloc( entries, sizeof( buf[0] ) * 2 );
-    if( unlikely(buf == NULL) )
-        return VLC_ENOMEM;
-
-    ck->p_sample_count_pts = buf;
-    ck->p_sample_offset_pts = buf + entries;
-    return 0;
-}
-
-static void MP4_ChunkDestroy( mp4_chunk_t *ck )
-{
-    if( ck->p_sample_count_dts != ck->small_dts_buf )
-        free( ck->p_sample_count_dts );
-    if( ck->p_sample_count_pts != ck->small_pts_buf )
-        free( ck->p_sample_count_pts );
-}
-
 static const mp4_chunk_t * MP4_TrackChunkForSample( const mp4_track_t *p_track,
                                                     uint32_t i_sample )
 {
@@ -410,46 +362,6 @@ static const mp4_chunk_t * MP4_TrackChunkForSample( const mp4_track_t *p_track,
     return NULL;
 }
 
-static stime_t MP4_ChunkGetSampleDTS( const mp4_chunk_t *p_chunk,
-                                      uint32_t i_sample )
-{
-    uint32_t i_index = 0;
-    stime_t sdts = p_chunk->i_first_dts;
-    while( i_sample > 0 && i_index < p_chunk->i_entries_dts )
-    {
-        if( i_sample > p_chunk->p_sample_count_dts[i_index] )
-        {
-            sdts += (stime_t)p_chunk->p_sample_count_dts[i_index] *
-                p_chunk->p_sample_delta_dts[i_index];
-            i_sample -= p_chunk->p_sample_count_dts[i_index++];
-        }
-        else
-        {
-            sdts += (stime_t)i_sample * p_chunk->p_sample_delta_dts[i_index];
-            break;
-        }
-    }
-    return sdts;
-}
-
-static bool MP4_ChunkGetSampleCTSDelta( const mp4_chunk_t *p_chunk,
-                                        uint32_t i_sample, stime_t *pi_delta )
-{
-    if( p_chunk->p_sample_count_pts && p_chunk->p_sample_offset_pts )
-    {
-        for( uint32_t i_index = 0; i_index < p_chunk->i_entries_pts ; i_index++ )
-        {
-            if( i_sample < p_chunk->p_sample_count_pts[i_index] )
-            {
-                *pi_delta = p_chunk->p_sample_offset_pts[i_index];
-                return true;
-            }
-            i_sample -= p_chunk->p_sample_count_pts[i_index];
-        }
-    }
-    return false;
-}
-
 static vlc_tick_t MP4_TrackGetDTSPTS( demux_t *p_demux, const mp4_track_t *p_track,
                                       vlc_tick_t *pi_nzpts )
 {
@@ -500,43 +412,28 @@ static inline vlc_tick_t MP4_GetSamplesDuration( demux_t *p_demux, mp4_track_t *
 {
     VLC_UNUSED( p_demux );
 
+    MP4_TrackIndexChunks( p_track, p_track->i_chunk );
     const mp4_chunk_t *p_chunk = &p_track->chunk[p_track->i_chunk];
     stime_t i_duration = 0;
 
-    /* Forward to right index, and set remaining count in that index */
-    unsigned i_index = 0;
-    unsigned i_remain = 0;
-    for( unsigned i = p_chunk->i_sample_first;
-         i<p_track->i_sample && i_index < p_chunk->i_entries_dts; )
-    {
-        if( p_track->i_sample - i >= p_chunk->p_sample_count_dts[i_index] )
-        {
-            i += p_chunk->p_sample_count_dts[i_index];
-            i_index++;
-        }
-        else
-        {
-            i_remain = p_track->i_sample - i;
-            break;
-        }
-    }
+    /* Walk the runs from the chunk start, skipping the samples already read */
+    mp4_tts_iter_t it;
+    uint32_t i_count;
+    int32_t i_delta;
+    uint32_t i_skip = p_track->i_sample - p_chunk->i_sample_first;
 
-    /* Compute total duration from all samples from index */
-    while( i_nb_samples > 0 && i_index < p_chunk->i_entries_dts )
+    MP4_TTSIterInit( &it, &p_track->stts, &p_chunk->dts, p_chunk->i_sample_count );
+    while( i_nb_samples > 0 && (i_count = MP4_TTSIterNext( &it, &i_delta )) )
     {
-        if( i_nb_samples >= p_chunk->p_sample_count_dts[i_index] - i_remain )
+        if( i_skip >= i_count )
         {
-            i_duration += (p_chunk->p_sample_count_dts[i_index] - i_remain) *
-                          (int64_t) p_chunk->p_sample_delta_dts[i_index];
-            i_nb_samples -= (p_chunk->p_sample_count_dts[i_index] - i_remain);
-            i_index++;
-            i_remain = 0;
-        }
-        else
-        {
-            i_duration += (stime_t)i_nb_samples * p_chunk->p_sample_delta_dts[i_index];
-            break;
+            i_skip -= i_count;
+            continue;
         }
+        i_count = __MIN( i_count - i_skip, i_nb_samples );
+        i_skip = 0;
+        i_duration += (stime_t)i_count * (uint32_t)i_delta;
+        i_nb_samples -= i_count;
     }
 
     return MP4_rescale_mtime( i_duration, p_track->i_timescale );
@@ -679,6 +576,9 @@ static void MP4_GetInterleaving( demux_t *p_demux, vlc_tick_t *pi_max_contiguous
         if( !cur->i_chunk_count )
             continue;
 
+        /* Needs the duration of every chunk */
+        MP4_TrackIndexChunks( cur, cur->i_chunk_count - 1 );
+
         if( tk == NULL || cur->chunk[0].i_offset < tk->chunk[0].i_offset )
             tk = cur;
     }
@@ -728,6 +628,28 @@ static void MP4_GetInterleaving( demux_t *p_demux, vlc_tick_t *pi_max_contiguous
         p_sys->track[i].i_chunk = 0;
 }
 
+/* Cheap interleaving estimate, from the first and last chunk of each track,
+ * leaving the virtual run numbers alone */
+static bool MP4_TracksOverlap( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    uint64_t i_max_start = 0, i_min_end = UINT64_MAX;
+    unsigned i_tracks = 0;
+
+    for( unsigned i=0; i < p_sys->i_tracks; i++ )
+    {
+        const mp4_track_t *cur = &p_sys->track[i];
+        if( !cur->i_chunk_count )
+            continue;
+
+        i_max_start = __MAX( i_max_start, cur->chunk[0].i_offset );
+        i_min_end = __MIN( i_min_end, cur->chunk[cur->i_chunk_count - 1].i_offset );
+        i_tracks++;
+    }
+
+    return i_tracks < 2 || i_max_start < i_min_end;
+}
+
 static block_t * MP4_Block_Convert( demux_t *p_demux, const mp4_track_t *p_track, block_t *p_block )
 {
     /* might have some encap */
@@ -1238,16 +1160,27 @@ static int Open( vlc_object_t * p_this )
         goto error;
     }
 
-    if( p_sys->i_tracks > 1 && !p_sys->b_fastseekable )
+    bool b_interleaved = true;
+    if( p_sys->i_tracks > 1 && p_sys->b_fastseekable )
+    {
+        /* No preloading, hence no need for the run numbers */
+        b_interleaved = MP4_TracksOverlap( p_demux );
+        msg_Dbg( p_demux, "media is%s interleaved", b_interleaved ? "" : " not" );
+    }
+    else if( p_sys->i_tracks > 1 )
     {
         vlc_tick_t i_max_continuity;
         bool b_flat;
         MP4_GetInterleaving( p_demux, &i_max_continuity, &b_flat );
+        b_interleaved = !b_flat && i_max_continuity <= DEMUX_TRACK_MAX_PRELOAD;
         if( b_flat )
             msg_Warn( p_demux, "that media doesn't look interleaved, will need to seek");
-        else if( i_max_continuity > DEMUX_TRACK_MAX_PRELOAD )
+        else if( !b_interleaved )
             msg_Warn( p_demux, "that media doesn't look properly interleaved, will need to seek");
     }
+    /* Samples are read in file order, unless tracks are far apart */
+    vlc_stream_SetAccessHint( p_demux->s, b_interleaved ? STREAM_ACCESS_SEQUENTIAL
+                                                        : STREAM_ACCESS_NORMAL );
 
     /* */
     LoadChapter( p_demux );
@@ -1487,7 +1420,7 @@ static int DemuxTrack( demux_t *p_demux, mp4_track_t *tk, uint64_t i_readpos,
             i_samplessize = OverflowCheck( p_demux, tk, i_readpos, i_samplessize );
 
             /* now read pes */
-            if( !(p_block = vlc_stream_Block( p_demux->s, i_samplessize )) )
+            if( !(p_block = vlc_stream_BlockMapped( p_demux->s, i_samplessize )) )
             {
                 msg_Warn( p_demux, "track[0x%x] will be disabled (eof?)"
                                    ": Failed to read %d bytes sample at %"PRIu64,
@@ -2413,7 +2346,10 @@ static void LoadChapter( demux_t  *p_demux )
     }
 }
 
-/* now create basic chunk data, the rest will be filled by MP4_CreateSamplesIndex */
+/* now create basic chunk data, the rest will be filled by MP4_CreateSamplesIndex
+ * Note that every chunk entry is still allocated at open, with its offset and
+ * samples read from stco/stsc in O(chunks). Only walking the stts/ctts runs
+ * for the chunks timing is deferred to MP4_TrackIndexChunks. */
 static int TrackCreateChunksIndex( demux_t *p_demux,
                                    mp4_track_t *p_demux_track )
 {
@@ -2450,12 +2386,6 @@ static int TrackCreateChunksIndex( demux_t *p_demux,
         ck->i_offset = BOXDATA(p_co64)->i_chunk_offset[i_chunk];
 
         ck->i_first_dts = 0;
-        ck->i_entries_dts = 0;
-        ck->p_sample_count_dts = NULL;
-        ck->p_sample_delta_dts = NULL;
-        ck->i_entries_pts = 0;
-        ck->p_sample_count_pts = NULL;
-        ck->p_sample_offset_pts = NULL;
     }
 
     /* now we read index for SampleEntry( soun vide mp4a mp4v ...)
@@ -2517,54 +2447,6 @@ static int TrackCreateChunksIndex( demux_t *p_demux,
     return VLC_SUCCESS;
 }
 
-static int xTTS_CountEntries( demux_t *p_demux, uint32_t *pi_entry /* out */,
-                              const uint32_t i_index,
-                              uint32_t i_index_samples_left,
-                              uint32_t i_sample_count,
-                              const uint32_t *pi_index_sample_count,
-                              const uint32_t i_table_count )
-{
-    uint32_t i_array_offset;
-    while( i_sample_count > 0 )
-    {
-        if ( likely((UINT32_MAX - i_index) >= *pi_entry) )
-            i_array_offset = i_index + *pi_entry;
-        else
-            return VLC_EGENERIC;
-
-        if ( i_array_offset >= i_table_count )
-        {
-            msg_Err( p_demux, "invalid index counting total samples %u %u", i_array_offset,  i_table_count );
-            return VLC_EINVAL;
-        }
-
-        if ( i_index_samples_left )
-        {
-            if ( i_index_samples_left > i_sample_count )
-            {
-                i_index_samples_left -= i_sample_count;
-                i_sample_count = 0;
-                *pi_entry +=1; /* No samples left, go copy */
-                break;
-            }
-            else
-            {
-                i_sample_count -= i_index_samples_left;
-                i_index_samples_left = 0;
-                *pi_entry += 1;
-                continue;
-            }
-        }
-        else
-        {
-            i_sample_count -= __MIN( i_sample_count, pi_index_sample_count[i_array_offset] );
-            *pi_entry += 1;
-        }
-    }
-
-    return VLC_SUCCESS;
-}
-
 static int TrackCreateSamplesIndex( demux_t *p_demux,
                                     mp4_track_t *p_demux_track )
 {
@@ -2602,18 +2484,9 @@ static int TrackCreateSamplesIndex( demux_t *p_demux,
     }
     else
     {
-        /* 2: each sample can have a different size */
+        /* 2: each sample can have a different size, use the box table */
         p_demux_track->i_sample_size = 0;
-        p_demux_track->p_sample_size =
-            calloc( p_demux_track->i_sample_count, sizeof( uint32_t ) );
-        if( p_demux_track->p_sample_size == NULL )
-            return VLC_ENOMEM;
-
-        for( uint32_t i_sample = 0; i_sample < p_demux_track->i_sample_count; i_sample++ )
-        {
-            p_demux_track->p_sample_size[i_sample] =
-                    stsz->i_entry_size[i_sample];
-        }
+        p_demux_track->p_sample_size = stsz->i_entry_size;
     }
 
     if ( p_demux_track->i_chunk_count && p_demux_track->i_sample_size == 0 )
@@ -2626,14 +2499,12 @@ static int TrackCreateSamplesIndex( demux_t *p_demux,
         }
     }
 
-    /* Use stts table to create a sample number -> dts table.
-     * XXX: if we don't want to waste too much memory, we can't expand
-     *  the box! so each chunk will contain an "extract" of this table
-     *  for fast research (problem with raw stream where a sample is sometime
-     *  just channels*bits_per_sample/8 */
-
-     /* FIXME: refactor STTS & CTTS, STTS having now only few extra lines and
-      *        differing in 2/2 fields and 1 signedness */
+    /* Use stts table to find the dts of each chunk.
+     * The table is already run-length coded, so the chunks only keep where
+     * their samples start in it, and the dts of any sample is computed from
+     * there on demand, instead of expanding the table per chunk. Finding
+     * where each chunk starts is also deferred to when the chunk is first
+     * accessed (see MP4_TrackIndexChunks). */
 
     int64_t i_next_dts = 0;
     /* Find stts
@@ -2648,97 +2519,22 @@ static int TrackCreateSamplesIndex( demux_t *p_demux,
     else
     {
         MP4_Box_data_stts_t *stts = p_box->data.p_stts;
+        uint64_t i_samples = 0;
 
         msg_Warn( p_demux, "STTS table of %"PRIu32" entries", stts->i_entry_count );
 
-        /* Create sample -> dts table per chunk */
-        uint32_t i_index = 0;
-        uint32_t i_current_index_samples_left = 0;
+        p_demux_track->stts.pi_count = stts->pi_sample_count;
+        p_demux_track->stts.pi_value = stts->pi_sample_delta;
+        p_demux_track->stts.i_entries = stts->i_entry_count;
 
-        for( uint32_t i_chunk = 0; i_chunk < p_demux_track->i_chunk_count; i_chunk++ )
+        for( uint32_t i = 0; i < stts->i_entry_count; i++ )
         {
-            mp4_chunk_t *ck = &p_demux_track->chunk[i_chunk];
-            uint32_t i_sample_count;
-
-            /* save first dts */
-            ck->i_first_dts = i_next_dts;
-
-            /* count how many entries are needed for this chunk
-             * for p_sample_delta_dts and p_sample_count_dts */
-            ck->i_entries_dts = 0;
-
-            int i_ret = xTTS_CountEntries( p_demux, &ck->i_entries_dts, i_index,
-                                           i_current_index_samples_left,
-                                           ck->i_sample_count,
-                                           stts->pi_sample_count,
-                                           stts->i_entry_count );
-            if ( i_ret == VLC_EGENERIC )
-                return i_ret;
-
-            /* allocate them */
-            i_ret = MP4_ChunkAllocDtsEntries( ck );
-            if( i_ret )
-            {
-                msg_Err( p_demux, "can't allocate memory for i_entry=%"PRIu32, ck->i_entries_dts );
-                ck->i_entries_dts = 0;
-                return i_ret;
-            }
-
-            /* now copy */
-            i_sample_count = ck->i_sample_count;
-
-            for( uint32_t i = 0; i < ck->i_entries_dts; i++ )
-            {
-                if ( i_current_index_samples_left )
-                {
-                    if ( i_current_index_samples_left > i_sample_count )
-                    {
-                        ck->p_sample_count_dts[i] = i_sample_count;
-                        ck->p_sample_delta_dts[i] = stts->pi_sample_delta[i_index];
-                        i_next_dts += (int64_t)ck->p_sample_count_dts[i] * stts->pi_sample_delta[i_index];
-                        if ( i_sample_count ) ck->i_duration = i_next_dts - ck->i_first_dts;
-                        i_current_index_samples_left -= i_sample_count;
-                        i_sample_count = 0;
-                        assert( i == ck->i_entries_dts - 1 );
-                        break;
-                    }
-                    else
-                    {
-                        ck->p_sample_count_dts[i] = i_current_index_samples_left;
-                        ck->p_sample_delta_dts[i] = stts->pi_sample_delta[i_index];
-                        i_next_dts += (int64_t)ck->p_sample_count_dts[i] * stts->pi_sample_delta[i_index];
-                        if ( i_current_index_samples_left ) ck->i_duration = i_next_dts - ck->i_first_dts;
-                        i_sample_count -= i_current_index_samples_left;
-                        i_current_index_samples_left = 0;
-                        i_index++;
-                    }
-                }
-                else
-                {
-                    if ( stts->pi_sample_count[i_index] > i_sample_count )
-                    {
-                        ck->p_sample_count_dts[i] = i_sample_count;
-                        ck->p_sample_delta_dts[i] = stts->pi_sample_delta[i_index];
-                        i_next_dts += (int64_t)ck->p_sample_count_dts[i] * stts->pi_sample_delta[i_index];
-                        if ( i_sample_count ) ck->i_duration = i_next_dts - ck->i_first_dts;
-                        i_current_index_samples_left = stts->pi_sample_count[i_index] - i_sample_count;
-                        i_sample_count = 0;
-                        assert( i == ck->i_entries_dts - 1 );
-                        // keep building from same index
-                    }
-                    else
-                    {
-                        ck->p_sample_count_dts[i] = stts->pi_sample_count[i_index];
-                        ck->p_sample_delta_dts[i] = stts->pi_sample_delta[i_index];
-                        i_next_dts += (int64_t)ck->p_sample_count_dts[i] * stts->pi_sample_delta[i_index];
-                        if ( stts->pi_sample_count[i_index] ) ck->i_duration = i_next_dts - ck->i_first_dts;
-                        i_sample_count -= stts->pi_sample_count[i_index];
-                        i_index++;
-                    }
-                }
-
-            }
+            i_samples += stts->pi_sample_count[i];
+            i_next_dts += (int64_t)stts->pi_sample_count[i] * stts->pi_sample_delta[i];
         }
+        if( i_samples < p_demux_track->i_sample_count )
+            msg_Err( p_demux, "invalid index counting total samples %"PRIu64" %"PRIu32,
+                     i_samples, p_demux_track->i_sample_count );
     }
 
 
@@ -2767,88 +2563,18 @@ static int TrackCreateSamplesIndex( demux_t *p_demux,
             }
         }
 
-        /* Create pts-dts table per chunk */
-        uint32_t i_index = 0;
-        uint32_t i_current_index_samples_left = 0;
-
-        for( uint32_t i_chunk = 0; i_chunk < p_demux_track->i_chunk_count; i_chunk++ )
-        {
-            mp4_chunk_t *ck = &p_demux_track->chunk[i_chunk];
-            uint32_t i_sample_count;
-
-            /* count how many entries are needed for this chunk
-             * for p_sample_offset_pts and p_sample_count_pts */
-            ck->i_entries_pts = 0;
-            int i_ret = xTTS_CountEntries( p_demux, &ck->i_entries_pts, i_index,
-                                           i_current_index_samples_left,
-                                           ck->i_sample_count,
-                                           ctts->pi_sample_count,
-                                           ctts->i_entry_count );
-            if ( i_ret == VLC_EGENERIC )
-                return i_ret;
-
-            /* allocate them */
-            i_ret = MP4_ChunkAllocPtsEntries( ck );
-            if( i_ret )
-            {
-                msg_Err( p_demux, "can't allocate memory for i_entry=%"PRIu32, ck->i_entries_pts );
-                ck->i_entries_pts = 0;
-                return i_ret;
-            }
-
-            /* now copy */
-            i_sample_count = ck->i_sample_count;
-
-            for( uint32_t i = 0; i < ck->i_entries_pts; i++ )
-            {
-                int64_t i_ctsdelta = ctts->pi_sample_offset[i_index] + i_cts_shift;
-                if( i_ctsdelta < 0 ) /* should not */
-                    i_ctsdelta = 0;
-                if ( i_current_index_samples_left )
-                {
-                    if ( i_current_index_samples_left > i_sample_count )
-                    {
-                        ck->p_sample_count_pts[i] = i_sample_count;
-                        ck->p_sample_offset_pts[i] = i_ctsdelta;
-                        i_current_index_samples_left -= i_sample_count;
-                        i_sample_count = 0;
-                        assert( i == ck->i_entries_pts - 1 );
-                        break;
-                    }
-                    else
-                    {
-                        ck->p_sample_count_pts[i] = i_current_index_samples_left;
-                        ck->p_sample_offset_pts[i] = i_ctsdelta;
-                        i_sample_count -= i_current_index_samples_left;
-                        i_current_index_samples_left = 0;
-                        i_index++;
-                    }
-                }
-                else
-                {
-                    if ( ctts->pi_sample_count[i_index] > i_sample_count )
-                    {
-                        ck->p_sample_count_pts[i] = i_sample_count;
-                        ck->p_sample_offset_pts[i] = i_ctsdelta;
-                        i_current_index_samples_left = ctts->pi_sample_count[i_index] - i_sample_count;
-                        i_sample_count = 0;
-                        assert( i == ck->i_entries_pts - 1 );
-                        // keep building from same index
-                    }
-                    else
-                    {
-                        ck->p_sample_count_pts[i] = ctts->pi_sample_count[i_index];
-                        ck->p_sample_offset_pts[i] = i_ctsdelta;
-                        i_sample_count -= ctts->pi_sample_count[i_index];
-                        i_index++;
-                    }
-                }
-
-
-            }
-        }
+        p_demux_track->ctts.pi_count = ctts->pi_sample_count;
+        p_demux_track->ctts.pi_value = ctts->pi_sample_offset;
+        p_demux_track->ctts.i_entries = ctts->i_entry_count;
+        p_demux_track->i_cts_shift = i_cts_shift;
     }
 
+    /* No chunk is indexed yet */
+    p_demux_track->i_chunk_timed = 0;
+    p_demux_track->i_first_dts = 0;
+    p_demux_track->next_dts = (mp4_tts_pos_t) { 0, 0 };
+    p_demux_track->next_pts = (mp4_tts_pos_t) { 0, 0 };
+
     msg_Dbg( p_demux, "track[Id 0x%x] read %"PRIu32" samples length:%"PRId64"s",
              p_demux_track->i_track_ID, p_demux_track->i_sample_count,
              i_next_dts / p_demux_track->i_timescale );
@@ -2863,7 +2589,7 @@ static int TrackCreateSamplesIndex( demux_t *p_demux,
  */
 static void TrackGetESSampleRate( demux_t *p_demux,
                                   unsigned *pi_num, unsigned *pi_den,
-                                  const mp4_track_t *p_track,
+                                  mp4_track_t *p_track,
                                   unsigned i_sd_index,
                                   unsigned i_chunk )
 {
@@ -2887,7 +2613,8 @@ static void TrackGetESSampleRate( demux_t *p_demux,
     if( p_track->i_chunk_count == 0 )
         return;
 
-    /* */
+    /* Needs the duration of the chunks up to the end of the description */
+    MP4_TrackIndexChunks( p_track, p_track->i_chunk_count - 1 );
     const mp4_chunk_t *p_chunk = &p_track->chunk[i_chunk];
     while( p_chunk > &p_track->chunk[0] &&
            p_chunk[-1].i_sample_description_index == i_sd_index )
@@ -2933,7 +2660,7 @@ static void TrackConfigApply( const track_config_t *p_cfg,
      p_track->i_block_flags = p_cfg->i_block_flags;
 }
 
-static int TrackFillConfig( demux_t *p_demux, const mp4_track_t *p_track,
+static int TrackFillConfig( demux_t *p_demux, mp4_track_t *p_track,
                             const MP4_Box_t *p_sample,unsigned i_chunk,
                             es_format_t *p_fmt, track_config_t *p_cfg )
 {
@@ -3198,6 +2925,7 @@ static int TrackTimeToSampleChunk( demux_t *p_demux, mp4_track_t *p_track,
             break;
         }
 
+        MP4_TrackIndexChunks( p_track, i_chunk + 1 );
         if( (uint64_t)i_start >= p_track->chunk[i_chunk].i_first_dts &&
             (uint64_t)i_start <  p_track->chunk[i_chunk + 1].i_first_dts )
         {
@@ -3209,29 +2937,27 @@ static int TrackTimeToSampleChunk( demux_t *p_demux, mp4_track_t *p_track,
     i_sample = p_track->chunk[i_chunk].i_sample_first;
     i_dts    = p_track->chunk[i_chunk].i_first_dts;
 
-    for( uint_fast32_t i_index = 0;
-         i_index < p_track->chunk[i_chunk].i_entries_dts &&
-         i_sample < p_track->chunk[i_chunk].i_sample_count;
-         i_index++ )
+    mp4_tts_iter_t it;
+    uint32_t i_count;
+    int32_t i_delta;
+
+    MP4_TTSIterInit( &it, &p_track->stts, &p_track->chunk[i_chunk].dts,
+                     p_track->chunk[i_chunk].i_sample_count );
+    while( i_sample < p_track->chunk[i_chunk].i_sample_count &&
+           (i_count = MP4_TTSIterNext( &it, &i_delta )) )
     {
-        if( i_dts +
-            (uint64_t)p_track->chunk[i_chunk].p_sample_count_dts[i_index] *
-            p_track->chunk[i_chunk].p_sample_delta_dts[i_index] < (uint64_t)i_start )
+        if( i_dts + (uint64_t)i_count * (uint32_t)i_delta < (uint64_t)i_start )
         {
-            i_dts    +=
-                (uint64_t)p_track->chunk[i_chunk].p_sample_count_dts[i_index] *
-                p_track->chunk[i_chunk].p_sample_delta_dts[i_index];
-
-            i_sample += p_track->chunk[i_chunk].p_sample_count_dts[i_index];
+            i_dts    += (uint64_t)i_count * (uint32_t)i_delta;
+            i_sample += i_count;
         }
         else
         {
-            if( p_track->chunk[i_chunk].p_sample_delta_dts[i_index] <= 0 )
+            if( i_delta == 0 )
             {
                 break;
             }
-            i_sample += ( i_start - i_dts ) /
-                p_track->chunk[i_chunk].p_sample_delta_dts[i_index];
+            i_sample += ( i_start - i_dts ) / (uint32_t)i_delta;
             break;
         }
     }
@@ -3381,8 +3107,7 @@ static void TrackUpdateStarttimes( mp4_track_t *p_track )
     p_track->i_start_delta = p_track->i_next_delta;
 
     /* Probe the 16 first B frames */
-    const mp4_chunk_t *p_chunk = &p_track->chunk[p_track->i_chunk];
-    if( p_chunk->i_entries_pts )
+    if( p_track->ctts.i_entries )
     {
         for( uint32_t i=1; i<16; i++ )
         {
@@ -3390,10 +3115,11 @@ static void TrackUpdateStarttimes( mp4_track_t *p_track )
             const mp4_chunk_t *ck = MP4_TrackChunkForSample( p_track, i_nextsample );
             if(!ck)
                 break;
+            MP4_TrackIndexChunks( p_track, ck - p_track->chunk );
             stime_t pts;
-            stime_t dts = pts = MP4_ChunkGetSampleDTS( ck, i_nextsample - ck->i_sample_first );
+            stime_t dts = pts = MP4_ChunkGetSampleDTS( p_track, ck, i_nextsample - ck->i_sample_first );
             stime_t delta = UNKNOWN_DELTA;
-            if( MP4_ChunkGetSampleCTSDelta( ck, i_nextsample - ck->i_sample_first, &delta ) )
+            if( MP4_ChunkGetSampleCTSDelta( p_track, ck, i_nextsample - ck->i_sample_first, &delta ) )
                 pts += delta;
             stime_t lowest = p_track->i_start_dts;
             if( p_track->i_start_delta != UNKNOWN_DELTA )
@@ -3409,11 +3135,12 @@ static void TrackUpdateStarttimes( mp4_track_t *p_track )
 
 static void TrackUpdateSampleAndTimes( mp4_track_t *p_track )
 {
+    MP4_TrackIndexChunks( p_track, p_track->i_chunk );
     const mp4_chunk_t *p_chunk = &p_track->chunk[p_track->i_chunk];
     uint32_t i_chunk_sample = p_track->i_sample - p_chunk->i_sample_first;
-    p_track->i_next_dts = MP4_ChunkGetSampleDTS( p_chunk, i_chunk_sample );
+    p_track->i_next_dts = MP4_ChunkGetSampleDTS( p_track, p_chunk, i_chunk_sample );
     stime_t i_next_delta;
-    if( !MP4_ChunkGetSampleCTSDelta( p_chunk, i_chunk_sample, &i_next_delta ) )
+    if( !MP4_ChunkGetSampleCTSDelta( p_track, p_chunk, i_chunk_sample, &i_next_delta ) )
         p_track->i_next_delta = UNKNOWN_DELTA;
     else
         p_track->i_next_delta = i_next_delta;
@@ -3706,16 +3433,8 @@ static void MP4_TrackClean( es_out_t *out, mp4_track_t *p_track )
     if( p_track->p_es )
         es_out_Del( out, p_track->p_es );
 
-    if( p_track->chunk )
-    {
-        for( unsigned int i_chunk = 0; i_chunk < p_track->i_chunk_count; i_chunk++ )
-            MP4_ChunkDestroy( &p_track->chunk[i_chunk] );
-    }
     free( p_track->chunk );
 
-    if( !p_track->i_sample_size )
-        free( p_track->p_sample_size );
-
     ASFPacketTrackReset( &p_track->asfinfo );
 
     free( p_track->context.runs.p_array );
@@ -4598,7 +4317,7 @@ static int FragDemuxTrack( demux_t *p_demux, mp4_track_t *p_track,
 
         len = OverflowCheck( p_demux, p_track, vlc_stream_Tell(p_demux->s), len );
 
-        block_t *p_block = vlc_stream_Block( p_demux->s, len );
+        block_t *p_block = vlc_stream_BlockMapped( p_demux->s, len );
         uint32_t i_read = ( p_block ) ? p_block->i_buffer : 0;
         p_track->context.i_trun_sample_pos += i_read;
         if( i_read < len || p_block == NULL )
@@ -30,6 +30,21 @@
 #include "fragments.h"
 #include "../asf/asfpacket.h"
 
+/* Runs of samples sharing the same value, as stored in stts and ctts */
+typedef struct
+{
+    const uint32_t *pi_count;
+    const int32_t  *pi_value;
+    uint32_t        i_entries;
+} mp4_tts_t;
+
+/* Position in a mp4_tts_t: run, and samples of that run before it */
+typedef struct
+{
+    uint32_t i_index;
+    uint32_t i_skip;
+} mp4_tts_pos_t;
+
 /* Contain all information about a chunk */
 typedef struct
 {
@@ -46,15 +61,10 @@ typedef struct
     uint64_t     i_first_dts;   /* DTS of the first sample */
     uint64_t     i_duration;    /* total duration of all samples */
 
-    uint32_t     i_entries_dts;
-    uint32_t     *p_sample_count_dts;
-    uint32_t     *p_sample_delta_dts;   /* dts delta */
-    uint32_t     small_dts_buf[4];
-
-    uint32_t     i_entries_pts;
-    uint32_t     *p_sample_count_pts;
-    uint32_t     *p_sample_offset_pts;  /* pts-dts */
-    uint32_t     small_pts_buf[4];
+    /* where the chunk samples start in the track stts and ctts runs,
+     * which are walked on demand instead of being copied per chunk */
+    mp4_tts_pos_t dts;
+    mp4_tts_pos_t pts;
 
     /* TODO if needed add pts
         but quickly *add* support for edts and seeking */
@@ -146,14 +156,25 @@ typedef struct
     /* sample size, p_sample_size defined only if i_sample_size == 0
         else i_sample_size is size for all sample */
     uint32_t         i_sample_size;
-    uint32_t         *p_sample_size; /* XXX perhaps add file offset if take
-//                                    too much time to do sumations each time*/
+    const uint32_t  *p_sample_size; /* stsz table, owned by the box */
+
+    /* sample -> dts delta and dts -> pts offset runs, owned by the boxes */
+    mp4_tts_t        stts;
+    mp4_tts_t        ctts;
+    int64_t          i_cts_shift;
 
     uint32_t     i_sample_first; /* i_sample_first value
                                                    of the next chunk */
     uint64_t     i_first_dts;    /* i_first_dts value
                                                    of the next chunk */
 
+    /* The chunks timing is indexed on demand, in order (see
+     * MP4_TrackIndexChunks): chunks below i_chunk_timed have theirs, and
+     * the next one starts at i_first_dts and at these runs positions */
+    uint32_t      i_chunk_timed;
+    mp4_tts_pos_t next_dts;
+    mp4_tts_pos_t next_pts;
+
     const MP4_Box_t *p_track;
     const MP4_Box_t *p_stbl;  /* will contain all timing information */
     const MP4_Box_t *p_stsd;  /* will contain all data to initialize decoder */
@@ -201,6 +222,27 @@ int SetupSpuES( demux_t *p_demux, const mp4_track_t *p_track,
                 const MP4_Box_t *p_sample, es_format_t *, track_config_t * );
 void SetupMeta( vlc_meta_t *p_meta, const MP4_Box_t *p_udta );
 
+typedef struct
+{
+    const mp4_tts_t *p_tts;
+    mp4_tts_pos_t    pos;
+    uint32_t         i_left; /* samples left to walk */
+} mp4_tts_iter_t;
+
+void MP4_TTSIterInit( mp4_tts_iter_t *, const mp4_tts_t *,
+                      const mp4_tts_pos_t *, uint32_t i_samples );
+/* Returns how many of the remaining samples are in the next run, and the
+ * run value, or 0 once all samples or the table are consumed */
+uint32_t MP4_TTSIterNext( mp4_tts_iter_t *, int32_t *pi_value );
+/* Indexes the timing of the chunks up to i_chunk included, if not yet */
+void MP4_TrackIndexChunks( mp4_track_t *, uint32_t i_chunk );
+/* dts of a sample of a chunk, i_sample counting from the chunk first one */
+stime_t MP4_ChunkGetSampleDTS( const mp4_track_t *, const mp4_chunk_t *,
+                               uint32_t i_sample );
+/* pts - dts of a sample of a chunk, false without ctts */
+bool MP4_ChunkGetSampleCTSDelta( const mp4_track_t *, const mp4_chunk_t *,
+                                 uint32_t i_sample, stime_t *pi_delta );
+
 /* format of RTP reception hint track sample constructor */
 typedef struct
 {
@@ -0,0 +1,120 @@
+/*****************************************************************************
+ * tts.c : MP4 stts and ctts runs walking
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "mp4.h"
+
+void MP4_TTSIterInit( mp4_tts_iter_t *it, const mp4_tts_t *p_tts,
+                      const mp4_tts_pos_t *p_pos, uint32_t i_samples )
+{
+    it->p_tts = p_tts;
+    it->pos = *p_pos;
+    it->i_left = i_samples;
+}
+
+uint32_t MP4_TTSIterNext( mp4_tts_iter_t *it, int32_t *pi_value )
+{
+    while( it->i_left > 0 && it->pos.i_index < it->p_tts->i_entries )
+    {
+        uint32_t i_count = it->p_tts->pi_count[it->pos.i_index] - it->pos.i_skip;
+        *pi_value = it->p_tts->pi_value[it->pos.i_index];
+        if( i_count > it->i_left )
+        {
+            i_count = it->i_left;
+            it->pos.i_skip += i_count;
+        }
+        else
+        {
+            it->pos.i_index++;
+            it->pos.i_skip = 0;
+        }
+        it->i_left -= i_count;
+        if( i_count > 0 )
+            return i_count;
+    }
+    return 0;
+}
+
+void MP4_TrackIndexChunks( mp4_track_t *p_track, uint32_t i_chunk )
+{
+    for( ; p_track->i_chunk_timed <= i_chunk &&
+           p_track->i_chunk_timed < p_track->i_chunk_count;
+         p_track->i_chunk_timed++ )
+    {
+        mp4_chunk_t *ck = &p_track->chunk[p_track->i_chunk_timed];
+        mp4_tts_iter_t it;
+        uint32_t i_count;
+        int32_t i_value;
+
+        ck->i_first_dts = p_track->i_first_dts;
+        ck->dts = p_track->next_dts;
+        ck->pts = p_track->next_pts;
+
+        MP4_TTSIterInit( &it, &p_track->stts, &ck->dts, ck->i_sample_count );
+        while( (i_count = MP4_TTSIterNext( &it, &i_value )) )
+            p_track->i_first_dts += (int64_t)i_count * i_value;
+        ck->i_duration = p_track->i_first_dts - ck->i_first_dts;
+        p_track->next_dts = it.pos;
+
+        MP4_TTSIterInit( &it, &p_track->ctts, &ck->pts, ck->i_sample_count );
+        while( MP4_TTSIterNext( &it, &i_value ) )
+            ;
+        p_track->next_pts = it.pos;
+    }
+}
+
+stime_t MP4_ChunkGetSampleDTS( const mp4_track_t *p_track,
+                               const mp4_chunk_t *p_chunk,
+                               uint32_t i_sample )
+{
+    mp4_tts_iter_t it;
+    uint32_t i_count;
+    int32_t i_delta;
+    stime_t sdts = p_chunk->i_first_dts;
+
+    MP4_TTSIterInit( &it, &p_track->stts, &p_chunk->dts, i_sample );
+    while( (i_count = MP4_TTSIterNext( &it, &i_delta )) )
+        sdts += (stime_t)i_count * (uint32_t)i_delta;
+    return sdts;
+}
+
+bool MP4_ChunkGetSampleCTSDelta( const mp4_track_t *p_track,
+                                 const mp4_chunk_t *p_chunk,
+                                 uint32_t i_sample, stime_t *pi_delta )
+{
+    mp4_tts_iter_t it;
+    uint32_t i_count;
+    int32_t i_offset;
+
+    MP4_TTSIterInit( &it, &p_track->ctts, &p_chunk->pts, p_chunk->i_sample_count );
+    while( (i_count = MP4_TTSIterNext( &it, &i_offset )) )
+    {
+        if( i_sample < i_count )
+        {
+            int64_t i_ctsdelta = i_offset + p_track->i_cts_shift;
+            *pi_delta = i_ctsdelta > 0 ? (uint32_t)i_ctsdelta : 0; /* should not be < 0 */
+            return true;
+        }
+        i_sample -= i_count;
+    }
+    return false;
+}
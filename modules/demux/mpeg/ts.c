@@ -51,6 +51,7 @@
 #include "timestamps.h"
 
 #include "ts.h"
+#include "ts_index.h"
 
 #include "../../codec/scte18.h"
 #include "../opus.h"
@@ -123,6 +124,18 @@ static void Close ( vlc_object_t * );
 #define TS_OFFSETFIX_TEXT   "Try to fix too early PCR (or late DTS)"
 #define TS_GENERATED_PCR_OFFSET_TEXT "Offset in ms for generated PCR"
 
+#define BULK_READ_TEXT N_("Packets read at once")
+#define BULK_READ_LONGTEXT N_( \
+    "Read the transport stream by chunks of up to this many packets, and " \
+    "dispatch the packets straight from the chunk. Payloads are only copied " \
+    "when they are gathered into PES. 0 reads the packets one by one." )
+
+#define SEEK_INDEX_TEXT N_("Seek index")
+#define SEEK_INDEX_LONGTEXT N_( \
+    "Remember where the PCRs and the program boundaries of large files are, " \
+    "and keep them in the cache directory, so that seeking and getting the " \
+    "duration of a file played before only take a single read." )
+
 #define PCR_TEXT N_("Trust in-stream PCR")
 #define PCR_LONGTEXT N_("Use the stream PCR as a reference.")
 
@@ -164,6 +177,9 @@ vlc_module_begin ()
     add_bool( "ts-pcr-offsetfix", true, TS_OFFSETFIX_TEXT, NULL )
     add_integer_with_range( "ts-generated-pcr-offset", 120, 0, 500,
                             TS_GENERATED_PCR_OFFSET_TEXT, NULL )
+    add_integer_with_range( "ts-bulk-read", 7 * 32, 0, 7 * 1024,
+                            BULK_READ_TEXT, BULK_READ_LONGTEXT )
+    add_bool( "ts-seek-index", true, SEEK_INDEX_TEXT, SEEK_INDEX_LONGTEXT )
 
     set_capability( "demux", 10 )
     set_callbacks( Open, Close )
@@ -187,6 +203,13 @@ static inline int PIDGet( block_t *p )
 {
     return ( (p->p_buffer[1]&0x1f)<<8 )|p->p_buffer[2];
 }
+/* Packets from the bulk reads already had their PID extracted */
+static inline int PacketPID( demux_sys_t *p_sys, block_t *p )
+{
+    if( p == &p_sys->bulk.packet )
+        return p_sys->bulk.i_pid;
+    return PIDGet( p );
+}
 static stime_t GetPCR( const block_t * );
 
 static block_t * ProcessTSPacket( demux_t *p_demux, ts_pid_t *pid, block_t *p_pkt, int * );
@@ -195,6 +218,10 @@ static bool GatherPESData( demux_t *p_demux, ts_pid_t *, block_t *, size_t );
 static void ProgramSetPCR( demux_t *p_demux, ts_pmt_t *p_prg, stime_t i_pcr );
 
 static block_t* ReadTSPacket( demux_t *p_demux );
+static block_t* DetachTSPacket( demux_sys_t *p_sys, block_t *p_pkt );
+static uint64_t TSTell( demux_sys_t *p_sys );
+static int TSSeek( demux_sys_t *p_sys, uint64_t i_pos );
+static void TSAlignForRecord( demux_t *p_demux );
 static int SeekToTime( demux_t *p_demux, const ts_pmt_t *, stime_t time );
 static void ReadyQueuesPostSeek( demux_t *p_demux );
 static void PCRHandle( demux_t *p_demux, ts_pid_t *, stime_t );
@@ -401,6 +428,31 @@ static int Open( vlc_object_t *p_this )
     p_sys->i_packet_header_size = i_packet_header_size;
     p_sys->i_ts_read = 50;
     p_sys->csa = NULL;
+
+    /* Bulk reads, by whole packets with their optional header */
+    p_sys->bulk.p_buffer = NULL;
+    p_sys->bulk.i_offset = p_sys->bulk.i_length = 0;
+    p_sys->bulk.b_resync = false;
+    p_sys->bulk.p_pids = NULL;
+    p_sys->bulk.i_scanned = 0;
+    p_sys->p_index = NULL;
+    size_t i_bulk = var_InheritInteger( p_demux, "ts-bulk-read" );
+    if( i_bulk > 0 )
+    {
+        /* One extra packet for the partial one carried over between reads */
+        p_sys->bulk.i_size = (i_bulk + 1) * i_packet_size;
+        p_sys->bulk.p_buffer = malloc( p_sys->bulk.i_size );
+        p_sys->bulk.p_pids = vlc_alloc( i_bulk + 1, sizeof(uint16_t) );
+        if( !p_sys->bulk.p_buffer || !p_sys->bulk.p_pids )
+        {
+            free( p_sys->bulk.p_pids );
+            free( p_sys->bulk.p_buffer );
+            free( p_sys );
+            return VLC_ENOMEM;
+        }
+        p_sys->bulk.pf_scan = ts_scan_GetPackets();
+    }
+
     p_sys->b_start_record = false;
 
     vlc_dictionary_init( &p_sys->attachments, 0 );
@@ -414,12 +466,16 @@ static int Open( vlc_object_t *p_this )
     patpid = GetPID(p_sys, 0);
     if ( !PIDSetup( p_demux, TYPE_PAT, patpid, NULL ) )
     {
+        free( p_sys->bulk.p_pids );
+        free( p_sys->bulk.p_buffer );
         free( p_sys );
         return VLC_ENOMEM;
     }
     if( !ts_psi_PAT_Attach( patpid, p_demux ) )
     {
         PIDRelease( p_demux, patpid );
+        free( p_sys->bulk.p_pids );
+        free( p_sys->bulk.p_buffer );
         free( p_sys );
         return VLC_EGENERIC;
     }
@@ -531,6 +587,19 @@ static int Open( vlc_object_t *p_this )
     vlc_stream_Control( p_sys->stream, STREAM_CAN_SEEK, &p_sys->b_canseek );
     vlc_stream_Control( p_sys->stream, STREAM_CAN_FASTSEEK,
                         &p_sys->b_canfastseek );
+    /* Packets are read in order, only seeks jump around */
+    vlc_stream_SetAccessHint( p_sys->stream, STREAM_ACCESS_SEQUENTIAL );
+
+    if( p_sys->b_canfastseek && var_InheritBool( p_demux, "ts-seek-index" ) )
+    {
+        const int64_t i_size = stream_Size( p_sys->stream );
+        const uint8_t *p_peek;
+        ssize_t i_peek = vlc_stream_Peek( p_sys->stream, &p_peek, 4096 );
+        if( i_size >= TS_INDEX_MIN_SIZE && i_peek > 0 )
+            p_sys->p_index = ts_index_New( VLC_OBJECT(p_demux),
+                                           p_demux->psz_url, i_size,
+                                           p_peek, i_peek );
+    }
 
     if( !p_sys->b_access_control && var_CreateGetBool( p_demux, "ts-pmtfix-waitdata" ) )
         p_sys->es_creation = DELAY_ES;
@@ -592,6 +661,11 @@ static void Close( vlc_object_t *p_this )
     /* Clear up attachments */
     vlc_dictionary_clear( &p_sys->attachments, FreeDictAttachment, NULL );
 
+    if( p_sys->p_index )
+        ts_index_Delete( VLC_OBJECT(p_demux), p_sys->p_index );
+
+    free( p_sys->bulk.p_pids );
+    free( p_sys->bulk.p_buffer );
     free( p_sys );
 }
 
@@ -640,19 +714,22 @@ static int Demux( demux_t *p_demux )
         bool         b_frame = false;
         int          i_header = 0;
         block_t     *p_pkt;
-        if( !(p_pkt = ReadTSPacket( p_demux )) )
-        {
-            return VLC_DEMUXER_EOF;
-        }
 
         if( p_sys->b_start_record )
         {
-            /* Enable recording once synchronized */
+            /* Enable recording on a packet boundary, as the stream may be
+             * read ahead of the packets being demuxed */
+            TSAlignForRecord( p_demux );
             vlc_stream_Control( p_sys->stream, STREAM_SET_RECORD_STATE, true,
                                 "ts" );
             p_sys->b_start_record = false;
         }
 
+        if( !(p_pkt = ReadTSPacket( p_demux )) )
+        {
+            return VLC_DEMUXER_EOF;
+        }
+
         /* Early reject truncated packets from hw devices */
         if( unlikely(p_pkt->i_buffer < TS_PACKET_SIZE_188) )
         {
@@ -664,13 +741,13 @@ static int Demux( demux_t *p_demux )
         if( p_pkt->p_buffer[1]&0x80 )
         {
             msg_Dbg( p_demux, "transport_error_indicator set (pid=%d)",
-                     PIDGet( p_pkt ) );
+                     PacketPID( p_sys, p_pkt ) );
             block_Release( p_pkt );
             continue;
         }
 
         /* Parse the TS packet */
-        ts_pid_t *p_pid = GetPID( p_sys, PIDGet( p_pkt ) );
+        ts_pid_t *p_pid = GetPID( p_sys, PacketPID( p_sys, p_pkt ) );
         if( !SEEN(p_pid) )
         {
             if( p_pid->type == TYPE_FREE )
@@ -733,7 +810,10 @@ static int Demux( demux_t *p_demux )
 
             if( p_pid->u.p_stream->transport == TS_TRANSPORT_PES )
             {
-                b_frame = GatherPESData( p_demux, p_pid, p_pkt, i_header );
+                /* The PES keeps the packet: take it out of the read buffer */
+                p_pkt = DetachTSPacket( p_sys, p_pkt );
+                if( p_pkt )
+                    b_frame = GatherPESData( p_demux, p_pid, p_pkt, i_header );
             }
             else if( p_pid->u.p_stream->transport == TS_TRANSPORT_SECTIONS )
             {
@@ -954,7 +1034,7 @@ static int Control( demux_t *p_demux, int i_query, va_list args )
 
         if( (i64 = stream_Size( p_sys->stream) ) > 0 )
         {
-            uint64_t offset = vlc_stream_Tell( p_sys->stream );
+            uint64_t offset = TSTell( p_sys );
             *pf = (double)offset / (double)i64;
             return VLC_SUCCESS;
         }
@@ -1001,7 +1081,7 @@ static int Control( demux_t *p_demux, int i_query, va_list args )
 
         i64 = stream_Size( p_sys->stream );
         if( i64 > 0 &&
-            vlc_stream_Seek( p_sys->stream, (int64_t)(i64 * f) ) == VLC_SUCCESS )
+            TSSeek( p_sys, (int64_t)(i64 * f) ) == VLC_SUCCESS )
         {
             ReadyQueuesPostSeek( p_demux );
             return VLC_SUCCESS;
@@ -1767,20 +1847,206 @@ static void PESDataChainHandle( vlc_object_t *p_obj, void *priv, block_t *p_data
     ParsePESDataChain( (demux_t *)p_obj, (ts_pid_t *) priv, p_data, i_appendpcr );
 }
 
+static void BulkTSPacketRelease( block_t *p_pkt )
+{
+    /* Points into the read buffer, which is reused for the next packets */
+    VLC_UNUSED(p_pkt);
+}
+
+static const struct vlc_block_callbacks bulk_ts_packet_cbs =
+{
+    BulkTSPacketRelease,
+};
+
+/* Position of the next packet, not counting what is already buffered */
+static uint64_t TSTell( demux_sys_t *p_sys )
+{
+    return vlc_stream_Tell( p_sys->stream )
+         - ( p_sys->bulk.i_length - p_sys->bulk.i_offset );
+}
+
+static int TSSeek( demux_sys_t *p_sys, uint64_t i_pos )
+{
+    p_sys->bulk.i_offset = p_sys->bulk.i_length = 0;
+    p_sys->bulk.i_scanned = 0;
+    return vlc_stream_Seek( p_sys->stream, i_pos );
+}
+
+/* Moves the stream back to the first buffered packet and empties the buffer,
+ * so that the next read from the stream starts on a packet boundary */
+static int TSUnbuffer( demux_sys_t *p_sys )
+{
+    if( p_sys->bulk.i_length == p_sys->bulk.i_offset )
+        return VLC_SUCCESS;
+
+    if( vlc_stream_Seek( p_sys->stream, TSTell( p_sys ) ) != VLC_SUCCESS )
+        return VLC_EGENERIC;
+    p_sys->bulk.i_offset = p_sys->bulk.i_length = 0;
+    p_sys->bulk.i_scanned = 0;
+    return VLC_SUCCESS;
+}
+
+/* Aligns the stream on a packet boundary before recording it. The buffered
+ * packets are kept for demuxing: must not be called while one is in use. */
+static void TSAlignForRecord( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    const size_t i_packet_size = p_sys->i_packet_size;
+
+    if( TSUnbuffer( p_sys ) == VLC_SUCCESS )
+        return;
+
+    /* Cannot rewind: read the rest of the last partial packet instead. The
+     * packets already buffered will be missing from the recording. */
+    size_t i_avail = p_sys->bulk.i_length - p_sys->bulk.i_offset;
+    size_t i_missing = ( i_packet_size - i_avail % i_packet_size )
+                     % i_packet_size;
+
+    msg_Warn( p_demux, "%zu buffered packets will not be recorded",
+              i_avail / i_packet_size );
+    if( i_missing == 0 )
+        return;
+
+    memmove( p_sys->bulk.p_buffer,
+             &p_sys->bulk.p_buffer[p_sys->bulk.i_offset], i_avail );
+    p_sys->bulk.i_offset = 0;
+    p_sys->bulk.i_length = i_avail;
+
+    ssize_t i_read = vlc_stream_Read( p_sys->stream,
+                                      &p_sys->bulk.p_buffer[i_avail],
+                                      i_missing );
+    if( i_read > 0 )
+        p_sys->bulk.i_length += i_read;
+}
+
+void TsUnbufferForFilter( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    const size_t i_packet_size = p_sys->i_packet_size;
+
+    if( TSUnbuffer( p_sys ) == VLC_SUCCESS )
+        return;
+
+    /* Cannot rewind: drop the buffered packets, as they did not go through
+     * the filter, and skip the rest of the last partial one */
+    size_t i_avail = p_sys->bulk.i_length - p_sys->bulk.i_offset;
+
+    msg_Warn( p_demux, "dropping %zu buffered packets",
+              i_avail / i_packet_size );
+    p_sys->bulk.i_offset = p_sys->bulk.i_length = 0;
+    p_sys->bulk.i_scanned = 0;
+    if( i_avail % i_packet_size )
+        vlc_stream_Read( p_sys->stream, NULL,
+                         i_packet_size - i_avail % i_packet_size );
+}
+
+/* Returns a packet which can be kept after the next ReadTSPacket() */
+static block_t* DetachTSPacket( demux_sys_t *p_sys, block_t *p_pkt )
+{
+    if( p_pkt != &p_sys->bulk.packet )
+        return p_pkt;
+    return block_Duplicate( p_pkt );
+}
+
+/* Reads the packets by chunks, and hands them out from the read buffer.
+ * The returned packet is only valid until the next call. */
+static block_t* ReadTSPacketBulk( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    const size_t i_packet_size = p_sys->i_packet_size;
+    const size_t i_header_size = p_sys->i_packet_header_size;
+
+    for( ;; )
+    {
+        uint8_t *p = &p_sys->bulk.p_buffer[p_sys->bulk.i_offset];
+        size_t i_avail = p_sys->bulk.i_length - p_sys->bulk.i_offset;
+
+        if( p_sys->bulk.i_scanned == 0 && i_avail >= i_packet_size )
+        {
+            /* Check all the buffered packets at once */
+            p_sys->bulk.i_scanned = p_sys->bulk.pf_scan( p + i_header_size,
+                                                         i_packet_size,
+                                                         i_avail / i_packet_size,
+                                                         p_sys->bulk.p_pids );
+            p_sys->bulk.i_scan_index = 0;
+        }
+
+        if( i_avail >= i_packet_size )
+        {
+            if( p_sys->bulk.i_scanned > 0 )
+            {
+                if( unlikely(p_sys->bulk.b_resync) )
+                {
+                    msg_Dbg( p_demux, "resynced at %" PRIu64, TSTell( p_sys ) );
+                    p_sys->bulk.b_resync = false;
+                }
+                p_sys->bulk.i_offset += i_packet_size;
+                p_sys->bulk.i_scanned--;
+                p_sys->bulk.i_pid = p_sys->bulk.p_pids[p_sys->bulk.i_scan_index++];
+
+                /* Skip header (BluRay streams), see ReadTSPacket() */
+                return block_Init( &p_sys->bulk.packet, &bulk_ts_packet_cbs,
+                                   p + i_header_size,
+                                   i_packet_size - i_header_size );
+            }
+
+            if( !p_sys->bulk.b_resync )
+            {
+                msg_Warn( p_demux, "lost synchro" );
+                p_sys->bulk.b_resync = true;
+            }
+
+            /* Look for two sync bytes a packet apart */
+            size_t i_skip = 1;
+            while( i_skip + i_header_size + i_packet_size < i_avail &&
+                   ( p[i_skip + i_header_size] != 0x47 ||
+                     p[i_skip + i_header_size + i_packet_size] != 0x47 ) )
+                i_skip++;
+
+            msg_Dbg( p_demux, "skipping %zu bytes of garbage at %"PRIu64,
+                     i_skip, TSTell( p_sys ) );
+            p_sys->bulk.i_offset += i_skip;
+            if( i_skip + i_header_size + i_packet_size < i_avail )
+                continue;
+            /* Not found yet: keep the tail and read more */
+            p += i_skip;
+            i_avail -= i_skip;
+        }
+
+        /* Move the partial packet to the front and fill the rest */
+        memmove( p_sys->bulk.p_buffer, p, i_avail );
+        p_sys->bulk.i_offset = 0;
+        p_sys->bulk.i_length = i_avail;
+
+        ssize_t i_read = vlc_stream_ReadPartial( p_sys->stream,
+                                                 &p_sys->bulk.p_buffer[i_avail],
+                                                 p_sys->bulk.i_size - i_avail );
+        if( i_read <= 0 )
+        {
+            msg_Dbg( p_demux, "EOF at %"PRIu64, TSTell( p_sys ) );
+            return NULL;
+        }
+        p_sys->bulk.i_length += i_read;
+    }
+}
+
 static block_t* ReadTSPacket( demux_t *p_demux )
 {
     demux_sys_t *p_sys = p_demux->p_sys;
 
     block_t     *p_pkt;
 
+    if( p_sys->bulk.p_buffer )
+        return ReadTSPacketBulk( p_demux );
+
     /* Get a new TS packet */
     if( !( p_pkt = vlc_stream_Block( p_sys->stream, p_sys->i_packet_size ) ) )
     {
         int64_t size = stream_Size( p_sys->stream );
-        if( size >= 0 && (uint64_t)size == vlc_stream_Tell( p_sys->stream ) )
-            msg_Dbg( p_demux, "EOF at %"PRIu64, vlc_stream_Tell( p_sys->stream ) );
+        if( size >= 0 && (uint64_t)size == TSTell( p_sys ) )
+            msg_Dbg( p_demux, "EOF at %"PRIu64, TSTell( p_sys ) );
         else
-            msg_Dbg( p_demux, "Can't read TS packet at %"PRIu64, vlc_stream_Tell(p_sys->stream) );
+            msg_Dbg( p_demux, "Can't read TS packet at %"PRIu64, TSTell( p_sys ) );
         return NULL;
     }
 
@@ -1826,7 +2092,7 @@ static block_t* ReadTSPacket( demux_t *p_demux )
                 i_skip++;
             }
             msg_Dbg( p_demux, "skipping %d bytes of garbage at %"PRIu64,
-                     i_skip, vlc_stream_Tell( p_sys->stream ) );
+                     i_skip, TSTell( p_sys ) );
             if (vlc_stream_Read( p_sys->stream, NULL, i_skip ) != i_skip)
                 return NULL;
 
@@ -1835,7 +2101,7 @@ static block_t* ReadTSPacket( demux_t *p_demux )
                 break;
             }
         }
-        msg_Dbg( p_demux, "resynced at %" PRIu64, vlc_stream_Tell( p_sys->stream ) );
+        msg_Dbg( p_demux, "resynced at %" PRIu64, TSTell( p_sys ) );
         if( !( p_pkt = vlc_stream_Block( p_sys->stream, p_sys->i_packet_size ) ) )
         {
             msg_Dbg( p_demux, "eof ?" );
@@ -1958,17 +2224,34 @@ static int SeekToTime( demux_t *p_demux, const ts_pmt_t *p_pmt, stime_t i_scaled
 
     /* Deal with common but worst binary search case */
     if( p_pmt->pcr.i_first == i_scaledtime && p_sys->b_canseek )
-        return vlc_stream_Seek( p_sys->stream, 0 );
+        return TSSeek( p_sys, 0 );
 
     const int64_t i_stream_size = stream_Size( p_sys->stream );
     if( !p_sys->b_canfastseek || i_stream_size < p_sys->i_packet_size )
         return VLC_EGENERIC;
 
-    const uint64_t i_initial_pos = vlc_stream_Tell( p_sys->stream );
+    const uint64_t i_initial_pos = TSTell( p_sys );
 
     /* Find the time position by using binary search algorithm. */
     uint64_t i_head_pos = 0;
     uint64_t i_tail_pos = (uint64_t) i_stream_size - p_sys->i_packet_size;
+
+    /* Start from the closest known PCRs, or go there straight */
+    if( p_sys->p_index )
+    {
+        const ts_index_entry_t *p_next;
+        const ts_index_entry_t *p_entry =
+                ts_index_Find( p_sys->p_index, p_pmt->i_number, i_scaledtime, &p_next );
+        if( p_entry )
+        {
+            if( i_scaledtime - p_entry->i_pcr < TO_SCALE(VLC_TICK_0 + VLC_TICK_FROM_MS(500)) )
+                return TSSeek( p_sys, p_entry->i_pos );
+            i_head_pos = p_entry->i_pos;
+        }
+        if( p_next && p_next->i_pos < i_tail_pos )
+            i_tail_pos = p_next->i_pos;
+    }
+
     if( i_head_pos >= i_tail_pos )
         return VLC_EGENERIC;
 
@@ -1980,7 +2263,7 @@ static int SeekToTime( demux_t *p_demux, const ts_pmt_t *p_pmt, stime_t i_scaled
         uint64_t i_div = i_splitpos % p_sys->i_packet_size;
         i_splitpos -= i_div;
 
-        if ( vlc_stream_Seek( p_sys->stream, i_splitpos ) != VLC_SUCCESS )
+        if ( TSSeek( p_sys, i_splitpos ) != VLC_SUCCESS )
             break;
 
         uint64_t i_pos = i_splitpos;
@@ -1994,9 +2277,9 @@ static int SeekToTime( demux_t *p_demux, const ts_pmt_t *p_pmt, stime_t i_scaled
                 break;
             }
             else
-                i_pos = vlc_stream_Tell( p_sys->stream );
+                i_pos = TSTell( p_sys );
 
-            int i_pid = PIDGet( p_pkt );
+            int i_pid = PacketPID( p_sys, p_pkt );
             ts_pid_t *p_pid = GetPID(p_sys, i_pid);
             if( i_pid != 0x1FFF && p_pid->type == TYPE_STREAM &&
                 ts_stream_Find_es( p_pid->u.p_stream, p_pmt ) &&
@@ -2015,6 +2298,11 @@ static int SeekToTime( demux_t *p_demux, const ts_pmt_t *p_pmt, stime_t i_scaled
                     }
                 }
 
+                if( i_pcr != -1 && p_sys->p_index )
+                    ts_index_Add( p_sys->p_index, p_pmt->i_number,
+                                  TimeStampWrapAround( p_pmt->pcr.i_first, i_pcr ),
+                                  TSTell( p_sys ) );
+
                 if( i_pcr == -1 )
                 {
                     stime_t i_dts = -1;
@@ -2051,7 +2339,7 @@ static int SeekToTime( demux_t *p_demux, const ts_pmt_t *p_pmt, stime_t i_scaled
     if( !b_found )
     {
         msg_Dbg( p_demux, "Seek():cannot find a time position." );
-        if( vlc_stream_Seek( p_sys->stream, i_initial_pos ) != VLC_SUCCESS )
+        if( TSSeek( p_sys, i_initial_pos ) != VLC_SUCCESS )
             msg_Err( p_demux, "Can't seek back to %" PRIu64, i_initial_pos );
         return VLC_EGENERIC;
     }
@@ -2080,7 +2368,7 @@ static int ProbeChunk( demux_t *p_demux, int i_program, bool b_end, bool *pb_fou
             continue;
         }
 
-        const int i_pid = PIDGet( p_pkt );
+        const int i_pid = PacketPID( p_sys, p_pkt );
         ts_pid_t *p_pid = GetPID(p_sys, i_pid);
 
         p_pid->i_flags |= FLAG_SEEN;
@@ -2137,7 +2425,7 @@ static int ProbeChunk( demux_t *p_demux, int i_program, bool b_end, bool *pb_fou
                         if( b_end )
                         {
                             p_pmt->i_last_dts = i_pcr;
-                            p_pmt->i_last_dts_byte = vlc_stream_Tell( p_sys->stream );
+                            p_pmt->i_last_dts_byte = TSTell( p_sys );
                         }
                         /* Start, only keep first */
                         else if( b_pcrresult && p_pmt->pcr.i_first == -1 )
@@ -2165,7 +2453,7 @@ static int ProbeChunk( demux_t *p_demux, int i_program, bool b_end, bool *pb_fou
 int ProbeStart( demux_t *p_demux, int i_program )
 {
     demux_sys_t *p_sys = p_demux->p_sys;
-    const uint64_t i_initial_pos = vlc_stream_Tell( p_sys->stream );
+    const uint64_t i_initial_pos = TSTell( p_sys );
     int64_t i_stream_size = stream_Size( p_sys->stream );
 
     int i_probe_count = 0;
@@ -2177,7 +2465,7 @@ int ProbeStart( demux_t *p_demux, int i_program )
         i_pos = (int64_t)p_sys->i_packet_size * i_probe_count;
         i_pos = __MIN( i_pos, i_stream_size );
 
-        if( vlc_stream_Seek( p_sys->stream, i_pos ) )
+        if( TSSeek( p_sys, i_pos ) )
             return VLC_EGENERIC;
 
         int i_count =  ProbeChunk( p_demux, i_program, false, &b_found );
@@ -2189,7 +2477,7 @@ int ProbeStart( demux_t *p_demux, int i_program )
     } while( i_pos < i_stream_size && !b_found &&
              i_probe_count < PROBE_MAX );
 
-    if( vlc_stream_Seek( p_sys->stream, i_initial_pos ) )
+    if( TSSeek( p_sys, i_initial_pos ) )
         return VLC_EGENERIC;
 
     return (b_found) ? VLC_SUCCESS : VLC_EGENERIC;
@@ -2198,7 +2486,7 @@ int ProbeStart( demux_t *p_demux, int i_program )
 int ProbeEnd( demux_t *p_demux, int i_program )
 {
     demux_sys_t *p_sys = p_demux->p_sys;
-    const uint64_t i_initial_pos = vlc_stream_Tell( p_sys->stream );
+    const uint64_t i_initial_pos = TSTell( p_sys );
     int64_t i_stream_size = stream_Size( p_sys->stream );
 
     int i_probe_count = PROBE_CHUNK_COUNT;
@@ -2210,7 +2498,7 @@ int ProbeEnd( demux_t *p_demux, int i_program )
         i_pos = i_stream_size - (p_sys->i_packet_size * i_probe_count);
         i_pos = __MAX( i_pos, 0 );
 
-        if( vlc_stream_Seek( p_sys->stream, i_pos ) )
+        if( TSSeek( p_sys, i_pos ) )
             return VLC_EGENERIC;
 
         int i_count = ProbeChunk( p_demux, i_program, true, &b_found );
@@ -2222,7 +2510,7 @@ int ProbeEnd( demux_t *p_demux, int i_program )
     } while( i_pos > 0 && !b_found &&
              i_probe_count < PROBE_MAX );
 
-    if( vlc_stream_Seek( p_sys->stream, i_initial_pos ) )
+    if( TSSeek( p_sys, i_initial_pos ) )
         return VLC_EGENERIC;
 
     return (b_found) ? VLC_SUCCESS : VLC_EGENERIC;
@@ -2232,6 +2520,11 @@ static void ProgramSetPCR( demux_t *p_demux, ts_pmt_t *p_pmt, stime_t i_pcr )
 {
     demux_sys_t *p_sys = p_demux->p_sys;
 
+    /* The PCR packet was just read, unless it is generated from the DTS
+     * of a PES whose packets were read before */
+    if( p_sys->p_index && !p_pmt->pcr.b_disable )
+        ts_index_Add( p_sys->p_index, p_pmt->i_number, i_pcr, TSTell( p_sys ) );
+
     /* Check if we have enqueued blocks waiting the/before the
        PCR barrier, and then adapt pcr so they have valid PCR when dequeuing */
     if( p_pmt->pcr.i_current == -1 && p_pmt->pcr.b_fix_done )
@@ -2277,14 +2570,14 @@ static void ProgramSetPCR( demux_t *p_demux, ts_pmt_t *p_pmt, stime_t i_pcr )
         es_out_Control( p_demux->out, ES_OUT_SET_GROUP_PCR, p_pmt->i_number, FROM_SCALE(i_pcr) );
         /* growing files/named fifo handling */
         if( p_sys->b_access_control == false &&
-            vlc_stream_Tell( p_sys->stream ) > p_pmt->i_last_dts_byte )
+            TSTell( p_sys ) > p_pmt->i_last_dts_byte )
         {
             if( p_pmt->i_last_dts_byte == 0 ) /* first run */
                 p_pmt->i_last_dts_byte = stream_Size( p_sys->stream );
             else
             {
                 p_pmt->i_last_dts = i_pcr;
-                p_pmt->i_last_dts_byte = vlc_stream_Tell( p_sys->stream );
+                p_pmt->i_last_dts_byte = TSTell( p_sys );
             }
         }
     }
@@ -20,10 +20,13 @@
 #ifndef VLC_TS_H
 #define VLC_TS_H
 
+#include "ts_scan.h"
+
 #ifdef HAVE_ARIBB24
     typedef struct arib_instance_t arib_instance_t;
 #endif
 typedef struct csa_t csa_t;
+typedef struct ts_index_t ts_index_t;
 
 #define TS_USER_PMT_NUMBER (0)
 
@@ -71,6 +74,27 @@ struct demux_sys_t
     /* how many TS packet we read at once */
     unsigned    i_ts_read;
 
+    /* Bulk ingest: chunks of packets are read at once, and the packets are
+     * handed out as blocks pointing into the read buffer */
+    struct
+    {
+        uint8_t *p_buffer;
+        size_t   i_size;    /* capacity */
+        size_t   i_offset;  /* next packet */
+        size_t   i_length;  /* end of the read data */
+        bool     b_resync;
+        block_t  packet;    /* last packet handed out */
+        /* Packets from i_offset already checked by the scanner */
+        ts_scan_packets_fn pf_scan;
+        uint16_t *p_pids;
+        size_t   i_scanned;
+        size_t   i_scan_index;
+        uint16_t i_pid;     /* PID of the last packet handed out */
+    } bulk;
+
+    /* PCR positions and program boundaries, kept across sessions */
+    ts_index_t *p_index;
+
     bool        b_cc_check;
     bool        b_ignore_time_for_positions;
 
@@ -146,6 +170,10 @@ struct demux_sys_t
 
 void TsChangeStandard( demux_sys_t *, ts_standards_e );
 
+/* Moves the stream back to the first packet not demuxed yet, before it is
+ * wrapped by a filter. Packets which cannot be read again are dropped. */
+void TsUnbufferForFilter( demux_t *p_demux );
+
 bool ProgramIsSelected( demux_sys_t *, uint16_t i_pgrm );
 
 void UpdatePESFilters( demux_t *p_demux, bool b_all );
@@ -0,0 +1,526 @@
+/*****************************************************************************
+ * ts_index.c: Transport Stream seek index
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <time.h>
+#include <sys/stat.h>
+
+#include <vlc_common.h>
+#include <vlc_configuration.h>
+#include <vlc_fs.h>
+#include <vlc_hash.h>
+#include <vlc_strings.h>
+
+#include "timestamps.h"
+#include "ts_index.h"
+
+/*
+ * The index keeps, for each program, the PCRs met during playback and
+ * seeks with the position of their packet, sorted by position. Entries are
+ * kept at least INDEX_SPACING apart, which is below the precision of
+ * SeekToTime(), so that once a file has been played through any seek is
+ * resolved with a single read.
+ *
+ * It is saved in the cache directory, under a name derived from the URL,
+ * the size and the first bytes of the file:
+ *
+ *   "VLCTSIX1", size (8), programs (4)
+ *   per program: number (4), has bounds (1), first, first dts,
+ *                last dts, last dts byte (8 each), entries (4),
+ *                per entry: pcr, position (8 each)
+ *
+ * All integers are little-endian.
+ *
+ * The cache directory is pruned whenever an index is saved: indexes not
+ * saved for TS_INDEX_CACHE_MAX_AGE are removed, then the oldest ones beyond
+ * TS_INDEX_CACHE_MAX_FILES. Changed files get a new name, so their stale
+ * index ages out the same way.
+ */
+#define INDEX_SPACING TO_SCALE_NZ(VLC_TICK_FROM_MS(400))
+#define INDEX_MAGIC "VLCTSIX1"
+#define INDEX_PEEK  4096
+/* 24 hours of entries, to bound what is read back from the cache */
+#define INDEX_MAX_ENTRIES (24 * 3600 * 5 / 2)
+
+typedef struct
+{
+    int i_number;
+    bool b_bounds;
+    ts_index_bounds_t bounds;
+    ts_index_entry_t *p_entries;
+    size_t i_entries;
+    size_t i_alloc;
+} ts_index_program_t;
+
+struct ts_index_t
+{
+    char *psz_path;
+    uint64_t i_size;
+    bool b_dirty;
+    DECL_ARRAY(ts_index_program_t) programs;
+};
+
+static ts_index_program_t * GetProgram( const ts_index_t *p_index,
+                                        int i_program )
+{
+    for( int i = 0; i < p_index->programs.i_size; i++ )
+        if( p_index->programs.p_elems[i].i_number == i_program )
+            return &p_index->programs.p_elems[i];
+    return NULL;
+}
+
+static ts_index_program_t * AddProgram( ts_index_t *p_index, int i_program )
+{
+    ts_index_program_t *p_prg = GetProgram( p_index, i_program );
+    if( p_prg )
+        return p_prg;
+
+    const ts_index_program_t prg = { .i_number = i_program };
+    ARRAY_APPEND( p_index->programs, prg );
+    return &ARRAY_VAL( p_index->programs, p_index->programs.i_size - 1 );
+}
+
+static bool AddEntry( ts_index_program_t *p_prg, size_t i_at,
+                      const ts_index_entry_t *p_entry )
+{
+    if( p_prg->i_entries == p_prg->i_alloc )
+    {
+        size_t i_alloc = p_prg->i_alloc ? p_prg->i_alloc * 2 : 256;
+        ts_index_entry_t *p_entries = vlc_reallocarray( p_prg->p_entries,
+                                                        i_alloc,
+                                                        sizeof(*p_entries) );
+        if( !p_entries )
+            return false;
+        p_prg->p_entries = p_entries;
+        p_prg->i_alloc = i_alloc;
+    }
+
+    memmove( &p_prg->p_entries[i_at + 1], &p_prg->p_entries[i_at],
+             (p_prg->i_entries - i_at) * sizeof(*p_prg->p_entries) );
+    p_prg->p_entries[i_at] = *p_entry;
+    p_prg->i_entries++;
+    return true;
+}
+
+/*****************************************************************************
+ * Cache file
+ *****************************************************************************/
+static char * GetCachePath( const char *psz_url, uint64_t i_size,
+                            const uint8_t *p_peek, size_t i_peek )
+{
+    char *psz_cachedir = config_GetUserDir( VLC_CACHE_DIR );
+    if( !psz_cachedir )
+        return NULL;
+
+    uint8_t size[8];
+    SetQWLE( size, i_size );
+
+    char psz_hash[VLC_HASH_MD5_DIGEST_HEX_SIZE];
+    vlc_hash_md5_t md5;
+    vlc_hash_md5_Init( &md5 );
+    vlc_hash_md5_Update( &md5, psz_url, strlen( psz_url ) );
+    vlc_hash_md5_Update( &md5, size, sizeof(size) );
+    vlc_hash_md5_Update( &md5, p_peek, __MIN(i_peek, INDEX_PEEK) );
+    vlc_hash_FinishHex( &md5, psz_hash );
+
+    char *psz_path;
+    if( asprintf( &psz_path, "%s" DIR_SEP "ts-index" DIR_SEP "%s",
+                  psz_cachedir, psz_hash ) == -1 )
+        psz_path = NULL;
+    free( psz_cachedir );
+    return psz_path;
+}
+
+typedef struct
+{
+    char *psz_path;
+    time_t i_mtime;
+} cache_file_t;
+
+static int CompareMTime( const void *a, const void *b )
+{
+    const cache_file_t *p_a = a, *p_b = b;
+    return (p_a->i_mtime > p_b->i_mtime) - (p_a->i_mtime < p_b->i_mtime);
+}
+
+static void PruneCache( vlc_object_t *p_obj, const char *psz_dir )
+{
+    DIR *p_dir = vlc_opendir( psz_dir );
+    if( !p_dir )
+        return;
+
+    DECL_ARRAY(cache_file_t) files;
+    ARRAY_INIT( files );
+    const time_t i_now = time( NULL );
+    unsigned i_pruned = 0;
+    const char *psz_name;
+
+    while( (psz_name = vlc_readdir( p_dir )) != NULL )
+    {
+        cache_file_t file;
+        struct stat st;
+
+        if( psz_name[0] == '.' ||
+            asprintf( &file.psz_path, "%s" DIR_SEP "%s",
+                      psz_dir, psz_name ) == -1 )
+            continue;
+
+        if( vlc_stat( file.psz_path, &st ) || !S_ISREG( st.st_mode ) )
+        {
+            free( file.psz_path );
+            continue;
+        }
+
+        if( i_now - st.st_mtime > TS_INDEX_CACHE_MAX_AGE )
+        {
+            if( !vlc_unlink( file.psz_path ) )
+                i_pruned++;
+            free( file.psz_path );
+            continue;
+        }
+
+        file.i_mtime = st.st_mtime;
+        ARRAY_APPEND( files, file );
+    }
+    closedir( p_dir );
+
+    if( files.i_size > TS_INDEX_CACHE_MAX_FILES )
+    {
+        qsort( files.p_elems, files.i_size, sizeof(*files.p_elems),
+               CompareMTime );
+        for( int i = 0; i < files.i_size - TS_INDEX_CACHE_MAX_FILES; i++ )
+            if( !vlc_unlink( files.p_elems[i].psz_path ) )
+                i_pruned++;
+    }
+
+    if( i_pruned )
+        msg_Dbg( p_obj, "pruned %u seek indexes", i_pruned );
+
+    for( int i = 0; i < files.i_size; i++ )
+        free( files.p_elems[i].psz_path );
+    ARRAY_RESET( files );
+}
+
+static bool Read( FILE *p_file, void *p_buf, size_t i_size )
+{
+    return fread( p_buf, 1, i_size, p_file ) == i_size;
+}
+
+static bool ReadU32( FILE *p_file, uint32_t *pi )
+{
+    uint8_t buf[4];
+    if( !Read( p_file, buf, 4 ) )
+        return false;
+    *pi = GetDWLE( buf );
+    return true;
+}
+
+static bool ReadU64( FILE *p_file, uint64_t *pi )
+{
+    uint8_t buf[8];
+    if( !Read( p_file, buf, 8 ) )
+        return false;
+    *pi = GetQWLE( buf );
+    return true;
+}
+
+static bool ReadS64( FILE *p_file, int64_t *pi )
+{
+    uint64_t i;
+    if( !ReadU64( p_file, &i ) )
+        return false;
+    *pi = (int64_t) i;
+    return true;
+}
+
+static bool Load( ts_index_t *p_index, FILE *p_file )
+{
+    char magic[8];
+    uint64_t i_size;
+    uint32_t i_programs;
+
+    if( !Read( p_file, magic, 8 ) || memcmp( magic, INDEX_MAGIC, 8 ) ||
+        !ReadU64( p_file, &i_size ) || i_size != p_index->i_size ||
+        !ReadU32( p_file, &i_programs ) || i_programs > UINT16_MAX )
+        return false;
+
+    for( uint32_t i = 0; i < i_programs; i++ )
+    {
+        uint32_t i_number, i_entries;
+        uint8_t b_bounds;
+        ts_index_bounds_t bounds;
+
+        if( !ReadU32( p_file, &i_number ) || !Read( p_file, &b_bounds, 1 ) ||
+            !ReadS64( p_file, &bounds.i_first ) ||
+            !ReadS64( p_file, &bounds.i_first_dts ) ||
+            !ReadS64( p_file, &bounds.i_last_dts ) ||
+            !ReadU64( p_file, &bounds.i_last_dts_byte ) ||
+            !ReadU32( p_file, &i_entries ) || i_entries > INDEX_MAX_ENTRIES )
+            return false;
+
+        ts_index_program_t *p_prg = AddProgram( p_index, i_number );
+        if( b_bounds )
+        {
+            p_prg->b_bounds = true;
+            p_prg->bounds = bounds;
+        }
+
+        for( uint32_t j = 0; j < i_entries; j++ )
+        {
+            ts_index_entry_t entry;
+            if( !ReadS64( p_file, &entry.i_pcr ) ||
+                !ReadU64( p_file, &entry.i_pos ) )
+                return false;
+
+            /* Only keep a consistent index */
+            if( p_prg->i_entries > 0 )
+            {
+                const ts_index_entry_t *p_last =
+                        &p_prg->p_entries[p_prg->i_entries - 1];
+                if( entry.i_pos <= p_last->i_pos ||
+                    entry.i_pcr <= p_last->i_pcr )
+                    return false;
+            }
+            if( entry.i_pos > i_size ||
+                !AddEntry( p_prg, p_prg->i_entries, &entry ) )
+                return false;
+        }
+    }
+    return true;
+}
+
+static void Write( FILE *p_file, const void *p_buf, size_t i_size,
+                   bool *pb_error )
+{
+    if( fwrite( p_buf, 1, i_size, p_file ) != i_size )
+        *pb_error = true;
+}
+
+static void WriteU32( FILE *p_file, uint32_t i, bool *pb_error )
+{
+    uint8_t buf[4];
+    SetDWLE( buf, i );
+    Write( p_file, buf, 4, pb_error );
+}
+
+static void WriteU64( FILE *p_file, uint64_t i, bool *pb_error )
+{
+    uint8_t buf[8];
+    SetQWLE( buf, i );
+    Write( p_file, buf, 8, pb_error );
+}
+
+static bool Save( const ts_index_t *p_index, FILE *p_file )
+{
+    bool b_error = false;
+
+    Write( p_file, INDEX_MAGIC, 8, &b_error );
+    WriteU64( p_file, p_index->i_size, &b_error );
+    WriteU32( p_file, p_index->programs.i_size, &b_error );
+
+    for( int i = 0; i < p_index->programs.i_size; i++ )
+    {
+        const ts_index_program_t *p_prg = &p_index->programs.p_elems[i];
+        const uint8_t b_bounds = p_prg->b_bounds;
+
+        WriteU32( p_file, p_prg->i_number, &b_error );
+        Write( p_file, &b_bounds, 1, &b_error );
+        WriteU64( p_file, p_prg->bounds.i_first, &b_error );
+        WriteU64( p_file, p_prg->bounds.i_first_dts, &b_error );
+        WriteU64( p_file, p_prg->bounds.i_last_dts, &b_error );
+        WriteU64( p_file, p_prg->bounds.i_last_dts_byte, &b_error );
+        WriteU32( p_file, p_prg->i_entries, &b_error );
+        for( size_t j = 0; j < p_prg->i_entries; j++ )
+        {
+            WriteU64( p_file, p_prg->p_entries[j].i_pcr, &b_error );
+            WriteU64( p_file, p_prg->p_entries[j].i_pos, &b_error );
+        }
+    }
+    return !b_error;
+}
+
+/*****************************************************************************
+ * Index
+ *****************************************************************************/
+ts_index_t * ts_index_New( vlc_object_t *p_obj, const char *psz_url,
+                           uint64_t i_size, const uint8_t *p_peek,
+                           size_t i_peek )
+{
+    ts_index_t *p_index = malloc( sizeof(*p_index) );
+    if( !p_index )
+        return NULL;
+
+    p_index->psz_path = psz_url ? GetCachePath( psz_url, i_size,
+                                                p_peek, i_peek ) : NULL;
+    p_index->i_size = i_size;
+    p_index->b_dirty = false;
+    ARRAY_INIT( p_index->programs );
+
+    FILE *p_file = p_index->psz_path ? vlc_fopen( p_index->psz_path, "rb" )
+                                     : NULL;
+    if( p_file )
+    {
+        if( Load( p_index, p_file ) )
+            msg_Dbg( p_obj, "loaded seek index %s", p_index->psz_path );
+        else
+        {
+            msg_Warn( p_obj, "ignoring invalid seek index %s",
+                      p_index->psz_path );
+            for( int i = 0; i < p_index->programs.i_size; i++ )
+                free( p_index->programs.p_elems[i].p_entries );
+            ARRAY_RESET( p_index->programs );
+        }
+        fclose( p_file );
+    }
+
+    return p_index;
+}
+
+void ts_index_Delete( vlc_object_t *p_obj, ts_index_t *p_index )
+{
+    if( p_index->b_dirty && p_index->psz_path )
+    {
+        /* Write a temporary file first, to never leave a truncated one */
+        char *psz_tmp;
+        char *psz_dir = strdup( p_index->psz_path );
+        if( psz_dir )
+        {
+            *strrchr( psz_dir, DIR_SEP_CHAR ) = '\0';
+            char *psz_cachedir = strdup( psz_dir );
+            if( psz_cachedir )
+            {
+                *strrchr( psz_cachedir, DIR_SEP_CHAR ) = '\0';
+                vlc_mkdir( psz_cachedir, 0700 );
+                free( psz_cachedir );
+            }
+            vlc_mkdir( psz_dir, 0700 );
+        }
+
+        if( asprintf( &psz_tmp, "%s.tmp", p_index->psz_path ) != -1 )
+        {
+            FILE *p_file = vlc_fopen( psz_tmp, "wb" );
+            if( p_file )
+            {
+                bool b_saved = Save( p_index, p_file );
+                if( fclose( p_file ) )
+                    b_saved = false;
+                if( b_saved && !vlc_rename( psz_tmp, p_index->psz_path ) )
+                {
+                    msg_Dbg( p_obj, "saved seek index %s",
+                             p_index->psz_path );
+                    if( psz_dir )
+                        PruneCache( p_obj, psz_dir );
+                }
+                else
+                    vlc_unlink( psz_tmp );
+            }
+            free( psz_tmp );
+        }
+        free( psz_dir );
+    }
+
+    for( int i = 0; i < p_index->programs.i_size; i++ )
+        free( p_index->programs.p_elems[i].p_entries );
+    ARRAY_RESET( p_index->programs );
+    free( p_index->psz_path );
+    free( p_index );
+}
+
+void ts_index_Add( ts_index_t *p_index, int i_program, stime_t i_pcr,
+                   uint64_t i_pos )
+{
+    ts_index_program_t *p_prg = AddProgram( p_index, i_program );
+    if( p_prg->i_entries >= INDEX_MAX_ENTRIES )
+        return;
+
+    /* First entry after i_pos */
+    size_t i_lo = 0, i_hi = p_prg->i_entries;
+    while( i_lo < i_hi )
+    {
+        size_t i_mid = i_lo + (i_hi - i_lo) / 2;
+        if( p_prg->p_entries[i_mid].i_pos <= i_pos )
+            i_lo = i_mid + 1;
+        else
+            i_hi = i_mid;
+    }
+
+    /* Keep the entries spaced, and drop what does not fit in the
+     * timeline (discontinuities, or PCR going back) */
+    if( i_lo > 0 )
+    {
+        const ts_index_entry_t *p_prev = &p_prg->p_entries[i_lo - 1];
+        if( p_prev->i_pos == i_pos || i_pcr - p_prev->i_pcr < INDEX_SPACING )
+            return;
+    }
+    if( i_lo < p_prg->i_entries &&
+        p_prg->p_entries[i_lo].i_pcr - i_pcr < INDEX_SPACING )
+        return;
+
+    const ts_index_entry_t entry = { .i_pcr = i_pcr, .i_pos = i_pos };
+    if( AddEntry( p_prg, i_lo, &entry ) )
+        p_index->b_dirty = true;
+}
+
+const ts_index_entry_t * ts_index_Find( const ts_index_t *p_index,
+                                        int i_program, stime_t i_pcr,
+                                        const ts_index_entry_t **pp_next )
+{
+    const ts_index_program_t *p_prg = GetProgram( p_index, i_program );
+    *pp_next = NULL;
+    if( !p_prg || p_prg->i_entries == 0 )
+        return NULL;
+
+    /* First entry after i_pcr */
+    size_t i_lo = 0, i_hi = p_prg->i_entries;
+    while( i_lo < i_hi )
+    {
+        size_t i_mid = i_lo + (i_hi - i_lo) / 2;
+        if( p_prg->p_entries[i_mid].i_pcr <= i_pcr )
+            i_lo = i_mid + 1;
+        else
+            i_hi = i_mid;
+    }
+
+    if( i_lo < p_prg->i_entries )
+        *pp_next = &p_prg->p_entries[i_lo];
+    return i_lo > 0 ? &p_prg->p_entries[i_lo - 1] : NULL;
+}
+
+void ts_index_SetBounds( ts_index_t *p_index, int i_program,
+                         const ts_index_bounds_t *p_bounds )
+{
+    ts_index_program_t *p_prg = AddProgram( p_index, i_program );
+    p_prg->b_bounds = true;
+    p_prg->bounds = *p_bounds;
+    p_index->b_dirty = true;
+}
+
+bool ts_index_GetBounds( const ts_index_t *p_index, int i_program,
+                         ts_index_bounds_t *p_bounds )
+{
+    const ts_index_program_t *p_prg = GetProgram( p_index, i_program );
+    if( !p_prg || !p_prg->b_bounds )
+        return false;
+    *p_bounds = p_prg->bounds;
+    return true;
+}
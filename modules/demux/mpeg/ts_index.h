@@ -0,0 +1,78 @@
+/*****************************************************************************
+ * ts_index.h: Transport Stream seek index
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifndef VLC_TS_INDEX_H
+#define VLC_TS_INDEX_H
+
+/* Files smaller than this are probed quickly enough without an index */
+#define TS_INDEX_MIN_SIZE (INT64_C(64) << 20)
+
+/* Bounds of the cache directory: number of indexes, and seconds an index
+ * is kept after it was last saved */
+#define TS_INDEX_CACHE_MAX_FILES 128
+#define TS_INDEX_CACHE_MAX_AGE   (90 * 24 * 3600)
+
+typedef struct ts_index_t ts_index_t;
+
+typedef struct
+{
+    stime_t  i_pcr; /* wrapped around the first PCR of the program */
+    uint64_t i_pos; /* position right after the packet carrying it */
+} ts_index_entry_t;
+
+/* Boundaries of a program, as found by ProbeStart() and ProbeEnd() */
+typedef struct
+{
+    stime_t  i_first;
+    stime_t  i_first_dts;
+    stime_t  i_last_dts;
+    uint64_t i_last_dts_byte;
+} ts_index_bounds_t;
+
+/**
+ * Creates an index for a file, loading it from the cache directory if it
+ * was saved for the same file before.
+ *
+ * @param p_peek first bytes of the file, part of its identity
+ */
+ts_index_t * ts_index_New( vlc_object_t *, const char *psz_url,
+                           uint64_t i_size, const uint8_t *p_peek,
+                           size_t i_peek );
+/** Saves the index to the cache directory if it changed, and frees it */
+void ts_index_Delete( vlc_object_t *, ts_index_t * );
+
+/** Records that a PCR of a program ends at i_pos */
+void ts_index_Add( ts_index_t *, int i_program, stime_t i_pcr, uint64_t i_pos );
+
+/**
+ * Finds the last indexed PCR of a program at or before i_pcr.
+ *
+ * @param pp_next set to the following entry, or NULL
+ * @return the entry, or NULL if every indexed PCR is after i_pcr
+ */
+const ts_index_entry_t * ts_index_Find( const ts_index_t *, int i_program,
+                                        stime_t i_pcr,
+                                        const ts_index_entry_t **pp_next );
+
+void ts_index_SetBounds( ts_index_t *, int i_program,
+                         const ts_index_bounds_t * );
+bool ts_index_GetBounds( const ts_index_t *, int i_program,
+                         ts_index_bounds_t * );
+
+#endif
@@ -43,6 +43,7 @@
 #include "ts_strings.h"
 
 #include "timestamps.h"
+#include "ts_index.h"
 
 #include "../../codec/jpeg2000.h"
 #include "../../codec/opus_header.h"
@@ -2082,6 +2083,8 @@ static void PMTCallBack( void *data, dvbpsi_pmt_t *p_dvbpsipmt )
                 en50221_capmt_Delete( p_en );
                 if ( p_sys->standard == TS_STANDARD_ARIB && p_sys->stream == p_demux->s )
                 {
+                    /* The packets read ahead must be descrambled too */
+                    TsUnbufferForFilter( p_demux );
                     stream_t *wrapper = ts_stream_wrapper_New( p_demux->s );
                     if( wrapper )
                     {
@@ -2191,9 +2194,33 @@ static void PMTCallBack( void *data, dvbpsi_pmt_t *p_dvbpsipmt )
     /* Probe Boundaries */
     if( p_sys->b_canfastseek && p_pmt->i_last_dts == TS_TICK_UNKNOWN )
     {
-        p_pmt->i_last_dts = 0;
-        ProbeStart( p_demux, p_pmt->i_number );
-        ProbeEnd( p_demux, p_pmt->i_number );
+        ts_index_bounds_t bounds;
+        if( p_sys->p_index &&
+            ts_index_GetBounds( p_sys->p_index, p_pmt->i_number, &bounds ) )
+        {
+            /* Same as probed last time */
+            if( p_pmt->pcr.i_first == -1 )
+                p_pmt->pcr.i_first = bounds.i_first;
+            if( p_pmt->pcr.i_first_dts == -1 )
+                p_pmt->pcr.i_first_dts = bounds.i_first_dts;
+            p_pmt->i_last_dts = bounds.i_last_dts;
+            p_pmt->i_last_dts_byte = bounds.i_last_dts_byte;
+        }
+        else
+        {
+            p_pmt->i_last_dts = 0;
+            ProbeStart( p_demux, p_pmt->i_number );
+            ProbeEnd( p_demux, p_pmt->i_number );
+
+            if( p_sys->p_index )
+            {
+                bounds.i_first = p_pmt->pcr.i_first;
+                bounds.i_first_dts = p_pmt->pcr.i_first_dts;
+                bounds.i_last_dts = p_pmt->i_last_dts;
+                bounds.i_last_dts_byte = p_pmt->i_last_dts_byte;
+                ts_index_SetBounds( p_sys->p_index, p_pmt->i_number, &bounds );
+            }
+        }
     }
 
     dvbpsi_pmt_delete( p_dvbpsipmt );
@@ -0,0 +1,172 @@
+/*****************************************************************************
+ * ts_scan.c: Batch TS packet header scanner
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc_common.h>
+#include <vlc_cpu.h>
+
+#include "ts_scan.h"
+
+/*
+ * The 4 header bytes of a packet are handled as one little-endian word:
+ * the sync byte is in bits 0-7, and the PID is the low 5 bits of the second
+ * byte (bits 8-12) followed by the third byte (bits 16-23).
+ */
+#define SYNC_MASK 0xff
+#define PID_HI_MASK 0x1f00
+
+static inline uint16_t HeaderPID( uint32_t w )
+{
+    return (w & PID_HI_MASK) | ((w >> 16) & 0xff);
+}
+
+size_t ts_scan_packets_c( const uint8_t *p, size_t i_stride,
+                          size_t i_count, uint16_t *pi_pid )
+{
+    for( size_t i = 0; i < i_count; i++, p += i_stride )
+    {
+        const uint32_t w = GetDWLE( p );
+        if( (w & SYNC_MASK) != 0x47 )
+            return i;
+        pi_pid[i] = HeaderPID( w );
+    }
+    return i_count;
+}
+
+#ifdef TS_SCAN_SSE2
+# include <emmintrin.h>
+
+__attribute__ ((__target__ ("sse2")))
+size_t ts_scan_packets_sse2( const uint8_t *p, size_t i_stride,
+                             size_t i_count, uint16_t *pi_pid )
+{
+    const __m128i sync_mask = _mm_set1_epi32( SYNC_MASK );
+    const __m128i sync = _mm_set1_epi32( 0x47 );
+    const __m128i pid_hi = _mm_set1_epi32( PID_HI_MASK );
+    const __m128i byte = _mm_set1_epi32( 0xff );
+    size_t i = 0;
+
+    for( ; i + 4 <= i_count; i += 4, p += 4 * i_stride )
+    {
+        const __m128i w = _mm_setr_epi32( GetDWLE( p ),
+                                          GetDWLE( p + i_stride ),
+                                          GetDWLE( p + 2 * i_stride ),
+                                          GetDWLE( p + 3 * i_stride ) );
+        const __m128i ok = _mm_cmpeq_epi32( _mm_and_si128( w, sync_mask ),
+                                            sync );
+        if( _mm_movemask_ps( _mm_castsi128_ps( ok ) ) != 0xf )
+            break;
+
+        /* PIDs are 13 bits, so the signed saturation never kicks in */
+        __m128i pid = _mm_or_si128( _mm_and_si128( w, pid_hi ),
+                                    _mm_and_si128( _mm_srli_epi32( w, 16 ),
+                                                   byte ) );
+        _mm_storel_epi64( (__m128i *)&pi_pid[i], _mm_packs_epi32( pid, pid ) );
+    }
+
+    return i + ts_scan_packets_c( p, i_stride, i_count - i, &pi_pid[i] );
+}
+#endif
+
+#ifdef TS_SCAN_AVX2
+# include <immintrin.h>
+
+__attribute__ ((__target__ ("avx2")))
+size_t ts_scan_packets_avx2( const uint8_t *p, size_t i_stride,
+                             size_t i_count, uint16_t *pi_pid )
+{
+    const __m256i sync_mask = _mm256_set1_epi32( SYNC_MASK );
+    const __m256i sync = _mm256_set1_epi32( 0x47 );
+    const __m256i pid_hi = _mm256_set1_epi32( PID_HI_MASK );
+    const __m256i byte = _mm256_set1_epi32( 0xff );
+    const __m256i offsets = _mm256_mullo_epi32( _mm256_set1_epi32( i_stride ),
+                                    _mm256_setr_epi32( 0, 1, 2, 3, 4, 5, 6, 7 ) );
+    size_t i = 0;
+
+    for( ; i + 8 <= i_count; i += 8, p += 8 * i_stride )
+    {
+        const __m256i w = _mm256_i32gather_epi32( (const int *)p, offsets, 1 );
+        const __m256i ok = _mm256_cmpeq_epi32(
+                                _mm256_and_si256( w, sync_mask ), sync );
+        if( _mm256_movemask_ps( _mm256_castsi256_ps( ok ) ) != 0xff )
+            break;
+
+        __m256i pid = _mm256_or_si256( _mm256_and_si256( w, pid_hi ),
+                                       _mm256_and_si256(
+                                           _mm256_srli_epi32( w, 16 ), byte ) );
+        /* The packing works per 128-bit lane: gather both halves back */
+        pid = _mm256_permute4x64_epi64( _mm256_packs_epi32( pid, pid ), 0x08 );
+        _mm_storeu_si128( (__m128i *)&pi_pid[i],
+                          _mm256_castsi256_si128( pid ) );
+    }
+
+    return i + ts_scan_packets_c( p, i_stride, i_count - i, &pi_pid[i] );
+}
+#endif
+
+#ifdef TS_SCAN_NEON
+# include <arm_neon.h>
+
+size_t ts_scan_packets_neon( const uint8_t *p, size_t i_stride,
+                             size_t i_count, uint16_t *pi_pid )
+{
+    const uint32x4_t sync_mask = vdupq_n_u32( SYNC_MASK );
+    const uint32x4_t sync = vdupq_n_u32( 0x47 );
+    const uint32x4_t pid_hi = vdupq_n_u32( PID_HI_MASK );
+    const uint32x4_t byte = vdupq_n_u32( 0xff );
+    size_t i = 0;
+
+    for( ; i + 4 <= i_count; i += 4, p += 4 * i_stride )
+    {
+        const uint32_t words[4] = {
+            GetDWLE( p ), GetDWLE( p + i_stride ),
+            GetDWLE( p + 2 * i_stride ), GetDWLE( p + 3 * i_stride ),
+        };
+        const uint32x4_t w = vld1q_u32( words );
+        if( vminvq_u32( vceqq_u32( vandq_u32( w, sync_mask ), sync ) ) == 0 )
+            break;
+
+        uint32x4_t pid = vorrq_u32( vandq_u32( w, pid_hi ),
+                                    vandq_u32( vshrq_n_u32( w, 16 ), byte ) );
+        vst1_u16( &pi_pid[i], vmovn_u32( pid ) );
+    }
+
+    return i + ts_scan_packets_c( p, i_stride, i_count - i, &pi_pid[i] );
+}
+#endif
+
+ts_scan_packets_fn ts_scan_GetPackets( void )
+{
+#ifdef TS_SCAN_AVX2
+    if( vlc_CPU_AVX2() )
+        return ts_scan_packets_avx2;
+#endif
+#ifdef TS_SCAN_SSE2
+    if( vlc_CPU_SSE2() )
+        return ts_scan_packets_sse2;
+#endif
+#ifdef TS_SCAN_NEON
+    if( vlc_CPU_ARM_NEON() )
+        return ts_scan_packets_neon;
+#endif
+    return ts_scan_packets_c;
+}
@@ -0,0 +1,59 @@
+/*****************************************************************************
+ * ts_scan.h: Batch TS packet header scanner
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifndef VLC_TS_SCAN_H
+#define VLC_TS_SCAN_H
+
+#if defined(HAVE_SSE2_INTRINSICS)
+# define TS_SCAN_SSE2 1
+#endif
+#if defined(HAVE_SSE2_INTRINSICS) && defined(HAVE_AVX2_INTRINSICS)
+# define TS_SCAN_AVX2 1
+#endif
+#if defined(__aarch64__) && defined(__ARM_NEON)
+# define TS_SCAN_NEON 1
+#endif
+
+/**
+ * Checks the sync bytes of consecutive packets, and extracts their PID.
+ *
+ * @param p first byte (sync byte) of the first packet
+ * @param i_stride distance between two packets, 188, 192 or 204
+ * @param i_count number of whole packets available from p
+ * @param pi_pid PIDs of the packets in sync, room for i_count entries
+ * @return number of packets in sync before the first bad sync byte
+ */
+typedef size_t (*ts_scan_packets_fn)( const uint8_t *p, size_t i_stride,
+                                      size_t i_count, uint16_t *pi_pid );
+
+size_t ts_scan_packets_c( const uint8_t *, size_t, size_t, uint16_t * );
+#ifdef TS_SCAN_SSE2
+size_t ts_scan_packets_sse2( const uint8_t *, size_t, size_t, uint16_t * );
+#endif
+#ifdef TS_SCAN_AVX2
+size_t ts_scan_packets_avx2( const uint8_t *, size_t, size_t, uint16_t * );
+#endif
+#ifdef TS_SCAN_NEON
+size_t ts_scan_packets_neon( const uint8_t *, size_t, size_t, uint16_t * );
+#endif
+
+/** Returns the fastest scanner for this CPU */
+ts_scan_packets_fn ts_scan_GetPackets( void );
+
+#endif
@@ -0,0 +1,430 @@
+/*****************************************************************************
+ * binary.c: binary ring buffer tracer plugin
+ *****************************************************************************
+ * Copyright © 2021 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * Each thread emitting traces gets its own single-producer/single-consumer
+ * ring buffer. Records are encoded in a compact binary form on the calling
+ * thread, without any lock or system call. A background thread periodically
+ * drains the rings into the output file. If a ring is full, records are
+ * dropped (and counted) rather than blocking the caller.
+ *
+ * The file can be converted to the Chrome trace-event format (which Perfetto
+ * also reads) with extras/misc/vlc-trace-to-chrome.py.
+ *
+ * File format (native endianness):
+ *  - header: "VLCTRACE", uint32 version, uint32 0x01020304 (byte order mark),
+ *    int64 clock frequency;
+ *  - records: uint16 size (whole record), uint8 kind, uint8 entry count,
+ *    uint32 thread id, int64 timestamp (vlc_tick_t), then entries;
+ *  - entry: uint8 type, uint8 key length, key, then either an int64 value
+ *    (VLC_TRACER_INT), or an uint8 length and the string bytes.
+ * A record of kind RECORD_DROPPED has no entries, but an int64 count of
+ * records lost by the thread since the previous one.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc_common.h>
+#include <vlc_plugin.h>
+#include <vlc_fs.h>
+#include <vlc_list.h>
+#include <vlc_tracer.h>
+
+#include <stdatomic.h>
+#include <errno.h>
+#include <assert.h>
+
+#define BINARY_FILENAME "vlc-trace.bin"
+#define BINARY_MAGIC    "VLCTRACE"
+#define BINARY_VERSION  1
+
+#define RECORD_TRACE    0
+#define RECORD_DROPPED  1
+
+#define RECORD_HEADER_SIZE 16
+#define RECORD_MAX_SIZE    1024
+
+#define FLUSH_PERIOD VLC_TICK_FROM_MS(100)
+
+struct trace_ring
+{
+    /** Node of vlc_tracer_sys_t.rings (protected by its lock) */
+    struct vlc_list node;
+    /** Write position (written by the producing thread only) */
+    atomic_size_t head;
+    /** Read position (written by the flusher thread only) */
+    atomic_size_t tail;
+    /** Number of records dropped because the ring was full */
+    atomic_uint_least64_t dropped;
+    /** Number of dropped records already reported */
+    uint_least64_t reported;
+    /** Set when the producing thread has exited */
+    atomic_bool orphaned;
+    uint32_t thread_id;
+    size_t mask;
+    unsigned char data[];
+};
+
+typedef struct
+{
+    FILE *stream;
+    vlc_threadvar_t ring_key;
+    size_t ring_size;
+
+    vlc_mutex_t lock;
+    vlc_cond_t wait;
+    struct vlc_list rings;
+    bool stopping;
+    vlc_thread_t thread;
+} vlc_tracer_sys_t;
+
+static void RingOrphan(void *data)
+{
+    struct trace_ring *ring = data;
+
+    /* The flusher frees the ring once it has been drained */
+    atomic_store_explicit(&ring->orphaned, true, memory_order_release);
+}
+
+static struct trace_ring *RingGet(vlc_tracer_sys_t *sys)
+{
+    struct trace_ring *ring = vlc_threadvar_get(sys->ring_key);
+    if (likely(ring != NULL))
+        return ring;
+
+    ring = malloc(sizeof (*ring) + sys->ring_size);
+    if (unlikely(ring == NULL))
+        return NULL;
+
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+    atomic_init(&ring->dropped, 0);
+    ring->reported = 0;
+    atomic_init(&ring->orphaned, false);
+    ring->thread_id = vlc_thread_id();
+    ring->mask = sys->ring_size - 1;
+
+    if (vlc_threadvar_set(sys->ring_key, ring))
+    {
+        free(ring);
+        return NULL;
+    }
+
+    vlc_mutex_lock(&sys->lock);
+    vlc_list_append(&ring->node, &sys->rings);
+    vlc_mutex_unlock(&sys->lock);
+    return ring;
+}
+
+static void RingWrite(struct trace_ring *ring, const void *buf, size_t len)
+{
+    size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+
+    if (ring->mask + 1 - (head - tail) < len)
+    {
+        atomic_fetch_add_explicit(&ring->dropped, 1, memory_order_relaxed);
+        return;
+    }
+
+    size_t offset = head & ring->mask;
+    size_t first = ring->mask + 1 - offset;
+
+    if (first > len)
+        first = len;
+    memcpy(ring->data + offset, buf, first);
+    memcpy(ring->data, (const unsigned char *)buf + first, len - first);
+
+    atomic_store_explicit(&ring->head, head + len, memory_order_release);
+}
+
+static size_t RecordHeader(unsigned char *rec, uint8_t kind, uint8_t count,
+                           uint32_t thread_id, vlc_tick_t ts)
+{
+    rec[2] = kind;
+    rec[3] = count;
+    memcpy(rec + 4, &thread_id, 4);
+    int64_t ts64 = ts;
+    memcpy(rec + 8, &ts64, 8);
+    return RECORD_HEADER_SIZE;
+}
+
+static void RecordSetSize(unsigned char *rec, size_t size)
+{
+    uint16_t size16 = size;
+    memcpy(rec, &size16, 2);
+}
+
+static void TraceBinary(void *opaque, va_list entries)
+{
+    vlc_tracer_sys_t *sys = opaque;
+    struct trace_ring *ring = RingGet(sys);
+    if (unlikely(ring == NULL))
+        return;
+
+    unsigned char rec[RECORD_MAX_SIZE];
+    size_t len = RECORD_HEADER_SIZE;
+    unsigned count = 0;
+
+    struct vlc_tracer_entry entry = va_arg(entries, struct vlc_tracer_entry);
+    while (entry.key != NULL)
+    {
+        size_t keylen = strnlen(entry.key, UINT8_MAX);
+        const char *str = NULL;
+        size_t strsize = 0;
+        size_t need = 2 + keylen;
+
+        switch (entry.type)
+        {
+            case VLC_TRACER_INT:
+                need += 8;
+                break;
+            case VLC_TRACER_STRING:
+                str = entry.value.string != NULL ? entry.value.string : "";
+                strsize = strnlen(str, UINT8_MAX);
+                need += 1 + strsize;
+                break;
+            default:
+                vlc_assert_unreachable();
+        }
+
+        /* Truncate records rather than overflowing */
+        if (len + need > sizeof (rec) || count == UINT8_MAX)
+            break;
+
+        rec[len++] = entry.type;
+        rec[len++] = keylen;
+        memcpy(rec + len, entry.key, keylen);
+        len += keylen;
+
+        if (entry.type == VLC_TRACER_INT)
+        {
+            int64_t value = entry.value.integer;
+            memcpy(rec + len, &value, 8);
+            len += 8;
+        }
+        else
+        {
+            rec[len++] = strsize;
+            memcpy(rec + len, str, strsize);
+            len += strsize;
+        }
+        count++;
+
+        entry = va_arg(entries, struct vlc_tracer_entry);
+    }
+
+    RecordHeader(rec, RECORD_TRACE, count, ring->thread_id, vlc_tick_now());
+    RecordSetSize(rec, len);
+    RingWrite(ring, rec, len);
+}
+
+/** Drains one ring into the output file (flusher thread only). */
+static void RingFlush(vlc_tracer_sys_t *sys, struct trace_ring *ring)
+{
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    size_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    size_t len = head - tail;
+
+    if (len > 0)
+    {
+        size_t offset = tail & ring->mask;
+        size_t first = ring->mask + 1 - offset;
+
+        if (first > len)
+            first = len;
+        fwrite(ring->data + offset, 1, first, sys->stream);
+        fwrite(ring->data, 1, len - first, sys->stream);
+
+        atomic_store_explicit(&ring->tail, head, memory_order_release);
+    }
+
+    uint_least64_t dropped = atomic_load_explicit(&ring->dropped,
+                                                  memory_order_relaxed);
+    if (dropped != ring->reported)
+    {
+        unsigned char rec[RECORD_HEADER_SIZE + 8];
+        int64_t count = dropped - ring->reported;
+
+        RecordHeader(rec, RECORD_DROPPED, 0, ring->thread_id, vlc_tick_now());
+        memcpy(rec + RECORD_HEADER_SIZE, &count, 8);
+        RecordSetSize(rec, sizeof (rec));
+        fwrite(rec, 1, sizeof (rec), sys->stream);
+        ring->reported = dropped;
+    }
+}
+
+static void FlushAll(vlc_tracer_sys_t *sys)
+{
+    vlc_mutex_assert(&sys->lock);
+
+    struct trace_ring *ring;
+    vlc_list_foreach(ring, &sys->rings, node)
+    {
+        /* Check for orphans before draining, so nothing is lost */
+        bool orphaned = atomic_load_explicit(&ring->orphaned,
+                                             memory_order_acquire);
+        RingFlush(sys, ring);
+        if (orphaned)
+        {
+            vlc_list_remove(&ring->node);
+            free(ring);
+        }
+    }
+    fflush(sys->stream);
+}
+
+static void *FlushThread(void *data)
+{
+    vlc_tracer_sys_t *sys = data;
+    vlc_tick_t deadline = vlc_tick_now() + FLUSH_PERIOD;
+
+    vlc_mutex_lock(&sys->lock);
+    while (!sys->stopping)
+    {
+        if (vlc_cond_timedwait(&sys->wait, &sys->lock, deadline) == 0)
+            continue;
+
+        FlushAll(sys);
+        deadline += FLUSH_PERIOD;
+    }
+    FlushAll(sys);
+    vlc_mutex_unlock(&sys->lock);
+    return NULL;
+}
+
+static void Close(void *opaque)
+{
+    vlc_tracer_sys_t *sys = opaque;
+
+    vlc_mutex_lock(&sys->lock);
+    sys->stopping = true;
+    vlc_cond_signal(&sys->wait);
+    vlc_mutex_unlock(&sys->lock);
+    vlc_join(sys->thread, NULL);
+
+    /* Rings of threads still alive are not referenced anymore once the key
+     * is deleted. */
+    vlc_threadvar_delete(&sys->ring_key);
+
+    struct trace_ring *ring;
+    vlc_list_foreach(ring, &sys->rings, node)
+        free(ring);
+
+    fclose(sys->stream);
+    free(sys);
+}
+
+static const struct vlc_tracer_operations binary_ops =
+{
+    TraceBinary,
+    Close
+};
+
+static const struct vlc_tracer_operations *Open(vlc_object_t *obj,
+                                               void **restrict sysp)
+{
+    vlc_tracer_sys_t *sys = malloc(sizeof (*sys));
+    if (unlikely(sys == NULL))
+        return NULL;
+
+    /* Round the ring size up to a power of two */
+    int64_t kib = var_InheritInteger(obj, "binary-tracer-buffer");
+    size_t size = 4096;
+    while (size < (uint64_t)kib * 1024 && size < (SIZE_MAX >> 2))
+        size <<= 1;
+    sys->ring_size = size;
+
+    if (vlc_threadvar_create(&sys->ring_key, RingOrphan))
+    {
+        free(sys);
+        return NULL;
+    }
+
+    const char *filename = BINARY_FILENAME;
+    char *path = var_InheritString(obj, "binary-tracer-file");
+    if (path != NULL)
+        filename = path;
+
+    msg_Dbg(obj, "opening trace file `%s'", filename);
+    sys->stream = vlc_fopen(filename, "wb");
+    if (sys->stream == NULL)
+    {
+        msg_Err(obj, "error opening trace file `%s': %s", filename,
+                vlc_strerror_c(errno));
+        goto error;
+    }
+    free(path);
+    path = NULL;
+
+    uint32_t version = BINARY_VERSION, bom = 0x01020304;
+    int64_t freq = CLOCK_FREQ;
+    if (fwrite(BINARY_MAGIC, 1, 8, sys->stream) != 8
+     || fwrite(&version, sizeof (version), 1, sys->stream) != 1
+     || fwrite(&bom, sizeof (bom), 1, sys->stream) != 1
+     || fwrite(&freq, sizeof (freq), 1, sys->stream) != 1)
+    {
+        fclose(sys->stream);
+        goto error;
+    }
+
+    vlc_mutex_init(&sys->lock);
+    vlc_cond_init(&sys->wait);
+    vlc_list_init(&sys->rings);
+    sys->stopping = false;
+
+    if (vlc_clone(&sys->thread, FlushThread, sys, VLC_THREAD_PRIORITY_LOW))
+    {
+        fclose(sys->stream);
+        goto error;
+    }
+
+    *sysp = sys;
+    return &binary_ops;
+
+error:
+    free(path);
+    vlc_threadvar_delete(&sys->ring_key);
+    free(sys);
+    return NULL;
+}
+
+#define FILE_TEXT N_("Trace filename")
+#define FILE_LONGTEXT N_("Specify the binary trace filename.")
+
+#define BUFFER_TEXT N_("Per-thread buffer size (KiB)")
+#define BUFFER_LONGTEXT N_( \
+    "Size of the ring buffer of each tracing thread. Traces are dropped " \
+    "when a buffer is full.")
+
+vlc_module_begin()
+    set_shortname(N_("Binary tracer"))
+    set_description(N_("Binary ring buffer tracer"))
+    set_category(CAT_ADVANCED)
+    set_subcategory(SUBCAT_ADVANCED_MISC)
+    set_capability("tracer", 0)
+    set_callback(Open)
+
+    add_savefile("binary-tracer-file", NULL, FILE_TEXT, FILE_LONGTEXT)
+    add_integer_with_range("binary-tracer-buffer", 256, 4, 65536,
+                           BUFFER_TEXT, BUFFER_LONGTEXT)
+vlc_module_end()
@@ -0,0 +1,76 @@
+/*****************************************************************************
+ * fragments.c: mp4 fragments and chunks boundaries
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc_common.h>
+
+#include "fragments.h"
+
+void mp4_fragmenter_Init(mp4_fragmenter_t *f, vlc_tick_t i_fragment_length,
+                         vlc_tick_t i_chunk_length)
+{
+    f->i_fragment_length = i_fragment_length;
+    f->i_chunk_length = (i_chunk_length < i_fragment_length) ? i_chunk_length : 0;
+    f->i_fragment_start = 0;
+    f->b_started = false;
+}
+
+vlc_tick_t mp4_fragmenter_GetStep(const mp4_fragmenter_t *f)
+{
+    return f->i_chunk_length ? f->i_chunk_length : f->i_fragment_length;
+}
+
+bool mp4_fragmenter_IsIframePoint(const mp4_fragmenter_t *f,
+                                  vlc_tick_t i_last_iframe_time,
+                                  vlc_tick_t i_time,
+                                  vlc_tick_t i_written_duration)
+{
+    /* Keep the first keyframe past the fragment duration, so that chunks
+     * in between do not end the fragment */
+    if(f->i_chunk_length)
+        return i_last_iframe_time == 0 &&
+               i_time - f->i_fragment_start >= f->i_fragment_length;
+
+    /* Keep the last keyframe within the fragment duration */
+    return i_time - i_written_duration < f->i_fragment_length;
+}
+
+bool mp4_fragmenter_StartMoof(mp4_fragmenter_t *f, vlc_tick_t i_written_duration,
+                              vlc_tick_t i_iframe_point, bool b_has_iframes)
+{
+    if(!f->i_chunk_length)
+        return true;
+
+    bool b_start;
+    if(!f->b_started || i_iframe_point)
+        b_start = true;
+    else
+        b_start = !b_has_iframes &&
+                  i_written_duration - f->i_fragment_start >= f->i_fragment_length;
+
+    if(b_start)
+    {
+        f->i_fragment_start = i_written_duration;
+        f->b_started = true;
+    }
+    return b_start;
+}
@@ -0,0 +1,70 @@
+/*****************************************************************************
+ * fragments.h: mp4 fragments and chunks boundaries
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifndef VLC_MP4_FRAGMENTS_H
+#define VLC_MP4_FRAGMENTS_H
+
+/*
+ * Without chunking, each moof is a fragment, cut on the last keyframe
+ * within the fragment duration.
+ * With chunking, each moof is a chunk. A fragment then starts on the first
+ * keyframe past the fragment duration, or on duration when no stream has
+ * keyframes.
+ */
+typedef struct
+{
+    vlc_tick_t i_fragment_length;
+    vlc_tick_t i_chunk_length;   /* 0 if not chunked */
+    vlc_tick_t i_fragment_start; /* written duration at fragment start */
+    bool       b_started;        /* a fragment was started */
+} mp4_fragmenter_t;
+
+void mp4_fragmenter_Init(mp4_fragmenter_t *, vlc_tick_t i_fragment_length,
+                         vlc_tick_t i_chunk_length);
+
+/**
+ * Returns the duration to buffer before writing the next moof.
+ */
+vlc_tick_t mp4_fragmenter_GetStep(const mp4_fragmenter_t *);
+
+/**
+ * Checks if a keyframe becomes the iframe point of its stream.
+ *
+ * @param i_last_iframe_time current iframe point of the stream, or 0
+ * @param i_time start time of the keyframe
+ * @param i_written_duration duration already written
+ */
+bool mp4_fragmenter_IsIframePoint(const mp4_fragmenter_t *,
+                                  vlc_tick_t i_last_iframe_time,
+                                  vlc_tick_t i_time,
+                                  vlc_tick_t i_written_duration);
+
+/**
+ * Checks if the moof about to be written starts a fragment.
+ *
+ * @param i_written_duration start time of the moof
+ * @param i_iframe_point iframe point the moof starts at or after, or 0
+ * @param b_has_iframes whether any stream has keyframes
+ * @return true if the moof starts a fragment. When chunking, the iframe
+ * points must then be reset.
+ */
+bool mp4_fragmenter_StartMoof(mp4_fragmenter_t *, vlc_tick_t i_written_duration,
+                              vlc_tick_t i_iframe_point, bool b_has_iframes);
+
+#endif
@@ -41,6 +41,7 @@
 
 #include "../../demux/mp4/libmp4.h"
 #include "libmp4mux.h"
+#include "fragments.h"
 #include "../../packetizer/hxxx_nal.h"
 #include "../av1_pack.h"
 #include "../extradata.h"
@@ -54,6 +55,17 @@
     "\"Fast Start\" files are optimized for downloads and allow the user " \
     "to start previewing the file while it is downloading.")
 
+#define FRAGDURATION_TEXT N_("Fragment duration (ms)")
+#define FRAGDURATION_LONGTEXT N_(\
+    "Target duration of the fragments. Fragments start on keyframes " \
+    "when chunking, so they can be longer.")
+
+#define CHUNKDURATION_TEXT N_("Chunk duration (ms)")
+#define CHUNKDURATION_LONGTEXT N_(\
+    "Split the fragments into chunks of this duration, each written as " \
+    "its own moof and mdat as soon as it is complete, for low latency " \
+    "delivery. 0 writes whole fragments.")
+
 static int  Open   (vlc_object_t *);
 static void Close  (vlc_object_t *);
 static void CloseFrag  (vlc_object_t *);
@@ -77,7 +89,12 @@ add_submodule ()
     set_category(CAT_SOUT)
     set_subcategory(SUBCAT_SOUT_MUX)
     set_shortname("MP4 Frag")
-    add_shortcut("mp4frag", "mp4stream")
+    add_shortcut("mp4frag", "mp4stream", "cmaf")
+
+    add_integer_with_range(SOUT_CFG_PREFIX "frag-duration", 1500, 100, 60000,
+                           FRAGDURATION_TEXT, FRAGDURATION_LONGTEXT)
+    add_integer_with_range(SOUT_CFG_PREFIX "chunk-duration", 0, 0, 60000,
+                           CHUNKDURATION_TEXT, CHUNKDURATION_LONGTEXT)
     set_capability("sout mux", 0)
     set_callbacks(Open, CloseFrag)
 
@@ -87,7 +104,7 @@ vlc_module_end ()
  * Exported prototypes
  *****************************************************************************/
 static const char *const ppsz_sout_options[] = {
-    "faststart", NULL
+    "faststart", "frag-duration", "chunk-duration", NULL
 };
 
 static int Control(sout_mux_t *, int, va_list);
@@ -173,6 +190,9 @@ typedef struct
     /* mp4frag */
     vlc_tick_t     i_written_duration;
     uint32_t       i_mfhd_sequence;
+    mp4_fragmenter_t fragmenter;
+    bool           b_cmaf;
+    bool           b_error;
 } sout_mux_sys_t;
 
 static void mp4_stream_Delete(mp4_stream_t *p_stream)
@@ -273,7 +293,8 @@ static int Open(vlc_object_t *p_this)
     {
         if(!strcmp(p_mux->psz_mux, "mov"))
             options |= QUICKTIME;
-        if(!strcmp(p_mux->psz_mux, "mp4frag") || !strcmp(p_mux->psz_mux, "mp4stream"))
+        if(!strcmp(p_mux->psz_mux, "mp4frag") || !strcmp(p_mux->psz_mux, "mp4stream") ||
+           !strcmp(p_mux->psz_mux, "cmaf"))
             options |= FRAGMENTED;
     }
 
@@ -291,6 +312,11 @@ static int Open(vlc_object_t *p_this)
     p_sys->i_written_duration= 0;
     p_sys->i_start_dts = VLC_TICK_INVALID;
     p_sys->i_mfhd_sequence = 1;
+    mp4_fragmenter_Init(&p_sys->fragmenter,
+            VLC_TICK_FROM_MS(var_GetInteger(p_mux, SOUT_CFG_PREFIX "frag-duration")),
+            VLC_TICK_FROM_MS(var_GetInteger(p_mux, SOUT_CFG_PREFIX "chunk-duration")));
+    p_sys->b_cmaf = p_mux->psz_mux && !strcmp(p_mux->psz_mux, "cmaf");
+    p_sys->b_error = false;
 
     p_mux->p_sys        = p_sys;
     p_mux->pf_control   = Control;
@@ -303,6 +329,11 @@ static int Open(vlc_object_t *p_this)
         mp4mux_SetBrand(p_sys->muxh, BRAND_3gp6, 0x0);
         mp4mux_AddExtraBrand(p_sys->muxh, BRAND_3gp4);
     }
+    else if(p_sys->b_cmaf)
+    {
+        mp4mux_SetBrand(p_sys->muxh, BRAND_cmfc, 0x0);
+        mp4mux_AddExtraBrand(p_sys->muxh, BRAND_iso6);
+    }
     else
     {
         mp4mux_SetBrand(p_sys->muxh, BRAND_isom, 0x0);
@@ -468,6 +499,16 @@ static int AddStream(sout_mux_t *p_mux, sout_input_t *p_input)
         return VLC_EGENERIC;
     }
 
+    /* CMAF tracks are each stored in their own file. Fail the whole output
+     * rather than silently dropping the other tracks. */
+    if(p_sys->b_cmaf && p_sys->i_nb_streams > 0)
+    {
+        msg_Err(p_mux, "cmaf only supports one track per output, "
+                "use one output per track");
+        p_sys->b_error = true;
+        return VLC_EGENERIC;
+    }
+
     if(!(p_stream = mp4_stream_New()))
         return VLC_ENOMEM;
 
@@ -900,8 +941,6 @@ static void box_send(sout_mux_t *p_mux,  bo_t *box)
 /***************************************************************************
     MP4 Live submodule
 ****************************************************************************/
-#define FRAGMENT_LENGTH  VLC_TICK_FROM_MS(1500)
-
 #define ENQUEUE_ENTRY(object, entry) \
     do {\
         if (object.p_last)\
@@ -966,6 +1005,7 @@ static bo_t *GetMoofBox(sout_mux_t *p_mux, size_t *pi_mdat_total_size,
 
     bo_t            *moof, *mfhd;
     size_t           i_fixupoffset = 0;
+    vlc_tick_t       i_moof_length = 0;
 
     *pi_mdat_total_size = 0;
 
@@ -1032,6 +1072,11 @@ static bo_t *GetMoofBox(sout_mux_t *p_mux, size_t *pi_mdat_total_size,
             i_tfhd_flags |= MP4_TFHD_DURATION_IS_EMPTY;
         }
 
+        /* Required by CMAF. The single trun data offset is already relative
+         * to the moof, as there is only one track. */
+        if (p_sys->b_cmaf)
+            i_tfhd_flags |= MP4_TFHD_DEFAULT_BASE_IS_MOOF;
+
         /* *** add /moof/traf/tfhd *** */
         bo_t *tfhd = box_full_new("tfhd", 0, i_tfhd_flags);
         if(!tfhd)
@@ -1159,6 +1204,8 @@ static bo_t *GetMoofBox(sout_mux_t *p_mux, size_t *pi_mdat_total_size,
             box_gather(traf, trun);
         }
 
+        i_moof_length = __MAX(i_moof_length, i_time - p_stream->i_written_duration);
+
         box_gather(moof, traf);
     }
 
@@ -1179,6 +1226,8 @@ static bo_t *GetMoofBox(sout_mux_t *p_mux, size_t *pi_mdat_total_size,
 
     /* set iframe flag, so the streaming server always starts from moof */
     moof->b->i_flags |= BLOCK_FLAG_TYPE_I;
+    /* the segmenting outputs measure the duration of the written blocks */
+    moof->b->i_length = i_moof_length;
 
     return moof;
 }
@@ -1210,6 +1259,7 @@ static void WriteFragmentMDAT(sout_mux_t *p_mux, size_t i_total_size)
             p_stream->i_written_duration += p_entry->p_block->i_length;
 
             p_entry->p_block->i_flags &= ~BLOCK_FLAG_TYPE_I; // clear flag for http stream
+            p_entry->p_block->i_length = 0; // carried by the moof
             sout_AccessOutWrite(p_mux->p_access, p_entry->p_block);
 
             p_stream->towrite.p_first = p_entry->p_next;
@@ -1287,9 +1337,11 @@ static void WriteFragments(sout_mux_t *p_mux, bool b_flush)
 {
     sout_mux_sys_t *p_sys = (sout_mux_sys_t*) p_mux->p_sys;
     bo_t *moof = NULL;
-    vlc_tick_t i_barrier_time = p_sys->i_written_duration + FRAGMENT_LENGTH;
+    vlc_tick_t i_barrier_time = p_sys->i_written_duration +
+            mp4_fragmenter_GetStep(&p_sys->fragmenter);
     size_t i_mdat_size = 0;
     bool b_has_samples = false;
+    bool b_has_iframes = false;
 
     if(!p_sys->b_header_sent)
     {
@@ -1304,6 +1356,10 @@ static void WriteFragments(sout_mux_t *p_mux, bool b_flush)
     for (unsigned int i = 0; i < p_sys->i_nb_streams; i++)
     {
         const mp4_stream_t *p_stream = p_sys->pp_streams[i];
+        /* also from streams without samples queued for this moof */
+        if (p_stream->b_hasiframes)
+            b_has_iframes = true;
+
         if (p_stream->read.p_first)
         {
             b_has_samples = true;
@@ -1333,13 +1389,38 @@ static void WriteFragments(sout_mux_t *p_mux, bool b_flush)
 
     if (moof)
     {
+        /* The moof starts a fragment once written up to an iframe point */
+        vlc_tick_t i_iframe_point = 0;
+        for (unsigned int i = 0; i < p_sys->i_nb_streams; i++)
+        {
+            mp4_stream_t *p_stream = p_sys->pp_streams[i];
+            if (p_stream->i_last_iframe_time &&
+                p_stream->i_last_iframe_time <= p_stream->i_written_duration)
+                i_iframe_point = p_stream->i_last_iframe_time;
+        }
+        bool b_fragment_start =
+            mp4_fragmenter_StartMoof(&p_sys->fragmenter, p_sys->i_written_duration,
+                                     i_iframe_point, b_has_iframes);
+        if (b_fragment_start && p_sys->fragmenter.i_chunk_length)
+        {
+            for (unsigned int i = 0; i < p_sys->i_nb_streams; i++)
+                p_sys->pp_streams[i]->i_last_iframe_time = 0;
+        }
+
+        assert(moof->b->i_flags & BLOCK_FLAG_TYPE_I); /* http sout */
+        /* Clients can only join at the start of a fragment */
+        if (!b_fragment_start)
+            moof->b->i_flags &= ~BLOCK_FLAG_TYPE_I;
+
         msg_Dbg(p_mux, "writing moof @ %"PRId64, p_sys->i_pos);
         p_sys->i_pos += bo_size(moof);
-        assert(moof->b->i_flags & BLOCK_FLAG_TYPE_I); /* http sout */
         box_send(p_mux, moof);
         msg_Dbg(p_mux, "writing mdat @ %"PRId64, p_sys->i_pos);
         WriteFragmentMDAT(p_mux, i_mdat_size);
 
+        if (p_sys->fragmenter.i_chunk_length)
+            return; /* keep the iframe points for the next chunks */
+
         /* update iframe point */
         for (unsigned int i = 0; i < p_sys->i_nb_streams; i++)
         {
@@ -1435,6 +1516,9 @@ static int MuxFrag(sout_mux_t *p_mux)
 {
     sout_mux_sys_t *p_sys = (sout_mux_sys_t*) p_mux->p_sys;
 
+    if (p_sys->b_error)
+        return VLC_EGENERIC;
+
     int i_stream = sout_MuxGetStream(p_mux, 1, NULL);
     if (i_stream < 0)
         return VLC_SUCCESS;
@@ -1474,12 +1558,17 @@ static int MuxFrag(sout_mux_t *p_mux)
         ENQUEUE_ENTRY(p_stream->read, p_stream->p_held_entry);
         p_stream->p_held_entry = NULL;
 
-        if (p_stream->b_hasiframes && (p_heldblock->i_flags & BLOCK_FLAG_TYPE_I) &&
-            mp4mux_track_GetDuration(p_stream->tinfo) - p_sys->i_written_duration < FRAGMENT_LENGTH)
+        if (p_stream->b_hasiframes && (p_heldblock->i_flags & BLOCK_FLAG_TYPE_I))
         {
+            vlc_tick_t i_iframe_time = mp4mux_track_GetDuration(p_stream->tinfo);
+
             /* Flag the last iframe time, we'll use it as boundary so it will start
                next fragment */
-            p_stream->i_last_iframe_time = mp4mux_track_GetDuration(p_stream->tinfo);
+            if (mp4_fragmenter_IsIframePoint(&p_sys->fragmenter,
+                                             p_stream->i_last_iframe_time,
+                                             i_iframe_time,
+                                             p_sys->i_written_duration))
+                p_stream->i_last_iframe_time = i_iframe_time;
         }
 
         /* update buffered time */
@@ -1528,7 +1617,8 @@ static int MuxFrag(sout_mux_t *p_mux)
     p_sys->i_written_duration = i_min_written_duration;
 
     /* we have prerolled enough to know all streams, and have enough date to create a fragment */
-    if (p_stream->read.p_first && p_sys->i_read_duration - p_sys->i_written_duration >= FRAGMENT_LENGTH)
+    if (p_stream->read.p_first && p_sys->i_read_duration - p_sys->i_written_duration >=
+            mp4_fragmenter_GetStep(&p_sys->fragmenter))
         WriteFragments(p_mux, false);
 
     return VLC_SUCCESS;
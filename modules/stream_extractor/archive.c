@@ -515,6 +515,9 @@ static int Control( stream_extractor_t* p_extractor, int i_query, va_list args )
             *va_arg( args, uint64_t* ) = archive_entry_size( p_sys->p_entry );
             break;
 
+        case STREAM_GET_MAPPED_BLOCK: /* the entry data is not the source */
+            return VLC_EGENERIC;
+
         default:
             return vlc_stream_vaControl( p_extractor->source, i_query, args );
     }
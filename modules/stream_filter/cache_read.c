@@ -465,6 +465,8 @@ static int AStreamControl(stream_t *s, int i_query, va_list args)
         case STREAM_GET_TAGS:
         case STREAM_GET_TYPE:
         case STREAM_SET_PAUSE_STATE:
+        case STREAM_GET_MAPPED_BLOCK:
+        case STREAM_SET_ACCESS_HINT:
         case STREAM_SET_PRIVATE_ID_STATE:
         case STREAM_SET_PRIVATE_ID_CA:
         case STREAM_GET_PRIVATE_ID_STATE:
@@ -75,6 +75,16 @@ typedef struct
     char        *buffer;
     size_t       seek_threshold;
 
+    /* Read-ahead window (see Thread()) */
+    size_t       window;
+    size_t       window_min;
+    bool         filling;
+    bool         seeking;
+
+    uint64_t     hits;
+    uint64_t     misses;
+    vlc_tick_t   stall;
+
     struct stream_ctrl *controls;
 } stream_sys_t;
 
@@ -218,6 +228,24 @@ static void *Thread(void *data)
             continue;
         }
 
+        /* The window is double-buffered: once it is full, the reader drains
+         * one half while the thread idles, then the thread refills that half
+         * with large reads, always staying ahead of the reader.
+         * There is only ever one read in flight: access modules are neither
+         * reentrant nor able to queue requests, so the window bounds how far
+         * ahead this single sequential read runs, not how many are issued. */
+        size_t ahead = (history < sys->buffer_length)
+                       ? sys->buffer_length - history : 0;
+
+        if (ahead >= sys->window
+         || (!sys->filling && ahead >= sys->window / 2))
+        {
+            sys->filling = false;
+            vlc_cond_wait(&sys->wait_space, &sys->lock);
+            continue;
+        }
+        sys->filling = true;
+
         assert(sys->buffer_size >= sys->buffer_length);
 
         size_t len = sys->buffer_size - sys->buffer_length;
@@ -241,6 +269,8 @@ static void *Thread(void *data)
          /* Do not step past the sharp edge of the circular buffer */
         if (offset + len > sys->buffer_size)
             len = sys->buffer_size - offset;
+        if (len > sys->window - ahead)
+            len = sys->window - ahead;
 
         ssize_t val = ThreadRead(stream, sys->buffer + offset, len);
         if (val < 0)
@@ -271,6 +301,14 @@ static int Seek(stream_t *stream, uint64_t offset)
     stream_sys_t *sys = stream->p_sys;
 
     vlc_mutex_lock(&sys->lock);
+    if (offset < sys->buffer_offset
+     || offset >= sys->buffer_offset + sys->buffer_length + sys->seek_threshold)
+    {   /* Random access: read-ahead would mostly be wasted */
+        sys->window /= 2;
+        if (sys->window < sys->window_min)
+            sys->window = sys->window_min;
+        sys->seeking = true;
+    }
     sys->stream_offset = offset;
     sys->error = false;
     vlc_cond_signal(&sys->wait_space);
@@ -298,6 +336,7 @@ static ssize_t Read(stream_t *stream, void *buf, size_t buflen)
 {
     stream_sys_t *sys = stream->p_sys;
     size_t copy, offset;
+    vlc_tick_t start = VLC_TICK_INVALID, stall = 0;
     bool eof;
 
     if (buflen == 0)
@@ -321,11 +360,36 @@ static ssize_t Read(stream_t *stream, void *buf, size_t buflen)
             return 0;
         }
 
+        if (start == VLC_TICK_INVALID)
+            start = vlc_tick_now();
+
         vlc_interrupt_forward_start(sys->interrupt, data);
         vlc_cond_wait(&sys->wait_data, &sys->lock);
         vlc_interrupt_forward_stop(data);
     }
 
+    if (start != VLC_TICK_INVALID)
+    {
+        stall = vlc_tick_now() - start;
+        if (stall <= 0)
+            stall = 1;
+        sys->misses++;
+        sys->stall += stall;
+
+        /* The window did not cover the upstream latency: widen it, unless
+         * the miss was caused by a seek out of the buffer. */
+        if (!sys->seeking && sys->window < sys->buffer_size)
+        {
+            sys->window *= 2;
+            if (sys->window > sys->buffer_size)
+                sys->window = sys->buffer_size;
+            msg_Dbg(stream, "read-ahead window: %zu bytes", sys->window);
+        }
+    }
+    else
+        sys->hits++;
+    sys->seeking = false;
+
     offset = sys->stream_offset % sys->buffer_size;
     if (copy > buflen)
         copy = buflen;
@@ -337,6 +401,8 @@ static ssize_t Read(stream_t *stream, void *buf, size_t buflen)
     sys->stream_offset += copy;
     vlc_cond_signal(&sys->wait_space);
     vlc_mutex_unlock(&sys->lock);
+
+    vlc_stream_ReportReadAhead(stream, stall);
     return copy;
 }
 
@@ -379,6 +445,7 @@ static int Control(stream_t *stream, int query, va_list args)
         case STREAM_GET_SIGNAL:
         case STREAM_GET_TAGS:
         case STREAM_GET_TYPE:
+        case STREAM_GET_MAPPED_BLOCK:
             return VLC_EGENERIC;
         case STREAM_SET_PAUSE_STATE:
         {
@@ -412,6 +479,7 @@ static int Control(stream_t *stream, int query, va_list args)
         }
         case STREAM_SET_PRIVATE_ID_CA:
         case STREAM_GET_PRIVATE_ID_STATE:
+        case STREAM_SET_ACCESS_HINT:
             return VLC_EGENERIC;
         default:
             msg_Err(stream, "unimplemented query (%d) in control", query);
@@ -465,6 +533,11 @@ static int Open(vlc_object_t *obj)
     sys->buffer_length = 0;
     sys->buffer_size = var_InheritInteger(obj, "prefetch-buffer-size") << 10u;
     sys->seek_threshold = var_InheritInteger(obj, "prefetch-seek-threshold");
+    sys->filling = true;
+    sys->seeking = false;
+    sys->hits = 0;
+    sys->misses = 0;
+    sys->stall = 0;
     sys->controls = NULL;
 
     uint64_t size = stream_Size(stream->s);
@@ -474,6 +547,13 @@ static int Open(vlc_object_t *obj)
             sys->buffer_size = size;
     }
 
+    /* Start with a small window, so that little is read in vain if the
+     * demuxer seeks around while probing, and grow it on misses. */
+    sys->window_min = sys->buffer_size / 16;
+    if (sys->window_min < 4096)
+        sys->window_min = __MIN(sys->buffer_size, 4096);
+    sys->window = sys->window_min;
+
     sys->buffer = malloc(sys->buffer_size);
     if (sys->buffer == NULL)
         goto error;
@@ -524,6 +604,10 @@ static void Close (vlc_object_t *obj)
     vlc_join(sys->thread, NULL);
     vlc_interrupt_destroy(sys->interrupt);
 
+    msg_Dbg(stream, "read-ahead: %"PRIu64" hits, %"PRIu64" misses, "
+            "%"PRId64" ms stalled, %zu bytes window", sys->hits, sys->misses,
+            MS_FROM_VLC_TICK(sys->stall), sys->window);
+
     while(sys->controls)
     {
         struct stream_ctrl *ctrl = sys->controls;
@@ -134,10 +134,14 @@ static int Seek( stream_t *s, uint64_t offset )
 
 static int Control( stream_t *s, int i_query, va_list args )
 {
+    stream_sys_t *sys = s->p_sys;
+
+    /* Mapped blocks would not be recorded */
+    if( i_query == STREAM_GET_MAPPED_BLOCK && sys->f != NULL )
+        return VLC_EGENERIC;
     if( i_query != STREAM_SET_RECORD_STATE )
         return vlc_stream_vaControl( s->s, i_query, args );
 
-    stream_sys_t *sys = s->p_sys;
     bool b_active = (bool)va_arg( args, int );
     const char *psz_extension = NULL;
     if( b_active )
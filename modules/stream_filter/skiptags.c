@@ -184,6 +184,17 @@ static int Control(stream_t *stream, int query, va_list args)
                 *va_arg(args, uint64_t *) = size - sys->header_skip;
             return ret;
         }
+
+        case STREAM_GET_MAPPED_BLOCK:
+        {
+            uint64_t offset = va_arg(args, uint64_t);
+            size_t length = va_arg(args, size_t);
+            block_t **blockp = va_arg(args, block_t **);
+
+            return vlc_stream_Control(stream->s, query,
+                                      offset + sys->header_skip, length,
+                                      blockp);
+        }
     }
 
     return vlc_stream_vaControl(stream->s, query, args);
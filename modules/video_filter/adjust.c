@@ -46,7 +46,11 @@
  *****************************************************************************/
 static int  Create    ( filter_t * );
 
+static picture_t *FilterPlanar( filter_t *, picture_t * );
+static void FilterPlanarSlice( filter_t *, picture_t *, const picture_t *,
+                               unsigned, unsigned );
 static picture_t *FilterPacked( filter_t *, picture_t * );
+static void Destroy( filter_t * );
 
 /*****************************************************************************
  * Module descriptor
@@ -116,6 +120,15 @@ typedef struct
                                int, int );
     int (*pf_process_sat_hue_clip)( picture_t *, picture_t *, int, int,
                                     int, int, int );
+
+    /* Parameters of the picture being filtered, shared by all bands */
+    struct
+    {
+        int pi_luma[1024]; /* The full range will only be used for 10-bit */
+        bool b_16bit;
+        bool b_clip;
+        int i_sin, i_cos, i_sat, i_x, i_y;
+    } planar;
 } filter_sys_t;
 
 static int FloatCallback( vlc_object_t *obj, char const *varname,
@@ -138,7 +151,11 @@ static int BoolCallback( vlc_object_t *obj, char const *varname,
     return VLC_SUCCESS;
 }
 
-VIDEO_FILTER_WRAPPER_CLOSE( FilterPlanar, Destroy )
+static const struct vlc_filter_operations planar_filter_ops =
+{
+    .filter_video = FilterPlanar, .filter_slice = FilterPlanarSlice,
+    .close = Destroy,
+};
 
 static const struct vlc_filter_operations packed_filter_ops =
 {
@@ -168,7 +185,7 @@ static int Create( filter_t *p_filter )
     {
         CASE_PLANAR_YUV
             /* Planar YUV */
-            p_filter->ops = &FilterPlanar_ops;
+            p_filter->ops = &planar_filter_ops;
             p_sys->pf_process_sat_hue_clip = planar_sat_hue_clip_C;
             p_sys->pf_process_sat_hue = planar_sat_hue_C;
             break;
@@ -176,7 +193,7 @@ static int Create( filter_t *p_filter )
         CASE_PLANAR_YUV10
         CASE_PLANAR_YUV9
             /* Planar YUV 9-bit or 10-bit */
-            p_filter->ops = &FilterPlanar_ops;
+            p_filter->ops = &planar_filter_ops;
             p_sys->pf_process_sat_hue_clip = planar_sat_hue_clip_C_16;
             p_sys->pf_process_sat_hue = planar_sat_hue_C_16;
             break;
@@ -242,15 +259,14 @@ static void Destroy( filter_t *p_filter )
 }
 
 /*****************************************************************************
- * Run the filter on a Planar YUV picture
+ * Compute the lookup tables and the parameters for a Planar YUV picture
  *****************************************************************************/
-static void FilterPlanar( filter_t *p_filter, picture_t *p_pic, picture_t *p_outpic )
+static void PreparePlanar( filter_t *p_filter )
 {
-    /* The full range will only be used for 10-bit */
-    int pi_luma[1024];
     int pi_gamma[1024];
 
     filter_sys_t *p_sys = p_filter->p_sys;
+    int *pi_luma = p_sys->planar.pi_luma;
 
     bool b_16bit;
     float f_range;
@@ -322,10 +338,69 @@ static void FilterPlanar( filter_t *p_filter, picture_t *p_pic, picture_t *p_out
         i_sat = 0;
     }
 
+    p_sys->planar.b_16bit = b_16bit;
+    p_sys->planar.b_clip = i_sat > i_range;
+    p_sys->planar.i_sat = i_sat;
+    p_sys->planar.i_sin = sinf(f_hue) * f_max;
+    p_sys->planar.i_cos = cosf(f_hue) * f_max;
+
+    /* pow(2, (bpp * 2) - 1) */
+    p_sys->planar.i_x = ( cosf(f_hue) + sinf(f_hue) ) * f_range * i_mid;
+    p_sys->planar.i_y = ( cosf(f_hue) - sinf(f_hue) ) * f_range * i_mid;
+}
+
+/*****************************************************************************
+ * Describe a band of a picture as a picture of its own
+ *****************************************************************************/
+static void GetPlanarBand( picture_t *p_band, const picture_t *p_pic,
+                           unsigned first, unsigned count )
+{
+    p_band->format = p_pic->format;
+    p_band->i_planes = p_pic->i_planes;
+    for( int i = 0; i < p_pic->i_planes; i++ )
+    {
+        unsigned start, end;
+
+        filter_GetSliceLines( p_pic, i, first, count, &start, &end );
+        p_band->p[i] = p_pic->p[i];
+        p_band->p[i].p_pixels += start * p_pic->p[i].i_pitch;
+        p_band->p[i].i_lines = end - start;
+        p_band->p[i].i_visible_lines = end - start;
+    }
+}
+
+/*****************************************************************************
+ * Run the filter on a Planar YUV picture
+ *****************************************************************************/
+static picture_t *FilterPlanar( filter_t *p_filter, picture_t *p_pic )
+{
+    picture_t *p_outpic = filter_NewPicture( p_filter );
+    if( p_outpic )
+    {
+        PreparePlanar( p_filter );
+        filter_SliceVideo( p_filter, p_outpic, p_pic );
+        picture_CopyProperties( p_outpic, p_pic );
+    }
+    picture_Release( p_pic );
+    return p_outpic;
+}
+
+static void FilterPlanarSlice( filter_t *p_filter, picture_t *p_dst,
+                               const picture_t *p_src,
+                               unsigned first, unsigned count )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+    const int *pi_luma = p_sys->planar.pi_luma;
+    picture_t band_in = { 0 }, band_out = { 0 };
+    picture_t *p_pic = &band_in, *p_outpic = &band_out;
+
+    GetPlanarBand( p_pic, p_src, first, count );
+    GetPlanarBand( p_outpic, p_dst, first, count );
+
     /*
      * Do the Y plane
      */
-    if ( b_16bit )
+    if ( p_sys->planar.b_16bit )
     {
         uint16_t *p_in, *p_in_end, *p_line_end;
         uint16_t *p_out;
@@ -402,26 +477,21 @@ static void FilterPlanar( filter_t *p_filter, picture_t *p_pic, picture_t *p_out
      * Do the U and V planes
      */
 
-    int i_sin = sinf(f_hue) * f_max;
-    int i_cos = cosf(f_hue) * f_max;
-
-    /* pow(2, (bpp * 2) - 1) */
-    int i_x = ( cosf(f_hue) + sinf(f_hue) ) * f_range * i_mid;
-    int i_y = ( cosf(f_hue) - sinf(f_hue) ) * f_range * i_mid;
-
-    if ( i_sat > i_range )
+    if ( p_sys->planar.b_clip )
     {
         /* Currently no errors are implemented in the function, if any are added
          * check them here */
-        p_sys->pf_process_sat_hue_clip( p_pic, p_outpic, i_sin, i_cos, i_sat,
-                                        i_x, i_y );
+        p_sys->pf_process_sat_hue_clip( p_pic, p_outpic, p_sys->planar.i_sin,
+                                        p_sys->planar.i_cos, p_sys->planar.i_sat,
+                                        p_sys->planar.i_x, p_sys->planar.i_y );
     }
     else
     {
         /* Currently no errors are implemented in the function, if any are added
          * check them here */
-        p_sys->pf_process_sat_hue( p_pic, p_outpic, i_sin, i_cos, i_sat,
-                                        i_x, i_y );
+        p_sys->pf_process_sat_hue( p_pic, p_outpic, p_sys->planar.i_sin,
+                                   p_sys->planar.i_cos, p_sys->planar.i_sat,
+                                   p_sys->planar.i_x, p_sys->planar.i_y );
     }
 }
 
@@ -57,13 +57,14 @@
  *     filter strengths, especially for pixels whose U and/or V values are
  *     far away from the origin (which is at 128 in uint8 format).
  *
+ * @param p_filter The filter instance, for its pixel kernels.
  * @param p_dst Input/output picture. Will be modified in-place.
  * @param i_field Darken which field? 0 = top, 1 = bottom.
  * @param i_strength Strength of effect: 1, 2 or 3 (division by 2, 4 or 8).
  * @see RenderPhosphor()
  * @see ComposeFrame()
  */
-static void DarkenField( picture_t *p_dst,
+static void DarkenField( filter_t *p_filter, picture_t *p_dst,
                          const int i_field, const int i_strength,
                          bool process_chroma )
 {
@@ -71,22 +72,17 @@ static void DarkenField( picture_t *p_dst,
     assert( i_field == 0 || i_field == 1 );
     assert( i_strength >= 1 && i_strength <= 3 );
 
-    /* Bitwise ANDing with this clears the i_strength highest bits
-       of each byte */
-    const uint8_t  remove_high_u8 = 0xFF >> i_strength;
-    const uint64_t remove_high_u64 = remove_high_u8 *
-                                            INT64_C(0x0101010101010101);
+    filter_sys_t *p_sys = p_filter->p_sys;
+    const deinterlace_kernels_t *kernels = p_sys->kernels;
+    const unsigned i_pixel_size = p_sys->chroma->pixel_size;
 
     /* Process luma.
 
-       For luma, the operation is just a shift + bitwise AND, so we vectorize
-       even in the C version.
-
-       There are SIMD versions too, which perform significantly faster.
+       For luma, the operation is just a shift.
     */
     int i_plane = Y_PLANE;
     uint8_t *p_out, *p_out_end;
-    int w = p_dst->p[i_plane].i_visible_pitch;
+    int w = p_dst->p[i_plane].i_visible_pitch / i_pixel_size;
     p_out = p_dst->p[i_plane].p_pixels;
     p_out_end = p_out + p_dst->p[i_plane].i_pitch
                       * p_dst->p[i_plane].i_visible_lines;
@@ -95,35 +91,23 @@ static void DarkenField( picture_t *p_dst,
     if( i_field == 1 )
         p_out += p_dst->p[i_plane].i_pitch;
 
-    int wm8 = w % 8;   /* remainder */
-    int w8  = w - wm8; /* part of width that is divisible by 8 */
     for( ; p_out < p_out_end ; p_out += 2*p_dst->p[i_plane].i_pitch )
-    {
-        uint64_t *po = (uint64_t *)p_out;
-        int x = 0;
-
-        for( ; x < w8; x += 8, ++po )
-            (*po) = ( ((*po) >> i_strength) & remove_high_u64 );
-
-        /* handle the width remainder */
-        uint8_t *po_temp = (uint8_t *)po;
-        for( ; x < w; ++x, ++po_temp )
-            (*po_temp) = ( ((*po_temp) >> i_strength) & remove_high_u8 );
-    }
+        kernels->darken_luma( p_out, w, i_strength );
 
     /* Process chroma if the field chromas are independent.
 
-       The origin (black) is at YUV = (0, 128, 128) in the uint8 format.
-       The chroma processing is a bit more complicated than luma,
-       and needs SIMD for vectorization.
+       The origin (black) is at YUV = (0, 128, 128) in the uint8 format,
+       and at the middle of the range for higher bit depths.
     */
     if( process_chroma )
     {
+        const int i_mid = 1 << (p_sys->chroma->pixel_bits - 1);
+
         for( i_plane++ /* luma already handled*/;
              i_plane < p_dst->i_planes;
              i_plane++ )
         {
-            w = p_dst->p[i_plane].i_visible_pitch;
+            w = p_dst->p[i_plane].i_visible_pitch / i_pixel_size;
             p_out = p_dst->p[i_plane].p_pixels;
             p_out_end = p_out + p_dst->p[i_plane].i_pitch
                               * p_dst->p[i_plane].i_visible_lines;
@@ -133,12 +117,7 @@ static void DarkenField( picture_t *p_dst,
                 p_out += p_dst->p[i_plane].i_pitch;
 
             for( ; p_out < p_out_end ; p_out += 2*p_dst->p[i_plane].i_pitch )
-            {
-                /* Handle the width remainder */
-                uint8_t *po = p_out;
-                for( int x = 0; x < w; ++x, ++po )
-                    (*po) = 128 + ( ((*po) - 128) / (1 << i_strength) );
-            } /* for p_out... */
+                kernels->darken_chroma( p_out, w, i_strength, i_mid );
         } /* for i_plane... */
     } /* if process_chroma */
 }
@@ -229,7 +208,8 @@ int RenderPhosphor( filter_t *p_filter,
     */
     if( p_sys->phosphor.i_dimmer_strength > 0 )
     {
-            DarkenField( p_dst, !i_field, p_sys->phosphor.i_dimmer_strength,
+            DarkenField( p_filter, p_dst, !i_field,
+                p_sys->phosphor.i_dimmer_strength,
                 p_sys->chroma->p[1].h.num == p_sys->chroma->p[1].h.den &&
                 p_sys->chroma->p[2].h.num == p_sys->chroma->p[2].h.den );
     }
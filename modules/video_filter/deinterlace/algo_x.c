@@ -38,136 +38,38 @@
  * Internal functions
  *****************************************************************************/
 
-/* XDeint8x8Detect: detect if a 8x8 block is interlaced.
- * XXX: It need to access to 8x10
- * We use more than 8 lines to help with scrolling (text)
- * (and because XDeint8x8Frame use line 9)
- * XXX: smooth/uniform area with noise detection doesn't works well
- * but it's not really a problem because they don't have much details anyway
+/* The 8x8 block routines are pixel kernels, see kernels.h:
+ *  - x_detect: detects if a 8x8 block is interlaced. It needs to access 8x10
+ *    pixels: we use more than 8 lines to help with scrolling (text), and
+ *    because the merge uses line 9.
+ *    Smooth/uniform areas with noise are not detected well, but it's not
+ *    really a problem because they don't have much details anyway.
+ *  - x_merge: small (1,6,1) blend for progressive blocks.
+ *  - x_field_e: stupid deinterlacing (1,0,1) for blocks that miss a
+ *    neighbour. TODO: a better one for the inner part.
+ *  - x_field: edge oriented interpolation, needs -4 and +5 pixels
+ *    horizontally and +1 line.
  */
 static inline int ssd( int a ) { return a*a; }
-static inline int XDeint8x8DetectC( uint8_t *src, int i_src )
-{
-    int y, x;
-    int ff, fr;
-    int fc;
-
-    /* Detect interlacing */
-    fc = 0;
-    for( y = 0; y < 7; y += 2 )
-    {
-        ff = fr = 0;
-        for( x = 0; x < 8; x++ )
-        {
-            fr += ssd(src[      x] - src[1*i_src+x]) +
-                  ssd(src[i_src+x] - src[2*i_src+x]);
-            ff += ssd(src[      x] - src[2*i_src+x]) +
-                  ssd(src[i_src+x] - src[3*i_src+x]);
-        }
-        if( ff < 6*fr/8 && fr > 32 )
-            fc++;
-
-        src += 2*i_src;
-    }
-
-    return fc < 1 ? false : true;
-}
-
-static inline void XDeint8x8MergeC( uint8_t *dst,  int i_dst,
-                                    uint8_t *src1, int i_src1,
-                                    uint8_t *src2, int i_src2 )
-{
-    int y, x;
-
-    /* Progressive */
-    for( y = 0; y < 8; y += 2 )
-    {
-        memcpy( dst, src1, 8 );
-        dst  += i_dst;
-
-        for( x = 0; x < 8; x++ )
-            dst[x] = (src1[x] + 6*src2[x] + src1[i_src1+x] + 4 ) >> 3;
-        dst += i_dst;
-
-        src1 += i_src1;
-        src2 += i_src2;
-    }
-}
 
-/* XDeint8x8FieldE: Stupid deinterlacing (1,0,1) for block that miss a
- * neighbour
- * (Use 8x9 pixels)
- * TODO: a better one for the inner part.
- */
-static inline void XDeint8x8FieldEC( uint8_t *dst, int i_dst,
-                                     uint8_t *src, int i_src )
+static inline int GetPixel( const uint8_t *p, int i, unsigned size )
 {
-    int y, x;
-
-    /* Interlaced */
-    for( y = 0; y < 8; y += 2 )
-    {
-        memcpy( dst, src, 8 );
-        dst += i_dst;
-
-        for( x = 0; x < 8; x++ )
-            dst[x] = (src[x] + src[2*i_src+x] ) >> 1;
-        dst += 1*i_dst;
-        src += 2*i_src;
-    }
+    return size == 1 ? p[i] : ((const uint16_t *)p)[i];
 }
 
-/* XDeint8x8Field: Edge oriented interpolation
- * (Need -4 and +5 pixels H, +1 line)
- */
-static inline void XDeint8x8FieldC( uint8_t *dst, int i_dst,
-                                    uint8_t *src, int i_src )
+static inline void SetPixel( uint8_t *p, int i, int v, unsigned size )
 {
-    int y, x;
-
-    /* Interlaced */
-    for( y = 0; y < 8; y += 2 )
-    {
-        memcpy( dst, src, 8 );
-        dst += i_dst;
-
-        for( x = 0; x < 8; x++ )
-        {
-            uint8_t *src2 = &src[2*i_src];
-            /* I use 8 pixels just to match the SIMD version, but it's overkill
-             * 5 would be enough (less isn't good) */
-            const int c0 = abs(src[x-4]-src2[x-2]) + abs(src[x-3]-src2[x-1]) +
-                           abs(src[x-2]-src2[x+0]) + abs(src[x-1]-src2[x+1]) +
-                           abs(src[x+0]-src2[x+2]) + abs(src[x+1]-src2[x+3]) +
-                           abs(src[x+2]-src2[x+4]) + abs(src[x+3]-src2[x+5]);
-
-            const int c1 = abs(src[x-3]-src2[x-3]) + abs(src[x-2]-src2[x-2]) +
-                           abs(src[x-1]-src2[x-1]) + abs(src[x+0]-src2[x+0]) +
-                           abs(src[x+1]-src2[x+1]) + abs(src[x+2]-src2[x+2]) +
-                           abs(src[x+3]-src2[x+3]) + abs(src[x+4]-src2[x+4]);
-
-            const int c2 = abs(src[x-2]-src2[x-4]) + abs(src[x-1]-src2[x-3]) +
-                           abs(src[x+0]-src2[x-2]) + abs(src[x+1]-src2[x-1]) +
-                           abs(src[x+2]-src2[x+0]) + abs(src[x+3]-src2[x+1]) +
-                           abs(src[x+4]-src2[x+2]) + abs(src[x+5]-src2[x+3]);
-
-            if( c0 < c1 && c1 <= c2 )
-                dst[x] = (src[x-1] + src2[x+1]) >> 1;
-            else if( c2 < c1 && c1 <= c0 )
-                dst[x] = (src[x+1] + src2[x-1]) >> 1;
-            else
-                dst[x] = (src[x+0] + src2[x+0]) >> 1;
-        }
-
-        dst += 1*i_dst;
-        src += 2*i_src;
-    }
+    if( size == 1 )
+        p[i] = v;
+    else
+        ((uint16_t *)p)[i] = v;
 }
 
 /* NxN arbitray size (and then only use pixel in the NxN block)
  */
-static inline int XDeintNxNDetect( uint8_t *src, int i_src,
-                                   int i_height, int i_width )
+static inline int XDeintNxNDetect( const uint8_t *src, int i_src,
+                                   int i_height, int i_width,
+                                   unsigned size, int i_shift )
 {
     int y, x;
     int ff, fr;
@@ -183,10 +85,10 @@ static inline int XDeintNxNDetect( uint8_t *src, int i_src,
         const uint8_t *s = &src[y*i_src];
         for( x = 0; x < i_width; x++ )
         {
-            fr += ssd(s[      x] - s[1*i_src+x]);
-            ff += ssd(s[      x] - s[2*i_src+x]);
+            fr += ssd(GetPixel(s, x, size) - GetPixel(s + i_src, x, size));
+            ff += ssd(GetPixel(s, x, size) - GetPixel(s + 2*i_src, x, size));
         }
-        if( ff < fr && fr > i_width / 2 )
+        if( ff < fr && fr > (i_width / 2) << i_shift )
             fc++;
     }
 
@@ -194,27 +96,32 @@ static inline int XDeintNxNDetect( uint8_t *src, int i_src,
 }
 
 static inline void XDeintNxNFrame( uint8_t *dst, int i_dst,
-                                   uint8_t *src, int i_src,
-                                   int i_width, int i_height )
+                                   const uint8_t *src, int i_src,
+                                   int i_width, int i_height, unsigned size )
 {
     int y, x;
 
     /* Progressive */
     for( y = 0; y < i_height; y += 2 )
     {
-        memcpy( dst, src, i_width );
+        memcpy( dst, src, i_width * size );
         dst += i_dst;
 
         if( y < i_height - 2 )
         {
             for( x = 0; x < i_width; x++ )
-                dst[x] = (src[x] + 2*src[1*i_src+x] + src[2*i_src+x] + 2 ) >> 2;
+                SetPixel( dst, x, (GetPixel(src, x, size)
+                                   + 2*GetPixel(src + i_src, x, size)
+                                   + GetPixel(src + 2*i_src, x, size) + 2 ) >> 2,
+                          size );
         }
         else
         {
             /* Blend last line */
             for( x = 0; x < i_width; x++ )
-                dst[x] = (src[x] + src[1*i_src+x] ) >> 1;
+                SetPixel( dst, x, (GetPixel(src, x, size)
+                                   + GetPixel(src + i_src, x, size) ) >> 1,
+                          size );
         }
         dst += 1*i_dst;
         src += 2*i_src;
@@ -222,73 +129,80 @@ static inline void XDeintNxNFrame( uint8_t *dst, int i_dst,
 }
 
 static inline void XDeintNxNField( uint8_t *dst, int i_dst,
-                                   uint8_t *src, int i_src,
-                                   int i_width, int i_height )
+                                   const uint8_t *src, int i_src,
+                                   int i_width, int i_height, unsigned size )
 {
     int y, x;
 
     /* Interlaced */
     for( y = 0; y < i_height; y += 2 )
     {
-        memcpy( dst, src, i_width );
+        memcpy( dst, src, i_width * size );
         dst += i_dst;
 
         if( y < i_height - 2 )
         {
             for( x = 0; x < i_width; x++ )
-                dst[x] = (src[x] + src[2*i_src+x] ) >> 1;
+                SetPixel( dst, x, (GetPixel(src, x, size)
+                                   + GetPixel(src + 2*i_src, x, size) ) >> 1,
+                          size );
         }
         else
         {
             /* Blend last line */
             for( x = 0; x < i_width; x++ )
-                dst[x] = (src[x] + src[i_src+x]) >> 1;
+                SetPixel( dst, x, (GetPixel(src, x, size)
+                                   + GetPixel(src + i_src, x, size) ) >> 1,
+                          size );
         }
         dst += 1*i_dst;
         src += 2*i_src;
     }
 }
 
-static inline void XDeintNxN( uint8_t *dst, int i_dst, uint8_t *src, int i_src,
-                              int i_width, int i_height )
+static inline void XDeintNxN( uint8_t *dst, int i_dst,
+                              const uint8_t *src, int i_src,
+                              int i_width, int i_height,
+                              unsigned size, int i_shift )
 {
-    if( XDeintNxNDetect( src, i_src, i_width, i_height ) )
-        XDeintNxNField( dst, i_dst, src, i_src, i_width, i_height );
+    if( XDeintNxNDetect( src, i_src, i_width, i_height, size, i_shift ) )
+        XDeintNxNField( dst, i_dst, src, i_src, i_width, i_height, size );
     else
-        XDeintNxNFrame( dst, i_dst, src, i_src, i_width, i_height );
+        XDeintNxNFrame( dst, i_dst, src, i_src, i_width, i_height, size );
 }
 
 /* XDeintBand8x8:
  */
-static inline void XDeintBand8x8C( uint8_t *dst, int i_dst,
-                                   uint8_t *src, int i_src,
-                                   const int i_mbx, int i_modx )
+static inline void XDeintBand8x8( const deinterlace_kernels_t *kernels,
+                                  uint8_t *dst, int i_dst,
+                                  const uint8_t *src, int i_src,
+                                  const int i_mbx, int i_modx,
+                                  unsigned size, int i_shift )
 {
+    /* 32 for 8-bit pixels */
+    const int i_threshold = 32 << i_shift;
     int x;
 
     for( x = 0; x < i_mbx; x++ )
     {
-        int s;
-        if( ( s = XDeint8x8DetectC( src, i_src ) ) )
+        if( kernels->x_detect( src, i_src, i_threshold ) )
         {
             if( x == 0 || x == i_mbx - 1 )
-                XDeint8x8FieldEC( dst, i_dst, src, i_src );
+                kernels->x_field_e( dst, i_dst, src, i_src );
             else
-                XDeint8x8FieldC( dst, i_dst, src, i_src );
+                kernels->x_field( dst, i_dst, src, i_src );
         }
         else
         {
-            XDeint8x8MergeC( dst, i_dst,
-                             &src[0*i_src], 2*i_src,
-                             &src[1*i_src], 2*i_src );
+            kernels->x_merge( dst, i_dst, src, i_src );
         }
 
-        dst += 8;
-        src += 8;
+        dst += 8 * size;
+        src += 8 * size;
     }
 
     if( i_modx )
-        XDeintNxN( dst, i_dst, src, i_src, i_modx, 8 );
+        XDeintNxN( dst, i_dst, src, i_src, i_modx, 8, size, i_shift );
 }
 
 /*****************************************************************************
@@ -297,17 +211,21 @@ static inline void XDeintBand8x8C( uint8_t *dst, int i_dst,
 
 int RenderX( filter_t *p_filter, picture_t *p_outpic, picture_t *p_pic )
 {
-    VLC_UNUSED(p_filter);
+    filter_sys_t *p_sys = p_filter->p_sys;
+    const unsigned size = p_sys->chroma->pixel_size;
+    /* Squared differences scale with the square of the pixel range */
+    const int i_shift = 2 * (p_sys->chroma->pixel_bits - 8);
     int i_plane;
 
     /* Copy image and skip lines */
     for( i_plane = 0 ; i_plane < p_pic->i_planes ; i_plane++ )
     {
+        const int i_width = p_outpic->p[i_plane].i_visible_pitch / size;
         const int i_mby = ( p_outpic->p[i_plane].i_visible_lines + 7 )/8 - 1;
-        const int i_mbx = p_outpic->p[i_plane].i_visible_pitch/8;
+        const int i_mbx = i_width/8;
 
         const int i_mody = p_outpic->p[i_plane].i_visible_lines - 8*i_mby;
-        const int i_modx = p_outpic->p[i_plane].i_visible_pitch - 8*i_mbx;
+        const int i_modx = i_width - 8*i_mbx;
 
         const int i_dst = p_outpic->p[i_plane].i_pitch;
         const int i_src = p_pic->p[i_plane].i_pitch;
@@ -317,27 +235,29 @@ int RenderX( filter_t *p_filter, picture_t *p_outpic, picture_t *p_pic )
         for( y = 0; y < i_mby; y++ )
         {
             uint8_t *dst = &p_outpic->p[i_plane].p_pixels[8*y*i_dst];
-            uint8_t *src = &p_pic->p[i_plane].p_pixels[8*y*i_src];
+            const uint8_t *src = &p_pic->p[i_plane].p_pixels[8*y*i_src];
 
-            XDeintBand8x8C( dst, i_dst, src, i_src, i_mbx, i_modx );
+            XDeintBand8x8( p_sys->kernels, dst, i_dst, src, i_src,
+                           i_mbx, i_modx, size, i_shift );
         }
 
         /* Last line (C only)*/
         if( i_mody )
         {
             uint8_t *dst = &p_outpic->p[i_plane].p_pixels[8*y*i_dst];
-            uint8_t *src = &p_pic->p[i_plane].p_pixels[8*y*i_src];
+            const uint8_t *src = &p_pic->p[i_plane].p_pixels[8*y*i_src];
 
             for( x = 0; x < i_mbx; x++ )
             {
-                XDeintNxN( dst, i_dst, src, i_src, 8, i_mody );
+                XDeintNxN( dst, i_dst, src, i_src, 8, i_mody, size, i_shift );
 
-                dst += 8;
-                src += 8;
+                dst += 8 * size;
+                src += 8 * size;
             }
 
             if( i_modx )
-                XDeintNxN( dst, i_dst, src, i_src, i_modx, i_mody );
+                XDeintNxN( dst, i_dst, src, i_src, i_modx, i_mody,
+                           size, i_shift );
         }
     }
 
@@ -337,31 +337,34 @@ struct filter_mode_t
     };
     deinterlace_algo     settings;
     bool                 can_pack;         /**< can handle packed pixel */
-    bool                 b_high_bit_depth; /**< can handle high bit depth */
+    unsigned             i_max_bits;       /**< highest bit depth handled */
 };
 static struct filter_mode_t filter_mode [] = {
     { "discard", .pf_render_single_pic = RenderDiscard,
-                 { false, false, false, true }, true, true },
+                 { false, false, false, true }, true, 16 },
     { "bob", .pf_render_ordered = RenderBob,
-                 { true, false, false, false }, true, true },
+                 { true, false, false, false }, true, 16 },
     { "progressive-scan", .pf_render_ordered = RenderBob,
-                 { true, false, false, false }, true, true },
+                 { true, false, false, false }, true, 16 },
     { "linear", .pf_render_ordered = RenderLinear,
-                 { true, false, false, false }, true, true },
+                 { true, false, false, false }, true, 16 },
     { "mean", .pf_render_single_pic = RenderMean,
-                 { false, false, false, true }, true, true },
+                 { false, false, false, true }, true, 16 },
     { "blend", .pf_render_single_pic = RenderBlend,
-                 { false, false, false, false }, true, true },
+                 { false, false, false, false }, true, 16 },
     { "yadif", .pf_render_single_pic = RenderYadifSingle,
-                 { false, true, false, false }, false, true },
+                 { false, true, false, false }, false, 16 },
     { "yadif2x", .pf_render_ordered = RenderYadif,
-                 { true, true, false, false }, false, true },
+                 { true, true, false, false }, false, 16 },
     { "x", .pf_render_single_pic = RenderX,
-                 { false, false, false, false }, false, false },
+                 { false, false, false, false }, false,
+                 DEINTERLACE_KERNELS_MAX_BITS },
     { "phosphor", .pf_render_ordered = RenderPhosphor,
-                 { true, true, false, false }, false, false },
+                 { true, true, false, false }, false,
+                 DEINTERLACE_KERNELS_MAX_BITS },
     { "ivtc", .pf_render_single_pic = RenderIVTC,
-                 { false, true, true, false }, false, false },
+                 { false, true, true, false }, false,
+                 DEINTERLACE_KERNELS_MAX_BITS },
 };
 
 /**
@@ -390,7 +393,7 @@ static int SetFilterMethod( filter_t *p_filter, const char *mode, bool pack )
                         " for packed format", mode );
                 return SetFilterMethod( p_filter, "blend", pack );
             }
-            if( p_sys->chroma->pixel_size > 1 && !filter_mode[i].b_high_bit_depth )
+            if( p_sys->chroma->pixel_bits > filter_mode[i].i_max_bits )
             {
                 msg_Err( p_filter, "unknown or incompatible deinterlace mode \"%s\""
                         " for high depth format", mode );
@@ -587,6 +590,9 @@ notsupp:
 #endif
     }
 
+    p_sys->kernels = DeinterlaceKernels( pixel_size );
+    msg_Dbg( p_filter, "using %s pixel kernels", p_sys->kernels->psz_name );
+
     /* */
     video_format_t fmt;
     GetOutputFormat( p_filter, &fmt, &p_filter->fmt_in.video );
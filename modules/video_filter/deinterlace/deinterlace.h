@@ -42,6 +42,7 @@ struct vlc_object_t;
 #include "algo_phosphor.h"
 #include "algo_ivtc.h"
 #include "common.h"
+#include "kernels.h"
 
 /*****************************************************************************
  * Local data
@@ -74,6 +75,8 @@ typedef struct
     /** Merge finalization routine for SSE */
     void (*pf_end_merge) ( void );
 #endif
+    /** X, Phosphor and IVTC pixel kernels: C, SSE4.1, AVX2, NEON */
+    const deinterlace_kernels_t *kernels;
 
     struct deinterlace_ctx   context;
 
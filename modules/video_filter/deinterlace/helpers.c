@@ -89,6 +89,7 @@ static void FieldFromPlane( plane_t *p_dst, const plane_t *p_src, int i_field )
         p_dst->p_pixels += p_src->i_pitch;
 }
 
+/* Pixel luma/chroma difference threshold to detect motion, for 8 bits. */
 #define T 10
 /**
  * Internal helper function for EstimateNumBlocksWithMotion():
@@ -102,6 +103,8 @@ static void FieldFromPlane( plane_t *p_dst, const plane_t *p_src, int i_field )
  * For interpretation of pi_top and pi_bot, it is assumed that the block
  * starts on an even-numbered line (belonging to the top field).
  *
+ * @param kernels Pixel kernels
+ * @param i_threshold Pixel difference threshold, scaled to the bit depth
  * @param[in] p_pix_p Base pointer to the block in previous picture
  * @param[in] p_pix_c Base pointer to the same block in current picture
  * @param i_pitch_prev i_pitch of previous picture
@@ -111,39 +114,27 @@ static void FieldFromPlane( plane_t *p_dst, const plane_t *p_src, int i_field )
  * @return 1 if the block had motion, 0 if no
  * @see EstimateNumBlocksWithMotion()
  */
-static int TestForMotionInBlock( uint8_t *p_pix_p, uint8_t *p_pix_c,
+static int TestForMotionInBlock( const deinterlace_kernels_t *kernels,
+                                 int i_threshold,
+                                 const uint8_t *p_pix_p, const uint8_t *p_pix_c,
                                  int i_pitch_prev, int i_pitch_curr,
                                  int* pi_top, int* pi_bot )
 {
-/* Pixel luma/chroma difference threshold to detect motion. */
-
     int32_t i_motion = 0;
     int32_t i_top_motion = 0;
     int32_t i_bot_motion = 0;
+    int pi_scores[8];
+
+    kernels->motion_block( p_pix_p, i_pitch_prev, p_pix_c, i_pitch_curr,
+                           i_threshold, pi_scores );
 
     for( int y = 0; y < 8; ++y )
     {
-        uint8_t *pc = p_pix_c;
-        uint8_t *pp = p_pix_p;
-        int score = 0;
-        for( int x = 0; x < 8; ++x )
-        {
-            int_fast16_t C = abs((*pc) - (*pp));
-            if( C > T )
-                ++score;
-
-            ++pc;
-            ++pp;
-        }
-
-        i_motion += score;
+        i_motion += pi_scores[y];
         if( y % 2 == 0 )
-            i_top_motion += score;
+            i_top_motion += pi_scores[y];
         else
-            i_bot_motion += score;
-
-        p_pix_c += i_pitch_curr;
-        p_pix_p += i_pitch_prev;
+            i_bot_motion += pi_scores[y];
     }
 
     /* Field motion thresholds.
@@ -164,7 +155,6 @@ static int TestForMotionInBlock( uint8_t *p_pix_p, uint8_t *p_pix_c,
        changes "enough". */
     return (i_motion >= 8);
 }
-#undef T
 
 /*****************************************************************************
  * Public functions
@@ -300,10 +290,12 @@ void ComposeFrame( filter_t *p_filter,
 }
 
 /* See header for function doc. */
-int EstimateNumBlocksWithMotion( const picture_t* p_prev,
+int EstimateNumBlocksWithMotion( filter_t *p_filter,
+                                 const picture_t* p_prev,
                                  const picture_t* p_curr,
                                  int *pi_top, int *pi_bot)
 {
+    filter_sys_t *p_sys = p_filter->p_sys;
     assert( p_prev != NULL );
     assert( p_curr != NULL );
 
@@ -313,8 +305,8 @@ int EstimateNumBlocksWithMotion( const picture_t* p_prev,
     if( p_prev->i_planes != p_curr->i_planes )
         return -1;
 
-    int (*motion_in_block)(uint8_t *, uint8_t *, int , int, int *, int *) =
-        TestForMotionInBlock;
+    const unsigned i_pixel_size = p_sys->chroma->pixel_size;
+    const int i_threshold = T << (p_sys->chroma->pixel_bits - 8);
 
     int i_score = 0;
     for( int i_plane = 0 ; i_plane < p_prev->i_planes ; i_plane++ )
@@ -331,7 +323,8 @@ int EstimateNumBlocksWithMotion( const picture_t* p_prev,
            Shouldn't really matter for our purposes. */
         const int i_mby = p_prev->p[i_plane].i_visible_lines / 8;
         const int w = FFMIN( p_prev->p[i_plane].i_visible_pitch,
-                             p_curr->p[i_plane].i_visible_pitch );
+                             p_curr->p[i_plane].i_visible_pitch )
+                    / i_pixel_size;
         const int i_mbx = w / 8;
 
         for( int by = 0; by < i_mby; ++by )
@@ -342,14 +335,15 @@ int EstimateNumBlocksWithMotion( const picture_t* p_prev,
             for( int bx = 0; bx < i_mbx; ++bx )
             {
                 int i_top_temp, i_bot_temp;
-                i_score += motion_in_block( p_pix_p, p_pix_c,
-                                            i_pitch_prev, i_pitch_curr,
-                                            &i_top_temp, &i_bot_temp );
+                i_score += TestForMotionInBlock( p_sys->kernels, i_threshold,
+                                                 p_pix_p, p_pix_c,
+                                                 i_pitch_prev, i_pitch_curr,
+                                                 &i_top_temp, &i_bot_temp );
                 i_score_top += i_top_temp;
                 i_score_bot += i_bot_temp;
 
-                p_pix_p += 8;
-                p_pix_c += 8;
+                p_pix_p += 8 * i_pixel_size;
+                p_pix_c += 8 * i_pixel_size;
             }
         }
     }
@@ -362,11 +356,14 @@ int EstimateNumBlocksWithMotion( const picture_t* p_prev,
     return i_score;
 }
 
+#undef T
+
 /* Threshold (value from Transcode 1.1.5) */
 #define T 100
 
 /* See header for function doc. */
-int CalculateInterlaceScore( const picture_t* p_pic_top,
+int CalculateInterlaceScore( filter_t *p_filter,
+                             const picture_t* p_pic_top,
                              const picture_t* p_pic_bot )
 {
     /*
@@ -385,6 +382,10 @@ int CalculateInterlaceScore( const picture_t* p_pic_top,
     if( p_pic_top->i_planes != p_pic_bot->i_planes )
         return -1;
 
+    filter_sys_t *p_sys = p_filter->p_sys;
+    const unsigned i_pixel_size = p_sys->chroma->pixel_size;
+    /* The comb metric is a product of two pixel differences */
+    const int i_threshold = T << (2 * (p_sys->chroma->pixel_bits - 8));
     int32_t i_score = 0;
 
     for( int i_plane = 0 ; i_plane < p_pic_top->i_planes ; ++i_plane )
@@ -396,7 +397,8 @@ int CalculateInterlaceScore( const picture_t* p_pic_top,
 
         const int i_lasty = p_pic_top->p[i_plane].i_visible_lines-1;
         const int w = FFMIN( p_pic_top->p[i_plane].i_visible_pitch,
-                             p_pic_bot->p[i_plane].i_visible_pitch );
+                             p_pic_bot->p[i_plane].i_visible_pitch )
+                    / i_pixel_size;
 
         /* Current line / neighbouring lines picture pointers */
         const picture_t *cur = p_pic_bot;
@@ -410,34 +412,21 @@ int CalculateInterlaceScore( const picture_t* p_pic_top,
         */
         for( int y = 1; y < i_lasty; ++y )
         {
-            uint8_t *p_c = &cur->p[i_plane].p_pixels[y*wc];     /* this line */
-            uint8_t *p_p = &ngh->p[i_plane].p_pixels[(y-1)*wn]; /* prev line */
-            uint8_t *p_n = &ngh->p[i_plane].p_pixels[(y+1)*wn]; /* next line */
-
-            for( int x = 0; x < w; ++x )
-            {
-                /* Worst case: need 17 bits for "comb". */
-                int_fast32_t C = *p_c;
-                int_fast32_t P = *p_p;
-                int_fast32_t N = *p_n;
-
-                /* Comments in Transcode's filter_ivtc.c attribute this
-                   combing metric to Gunnar Thalin.
-
-                    The idea is that if the picture is interlaced, both
-                    expressions will have the same sign, and this comes
-                    up positive. The value T = 100 has been chosen such
-                    that a pixel difference of 10 (on average) will
-                    trigger the detector.
-                */
-                int_fast32_t comb = (P - C) * (N - C);
-                if( comb > T )
-                    ++i_score;
-
-                ++p_c;
-                ++p_p;
-                ++p_n;
-            }
+            const uint8_t *p_c = &cur->p[i_plane].p_pixels[y*wc];     /* this line */
+            const uint8_t *p_p = &ngh->p[i_plane].p_pixels[(y-1)*wn]; /* prev line */
+            const uint8_t *p_n = &ngh->p[i_plane].p_pixels[(y+1)*wn]; /* next line */
+
+            /* Comments in Transcode's filter_ivtc.c attribute this
+               combing metric to Gunnar Thalin.
+
+                The idea is that if the picture is interlaced, both
+                expressions will have the same sign, and this comes
+                up positive. The value T = 100 has been chosen such
+                that a pixel difference of 10 (on average) will
+                trigger the detector.
+            */
+            i_score += p_sys->kernels->comb_line( p_c, p_p, p_n, w,
+                                                  i_threshold );
 
             /* Now the other field - swap current and neighbour pictures */
             const picture_t *tmp = cur;
@@ -0,0 +1,295 @@
+/*****************************************************************************
+ * kernels.c : C pixel kernels of the X, Phosphor and IVTC algorithms
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+#   include "config.h"
+#endif
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <vlc_common.h>
+#include <vlc_cpu.h>
+
+#include "kernels.h"
+
+/*****************************************************************************
+ * Pixel access
+ *****************************************************************************
+ * The kernels are written once for both pixel sizes; the size is a constant
+ * in each instance, so that the accessors are folded by the compiler.
+ *****************************************************************************/
+
+static inline int Get( const void *p, ptrdiff_t i, unsigned size )
+{
+    return size == 1 ? ((const uint8_t *)p)[i] : ((const uint16_t *)p)[i];
+}
+
+static inline void Set( void *p, ptrdiff_t i, int v, unsigned size )
+{
+    if( size == 1 )
+        ((uint8_t *)p)[i] = v;
+    else
+        ((uint16_t *)p)[i] = v;
+}
+
+static inline const void *Line( const void *p, ptrdiff_t pitch, int y )
+{
+    return (const uint8_t *)p + y * pitch;
+}
+
+static inline void *LineW( void *p, ptrdiff_t pitch, int y )
+{
+    return (uint8_t *)p + y * pitch;
+}
+
+static inline int ssd( int a ) { return a*a; }
+
+/*****************************************************************************
+ * X
+ *****************************************************************************/
+
+static inline int XDetect( const void *src, ptrdiff_t i_src, int i_threshold,
+                           unsigned size )
+{
+    int fc = 0;
+
+    for( int y = 0; y < 7; y += 2 )
+    {
+        const void *s0 = Line( src, i_src, y );
+        const void *s1 = Line( src, i_src, y + 1 );
+        const void *s2 = Line( src, i_src, y + 2 );
+        const void *s3 = Line( src, i_src, y + 3 );
+        int ff = 0, fr = 0;
+
+        for( int x = 0; x < 8; x++ )
+        {
+            fr += ssd(Get(s0, x, size) - Get(s1, x, size)) +
+                  ssd(Get(s1, x, size) - Get(s2, x, size));
+            ff += ssd(Get(s0, x, size) - Get(s2, x, size)) +
+                  ssd(Get(s1, x, size) - Get(s3, x, size));
+        }
+        if( ff < 6*fr/8 && fr > i_threshold )
+            fc++;
+    }
+
+    return fc > 0;
+}
+
+static inline void XMerge( void *dst, ptrdiff_t i_dst,
+                           const void *src, ptrdiff_t i_src, unsigned size )
+{
+    for( int y = 0; y < 8; y += 2 )
+    {
+        const void *s0 = Line( src, i_src, y );
+        const void *s1 = Line( src, i_src, y + 1 );
+        const void *s2 = Line( src, i_src, y + 2 );
+        void *d1 = LineW( dst, i_dst, y + 1 );
+
+        memcpy( LineW( dst, i_dst, y ), s0, 8 * size );
+        for( int x = 0; x < 8; x++ )
+            Set( d1, x, (Get(s0, x, size) + 6*Get(s1, x, size)
+                         + Get(s2, x, size) + 4) >> 3, size );
+    }
+}
+
+static inline void XFieldE( void *dst, ptrdiff_t i_dst,
+                            const void *src, ptrdiff_t i_src, unsigned size )
+{
+    for( int y = 0; y < 8; y += 2 )
+    {
+        const void *s0 = Line( src, i_src, y );
+        const void *s2 = Line( src, i_src, y + 2 );
+        void *d1 = LineW( dst, i_dst, y + 1 );
+
+        memcpy( LineW( dst, i_dst, y ), s0, 8 * size );
+        for( int x = 0; x < 8; x++ )
+            Set( d1, x, (Get(s0, x, size) + Get(s2, x, size)) >> 1, size );
+    }
+}
+
+static inline void XField( void *dst, ptrdiff_t i_dst,
+                           const void *src, ptrdiff_t i_src, unsigned size )
+{
+    for( int y = 0; y < 8; y += 2 )
+    {
+        const void *s = Line( src, i_src, y );
+        const void *s2 = Line( src, i_src, y + 2 );
+        void *d1 = LineW( dst, i_dst, y + 1 );
+
+        memcpy( LineW( dst, i_dst, y ), s, 8 * size );
+        for( int x = 0; x < 8; x++ )
+        {
+            /* Sum of absolute differences along the three directions */
+            int c0 = 0, c1 = 0, c2 = 0;
+
+            for( int k = -4; k < 4; k++ )
+            {
+                c0 += abs(Get(s, x+k,   size) - Get(s2, x+k+2, size));
+                c1 += abs(Get(s, x+k+1, size) - Get(s2, x+k+1, size));
+                c2 += abs(Get(s, x+k+2, size) - Get(s2, x+k,   size));
+            }
+
+            int v;
+            if( c0 < c1 && c1 <= c2 )
+                v = (Get(s, x-1, size) + Get(s2, x+1, size)) >> 1;
+            else if( c2 < c1 && c1 <= c0 )
+                v = (Get(s, x+1, size) + Get(s2, x-1, size)) >> 1;
+            else
+                v = (Get(s, x, size) + Get(s2, x, size)) >> 1;
+            Set( d1, x, v, size );
+        }
+    }
+}
+
+/*****************************************************************************
+ * Phosphor
+ *****************************************************************************/
+
+static inline void DarkenLuma( void *p, size_t i_width, int i_strength,
+                               unsigned size )
+{
+    for( size_t x = 0; x < i_width; x++ )
+        Set( p, x, Get(p, x, size) >> i_strength, size );
+}
+
+static inline void DarkenChroma( void *p, size_t i_width, int i_strength,
+                                 int i_mid, unsigned size )
+{
+    for( size_t x = 0; x < i_width; x++ )
+        Set( p, x, i_mid + (Get(p, x, size) - i_mid) / (1 << i_strength),
+             size );
+}
+
+/*****************************************************************************
+ * IVTC
+ *****************************************************************************/
+
+static inline unsigned CombLine( const void *cur, const void *prev,
+                                 const void *next, size_t i_width,
+                                 int i_threshold, unsigned size )
+{
+    unsigned i_score = 0;
+
+    for( size_t x = 0; x < i_width; x++ )
+    {
+        /* At most 25 bits for 12-bit pixels */
+        int_fast32_t C = Get( cur, x, size );
+        int_fast32_t P = Get( prev, x, size );
+        int_fast32_t N = Get( next, x, size );
+
+        if( (P - C) * (N - C) > i_threshold )
+            i_score++;
+    }
+    return i_score;
+}
+
+static inline void MotionBlock( const void *prev, ptrdiff_t i_prev,
+                                const void *cur, ptrdiff_t i_cur,
+                                int i_threshold, int pi_scores[8],
+                                unsigned size )
+{
+    for( int y = 0; y < 8; y++ )
+    {
+        const void *pp = Line( prev, i_prev, y );
+        const void *pc = Line( cur, i_cur, y );
+        int score = 0;
+
+        for( int x = 0; x < 8; x++ )
+            if( abs(Get(pc, x, size) - Get(pp, x, size)) > i_threshold )
+                score++;
+        pi_scores[y] = score;
+    }
+}
+
+/*****************************************************************************
+ * Instances
+ *****************************************************************************/
+
+#define KERNELS_C(bits, size) \
+static int XDetect##bits( const void *src, ptrdiff_t i_src, int i_threshold ) \
+{ \
+    return XDetect( src, i_src, i_threshold, size ); \
+} \
+static void XMerge##bits( void *dst, ptrdiff_t i_dst, \
+                          const void *src, ptrdiff_t i_src ) \
+{ \
+    XMerge( dst, i_dst, src, i_src, size ); \
+} \
+static void XFieldE##bits( void *dst, ptrdiff_t i_dst, \
+                           const void *src, ptrdiff_t i_src ) \
+{ \
+    XFieldE( dst, i_dst, src, i_src, size ); \
+} \
+static void XField##bits( void *dst, ptrdiff_t i_dst, \
+                          const void *src, ptrdiff_t i_src ) \
+{ \
+    XField( dst, i_dst, src, i_src, size ); \
+} \
+static void DarkenLuma##bits( void *p, size_t i_width, int i_strength ) \
+{ \
+    DarkenLuma( p, i_width, i_strength, size ); \
+} \
+static void DarkenChroma##bits( void *p, size_t i_width, int i_strength, \
+                                int i_mid ) \
+{ \
+    DarkenChroma( p, i_width, i_strength, i_mid, size ); \
+} \
+static unsigned CombLine##bits( const void *cur, const void *prev, \
+                                const void *next, size_t i_width, \
+                                int i_threshold ) \
+{ \
+    return CombLine( cur, prev, next, i_width, i_threshold, size ); \
+} \
+static void MotionBlock##bits( const void *prev, ptrdiff_t i_prev, \
+                               const void *cur, ptrdiff_t i_cur, \
+                               int i_threshold, int pi_scores[8] ) \
+{ \
+    MotionBlock( prev, i_prev, cur, i_cur, i_threshold, pi_scores, size ); \
+}
+
+KERNELS_C(8, 1)
+KERNELS_C(16, 2)
+
+const deinterlace_kernels_t deinterlace_kernels_c[2] = {
+    { "C", XDetect8, XMerge8, XFieldE8, XField8, DarkenLuma8, DarkenChroma8,
+      CombLine8, MotionBlock8 },
+    { "C", XDetect16, XMerge16, XFieldE16, XField16, DarkenLuma16,
+      DarkenChroma16, CombLine16, MotionBlock16 },
+};
+
+const deinterlace_kernels_t *DeinterlaceKernels( unsigned i_pixel_size )
+{
+    const unsigned i = i_pixel_size > 1;
+
+#ifdef DEINTERLACE_AVX2
+    if( vlc_CPU_AVX2() )
+        return &deinterlace_kernels_avx2[i];
+#endif
+#ifdef DEINTERLACE_SSE4_1
+    if( vlc_CPU_SSE4_1() )
+        return &deinterlace_kernels_sse4_1[i];
+#endif
+#ifdef CAN_COMPILE_ARM64
+    if( vlc_CPU_ARM_NEON() )
+        return &deinterlace_kernels_neon[i];
+#endif
+    return &deinterlace_kernels_c[i];
+}
@@ -0,0 +1,132 @@
+/*****************************************************************************
+ * kernels.h : pixel kernels of the X, Phosphor and IVTC algorithms
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef VLC_DEINTERLACE_KERNELS_H
+#define VLC_DEINTERLACE_KERNELS_H 1
+
+/**
+ * \file
+ * Pixel kernels of the X, Phosphor and IVTC algorithms, with a C reference
+ * implementation and SIMD versions, for 8-bit and high bit depth
+ * (up to 12 bits, stored in 16-bit words) pixels.
+ *
+ * All pitches are in bytes, all widths are in pixels.
+ * The SIMD versions must give the exact same results as the C ones.
+ */
+
+#include <stddef.h>
+
+/** Highest bit depth supported by the kernels */
+#define DEINTERLACE_KERNELS_MAX_BITS 12
+
+#if defined(HAVE_SSE2_INTRINSICS) && defined(CAN_COMPILE_SSE4_1)
+# define DEINTERLACE_SSE4_1 1
+#endif
+#if defined(DEINTERLACE_SSE4_1) && defined(HAVE_AVX2_INTRINSICS)
+# define DEINTERLACE_AVX2 1
+#endif
+
+typedef struct
+{
+    /** Name of the instruction set, for logs and tests */
+    const char *psz_name;
+
+    /**
+     * X: detects whether the 8x8 block at src is interlaced.
+     * Reads 8x10 pixels.
+     *
+     * @param i_threshold Minimum field difference (32 for 8-bit pixels)
+     */
+    int  (*x_detect)( const void *src, ptrdiff_t i_src, int i_threshold );
+
+    /**
+     * X: copies the even lines of an 8x8 block, and blends the odd lines
+     * with their neighbours (1,6,1). Reads 8x9 pixels.
+     */
+    void (*x_merge)( void *dst, ptrdiff_t i_dst,
+                     const void *src, ptrdiff_t i_src );
+
+    /**
+     * X: copies the even lines of an 8x8 block, and interpolates the odd
+     * lines (1,0,1). Reads 8x9 pixels.
+     */
+    void (*x_field_e)( void *dst, ptrdiff_t i_dst,
+                       const void *src, ptrdiff_t i_src );
+
+    /**
+     * X: copies the even lines of an 8x8 block, and interpolates the odd
+     * lines along edges. Reads 8x9 pixels, plus 4 on the left and 5 on the
+     * right of each line.
+     */
+    void (*x_field)( void *dst, ptrdiff_t i_dst,
+                     const void *src, ptrdiff_t i_src );
+
+    /**
+     * Phosphor: divides the luma of a line by 2^i_strength, in place.
+     */
+    void (*darken_luma)( void *p, size_t i_width, int i_strength );
+
+    /**
+     * Phosphor: divides the chroma of a line by 2^i_strength around the
+     * origin i_mid (128 for 8-bit), in place, rounding towards the origin.
+     */
+    void (*darken_chroma)( void *p, size_t i_width, int i_strength,
+                           int i_mid );
+
+    /**
+     * IVTC: counts the pixels of a line where (prev - cur) * (next - cur)
+     * is above i_threshold.
+     */
+    unsigned (*comb_line)( const void *cur, const void *prev,
+                           const void *next, size_t i_width,
+                           int i_threshold );
+
+    /**
+     * IVTC: counts the pixels of each line of an 8x8 block which differ by
+     * more than i_threshold between two pictures.
+     *
+     * @param[out] pi_scores Number of pixels with motion, for each line.
+     */
+    void (*motion_block)( const void *prev, ptrdiff_t i_prev,
+                          const void *cur, ptrdiff_t i_cur,
+                          int i_threshold, int pi_scores[8] );
+} deinterlace_kernels_t;
+
+/** C reference implementation, for 8-bit and 16-bit pixels */
+extern const deinterlace_kernels_t deinterlace_kernels_c[2];
+
+#ifdef DEINTERLACE_SSE4_1
+extern const deinterlace_kernels_t deinterlace_kernels_sse4_1[2];
+#endif
+#ifdef DEINTERLACE_AVX2
+extern const deinterlace_kernels_t deinterlace_kernels_avx2[2];
+#endif
+#ifdef CAN_COMPILE_ARM64
+extern const deinterlace_kernels_t deinterlace_kernels_neon[2];
+#endif
+
+/**
+ * Picks the fastest kernels available on this CPU.
+ *
+ * @param i_pixel_size 1 for 8-bit pixels, 2 for high bit depth pixels
+ */
+const deinterlace_kernels_t *DeinterlaceKernels( unsigned i_pixel_size );
+
+#endif
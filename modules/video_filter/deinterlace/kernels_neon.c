@@ -0,0 +1,353 @@
+/*****************************************************************************
+ * kernels_neon.c : AArch64 NEON kernels of the X, Phosphor and IVTC
+ *                  algorithms
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+#   include "config.h"
+#endif
+
+#include <stdint.h>
+#include <string.h>
+#include <arm_neon.h>
+
+#include <vlc_common.h>
+
+#include "kernels.h"
+
+/*
+ * As with the x86 versions, pixels are processed as signed 16-bit lanes,
+ * which is enough for up to 12 bits per pixel.
+ */
+
+/*****************************************************************************
+ * Helpers
+ *****************************************************************************/
+
+static inline int16x8_t Load8( const void *p, ptrdiff_t i, unsigned size )
+{
+    if( size == 1 )
+        return vreinterpretq_s16_u16( vmovl_u8(
+                                      vld1_u8( (const uint8_t *)p + i ) ) );
+    return vreinterpretq_s16_u16( vld1q_u16( (const uint16_t *)p + i ) );
+}
+
+static inline void Store8( void *p, int16x8_t v, unsigned size )
+{
+    if( size == 1 )
+        vst1_u8( p, vqmovun_s16( v ) );
+    else
+        vst1q_u16( p, vreinterpretq_u16_s16( v ) );
+}
+
+static inline int32x4_t SquareSum( int16x8_t a, int16x8_t b )
+{
+    int32x4_t v = vmull_s16( vget_low_s16( a ), vget_low_s16( a ) );
+    v = vmlal_high_s16( v, a, a );
+    v = vmlal_s16( v, vget_low_s16( b ), vget_low_s16( b ) );
+    return vmlal_high_s16( v, b, b );
+}
+
+static inline const void *Line( const void *p, ptrdiff_t pitch, int y )
+{
+    return (const uint8_t *)p + y * pitch;
+}
+
+static inline void *LineW( void *p, ptrdiff_t pitch, int y )
+{
+    return (uint8_t *)p + y * pitch;
+}
+
+static inline int Get( const void *p, size_t i, unsigned size )
+{
+    return size == 1 ? ((const uint8_t *)p)[i] : ((const uint16_t *)p)[i];
+}
+
+static inline void Set( void *p, size_t i, int v, unsigned size )
+{
+    if( size == 1 )
+        ((uint8_t *)p)[i] = v;
+    else
+        ((uint16_t *)p)[i] = v;
+}
+
+/*****************************************************************************
+ * X
+ *****************************************************************************/
+
+static inline int XDetect( const void *src, ptrdiff_t i_src, int i_threshold,
+                           unsigned size )
+{
+    int16x8_t r[10];
+    int fc = 0;
+
+    for( int y = 0; y < 10; y++ )
+        r[y] = Load8( Line( src, i_src, y ), 0, size );
+
+    for( int y = 0; y < 7; y += 2 )
+    {
+        const int fr = vaddvq_s32( SquareSum( vsubq_s16( r[y], r[y+1] ),
+                                              vsubq_s16( r[y+1], r[y+2] ) ) );
+        const int ff = vaddvq_s32( SquareSum( vsubq_s16( r[y], r[y+2] ),
+                                              vsubq_s16( r[y+1], r[y+3] ) ) );
+
+        if( ff < 6*fr/8 && fr > i_threshold )
+            fc++;
+    }
+
+    return fc > 0;
+}
+
+static inline void XMerge( void *dst, ptrdiff_t i_dst,
+                           const void *src, ptrdiff_t i_src, unsigned size )
+{
+    for( int y = 0; y < 8; y += 2 )
+    {
+        const int16x8_t s0 = Load8( Line( src, i_src, y ), 0, size );
+        const int16x8_t s1 = Load8( Line( src, i_src, y + 1 ), 0, size );
+        const int16x8_t s2 = Load8( Line( src, i_src, y + 2 ), 0, size );
+
+        /* Rounding shift: (v + 4) >> 3 */
+        const int16x8_t v = vrshrq_n_s16( vmlaq_n_s16( vaddq_s16( s0, s2 ),
+                                                       s1, 6 ), 3 );
+
+        memcpy( LineW( dst, i_dst, y ), Line( src, i_src, y ), 8 * size );
+        Store8( LineW( dst, i_dst, y + 1 ), v, size );
+    }
+}
+
+static inline void XFieldE( void *dst, ptrdiff_t i_dst,
+                            const void *src, ptrdiff_t i_src, unsigned size )
+{
+    for( int y = 0; y < 8; y += 2 )
+    {
+        const int16x8_t s0 = Load8( Line( src, i_src, y ), 0, size );
+        const int16x8_t s2 = Load8( Line( src, i_src, y + 2 ), 0, size );
+
+        memcpy( LineW( dst, i_dst, y ), Line( src, i_src, y ), 8 * size );
+        Store8( LineW( dst, i_dst, y + 1 ), vhaddq_s16( s0, s2 ), size );
+    }
+}
+
+static inline void XField( void *dst, ptrdiff_t i_dst,
+                           const void *src, ptrdiff_t i_src, unsigned size )
+{
+    for( int y = 0; y < 8; y += 2 )
+    {
+        const void *s = Line( src, i_src, y );
+        const void *s2 = Line( src, i_src, y + 2 );
+        int16x8_t a[10], b[10];
+
+        /* a[i] and b[i] hold the pixels at offset i - 4 of both lines */
+        for( int i = 0; i < 10; i++ )
+        {
+            a[i] = Load8( s, i - 4, size );
+            b[i] = Load8( s2, i - 4, size );
+        }
+
+        int16x8_t c0 = vdupq_n_s16( 0 );
+        int16x8_t c1 = vdupq_n_s16( 0 );
+        int16x8_t c2 = vdupq_n_s16( 0 );
+        for( int k = 0; k < 8; k++ )
+        {
+            c0 = vabaq_s16( c0, a[k], b[k+2] );
+            c1 = vabaq_s16( c1, a[k+1], b[k+1] );
+            c2 = vabaq_s16( c2, a[k+2], b[k] );
+        }
+
+        /* c2 < c1 <= c0 */
+        const uint16x8_t m2 = vbicq_u16( vcltq_s16( c2, c1 ),
+                                         vcgtq_s16( c1, c0 ) );
+        /* c0 < c1 <= c2, which takes precedence */
+        const uint16x8_t m0 = vbicq_u16( vcltq_s16( c0, c1 ),
+                                         vcgtq_s16( c1, c2 ) );
+
+        int16x8_t v = vhaddq_s16( a[4], b[4] );
+        v = vbslq_s16( m2, vhaddq_s16( a[5], b[3] ), v );
+        v = vbslq_s16( m0, vhaddq_s16( a[3], b[5] ), v );
+
+        memcpy( LineW( dst, i_dst, y ), s, 8 * size );
+        Store8( LineW( dst, i_dst, y + 1 ), v, size );
+    }
+}
+
+/*****************************************************************************
+ * Phosphor
+ *****************************************************************************/
+
+static inline void DarkenLuma( void *p, size_t i_width, int i_strength,
+                               unsigned size )
+{
+    size_t x = 0;
+
+    /* Shifts by a negative amount are right shifts */
+    if( size == 1 )
+    {
+        const int8x16_t shift = vdupq_n_s8( -i_strength );
+        for( ; x + 16 <= i_width; x += 16 )
+        {
+            uint8_t *q = (uint8_t *)p + x;
+            vst1q_u8( q, vshlq_u8( vld1q_u8( q ), shift ) );
+        }
+    }
+    else
+    {
+        const int16x8_t shift = vdupq_n_s16( -i_strength );
+        for( ; x + 8 <= i_width; x += 8 )
+        {
+            uint16_t *q = (uint16_t *)p + x;
+            vst1q_u16( q, vshlq_u16( vld1q_u16( q ), shift ) );
+        }
+    }
+
+    for( ; x < i_width; x++ )
+        Set( p, x, Get( p, x, size ) >> i_strength, size );
+}
+
+static inline void DarkenChroma( void *p, size_t i_width, int i_strength,
+                                 int i_mid, unsigned size )
+{
+    const int16x8_t shift = vdupq_n_s16( -i_strength );
+    const int16x8_t round = vdupq_n_s16( (1 << i_strength) - 1 );
+    const int16x8_t mid = vdupq_n_s16( i_mid );
+    size_t x = 0;
+
+    for( ; x + 8 <= i_width; x += 8 )
+    {
+        void *q = (uint8_t *)p + x * size;
+        int16x8_t d = vsubq_s16( Load8( q, 0, size ), mid );
+
+        /* Round towards mid as the C division */
+        d = vaddq_s16( d, vandq_s16( vshrq_n_s16( d, 15 ), round ) );
+        Store8( q, vaddq_s16( vshlq_s16( d, shift ), mid ), size );
+    }
+
+    for( ; x < i_width; x++ )
+        Set( p, x, i_mid + (Get( p, x, size ) - i_mid) / (1 << i_strength),
+             size );
+}
+
+/*****************************************************************************
+ * IVTC
+ *****************************************************************************/
+
+static inline unsigned CombLine( const void *cur, const void *prev,
+                                 const void *next, size_t i_width,
+                                 int i_threshold, unsigned size )
+{
+    const int32x4_t threshold = vdupq_n_s32( i_threshold );
+    uint32x4_t count = vdupq_n_u32( 0 );
+    size_t x = 0;
+
+    for( ; x + 8 <= i_width; x += 8 )
+    {
+        const int16x8_t C = Load8( cur, x, size );
+        const int16x8_t dp = vsubq_s16( Load8( prev, x, size ), C );
+        const int16x8_t dn = vsubq_s16( Load8( next, x, size ), C );
+
+        /* Comparison masks are all ones, subtract them to count */
+        count = vsubq_u32( count, vcgtq_s32( vmull_s16( vget_low_s16( dp ),
+                                                        vget_low_s16( dn ) ),
+                                             threshold ) );
+        count = vsubq_u32( count, vcgtq_s32( vmull_high_s16( dp, dn ),
+                                             threshold ) );
+    }
+
+    unsigned i_score = vaddvq_u32( count );
+    for( ; x < i_width; x++ )
+    {
+        int_fast32_t C = Get( cur, x, size );
+        int_fast32_t P = Get( prev, x, size );
+        int_fast32_t N = Get( next, x, size );
+
+        if( (P - C) * (N - C) > i_threshold )
+            i_score++;
+    }
+    return i_score;
+}
+
+static inline void MotionBlock( const void *prev, ptrdiff_t i_prev,
+                                const void *cur, ptrdiff_t i_cur,
+                                int i_threshold, int pi_scores[8],
+                                unsigned size )
+{
+    const int16x8_t threshold = vdupq_n_s16( i_threshold );
+
+    for( int y = 0; y < 8; y++ )
+    {
+        const int16x8_t d = vabdq_s16( Load8( Line( cur, i_cur, y ), 0, size ),
+                                       Load8( Line( prev, i_prev, y ), 0,
+                                              size ) );
+        const uint16x8_t m = vcgtq_s16( d, threshold );
+
+        pi_scores[y] = vaddvq_u16( vshrq_n_u16( m, 15 ) );
+    }
+}
+
+#define KERNELS_NEON(bits, size) \
+static int XDetect##bits( const void *src, ptrdiff_t i_src, int i_threshold ) \
+{ \
+    return XDetect( src, i_src, i_threshold, size ); \
+} \
+static void XMerge##bits( void *dst, ptrdiff_t i_dst, \
+                          const void *src, ptrdiff_t i_src ) \
+{ \
+    XMerge( dst, i_dst, src, i_src, size ); \
+} \
+static void XFieldE##bits( void *dst, ptrdiff_t i_dst, \
+                           const void *src, ptrdiff_t i_src ) \
+{ \
+    XFieldE( dst, i_dst, src, i_src, size ); \
+} \
+static void XField##bits( void *dst, ptrdiff_t i_dst, \
+                          const void *src, ptrdiff_t i_src ) \
+{ \
+    XField( dst, i_dst, src, i_src, size ); \
+} \
+static void DarkenLuma##bits( void *p, size_t i_width, int i_strength ) \
+{ \
+    DarkenLuma( p, i_width, i_strength, size ); \
+} \
+static void DarkenChroma##bits( void *p, size_t i_width, int i_strength, \
+                                int i_mid ) \
+{ \
+    DarkenChroma( p, i_width, i_strength, i_mid, size ); \
+} \
+static unsigned CombLine##bits( const void *cur, const void *prev, \
+                                const void *next, size_t i_width, \
+                                int i_threshold ) \
+{ \
+    return CombLine( cur, prev, next, i_width, i_threshold, size ); \
+} \
+static void MotionBlock##bits( const void *prev, ptrdiff_t i_prev, \
+                               const void *cur, ptrdiff_t i_cur, \
+                               int i_threshold, int pi_scores[8] ) \
+{ \
+    MotionBlock( prev, i_prev, cur, i_cur, i_threshold, pi_scores, size ); \
+}
+
+KERNELS_NEON(8, 1)
+KERNELS_NEON(16, 2)
+
+const deinterlace_kernels_t deinterlace_kernels_neon[2] = {
+    { "NEON", XDetect8, XMerge8, XFieldE8, XField8, DarkenLuma8,
+      DarkenChroma8, CombLine8, MotionBlock8 },
+    { "NEON", XDetect16, XMerge16, XFieldE16, XField16, DarkenLuma16,
+      DarkenChroma16, CombLine16, MotionBlock16 },
+};
@@ -0,0 +1,397 @@
+/*****************************************************************************
+ * kernels_test.c : checks the SIMD deinterlacing kernels against the C ones
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * Runs every kernel of every instruction set available on this CPU over
+ * random, flat and combed pictures of odd sizes, at 8, 10 and 12 bits, and
+ * checks that the results match the C reference exactly.
+ *
+ * With -b, also reports the time taken by each kernel over a 1080p plane.
+ */
+
+#ifdef HAVE_CONFIG_H
+#   include "config.h"
+#endif
+
+#undef NDEBUG
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <vlc_common.h>
+#include <vlc_cpu.h>
+
+#include "kernels.h"
+
+/* Margin around the pictures, for the X field kernel which reads around */
+#define BORDER 16
+
+struct plane
+{
+    uint8_t *base;
+    uint8_t *p; /* top left visible pixel */
+    ptrdiff_t pitch;
+    unsigned width, height, size;
+};
+
+static void PlaneInit(struct plane *pl, unsigned width, unsigned height,
+                      unsigned size)
+{
+    pl->width = width;
+    pl->height = height;
+    pl->size = size;
+    pl->pitch = (width + 2 * BORDER) * size;
+    pl->base = malloc(pl->pitch * (height + 2 * BORDER));
+    assert(pl->base != NULL);
+    pl->p = pl->base + BORDER * pl->pitch + BORDER * size;
+}
+
+static void PlaneCopy(struct plane *dst, const struct plane *src)
+{
+    memcpy(dst->base, src->base, src->pitch * (src->height + 2 * BORDER));
+}
+
+static uint8_t *PlanePixel(const struct plane *pl, unsigned x, unsigned y)
+{
+    return pl->p + y * pl->pitch + x * pl->size;
+}
+
+enum pattern
+{
+    PATTERN_RANDOM,
+    PATTERN_FLAT,
+    PATTERN_COMB,  /* alternates dark and bright lines, with noise */
+    PATTERN_EXTREMES, /* only 0 and the maximum value */
+};
+
+static void PlaneFill(struct plane *pl, enum pattern pattern, unsigned bits)
+{
+    const unsigned max = (1 << bits) - 1;
+    const unsigned lines = pl->height + 2 * BORDER;
+    const unsigned pixels = pl->pitch / pl->size;
+
+    for (unsigned y = 0; y < lines; y++)
+        for (unsigned x = 0; x < pixels; x++)
+        {
+            unsigned v;
+
+            switch (pattern)
+            {
+                case PATTERN_RANDOM:
+                    v = rand() & max;
+                    break;
+                case PATTERN_FLAT:
+                    v = max / 3;
+                    break;
+                case PATTERN_COMB:
+                    v = ((y & 1) ? max - max / 8 : max / 8)
+                      + (rand() & (max >> 4));
+                    break;
+                default:
+                    v = (rand() & 1) ? max : 0;
+                    break;
+            }
+
+            if (pl->size == 1)
+                pl->base[y * pl->pitch + x] = v;
+            else
+                ((uint16_t *)(pl->base + y * pl->pitch))[x] = v;
+        }
+}
+
+static void PlaneCheck(const struct plane *a, const struct plane *b,
+                       const char *isa, const char *kernel, unsigned bits)
+{
+    if (memcmp(a->base, b->base, a->pitch * (a->height + 2 * BORDER)) == 0)
+        return;
+    fprintf(stderr, "error: %s %s differs from C at %u bits (%ux%u)\n",
+            isa, kernel, bits, a->width, a->height);
+    abort();
+}
+
+static void TestX(const deinterlace_kernels_t *ref,
+                  const deinterlace_kernels_t *k,
+                  const struct plane *src, unsigned bits)
+{
+    const int threshold = 32 << (2 * (bits - 8));
+    struct plane a, b;
+
+    PlaneInit(&a, src->width, src->height, src->size);
+    PlaneInit(&b, src->width, src->height, src->size);
+    memset(a.base, 0, a.pitch * (a.height + 2 * BORDER));
+    memset(b.base, 0, b.pitch * (b.height + 2 * BORDER));
+
+    /* Blocks need 8x10 source pixels */
+    for (unsigned y = 0; y + 10 <= src->height; y += 8)
+        for (unsigned x = 0; x + 8 <= src->width; x += 8)
+        {
+            const uint8_t *s = PlanePixel(src, x, y);
+
+            if (ref->x_detect(s, src->pitch, threshold)
+             != k->x_detect(s, src->pitch, threshold))
+            {
+                fprintf(stderr, "error: %s x_detect differs from C at %u "
+                        "bits (%u, %u)\n", k->psz_name, bits, x, y);
+                abort();
+            }
+
+            ref->x_merge(PlanePixel(&a, x, y), a.pitch, s, src->pitch);
+            k->x_merge(PlanePixel(&b, x, y), b.pitch, s, src->pitch);
+        }
+    PlaneCheck(&a, &b, k->psz_name, "x_merge", bits);
+
+    for (unsigned y = 0; y + 10 <= src->height; y += 8)
+        for (unsigned x = 0; x + 8 <= src->width; x += 8)
+        {
+            const uint8_t *s = PlanePixel(src, x, y);
+
+            ref->x_field_e(PlanePixel(&a, x, y), a.pitch, s, src->pitch);
+            k->x_field_e(PlanePixel(&b, x, y), b.pitch, s, src->pitch);
+        }
+    PlaneCheck(&a, &b, k->psz_name, "x_field_e", bits);
+
+    for (unsigned y = 0; y + 10 <= src->height; y += 8)
+        for (unsigned x = 0; x + 8 <= src->width; x += 8)
+        {
+            const uint8_t *s = PlanePixel(src, x, y);
+
+            ref->x_field(PlanePixel(&a, x, y), a.pitch, s, src->pitch);
+            k->x_field(PlanePixel(&b, x, y), b.pitch, s, src->pitch);
+        }
+    PlaneCheck(&a, &b, k->psz_name, "x_field", bits);
+
+    free(b.base);
+    free(a.base);
+}
+
+static void TestPhosphor(const deinterlace_kernels_t *ref,
+                         const deinterlace_kernels_t *k,
+                         const struct plane *src, unsigned bits)
+{
+    struct plane a, b;
+
+    PlaneInit(&a, src->width, src->height, src->size);
+    PlaneInit(&b, src->width, src->height, src->size);
+
+    for (int strength = 1; strength <= 3; strength++)
+    {
+        PlaneCopy(&a, src);
+        PlaneCopy(&b, src);
+        for (unsigned y = 0; y < src->height; y++)
+        {
+            ref->darken_luma(PlanePixel(&a, 0, y), a.width, strength);
+            k->darken_luma(PlanePixel(&b, 0, y), b.width, strength);
+        }
+        PlaneCheck(&a, &b, k->psz_name, "darken_luma", bits);
+
+        PlaneCopy(&a, src);
+        PlaneCopy(&b, src);
+        for (unsigned y = 0; y < src->height; y++)
+        {
+            const int mid = 1 << (bits - 1);
+
+            ref->darken_chroma(PlanePixel(&a, 0, y), a.width, strength, mid);
+            k->darken_chroma(PlanePixel(&b, 0, y), b.width, strength, mid);
+        }
+        PlaneCheck(&a, &b, k->psz_name, "darken_chroma", bits);
+    }
+
+    free(b.base);
+    free(a.base);
+}
+
+static void TestIVTC(const deinterlace_kernels_t *ref,
+                     const deinterlace_kernels_t *k,
+                     const struct plane *src, const struct plane *prev,
+                     unsigned bits)
+{
+    const int comb = 100 << (2 * (bits - 8));
+    const int motion = 10 << (bits - 8);
+
+    for (unsigned y = 1; y + 1 < src->height; y++)
+    {
+        const uint8_t *c = PlanePixel(src, 0, y);
+        const uint8_t *p = PlanePixel(src, 0, y - 1);
+        const uint8_t *n = PlanePixel(src, 0, y + 1);
+
+        if (ref->comb_line(c, p, n, src->width, comb)
+         != k->comb_line(c, p, n, src->width, comb))
+        {
+            fprintf(stderr, "error: %s comb_line differs from C at %u bits "
+                    "(line %u)\n", k->psz_name, bits, y);
+            abort();
+        }
+    }
+
+    for (unsigned y = 0; y + 8 <= src->height; y += 8)
+        for (unsigned x = 0; x + 8 <= src->width; x += 8)
+        {
+            int a[8], b[8];
+
+            ref->motion_block(PlanePixel(prev, x, y), prev->pitch,
+                              PlanePixel(src, x, y), src->pitch, motion, a);
+            k->motion_block(PlanePixel(prev, x, y), prev->pitch,
+                            PlanePixel(src, x, y), src->pitch, motion, b);
+            if (memcmp(a, b, sizeof (a)))
+            {
+                fprintf(stderr, "error: %s motion_block differs from C at %u "
+                        "bits (%u, %u)\n", k->psz_name, bits, x, y);
+                abort();
+            }
+        }
+}
+
+static void Test(const deinterlace_kernels_t *k, unsigned bits)
+{
+    static const struct { unsigned width, height; } sizes[] = {
+        { 8, 10 }, { 17, 19 }, { 33, 26 }, { 65, 39 }, { 127, 73 },
+        { 720, 576 },
+    };
+    static const enum pattern patterns[] = {
+        PATTERN_RANDOM, PATTERN_FLAT, PATTERN_COMB, PATTERN_EXTREMES,
+    };
+    const unsigned size = bits > 8 ? 2 : 1;
+    const deinterlace_kernels_t *ref = &deinterlace_kernels_c[size - 1];
+
+    for (size_t i = 0; i < ARRAY_SIZE(sizes); i++)
+        for (size_t j = 0; j < ARRAY_SIZE(patterns); j++)
+        {
+            struct plane src, prev;
+
+            PlaneInit(&src, sizes[i].width, sizes[i].height, size);
+            PlaneInit(&prev, sizes[i].width, sizes[i].height, size);
+            PlaneFill(&src, patterns[j], bits);
+            PlaneFill(&prev, patterns[j], bits);
+
+            TestX(ref, k, &src, bits);
+            TestPhosphor(ref, k, &src, bits);
+            TestIVTC(ref, k, &src, &prev, bits);
+
+            free(prev.base);
+            free(src.base);
+        }
+}
+
+static double Now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+#define BENCH_RUNS 20
+
+static void Bench(const deinterlace_kernels_t *k, unsigned bits)
+{
+    const unsigned size = bits > 8 ? 2 : 1;
+    const int threshold = 32 << (2 * (bits - 8));
+    struct plane src, dst;
+    double start;
+    volatile unsigned sink = 0;
+
+    PlaneInit(&src, 1920, 1088, size);
+    PlaneInit(&dst, 1920, 1088, size);
+    PlaneFill(&src, PATTERN_RANDOM, bits);
+
+    printf("%-8s %2u bits:", k->psz_name, bits);
+
+    start = Now();
+    for (int r = 0; r < BENCH_RUNS; r++)
+        for (unsigned y = 0; y + 10 <= src.height; y += 8)
+            for (unsigned x = 0; x + 8 <= src.width; x += 8)
+            {
+                const uint8_t *s = PlanePixel(&src, x, y);
+                uint8_t *d = PlanePixel(&dst, x, y);
+
+                if (k->x_detect(s, src.pitch, threshold))
+                    k->x_field(d, dst.pitch, s, src.pitch);
+                else
+                    k->x_merge(d, dst.pitch, s, src.pitch);
+            }
+    printf(" x %6.2f ms", (Now() - start) * 1e3 / BENCH_RUNS);
+
+    start = Now();
+    for (int r = 0; r < BENCH_RUNS; r++)
+        for (unsigned y = 0; y < src.height; y++)
+        {
+            k->darken_luma(PlanePixel(&dst, 0, y), dst.width, 1);
+            k->darken_chroma(PlanePixel(&dst, 0, y), dst.width, 1,
+                             1 << (bits - 1));
+        }
+    printf(", phosphor %6.2f ms", (Now() - start) * 1e3 / BENCH_RUNS);
+
+    start = Now();
+    for (int r = 0; r < BENCH_RUNS; r++)
+        for (unsigned y = 1; y + 1 < src.height; y++)
+            sink += k->comb_line(PlanePixel(&src, 0, y),
+                                 PlanePixel(&src, 0, y - 1),
+                                 PlanePixel(&src, 0, y + 1), src.width,
+                                 100 << (2 * (bits - 8)));
+    printf(", comb %6.2f ms\n", (Now() - start) * 1e3 / BENCH_RUNS);
+
+    free(dst.base);
+    free(src.base);
+}
+
+int main(int argc, char **argv)
+{
+    const deinterlace_kernels_t *tables[4];
+    size_t count = 0;
+    bool bench = false;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "b")) != -1)
+        if (opt == 'b')
+            bench = true;
+
+    srand(0);
+
+    tables[count++] = deinterlace_kernels_c;
+#ifdef DEINTERLACE_SSE4_1
+    if (vlc_CPU_SSE4_1())
+        tables[count++] = deinterlace_kernels_sse4_1;
+#endif
+#ifdef DEINTERLACE_AVX2
+    if (vlc_CPU_AVX2())
+        tables[count++] = deinterlace_kernels_avx2;
+#endif
+#ifdef CAN_COMPILE_ARM64
+    if (vlc_CPU_ARM_NEON())
+        tables[count++] = deinterlace_kernels_neon;
+#endif
+
+    static const unsigned depths[] = { 8, 10, DEINTERLACE_KERNELS_MAX_BITS };
+
+    for (size_t i = 1; i < count; i++)
+        for (size_t j = 0; j < ARRAY_SIZE(depths); j++)
+            Test(&tables[i][depths[j] > 8], depths[j]);
+
+    if (bench)
+        for (size_t i = 0; i < count; i++)
+            for (size_t j = 0; j < ARRAY_SIZE(depths); j += 2)
+                Bench(&tables[i][depths[j] > 8], depths[j]);
+
+    /* Nothing to compare the C kernels against on this CPU */
+    return count > 1 ? 0 : 77;
+}
@@ -0,0 +1,550 @@
+/*****************************************************************************
+ * kernels_x86.c : SSE4.1 and AVX2 kernels of the X, Phosphor and IVTC
+ *                 algorithms
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+#   include "config.h"
+#endif
+
+#include <stdint.h>
+#include <string.h>
+
+#include <vlc_common.h>
+
+#include "kernels.h"
+
+#ifdef DEINTERLACE_SSE4_1
+#include <immintrin.h>
+
+/*
+ * All the arithmetic is done on 16-bit lanes: with at most 12 bits per
+ * pixel, differences, sums of 8 absolute differences and the (1,6,1) blend
+ * all fit. Squares and products are computed on 32-bit lanes.
+ *
+ * The X blocks are only 8 pixels wide, so they are not worth AVX2; the AVX2
+ * tables use the SSE4.1 versions for them.
+ */
+
+#define SSE4 __attribute__ ((__target__ ("sse4.1")))
+#define AVX2 __attribute__ ((__target__ ("avx2")))
+
+/*****************************************************************************
+ * Helpers
+ *****************************************************************************/
+
+/* Loads 8 pixels at index i as 16-bit lanes */
+SSE4 static inline __m128i Load8( const void *p, ptrdiff_t i, unsigned size )
+{
+    if( size == 1 )
+        return _mm_cvtepu8_epi16(
+            _mm_loadl_epi64( (const __m128i *)((const uint8_t *)p + i) ) );
+    return _mm_loadu_si128( (const __m128i *)((const uint16_t *)p + i) );
+}
+
+/* Stores 8 pixels from 16-bit lanes */
+SSE4 static inline void Store8( void *p, __m128i v, unsigned size )
+{
+    if( size == 1 )
+        _mm_storel_epi64( (__m128i *)p, _mm_packus_epi16( v, v ) );
+    else
+        _mm_storeu_si128( (__m128i *)p, v );
+}
+
+SSE4 static inline int HSum32( __m128i v )
+{
+    v = _mm_add_epi32( v, _mm_shuffle_epi32( v, _MM_SHUFFLE(1, 0, 3, 2) ) );
+    v = _mm_add_epi32( v, _mm_shuffle_epi32( v, _MM_SHUFFLE(2, 3, 0, 1) ) );
+    return _mm_cvtsi128_si32( v );
+}
+
+SSE4 static inline __m128i Square( __m128i d )
+{
+    return _mm_madd_epi16( d, d );
+}
+
+/* Products of the 16-bit lanes of a and b, as 32-bit lanes */
+SSE4 static inline __m128i MulLo32( __m128i a, __m128i b )
+{
+    const __m128i zero = _mm_setzero_si128();
+    return _mm_madd_epi16( _mm_unpacklo_epi16( a, zero ),
+                           _mm_unpacklo_epi16( b, zero ) );
+}
+
+SSE4 static inline __m128i MulHi32( __m128i a, __m128i b )
+{
+    const __m128i zero = _mm_setzero_si128();
+    return _mm_madd_epi16( _mm_unpackhi_epi16( a, zero ),
+                           _mm_unpackhi_epi16( b, zero ) );
+}
+
+static inline const void *Line( const void *p, ptrdiff_t pitch, int y )
+{
+    return (const uint8_t *)p + y * pitch;
+}
+
+static inline void *LineW( void *p, ptrdiff_t pitch, int y )
+{
+    return (uint8_t *)p + y * pitch;
+}
+
+static inline int Get( const void *p, size_t i, unsigned size )
+{
+    return size == 1 ? ((const uint8_t *)p)[i] : ((const uint16_t *)p)[i];
+}
+
+static inline void Set( void *p, size_t i, int v, unsigned size )
+{
+    if( size == 1 )
+        ((uint8_t *)p)[i] = v;
+    else
+        ((uint16_t *)p)[i] = v;
+}
+
+/*****************************************************************************
+ * X
+ *****************************************************************************/
+
+SSE4 static inline int XDetect( const void *src, ptrdiff_t i_src,
+                                int i_threshold, unsigned size )
+{
+    __m128i r[10];
+    int fc = 0;
+
+    for( int y = 0; y < 10; y++ )
+        r[y] = Load8( Line( src, i_src, y ), 0, size );
+
+    for( int y = 0; y < 7; y += 2 )
+    {
+        const int fr = HSum32( _mm_add_epi32(
+            Square( _mm_sub_epi16( r[y], r[y+1] ) ),
+            Square( _mm_sub_epi16( r[y+1], r[y+2] ) ) ) );
+        const int ff = HSum32( _mm_add_epi32(
+            Square( _mm_sub_epi16( r[y], r[y+2] ) ),
+            Square( _mm_sub_epi16( r[y+1], r[y+3] ) ) ) );
+
+        if( ff < 6*fr/8 && fr > i_threshold )
+            fc++;
+    }
+
+    return fc > 0;
+}
+
+SSE4 static inline void XMerge( void *dst, ptrdiff_t i_dst,
+                                const void *src, ptrdiff_t i_src,
+                                unsigned size )
+{
+    const __m128i four = _mm_set1_epi16( 4 );
+    const __m128i six = _mm_set1_epi16( 6 );
+
+    for( int y = 0; y < 8; y += 2 )
+    {
+        const __m128i s0 = Load8( Line( src, i_src, y ), 0, size );
+        const __m128i s1 = Load8( Line( src, i_src, y + 1 ), 0, size );
+        const __m128i s2 = Load8( Line( src, i_src, y + 2 ), 0, size );
+
+        __m128i v = _mm_add_epi16( _mm_add_epi16( s0, s2 ),
+                                   _mm_mullo_epi16( s1, six ) );
+        v = _mm_srli_epi16( _mm_add_epi16( v, four ), 3 );
+
+        memcpy( LineW( dst, i_dst, y ), Line( src, i_src, y ), 8 * size );
+        Store8( LineW( dst, i_dst, y + 1 ), v, size );
+    }
+}
+
+SSE4 static inline void XFieldE( void *dst, ptrdiff_t i_dst,
+                                 const void *src, ptrdiff_t i_src,
+                                 unsigned size )
+{
+    for( int y = 0; y < 8; y += 2 )
+    {
+        const __m128i s0 = Load8( Line( src, i_src, y ), 0, size );
+        const __m128i s2 = Load8( Line( src, i_src, y + 2 ), 0, size );
+
+        memcpy( LineW( dst, i_dst, y ), Line( src, i_src, y ), 8 * size );
+        Store8( LineW( dst, i_dst, y + 1 ),
+                _mm_srli_epi16( _mm_add_epi16( s0, s2 ), 1 ), size );
+    }
+}
+
+SSE4 static inline void XField( void *dst, ptrdiff_t i_dst,
+                                const void *src, ptrdiff_t i_src,
+                                unsigned size )
+{
+    for( int y = 0; y < 8; y += 2 )
+    {
+        const void *s = Line( src, i_src, y );
+        const void *s2 = Line( src, i_src, y + 2 );
+        __m128i a[10], b[10];
+
+        /* a[i] and b[i] hold the pixels at offset i - 4 of both lines */
+        for( int i = 0; i < 10; i++ )
+        {
+            a[i] = Load8( s, i - 4, size );
+            b[i] = Load8( s2, i - 4, size );
+        }
+
+        __m128i c0 = _mm_setzero_si128();
+        __m128i c1 = _mm_setzero_si128();
+        __m128i c2 = _mm_setzero_si128();
+        for( int k = 0; k < 8; k++ )
+        {
+            c0 = _mm_add_epi16( c0, _mm_abs_epi16(
+                                    _mm_sub_epi16( a[k], b[k+2] ) ) );
+            c1 = _mm_add_epi16( c1, _mm_abs_epi16(
+                                    _mm_sub_epi16( a[k+1], b[k+1] ) ) );
+            c2 = _mm_add_epi16( c2, _mm_abs_epi16(
+                                    _mm_sub_epi16( a[k+2], b[k] ) ) );
+        }
+
+        const __m128i left = _mm_srli_epi16( _mm_add_epi16( a[3], b[5] ), 1 );
+        const __m128i right = _mm_srli_epi16( _mm_add_epi16( a[5], b[3] ), 1 );
+        __m128i v = _mm_srli_epi16( _mm_add_epi16( a[4], b[4] ), 1 );
+
+        /* c2 < c1 <= c0 */
+        const __m128i m2 = _mm_andnot_si128( _mm_cmpgt_epi16( c1, c0 ),
+                                             _mm_cmplt_epi16( c2, c1 ) );
+        /* c0 < c1 <= c2, which takes precedence */
+        const __m128i m0 = _mm_andnot_si128( _mm_cmpgt_epi16( c1, c2 ),
+                                             _mm_cmplt_epi16( c0, c1 ) );
+        v = _mm_blendv_epi8( v, right, m2 );
+        v = _mm_blendv_epi8( v, left, m0 );
+
+        memcpy( LineW( dst, i_dst, y ), s, 8 * size );
+        Store8( LineW( dst, i_dst, y + 1 ), v, size );
+    }
+}
+
+/*****************************************************************************
+ * Phosphor
+ *****************************************************************************/
+
+SSE4 static inline void DarkenLuma( void *p, size_t i_width, int i_strength,
+                                    unsigned size )
+{
+    const __m128i shift = _mm_cvtsi32_si128( i_strength );
+    size_t x = 0;
+
+    if( size == 1 )
+    {
+        /* No 8-bit shifts: shift 16-bit lanes and drop the spilled bits */
+        const __m128i mask = _mm_set1_epi8( 0xFF >> i_strength );
+        for( ; x + 16 <= i_width; x += 16 )
+        {
+            __m128i *q = (__m128i *)((uint8_t *)p + x);
+            __m128i v = _mm_loadu_si128( q );
+            _mm_storeu_si128( q, _mm_and_si128( _mm_srl_epi16( v, shift ),
+                                                mask ) );
+        }
+    }
+    else
+    {
+        for( ; x + 8 <= i_width; x += 8 )
+        {
+            __m128i *q = (__m128i *)((uint16_t *)p + x);
+            _mm_storeu_si128( q, _mm_srl_epi16( _mm_loadu_si128( q ),
+                                                shift ) );
+        }
+    }
+
+    for( ; x < i_width; x++ )
+        Set( p, x, Get( p, x, size ) >> i_strength, size );
+}
+
+/* (v - mid) / 2^strength + mid, rounding towards mid as the C division */
+SSE4 static inline __m128i DarkenChromaVec( __m128i v, __m128i mid,
+                                            __m128i round, __m128i shift )
+{
+    __m128i d = _mm_sub_epi16( v, mid );
+    d = _mm_add_epi16( d, _mm_and_si128( _mm_srai_epi16( d, 15 ), round ) );
+    return _mm_add_epi16( _mm_sra_epi16( d, shift ), mid );
+}
+
+SSE4 static inline void DarkenChroma( void *p, size_t i_width,
+                                      int i_strength, int i_mid,
+                                      unsigned size )
+{
+    const __m128i shift = _mm_cvtsi32_si128( i_strength );
+    const __m128i round = _mm_set1_epi16( (1 << i_strength) - 1 );
+    const __m128i mid = _mm_set1_epi16( i_mid );
+    size_t x = 0;
+
+    for( ; x + 8 <= i_width; x += 8 )
+    {
+        void *q = (uint8_t *)p + x * size;
+        Store8( q, DarkenChromaVec( Load8( q, 0, size ), mid, round, shift ),
+                size );
+    }
+
+    for( ; x < i_width; x++ )
+        Set( p, x, i_mid + (Get( p, x, size ) - i_mid) / (1 << i_strength),
+             size );
+}
+
+/*****************************************************************************
+ * IVTC
+ *****************************************************************************/
+
+SSE4 static inline unsigned CombLine( const void *cur, const void *prev,
+                                      const void *next, size_t i_width,
+                                      int i_threshold, unsigned size )
+{
+    const __m128i threshold = _mm_set1_epi32( i_threshold );
+    __m128i count = _mm_setzero_si128();
+    size_t x = 0;
+
+    for( ; x + 8 <= i_width; x += 8 )
+    {
+        const __m128i C = Load8( cur, x, size );
+        const __m128i dp = _mm_sub_epi16( Load8( prev, x, size ), C );
+        const __m128i dn = _mm_sub_epi16( Load8( next, x, size ), C );
+
+        /* Comparison masks are -1, subtract them to count */
+        count = _mm_sub_epi32( count, _mm_cmpgt_epi32( MulLo32( dp, dn ),
+                                                       threshold ) );
+        count = _mm_sub_epi32( count, _mm_cmpgt_epi32( MulHi32( dp, dn ),
+                                                       threshold ) );
+    }
+
+    unsigned i_score = HSum32( count );
+    for( ; x < i_width; x++ )
+    {
+        int_fast32_t C = Get( cur, x, size );
+        int_fast32_t P = Get( prev, x, size );
+        int_fast32_t N = Get( next, x, size );
+
+        if( (P - C) * (N - C) > i_threshold )
+            i_score++;
+    }
+    return i_score;
+}
+
+SSE4 static inline void MotionBlock( const void *prev, ptrdiff_t i_prev,
+                                     const void *cur, ptrdiff_t i_cur,
+                                     int i_threshold, int pi_scores[8],
+                                     unsigned size )
+{
+    const __m128i threshold = _mm_set1_epi16( i_threshold );
+
+    for( int y = 0; y < 8; y++ )
+    {
+        const __m128i d = _mm_abs_epi16( _mm_sub_epi16(
+                                Load8( Line( cur, i_cur, y ), 0, size ),
+                                Load8( Line( prev, i_prev, y ), 0, size ) ) );
+        const unsigned mask = _mm_movemask_epi8( _mm_cmpgt_epi16( d,
+                                                                  threshold ) );
+        /* Two mask bits per 16-bit lane */
+        pi_scores[y] = vlc_popcount( mask ) / 2;
+    }
+}
+
+#define KERNELS_SSE4(bits, size) \
+SSE4 static int XDetect##bits( const void *src, ptrdiff_t i_src, \
+                               int i_threshold ) \
+{ \
+    return XDetect( src, i_src, i_threshold, size ); \
+} \
+SSE4 static void XMerge##bits( void *dst, ptrdiff_t i_dst, \
+                               const void *src, ptrdiff_t i_src ) \
+{ \
+    XMerge( dst, i_dst, src, i_src, size ); \
+} \
+SSE4 static void XFieldE##bits( void *dst, ptrdiff_t i_dst, \
+                                const void *src, ptrdiff_t i_src ) \
+{ \
+    XFieldE( dst, i_dst, src, i_src, size ); \
+} \
+SSE4 static void XField##bits( void *dst, ptrdiff_t i_dst, \
+                               const void *src, ptrdiff_t i_src ) \
+{ \
+    XField( dst, i_dst, src, i_src, size ); \
+} \
+SSE4 static void DarkenLuma##bits( void *p, size_t i_width, int i_strength ) \
+{ \
+    DarkenLuma( p, i_width, i_strength, size ); \
+} \
+SSE4 static void DarkenChroma##bits( void *p, size_t i_width, \
+                                     int i_strength, int i_mid ) \
+{ \
+    DarkenChroma( p, i_width, i_strength, i_mid, size ); \
+} \
+SSE4 static unsigned CombLine##bits( const void *cur, const void *prev, \
+                                     const void *next, size_t i_width, \
+                                     int i_threshold ) \
+{ \
+    return CombLine( cur, prev, next, i_width, i_threshold, size ); \
+} \
+SSE4 static void MotionBlock##bits( const void *prev, ptrdiff_t i_prev, \
+                                    const void *cur, ptrdiff_t i_cur, \
+                                    int i_threshold, int pi_scores[8] ) \
+{ \
+    MotionBlock( prev, i_prev, cur, i_cur, i_threshold, pi_scores, size ); \
+}
+
+KERNELS_SSE4(8, 1)
+KERNELS_SSE4(16, 2)
+
+const deinterlace_kernels_t deinterlace_kernels_sse4_1[2] = {
+    { "SSE4.1", XDetect8, XMerge8, XFieldE8, XField8, DarkenLuma8,
+      DarkenChroma8, CombLine8, MotionBlock8 },
+    { "SSE4.1", XDetect16, XMerge16, XFieldE16, XField16, DarkenLuma16,
+      DarkenChroma16, CombLine16, MotionBlock16 },
+};
+
+#ifdef DEINTERLACE_AVX2
+/*****************************************************************************
+ * AVX2 line kernels
+ *****************************************************************************/
+
+/* Loads 16 pixels at index i as 16-bit lanes */
+AVX2 static inline __m256i Load16( const void *p, size_t i, unsigned size )
+{
+    if( size == 1 )
+        return _mm256_cvtepu8_epi16(
+            _mm_loadu_si128( (const __m128i *)((const uint8_t *)p + i) ) );
+    return _mm256_loadu_si256( (const __m256i *)((const uint16_t *)p + i) );
+}
+
+AVX2 static inline void Store16( void *p, __m256i v, unsigned size )
+{
+    if( size == 1 )
+        _mm_storeu_si128( (__m128i *)p,
+                          _mm_packus_epi16( _mm256_castsi256_si128( v ),
+                                            _mm256_extracti128_si256( v, 1 ) ) );
+    else
+        _mm256_storeu_si256( (__m256i *)p, v );
+}
+
+AVX2 static inline void DarkenLumaAVX2( void *p, size_t i_width,
+                                        int i_strength, unsigned size )
+{
+    const __m128i shift = _mm_cvtsi32_si128( i_strength );
+    size_t x = 0;
+
+    if( size == 1 )
+    {
+        const __m256i mask = _mm256_set1_epi8( 0xFF >> i_strength );
+        for( ; x + 32 <= i_width; x += 32 )
+        {
+            __m256i *q = (__m256i *)((uint8_t *)p + x);
+            __m256i v = _mm256_loadu_si256( q );
+            _mm256_storeu_si256( q, _mm256_and_si256(
+                                    _mm256_srl_epi16( v, shift ), mask ) );
+        }
+    }
+    else
+    {
+        for( ; x + 16 <= i_width; x += 16 )
+        {
+            __m256i *q = (__m256i *)((uint16_t *)p + x);
+            _mm256_storeu_si256( q, _mm256_srl_epi16( _mm256_loadu_si256( q ),
+                                                      shift ) );
+        }
+    }
+
+    /* Remainder, at most a vector */
+    DarkenLuma( (uint8_t *)p + x * size, i_width - x, i_strength, size );
+}
+
+AVX2 static inline void DarkenChromaAVX2( void *p, size_t i_width,
+                                          int i_strength, int i_mid,
+                                          unsigned size )
+{
+    const __m128i shift = _mm_cvtsi32_si128( i_strength );
+    const __m256i round = _mm256_set1_epi16( (1 << i_strength) - 1 );
+    const __m256i mid = _mm256_set1_epi16( i_mid );
+    size_t x = 0;
+
+    for( ; x + 16 <= i_width; x += 16 )
+    {
+        void *q = (uint8_t *)p + x * size;
+        __m256i d = _mm256_sub_epi16( Load16( q, 0, size ), mid );
+        d = _mm256_add_epi16( d, _mm256_and_si256( _mm256_srai_epi16( d, 15 ),
+                                                   round ) );
+        Store16( q, _mm256_add_epi16( _mm256_sra_epi16( d, shift ), mid ),
+                 size );
+    }
+
+    DarkenChroma( (uint8_t *)p + x * size, i_width - x, i_strength, i_mid,
+                  size );
+}
+
+AVX2 static inline unsigned CombLineAVX2( const void *cur, const void *prev,
+                                          const void *next, size_t i_width,
+                                          int i_threshold, unsigned size )
+{
+    const __m256i threshold = _mm256_set1_epi32( i_threshold );
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i count = _mm256_setzero_si256();
+    size_t x = 0;
+
+    for( ; x + 16 <= i_width; x += 16 )
+    {
+        const __m256i C = Load16( cur, x, size );
+        const __m256i dp = _mm256_sub_epi16( Load16( prev, x, size ), C );
+        const __m256i dn = _mm256_sub_epi16( Load16( next, x, size ), C );
+
+        /* The lane order does not matter to count */
+        const __m256i lo = _mm256_madd_epi16( _mm256_unpacklo_epi16( dp, zero ),
+                                              _mm256_unpacklo_epi16( dn, zero ) );
+        const __m256i hi = _mm256_madd_epi16( _mm256_unpackhi_epi16( dp, zero ),
+                                              _mm256_unpackhi_epi16( dn, zero ) );
+        count = _mm256_sub_epi32( count, _mm256_cmpgt_epi32( lo, threshold ) );
+        count = _mm256_sub_epi32( count, _mm256_cmpgt_epi32( hi, threshold ) );
+    }
+
+    const __m128i sum = _mm_add_epi32( _mm256_castsi256_si128( count ),
+                                       _mm256_extracti128_si256( count, 1 ) );
+    return HSum32( sum )
+         + CombLine( (const uint8_t *)cur + x * size,
+                     (const uint8_t *)prev + x * size,
+                     (const uint8_t *)next + x * size,
+                     i_width - x, i_threshold, size );
+}
+
+#define KERNELS_AVX2(bits, size) \
+AVX2 static void DarkenLumaAVX2_##bits( void *p, size_t i_width, \
+                                        int i_strength ) \
+{ \
+    DarkenLumaAVX2( p, i_width, i_strength, size ); \
+} \
+AVX2 static void DarkenChromaAVX2_##bits( void *p, size_t i_width, \
+                                          int i_strength, int i_mid ) \
+{ \
+    DarkenChromaAVX2( p, i_width, i_strength, i_mid, size ); \
+} \
+AVX2 static unsigned CombLineAVX2_##bits( const void *cur, const void *prev, \
+                                          const void *next, size_t i_width, \
+                                          int i_threshold ) \
+{ \
+    return CombLineAVX2( cur, prev, next, i_width, i_threshold, size ); \
+}
+
+KERNELS_AVX2(8, 1)
+KERNELS_AVX2(16, 2)
+
+const deinterlace_kernels_t deinterlace_kernels_avx2[2] = {
+    { "AVX2", XDetect8, XMerge8, XFieldE8, XField8, DarkenLumaAVX2_8,
+      DarkenChromaAVX2_8, CombLineAVX2_8, MotionBlock8 },
+    { "AVX2", XDetect16, XMerge16, XFieldE16, XField16, DarkenLumaAVX2_16,
+      DarkenChromaAVX2_16, CombLineAVX2_16, MotionBlock16 },
+};
+#endif /* DEINTERLACE_AVX2 */
+
+#endif /* DEINTERLACE_SSE4_1 */
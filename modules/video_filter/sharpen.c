@@ -51,9 +51,13 @@
  *****************************************************************************/
 static int  Create    ( filter_t * );
 
+static void Destroy   ( filter_t * );
+static picture_t *Filter( filter_t *, picture_t * );
+static void FilterSlice( filter_t *, picture_t *, const picture_t *,
+                         unsigned, unsigned );
+
 static int SharpenCallback( vlc_object_t *, char const *,
                             vlc_value_t, vlc_value_t, void * );
-VIDEO_FILTER_WRAPPER_CLOSE(Filter, Destroy)
 
 #define SHARPEN_HELP N_("Augment contrast between contours.")
 #define FILTER_PREFIX "sharpen-"
@@ -88,8 +92,14 @@ static const char *const ppsz_filter_options[] = {
 typedef struct
 {
     atomic_int sigma;
+    int i_sigma; /* of the picture being filtered, shared by all bands */
 } filter_sys_t;
 
+static const struct vlc_filter_operations filter_ops =
+{
+    .filter_video = Filter, .filter_slice = FilterSlice, .close = Destroy,
+};
+
 /*****************************************************************************
  * Create: allocates Sharpen video thread output method
  *****************************************************************************
@@ -113,7 +123,7 @@ static int Create( filter_t *p_filter )
         return VLC_ENOMEM;
     p_filter->p_sys = p_sys;
 
-    p_filter->ops = &Filter_ops;
+    p_filter->ops = &filter_ops;
 
     config_ChainParse( p_filter, FILTER_PREFIX, ppsz_filter_options,
                    p_filter->p_cfg );
@@ -162,15 +172,21 @@ static void Destroy( filter_t *p_filter )
         const unsigned data_sz = sizeof(data_t);                        \
         const int i_src_line_len = p_pic->p[Y_PLANE].i_pitch / data_sz; \
         const int i_out_line_len = p_outpic->p[Y_PLANE].i_pitch / data_sz; \
-        const int sigma = atomic_load(&p_sys->sigma);         \
+        const unsigned i_visible_width = i_visible_pitch / data_sz;     \
+        const int sigma = p_sys->i_sigma;                               \
                                                                         \
-        memcpy(p_out, p_src, i_visible_pitch);                          \
-                                                                        \
-        for( unsigned i = 1; i < i_visible_lines - 1; i++ )             \
+        for( unsigned i = first; i < first + count; i++ )               \
         {                                                               \
+            if( i == 0 || i == i_visible_lines - 1 )                    \
+            {                                                           \
+                memcpy(&p_out[i * i_out_line_len],                      \
+                       &p_src[i * i_src_line_len], i_visible_pitch);    \
+                continue;                                               \
+            }                                                           \
+                                                                        \
             p_out[i * i_out_line_len] = p_src[i * i_src_line_len];      \
                                                                         \
-            for( unsigned j = data_sz; j < i_visible_pitch - 1; j++ )   \
+            for( unsigned j = 1; j < i_visible_width - 1; j++ )         \
             {                                                           \
                 const int line_idx_1 = (i - 1) * i_src_line_len;        \
                 const int line_idx_2 = i * i_src_line_len;              \
@@ -190,15 +206,41 @@ static void Destroy( filter_t *p_filter )
                 p_out[i * i_out_line_len + j] =                         \
                     VLC_CLIP( p_src[line_idx_2 + j] + pix, 0, maxval);  \
             }                                                           \
-            p_out[i * i_out_line_len + i_visible_pitch / data_sz - 1] = \
-                p_src[i * i_src_line_len + i_visible_pitch / data_sz - 1];  \
+            p_out[i * i_out_line_len + i_visible_width - 1] =           \
+                p_src[i * i_src_line_len + i_visible_width - 1];        \
         }                                                               \
-        memcpy(&p_out[(i_visible_lines - 1) * i_out_line_len],          \
-               &p_src[(i_visible_lines - 1) * i_src_line_len],          \
-               i_visible_pitch);                                        \
     } while (0)
 
-static void Filter( filter_t *p_filter, picture_t *p_pic, picture_t *p_outpic )
+static void CopyLines( picture_t *p_outpic, const picture_t *p_pic, int i_plane,
+                       unsigned first, unsigned count )
+{
+    const plane_t *p_src = &p_pic->p[i_plane];
+    plane_t *p_dst = &p_outpic->p[i_plane];
+    unsigned start, end;
+
+    filter_GetSliceLines( p_pic, i_plane, first, count, &start, &end );
+    for( unsigned i = start; i < end; i++ )
+        memcpy( &p_dst->p_pixels[i * p_dst->i_pitch],
+                &p_src->p_pixels[i * p_src->i_pitch],
+                __MIN(p_src->i_visible_pitch, p_dst->i_visible_pitch) );
+}
+
+static picture_t *Filter( filter_t *p_filter, picture_t *p_pic )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+    picture_t *p_outpic = filter_NewPicture( p_filter );
+    if( p_outpic )
+    {
+        p_sys->i_sigma = atomic_load( &p_sys->sigma );
+        filter_SliceVideo( p_filter, p_outpic, p_pic );
+        picture_CopyProperties( p_outpic, p_pic );
+    }
+    picture_Release( p_pic );
+    return p_outpic;
+}
+
+static void FilterSlice( filter_t *p_filter, picture_t *p_outpic,
+                         const picture_t *p_pic, unsigned first, unsigned count )
 {
     const int v1 = -1;
     const int v2 = 3; /* 2^3 = 8 */
@@ -212,8 +254,8 @@ static void Filter( filter_t *p_filter, picture_t *p_pic, picture_t *p_outpic )
     else
         SHARPEN_FRAME(1023, uint16_t);
 
-    plane_CopyPixels( &p_outpic->p[U_PLANE], &p_pic->p[U_PLANE] );
-    plane_CopyPixels( &p_outpic->p[V_PLANE], &p_pic->p[V_PLANE] );
+    CopyLines( p_outpic, p_pic, U_PLANE, first, count );
+    CopyLines( p_outpic, p_pic, V_PLANE, first, count );
 }
 
 static int SharpenCallback( vlc_object_t *p_this, char const *psz_var,
@@ -40,6 +40,7 @@
 struct vlc_access_private
 {
     module_t *module;
+    struct input_stats *stats;
 };
 
 struct vlc_access_stream_private
@@ -108,6 +109,7 @@ static stream_t *access_New(vlc_object_t *parent, input_thread_t *input,
     access->psz_filepath = NULL;
     access->b_preparsing = preparsing;
     priv = vlc_stream_Private(access);
+    priv->stats = input ? input_priv(input)->stats : NULL;
 
     if (unlikely(access->psz_url == NULL))
         goto error;
@@ -183,6 +185,22 @@ stream_t *vlc_access_NewMRL(vlc_object_t *parent, const char *mrl)
     return access_New(parent, NULL, NULL, false, mrl);
 }
 
+void vlc_access_ReportReceive(stream_t *access, uint64_t lost,
+                              vlc_tick_t delay)
+{
+    struct vlc_access_private *priv = vlc_stream_Private(access);
+    struct input_stats *stats = priv->stats;
+
+    if (stats == NULL)
+        return;
+
+    if (lost > 0)
+        atomic_fetch_add_explicit(&stats->lost_packets, lost,
+                                  memory_order_relaxed);
+    if (delay != VLC_TICK_INVALID)
+        vlc_latency_histogram_Add(&stats->receive_delay, delay);
+}
+
 /*****************************************************************************
  * access_vaDirectoryControlHelper:
  *****************************************************************************/
@@ -303,6 +321,7 @@ stream_t *stream_AccessNew(vlc_object_t *parent, input_thread_t *input,
         }
         priv = vlc_stream_Private(s);
         priv->input = input;
+        stream_SetStats(s, input ? input_priv(input)->stats : NULL);
 
         s->p_input_item = input ? input_GetItem(input) : NULL;
         s->psz_url = strdup(access->psz_url);
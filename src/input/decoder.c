@@ -44,6 +44,7 @@
 #include <vlc_decoder.h>
 #include <vlc_picture_pool.h>
 #include <vlc_tracer.h>
+#include <vlc_atomic.h>
 
 #include "audio_output/aout_internal.h"
 #include "stream_output/stream_output.h"
@@ -53,6 +54,7 @@
 #include "libvlc.h"
 
 #include "../video_output/vout_internal.h"
+#include "../misc/latency.h"
 
 /*
  * Possibles values set in p_owner->reload atomic
@@ -64,6 +66,120 @@ enum reload
     RELOAD_DECODER_AOUT /* Stop the aout and reload the decoder module */
 };
 
+/*
+ * Pipelined decoding: the DecoderThread packetizes, the DecodeThread runs the
+ * decoder module and the OutputThread plays the decoded buffers. The stages
+ * are connected by bounded queues.
+ */
+#define DECODER_QUEUE_SIZE 4 /* must be a power of 2 */
+
+enum decoder_item_type
+{
+    DECODER_ITEM_BLOCK,   /* block to decode, or audio buffer to play */
+    DECODER_ITEM_PICTURE, /* picture to play */
+    DECODER_ITEM_DRAIN,   /* drain the decoder module, then acknowledge */
+    DECODER_ITEM_FLUSH,   /* flush the decoder module, then acknowledge */
+    DECODER_ITEM_RELOAD,  /* drain and reload the decoder module */
+    DECODER_ITEM_SYNC,    /* acknowledge once the previous items are done */
+    DECODER_ITEM_QUIT,
+};
+
+struct decoder_item
+{
+    enum decoder_item_type type;
+    union
+    {
+        block_t *block;
+        picture_t *picture;
+        es_format_t *fmt;
+    };
+    vlc_sem_t *done; /* posted by the last stage for acknowledged items */
+};
+
+/* Bounded lock-free queue, with any number of producers and one consumer.
+ * Each cell carries a sequence number telling whether it is free for the
+ * producer at a given position, or filled for the consumer. */
+struct decoder_queue
+{
+    struct
+    {
+        atomic_uint seq;
+        struct decoder_item item;
+    } cells[DECODER_QUEUE_SIZE];
+    atomic_uint tail; /* next position to fill */
+    atomic_uint waiters; /* threads sleeping on a cell */
+    unsigned head; /* next position to read (consumer only) */
+};
+
+static void DecoderQueueInit( struct decoder_queue *q )
+{
+    for( unsigned i = 0; i < DECODER_QUEUE_SIZE; i++ )
+        atomic_init( &q->cells[i].seq, i );
+    atomic_init( &q->tail, 0 );
+    atomic_init( &q->waiters, 0 );
+    q->head = 0;
+}
+
+static void DecoderQueueWait( struct decoder_queue *q, atomic_uint *seq,
+                              unsigned val )
+{
+    /* Sequentially consistent with the stores in DecoderQueueWake() */
+    atomic_fetch_add( &q->waiters, 1 );
+    vlc_atomic_wait( seq, val );
+    atomic_fetch_sub( &q->waiters, 1 );
+}
+
+static void DecoderQueueWake( struct decoder_queue *q, atomic_uint *seq,
+                              unsigned val )
+{
+    atomic_store( seq, val );
+    if( atomic_load( &q->waiters ) > 0 )
+        vlc_atomic_notify_all( seq );
+}
+
+static void DecoderQueuePush( struct decoder_queue *q,
+                              const struct decoder_item *item )
+{
+    unsigned pos = atomic_load_explicit( &q->tail, memory_order_relaxed );
+
+    for( ;; )
+    {
+        atomic_uint *seq = &q->cells[pos % DECODER_QUEUE_SIZE].seq;
+        unsigned val = atomic_load_explicit( seq, memory_order_acquire );
+        int diff = (int)(val - pos);
+
+        if( diff == 0 )
+        {   /* The cell is free, claim it */
+            if( atomic_compare_exchange_weak_explicit( &q->tail, &pos, pos + 1,
+                                                       memory_order_relaxed,
+                                                       memory_order_relaxed ) )
+                break;
+            continue;
+        }
+        if( diff < 0 ) /* Full: wait for the consumer */
+            DecoderQueueWait( q, seq, val );
+        pos = atomic_load_explicit( &q->tail, memory_order_relaxed );
+    }
+
+    q->cells[pos % DECODER_QUEUE_SIZE].item = *item;
+    DecoderQueueWake( q, &q->cells[pos % DECODER_QUEUE_SIZE].seq, pos + 1 );
+}
+
+static void DecoderQueuePop( struct decoder_queue *q, struct decoder_item *item )
+{
+    unsigned pos = q->head;
+    atomic_uint *seq = &q->cells[pos % DECODER_QUEUE_SIZE].seq;
+    unsigned val;
+
+    /* Empty (or being filled): wait for a producer */
+    while( (val = atomic_load_explicit( seq, memory_order_acquire )) != pos + 1 )
+        DecoderQueueWait( q, seq, val );
+
+    *item = q->cells[pos % DECODER_QUEUE_SIZE].item;
+    q->head = pos + 1;
+    DecoderQueueWake( q, seq, pos + DECODER_QUEUE_SIZE );
+}
+
 struct vlc_input_decoder_t
 {
     decoder_t        dec;
@@ -177,6 +293,30 @@ struct vlc_input_decoder_t
     vlc_mutex_t     mouse_lock;
     vlc_mouse_event mouse_event;
     void           *mouse_opaque;
+
+    /* Latency tracing: the trace context of the last decoder inputs, matched
+     * with the decoded pictures by timestamp (needs locking) */
+#define DECODER_TRACE_COUNT 32
+    struct
+    {
+        vlc_tick_t pts;
+        struct vlc_frame_trace trace;
+    } traces[DECODER_TRACE_COUNT];
+    unsigned traces_next;
+    struct vlc_latency_histogram latency[INPUT_LATENCY_STAGE_COUNT];
+
+    /* Pipelined decoding (optional) */
+    struct
+    {
+        bool enabled;
+        vlc_thread_t decode_thread;
+        vlc_thread_t output_thread;
+        struct decoder_queue decode; /* DecoderThread -> DecodeThread */
+        struct decoder_queue output; /* module thread(s) -> OutputThread */
+        atomic_bool flushing; /* drop the queued data */
+        atomic_uint pending; /* queued data not yet decoded or played */
+        es_format_t fmt; /* last format sent to the DecodeThread */
+    } pipe;
 };
 
 /* Pictures which are DECODER_BOGUS_VIDEO_DELAY or more in advance probably have
@@ -197,6 +337,31 @@ static inline vlc_input_decoder_t *dec_get_owner( decoder_t *p_dec )
     return container_of( p_dec, vlc_input_decoder_t, dec );
 }
 
+/**
+ * Queues a request and waits until the last stage acknowledges it, i.e. until
+ * all the items queued before it are processed
+ */
+static void DecoderPipelineWait( struct decoder_queue *q,
+                                 enum decoder_item_type type )
+{
+    vlc_sem_t done;
+    struct decoder_item item = { .type = type, .done = &done };
+
+    vlc_sem_init( &done, 0 );
+    DecoderQueuePush( q, &item );
+    vlc_sem_wait( &done );
+}
+
+/**
+ * Waits for the OutputThread to play the queued buffers, before the outputs
+ * are changed
+ */
+static void ModuleThread_SyncOutput( vlc_input_decoder_t *p_owner )
+{
+    if( p_owner->pipe.enabled )
+        DecoderPipelineWait( &p_owner->pipe.output, DECODER_ITEM_SYNC );
+}
+
 /**
  * Load a decoder module
  */
@@ -332,6 +497,7 @@ static int ModuleThread_UpdateAudioFormat( decoder_t *p_dec )
         audio_output_t *p_aout = p_owner->p_aout;
 
         /* Parameters changed, restart the aout */
+        ModuleThread_SyncOutput( p_owner );
         vlc_mutex_lock( &p_owner->lock );
         p_owner->p_aout = NULL; // the DecoderThread should not use the old aout anymore
         vlc_mutex_unlock( &p_owner->lock );
@@ -354,6 +520,7 @@ static int ModuleThread_UpdateAudioFormat( decoder_t *p_dec )
 
     if( p_owner->p_aout == NULL )
     {
+        ModuleThread_SyncOutput( p_owner );
         p_dec->fmt_out.audio.i_format = p_dec->fmt_out.i_codec;
 
         audio_sample_format_t format = p_dec->fmt_out.audio;
@@ -420,6 +587,8 @@ static int ModuleThread_UpdateVideoFormat( decoder_t *p_dec, vlc_video_context *
         // video context didn't change
         if (vctx != NULL && p_owner->vctx == vctx)
             return 0;
+        // the vout is reconfigured below
+        ModuleThread_SyncOutput(p_owner);
     }
     assert(p_owner->p_vout);
 
@@ -559,6 +728,7 @@ static int CreateVoutIfNeeded(vlc_input_decoder_t *p_owner)
     if( !need_vout )
         return 0; // vout unchanged
 
+    ModuleThread_SyncOutput( p_owner );
     vlc_mutex_lock( &p_owner->lock );
 
     vout_thread_t *p_vout = p_owner->p_vout;
@@ -1043,6 +1213,14 @@ static int ModuleThread_PlayVideo( vlc_input_decoder_t *p_owner, picture_t *p_pi
     vlc_mutex_lock( &p_owner->lock );
     assert( p_owner->vout_started );
 
+    for( size_t i = 0; i < DECODER_TRACE_COUNT; i++ )
+        if( p_owner->traces[i].pts == p_picture->date )
+        {
+            p_picture->trace.demux = p_owner->traces[i].trace.demux;
+            p_picture->trace.decode = p_owner->traces[i].trace.decode;
+            break;
+        }
+
     bool prerolled = p_owner->i_preroll_end != PREROLL_NONE;
     if( prerolled && p_owner->i_preroll_end > p_picture->date )
     {
@@ -1104,11 +1282,13 @@ static void ModuleThread_UpdateStatVideo( vlc_input_decoder_t *p_owner,
     unsigned vout_late = 0;
     if( p_owner->p_vout != NULL )
     {
-        vout_GetResetStatistic( p_owner->p_vout, &displayed, &vout_lost, &vout_late );
+        vout_GetResetStatistic( p_owner->p_vout, &displayed, &vout_lost, &vout_late,
+                                p_owner->latency );
     }
     if (lost) vout_lost++;
 
-    decoder_Notify(p_owner, on_new_video_stats, 1, vout_lost, displayed, vout_late);
+    decoder_Notify(p_owner, on_new_video_stats, 1, vout_lost, displayed, vout_late,
+                   p_owner->latency);
 }
 
 static void ModuleThread_QueueVideo( decoder_t *p_dec, picture_t *p_pic )
@@ -1122,6 +1302,18 @@ static void ModuleThread_QueueVideo( decoder_t *p_dec, picture_t *p_pic )
         vlc_tracer_TraceStreamPTS( tracer, "DEC", p_owner->psz_id,
                             "OUT", p_pic->date );
     }
+    p_pic->trace.decoded = vlc_tick_now();
+
+    if( p_owner->pipe.enabled )
+    {
+        struct decoder_item item = {
+            .type = DECODER_ITEM_PICTURE, .picture = p_pic,
+        };
+        atomic_fetch_add( &p_owner->pipe.pending, 1 );
+        DecoderQueuePush( &p_owner->pipe.output, &item );
+        return;
+    }
+
     int success = ModuleThread_PlayVideo( p_owner, p_pic );
 
     ModuleThread_UpdateStatVideo( p_owner, success != VLC_SUCCESS );
@@ -1257,6 +1449,17 @@ static void ModuleThread_QueueAudio( decoder_t *p_dec, block_t *p_aout_buf )
         vlc_tracer_TraceStreamDTS( tracer, "DEC", p_owner->psz_id, "OUT",
                             p_aout_buf->i_pts, p_aout_buf->i_dts );
     }
+
+    if( p_owner->pipe.enabled )
+    {
+        struct decoder_item item = {
+            .type = DECODER_ITEM_BLOCK, .block = p_aout_buf,
+        };
+        atomic_fetch_add( &p_owner->pipe.pending, 1 );
+        DecoderQueuePush( &p_owner->pipe.output, &item );
+        return;
+    }
+
     int success = ModuleThread_PlayAudio( p_owner, p_aout_buf );
 
     ModuleThread_UpdateStatAudio( p_owner, success != VLC_SUCCESS );
@@ -1322,6 +1525,7 @@ static void ModuleThread_QueueSpu( decoder_t *p_dec, subpicture_t *p_spu )
 }
 
 static void DecoderThread_ProcessInput( vlc_input_decoder_t *p_owner, block_t *p_block );
+static void DecodeThread_Decode( vlc_input_decoder_t *p_owner, block_t *p_block );
 static void DecoderThread_DecodeBlock( vlc_input_decoder_t *p_owner, block_t *p_block )
 {
     decoder_t *p_dec = &p_owner->dec;
@@ -1333,6 +1537,23 @@ static void DecoderThread_DecodeBlock( vlc_input_decoder_t *p_owner, block_t *p_
                             p_block->i_pts, p_block->i_dts );
     }
 
+    if( p_block != NULL && p_dec->fmt_in.i_cat == VIDEO_ES )
+    {
+        if( p_block->trace.decode == VLC_TICK_INVALID )
+            p_block->trace.decode = vlc_tick_now();
+
+        /* Pictures are not allocated from the input blocks: remember the
+         * trace context so that it can be found back from the output. */
+        if( p_block->i_pts != VLC_TICK_INVALID )
+        {
+            vlc_mutex_lock( &p_owner->lock );
+            unsigned i = p_owner->traces_next++ % DECODER_TRACE_COUNT;
+            p_owner->traces[i].pts = p_block->i_pts;
+            p_owner->traces[i].trace = p_block->trace;
+            vlc_mutex_unlock( &p_owner->lock );
+        }
+    }
+
     int ret = p_dec->pf_decode( p_dec, p_block );
     switch( ret )
     {
@@ -1348,7 +1569,10 @@ static void DecoderThread_DecodeBlock( vlc_input_decoder_t *p_owner, block_t *p_
             if( !( p_block->i_flags & BLOCK_FLAG_CORE_PRIVATE_RELOADED ) )
             {
                 p_block->i_flags |= BLOCK_FLAG_CORE_PRIVATE_RELOADED;
-                DecoderThread_ProcessInput( p_owner, p_block );
+                if( p_owner->pipe.enabled )
+                    DecodeThread_Decode( p_owner, p_block );
+                else
+                    DecoderThread_ProcessInput( p_owner, p_block );
             }
             else /* We prefer loosing this block than an infinite recursion */
                 block_Release( p_block );
@@ -1358,6 +1582,84 @@ static void DecoderThread_DecodeBlock( vlc_input_decoder_t *p_owner, block_t *p_
     }
 }
 
+/**
+ * Decode a block from the DecodeThread
+ *
+ * \param p_dec the decoder object
+ * \param p_block the block to decode, or NULL to drain
+ */
+static void DecodeThread_Decode( vlc_input_decoder_t *p_owner, block_t *p_block )
+{
+    decoder_t *p_dec = &p_owner->dec;
+
+    if( p_owner->error )
+        goto error;
+
+    enum reload reload;
+    if( ( reload = atomic_exchange( &p_owner->reload, RELOAD_NO_REQUEST ) ) )
+    {
+        msg_Warn( p_dec, "Reloading the decoder module%s",
+                  reload == RELOAD_DECODER_AOUT ? " and the audio output" : "" );
+
+        /* The audio output may be deleted */
+        ModuleThread_SyncOutput( p_owner );
+        if( DecoderThread_Reload( p_owner, &p_dec->fmt_in, reload ) != VLC_SUCCESS )
+            goto error;
+    }
+
+    DecoderThread_DecodeBlock( p_owner, p_block );
+    return;
+
+error:
+    if( p_block )
+        block_Release( p_block );
+}
+
+/**
+ * Pass a packetized block to the decoder module, through the DecodeThread
+ * if the decoder is pipelined
+ *
+ * \param p_dec the decoder object
+ * \param p_block the block to decode, or NULL to drain
+ */
+static void DecoderThread_QueueBlock( vlc_input_decoder_t *p_owner, block_t *p_block )
+{
+    if( !p_owner->pipe.enabled )
+        DecoderThread_DecodeBlock( p_owner, p_block );
+    else if( p_block == NULL )
+        DecoderPipelineWait( &p_owner->pipe.decode, DECODER_ITEM_DRAIN );
+    else
+    {
+        struct decoder_item item = {
+            .type = DECODER_ITEM_BLOCK, .block = p_block,
+        };
+        atomic_fetch_add( &p_owner->pipe.pending, 1 );
+        DecoderQueuePush( &p_owner->pipe.decode, &item );
+    }
+}
+
+/**
+ * Request the DecodeThread to drain and reload the decoder module
+ */
+static int DecoderThread_QueueReload( vlc_input_decoder_t *p_owner,
+                                      const es_format_t *p_fmt )
+{
+    es_format_t *fmt = malloc( sizeof( *fmt ) );
+    if( unlikely( fmt == NULL ) || es_format_Copy( fmt, p_fmt ) != VLC_SUCCESS )
+    {
+        free( fmt );
+        return VLC_ENOMEM;
+    }
+
+    es_format_Clean( &p_owner->pipe.fmt );
+    if( es_format_Copy( &p_owner->pipe.fmt, p_fmt ) != VLC_SUCCESS )
+        es_format_Init( &p_owner->pipe.fmt, p_fmt->i_cat, 0 );
+
+    struct decoder_item item = { .type = DECODER_ITEM_RELOAD, .fmt = fmt };
+    DecoderQueuePush( &p_owner->pipe.decode, &item );
+    return VLC_SUCCESS;
+}
+
 /**
  * Decode a block
  *
@@ -1368,7 +1670,8 @@ static void DecoderThread_ProcessInput( vlc_input_decoder_t *p_owner, block_t *p
 {
     decoder_t *p_dec = &p_owner->dec;
 
-    if( p_owner->error )
+    /* When pipelined, errors and reloads are handled by the DecodeThread */
+    if( !p_owner->pipe.enabled && p_owner->error )
         goto error;
 
     /* Here, the atomic doesn't prevent to miss a reload request.
@@ -1376,7 +1679,8 @@ static void DecoderThread_ProcessInput( vlc_input_decoder_t *p_owner, block_t *p
      * audio output requested a reload. This will only result in a drop of an
      * input block or an output buffer. */
     enum reload reload;
-    if( ( reload = atomic_exchange( &p_owner->reload, RELOAD_NO_REQUEST ) ) )
+    if( !p_owner->pipe.enabled &&
+        ( reload = atomic_exchange( &p_owner->reload, RELOAD_NO_REQUEST ) ) )
     {
         msg_Warn( p_dec, "Reloading the decoder module%s",
                   reload == RELOAD_DECODER_AOUT ? " and the audio output" : "" );
@@ -1413,22 +1717,41 @@ static void DecoderThread_ProcessInput( vlc_input_decoder_t *p_owner, block_t *p
         block_t *p_packetized_block;
         block_t **pp_block = p_block ? &p_block : NULL;
         decoder_t *p_packetizer = p_owner->p_packetizer;
+        /* The packetizer may output new blocks, keep the demuxer date */
+        vlc_tick_t demux_date = p_block ? p_block->trace.demux
+                                        : VLC_TICK_INVALID;
 
         while( (p_packetized_block =
                 p_packetizer->pf_packetize( p_packetizer, pp_block ) ) )
         {
-            if( !es_format_IsSimilar( &p_dec->fmt_in, &p_packetizer->fmt_out ) )
+            /* The decoder module input format is owned by the DecodeThread
+             * when pipelined */
+            const es_format_t *fmt_in = p_owner->pipe.enabled
+                                      ? &p_owner->pipe.fmt : &p_dec->fmt_in;
+            if( !es_format_IsSimilar( fmt_in, &p_packetizer->fmt_out ) )
             {
                 msg_Dbg( p_dec, "restarting module due to input format change");
 
-                /* Drain the decoder module */
-                DecoderThread_DecodeBlock( p_owner, NULL );
-
-                if( DecoderThread_Reload( p_owner, &p_packetizer->fmt_out,
-                                          RELOAD_DECODER ) != VLC_SUCCESS )
+                if( p_owner->pipe.enabled )
                 {
-                    block_ChainRelease( p_packetized_block );
-                    return;
+                    if( DecoderThread_QueueReload( p_owner,
+                                &p_packetizer->fmt_out ) != VLC_SUCCESS )
+                    {
+                        block_ChainRelease( p_packetized_block );
+                        return;
+                    }
+                }
+                else
+                {
+                    /* Drain the decoder module */
+                    DecoderThread_DecodeBlock( p_owner, NULL );
+
+                    if( DecoderThread_Reload( p_owner, &p_packetizer->fmt_out,
+                                              RELOAD_DECODER ) != VLC_SUCCESS )
+                    {
+                        block_ChainRelease( p_packetized_block );
+                        return;
+                    }
                 }
             }
 
@@ -1440,8 +1763,11 @@ static void DecoderThread_ProcessInput( vlc_input_decoder_t *p_owner, block_t *p
                 block_t *p_next = p_packetized_block->p_next;
                 p_packetized_block->p_next = NULL;
 
-                DecoderThread_DecodeBlock( p_owner, p_packetized_block );
-                if( p_owner->error )
+                if( p_packetized_block->trace.demux == VLC_TICK_INVALID )
+                    p_packetized_block->trace.demux = demux_date;
+
+                DecoderThread_QueueBlock( p_owner, p_packetized_block );
+                if( !p_owner->pipe.enabled && p_owner->error )
                 {
                     block_ChainRelease( p_next );
                     return;
@@ -1452,10 +1778,10 @@ static void DecoderThread_ProcessInput( vlc_input_decoder_t *p_owner, block_t *p
         }
         /* Drain the decoder after the packetizer is drained */
         if( !pp_block )
-            DecoderThread_DecodeBlock( p_owner, NULL );
+            DecoderThread_QueueBlock( p_owner, NULL );
     }
     else
-        DecoderThread_DecodeBlock( p_owner, p_block );
+        DecoderThread_QueueBlock( p_owner, p_block );
     return;
 
 error:
@@ -1468,13 +1794,21 @@ static void DecoderThread_Flush( vlc_input_decoder_t *p_owner )
     decoder_t *p_dec = &p_owner->dec;
     decoder_t *p_packetizer = p_owner->p_packetizer;
 
-    if( p_owner->error )
+    if( p_owner->pipe.enabled )
+    {
+        /* Drop the queued data, and flush the decoder module from its own
+         * thread */
+        atomic_store( &p_owner->pipe.flushing, true );
+        DecoderPipelineWait( &p_owner->pipe.decode, DECODER_ITEM_FLUSH );
+        atomic_store( &p_owner->pipe.flushing, false );
+    }
+    else if( p_owner->error )
         return;
 
     if( p_packetizer != NULL && p_packetizer->pf_flush != NULL )
         p_packetizer->pf_flush( p_packetizer );
 
-    if ( p_dec->pf_flush != NULL )
+    if ( !p_owner->pipe.enabled && p_dec->pf_flush != NULL )
         p_dec->pf_flush( p_dec );
 
     /* flush CC sub decoders */
@@ -1509,6 +1843,9 @@ static void DecoderThread_Flush( vlc_input_decoder_t *p_owner )
          * vlc_input_decoder_Flush() */
         if( p_owner->out_pool != NULL )
             picture_pool_Cancel( p_owner->out_pool, false );
+
+        for( size_t i = 0; i < DECODER_TRACE_COUNT; i++ )
+            p_owner->traces[i].pts = VLC_TICK_INVALID;
     }
     else if( p_dec->fmt_in.i_cat == SPU_ES )
     {
@@ -1749,6 +2086,185 @@ static void *DecoderThread( void *p_data )
     return NULL;
 }
 
+/**
+ * Accounts for a buffer leaving the pipeline
+ */
+static void DecoderPipelineDone( vlc_input_decoder_t *p_owner )
+{
+    if( atomic_fetch_sub( &p_owner->pipe.pending, 1 ) == 1 )
+    {   /* vlc_input_decoder_Wait() checks whether the pipeline is empty */
+        vlc_mutex_lock( &p_owner->lock );
+        vlc_cond_signal( &p_owner->wait_acknowledge );
+        vlc_mutex_unlock( &p_owner->lock );
+    }
+}
+
+/**
+ * The decoder module loop, when pipelined
+ */
+static void *DecodeThread( void *p_data )
+{
+    vlc_input_decoder_t *p_owner = p_data;
+    decoder_t *p_dec = &p_owner->dec;
+    struct decoder_item item;
+
+    for( ;; )
+    {
+        DecoderQueuePop( &p_owner->pipe.decode, &item );
+
+        switch( item.type )
+        {
+            case DECODER_ITEM_BLOCK:
+                if( atomic_load( &p_owner->pipe.flushing ) )
+                    block_Release( item.block );
+                else
+                    DecodeThread_Decode( p_owner, item.block );
+                DecoderPipelineDone( p_owner );
+                break;
+
+            case DECODER_ITEM_DRAIN:
+                DecodeThread_Decode( p_owner, NULL );
+                /* Acknowledged once the output is played */
+                DecoderQueuePush( &p_owner->pipe.output, &item );
+                break;
+
+            case DECODER_ITEM_FLUSH:
+                if( !p_owner->error && p_dec->pf_flush != NULL )
+                    p_dec->pf_flush( p_dec );
+                /* Acknowledged once the output is dropped */
+                DecoderQueuePush( &p_owner->pipe.output, &item );
+                break;
+
+            case DECODER_ITEM_RELOAD:
+                if( !p_owner->error )
+                {
+                    /* Drain the decoder module */
+                    DecoderThread_DecodeBlock( p_owner, NULL );
+                    ModuleThread_SyncOutput( p_owner );
+                    DecoderThread_Reload( p_owner, item.fmt, RELOAD_DECODER );
+                }
+                es_format_Clean( item.fmt );
+                free( item.fmt );
+                break;
+
+            case DECODER_ITEM_QUIT:
+                return NULL;
+
+            default:
+                vlc_assert_unreachable();
+        }
+    }
+}
+
+/**
+ * The output loop, when pipelined
+ */
+static void *OutputThread( void *p_data )
+{
+    vlc_input_decoder_t *p_owner = p_data;
+    struct decoder_item item;
+
+    for( ;; )
+    {
+        DecoderQueuePop( &p_owner->pipe.output, &item );
+
+        switch( item.type )
+        {
+            case DECODER_ITEM_PICTURE:
+                if( atomic_load( &p_owner->pipe.flushing ) )
+                    picture_Release( item.picture );
+                else
+                {
+                    int ret = ModuleThread_PlayVideo( p_owner, item.picture );
+                    ModuleThread_UpdateStatVideo( p_owner, ret != VLC_SUCCESS );
+                }
+                DecoderPipelineDone( p_owner );
+                break;
+
+            case DECODER_ITEM_BLOCK:
+                if( atomic_load( &p_owner->pipe.flushing ) )
+                    block_Release( item.block );
+                else
+                {
+                    int ret = ModuleThread_PlayAudio( p_owner, item.block );
+                    ModuleThread_UpdateStatAudio( p_owner, ret != VLC_SUCCESS );
+                }
+                DecoderPipelineDone( p_owner );
+                break;
+
+            case DECODER_ITEM_DRAIN:
+            case DECODER_ITEM_FLUSH:
+            case DECODER_ITEM_SYNC:
+                vlc_sem_post( item.done );
+                break;
+
+            case DECODER_ITEM_QUIT:
+                return NULL;
+
+            default:
+                vlc_assert_unreachable();
+        }
+    }
+}
+
+static void DecoderPipelineStart( vlc_input_decoder_t *p_owner, int i_priority )
+{
+    decoder_t *p_dec = &p_owner->dec;
+
+    DecoderQueueInit( &p_owner->pipe.decode );
+    DecoderQueueInit( &p_owner->pipe.output );
+    atomic_init( &p_owner->pipe.flushing, false );
+    atomic_init( &p_owner->pipe.pending, 0 );
+    if( es_format_Copy( &p_owner->pipe.fmt, &p_dec->fmt_in ) != VLC_SUCCESS )
+        return;
+
+    /* The flag must be set before the module can output from the thread */
+    p_owner->pipe.enabled = true;
+    if( vlc_clone( &p_owner->pipe.output_thread, OutputThread, p_owner,
+                   i_priority ) )
+        goto error;
+    if( vlc_clone( &p_owner->pipe.decode_thread, DecodeThread, p_owner,
+                   i_priority ) )
+    {
+        struct decoder_item item = { .type = DECODER_ITEM_QUIT };
+        DecoderQueuePush( &p_owner->pipe.output, &item );
+        vlc_join( p_owner->pipe.output_thread, NULL );
+        goto error;
+    }
+    msg_Dbg( p_dec, "pipelined decoding" );
+    return;
+
+error:
+    msg_Warn( p_dec, "cannot spawn pipeline threads" );
+    p_owner->pipe.enabled = false;
+    es_format_Clean( &p_owner->pipe.fmt );
+}
+
+/* Stops the DecodeThread, once the DecoderThread is stopped */
+static void DecoderPipelineStopDecode( vlc_input_decoder_t *p_owner )
+{
+    struct decoder_item item = { .type = DECODER_ITEM_QUIT };
+
+    atomic_store( &p_owner->pipe.flushing, true );
+    DecoderQueuePush( &p_owner->pipe.decode, &item );
+    vlc_join( p_owner->pipe.decode_thread, NULL );
+}
+
+/* Stops the OutputThread, once the decoder module is closed */
+static void DecoderPipelineStopOutput( vlc_input_decoder_t *p_owner )
+{
+    struct decoder_item item = { .type = DECODER_ITEM_QUIT };
+
+    DecoderQueuePush( &p_owner->pipe.output, &item );
+    vlc_join( p_owner->pipe.output_thread, NULL );
+    es_format_Clean( &p_owner->pipe.fmt );
+}
+
+static bool DecoderPipelineIsEmpty( vlc_input_decoder_t *p_owner )
+{
+    return !p_owner->pipe.enabled || atomic_load( &p_owner->pipe.pending ) == 0;
+}
+
 static const struct decoder_owner_callbacks dec_video_cbs =
 {
     .video = {
@@ -1849,10 +2365,17 @@ CreateDecoder( vlc_object_t *p_parent, const es_format_t *fmt,
     p_owner->drained = false;
     atomic_init( &p_owner->reload, RELOAD_NO_REQUEST );
     p_owner->b_idle = false;
+    p_owner->pipe.enabled = false;
 
     p_owner->mouse_event = NULL;
     p_owner->mouse_opaque = NULL;
 
+    for( size_t i = 0; i < DECODER_TRACE_COUNT; i++ )
+        p_owner->traces[i].pts = VLC_TICK_INVALID;
+    p_owner->traces_next = 0;
+    for( size_t i = 0; i < INPUT_LATENCY_STAGE_COUNT; i++ )
+        vlc_latency_histogram_Init( &p_owner->latency[i] );
+
     es_format_Init( &p_owner->fmt, fmt->i_cat, 0 );
 
     /* decoder fifo */
@@ -1958,6 +2481,9 @@ static void DeleteDecoder( vlc_input_decoder_t *p_owner )
 
     const enum es_format_category_e i_cat =p_dec->fmt_in.i_cat;
     decoder_Clean( p_dec );
+    /* Asynchronous modules may output until they are closed */
+    if( p_owner->pipe.enabled )
+        DecoderPipelineStopOutput( p_owner );
     if ( p_owner->out_pool )
     {
         picture_pool_Release( p_owner->out_pool );
@@ -2110,10 +2636,17 @@ decoder_New( vlc_object_t *p_parent, const es_format_t *fmt, const char *psz_id,
     }
 #endif
 
+    if( p_sout == NULL && !thumbnailing
+     && ( fmt->i_cat == VIDEO_ES || fmt->i_cat == AUDIO_ES )
+     && var_InheritBool( p_dec, "decoder-pipeline" ) )
+        DecoderPipelineStart( p_owner, i_priority );
+
     /* Spawn the decoder thread */
     if( vlc_clone( &p_owner->thread, DecoderThread, p_owner, i_priority ) )
     {
         msg_Err( p_dec, "cannot spawn decoder thread" );
+        if( p_owner->pipe.enabled )
+            DecoderPipelineStopDecode( p_owner );
         DeleteDecoder( p_owner );
         return NULL;
     }
@@ -2207,6 +2740,8 @@ void vlc_input_decoder_Delete( vlc_input_decoder_t *p_owner )
     vlc_mutex_unlock( &p_owner->lock );
 
     vlc_join( p_owner->thread, NULL );
+    if( p_owner->pipe.enabled )
+        DecoderPipelineStopDecode( p_owner );
 
     /* */
     if( p_owner->cc.b_supported )
@@ -2261,7 +2796,8 @@ bool vlc_input_decoder_IsEmpty( vlc_input_decoder_t * p_owner )
     assert( !p_owner->b_waiting );
 
     vlc_fifo_Lock( p_owner->p_fifo );
-    if( !vlc_fifo_IsEmpty( p_owner->p_fifo ) || p_owner->b_draining )
+    if( !vlc_fifo_IsEmpty( p_owner->p_fifo ) || p_owner->b_draining
+     || !DecoderPipelineIsEmpty( p_owner ) )
     {
         vlc_fifo_Unlock( p_owner->p_fifo );
         return false;
@@ -2316,6 +2852,11 @@ void vlc_input_decoder_Flush( vlc_input_decoder_t *p_owner )
     /* Empty the fifo */
     block_ChainRelease( vlc_fifo_DequeueAllUnlocked( p_owner->p_fifo ) );
 
+    /* Drop the data already queued in the pipeline, until the DecoderThread
+     * has flushed it */
+    if( p_owner->pipe.enabled )
+        atomic_store( &p_owner->pipe.flushing, true );
+
     /* Don't need to wait for the DecoderThread to flush. Indeed, if called a
      * second time, this function will clear the FIFO again before anything was
      * dequeued by DecoderThread and there is no need to flush a second time in
@@ -2513,7 +3054,8 @@ void vlc_input_decoder_Wait( vlc_input_decoder_t *p_owner )
         if( p_owner->paused )
             break;
         vlc_fifo_Lock( p_owner->p_fifo );
-        if( p_owner->b_idle && vlc_fifo_IsEmpty( p_owner->p_fifo ) )
+        if( p_owner->b_idle && vlc_fifo_IsEmpty( p_owner->p_fifo )
+         && DecoderPipelineIsEmpty( p_owner ) )
         {
             msg_Err( &p_owner->dec, "buffer deadlock prevented" );
             vlc_fifo_Unlock( p_owner->p_fifo );
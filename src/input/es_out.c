@@ -392,7 +392,8 @@ decoder_on_thumbnail_ready(vlc_input_decoder_t *decoder, picture_t *pic, void *u
 
 static void
 decoder_on_new_video_stats(vlc_input_decoder_t *decoder, unsigned decoded, unsigned lost,
-                           unsigned displayed, unsigned late, void *userdata)
+                           unsigned displayed, unsigned late,
+                           struct vlc_latency_histogram *latency, void *userdata)
 {
     (void) decoder;
 
@@ -415,6 +416,8 @@ decoder_on_new_video_stats(vlc_input_decoder_t *decoder, unsigned decoded, unsig
                               memory_order_relaxed);
     atomic_fetch_add_explicit(&stats->late_pictures, late,
                               memory_order_relaxed);
+    for (size_t i = 0; i < INPUT_LATENCY_STAGE_COUNT; i++)
+        vlc_latency_histogram_Move(&stats->latency[i], &latency[i]);
 }
 
 static void
@@ -2904,6 +2907,9 @@ static int EsOutSend( es_out_t *out, es_out_id_t *es, block_t *p_block )
     assert( p_block->p_next == NULL );
     struct vlc_tracer *tracer = vlc_object_get_tracer( &p_input->obj );
 
+    if( p_block->trace.demux == VLC_TICK_INVALID )
+        p_block->trace.demux = vlc_tick_now();
+
     if ( tracer != NULL )
     {
         vlc_tracer_TraceStreamDTS( tracer, "DEMUX", es->id.str_id, "OUT",
@@ -96,7 +96,10 @@ enum es_out_query_private_e
     ES_OUT_PRIV_SET_VBI_PAGE,                       /* arg1=unsigned res=can fail */
 
     /* Set VBI/Teletext menu transparent */
-    ES_OUT_PRIV_SET_VBI_TRANSPARENCY                /* arg1=bool res=can fail */
+    ES_OUT_PRIV_SET_VBI_TRANSPARENCY,               /* arg1=bool res=can fail */
+
+    /* Skip forward or backward in the timeshift buffer */
+    ES_OUT_PRIV_SKIP_TIMESHIFT,                     /* arg1=vlc_tick_t res=can fail */
 };
 
 static inline int es_out_vaPrivControl( es_out_t *out, int query, va_list args )
@@ -203,6 +206,10 @@ static inline int es_out_SetFrameNext( es_out_t *p_out )
 {
     return es_out_PrivControl( p_out, ES_OUT_PRIV_SET_FRAME_NEXT );
 }
+static inline int es_out_SkipTimeshift( es_out_t *p_out, vlc_tick_t i_skip )
+{
+    return es_out_PrivControl( p_out, ES_OUT_PRIV_SKIP_TIMESHIFT, i_skip );
+}
 static inline void es_out_SetTimes( es_out_t *p_out, double f_position,
                                     vlc_tick_t i_time, vlc_tick_t i_normal_time,
                                     vlc_tick_t i_length )
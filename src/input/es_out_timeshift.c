@@ -36,6 +36,10 @@
 #endif
 #include <sys/stat.h>
 #include <unistd.h>
+#ifdef HAVE_MMAP
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#endif
 
 #include <vlc_common.h>
 #include <vlc_fs.h>
@@ -45,6 +49,7 @@
 #endif
 #include <vlc_es_out.h>
 #include <vlc_block.h>
+#include <vlc_vector.h>
 #include "input_internal.h"
 #include "es_out.h"
 
@@ -188,25 +193,49 @@ static_assert(offsetof(ts_cmd_t, header) == offsetof(ts_cmd_send_t, header), "in
 static_assert(offsetof(ts_cmd_t, header) == offsetof(ts_cmd_control_t, header), "invalid packing");
 static_assert(offsetof(ts_cmd_t, header) == offsetof(ts_cmd_privcontrol_t, header), "invalid packing");
 
+struct ts_cmd_vector VLC_VECTOR(ts_cmd_t);
+
+/* Header of the block data in storage files */
+typedef struct
+{
+    vlc_tick_t i_dts;
+    vlc_tick_t i_pts;
+    vlc_tick_t i_length;
+    uint32_t   i_flags;
+    unsigned   i_nb_samples;
+    size_t     i_buffer;
+} ts_storage_block_t;
+
+/* A storage is one segment of the timeshift buffer. The data of C_SEND
+ * commands lives in a temporary file, mapped in memory while the segment is
+ * read or written. The commands themselves are kept in memory in date
+ * order, which makes them the time index of the segment. */
 typedef struct ts_storage_t ts_storage_t;
 struct ts_storage_t
 {
-    ts_storage_t *p_next;
-
     /* */
 #ifdef _WIN32
     char    *psz_file;  /* Filename */
+#endif
+#ifdef HAVE_MMAP
+    int     fd;
+    uint8_t *p_map;     /* File mapping, NULL if not mapped */
+#else
+    FILE    *p_file;    /* FILE handle for data reading and writing */
 #endif
     size_t  i_file_max; /* Max size in bytes */
-    int64_t i_file_size;/* Current size in bytes */
-    FILE    *p_filew;   /* FILE handle for data writing */
-    FILE    *p_filer;   /* FILE handle for data reading */
+    size_t  i_file_size;/* Current size in bytes */
 
     /* */
-    uint8_t *p_cmd_r;
-    uint8_t *p_cmd_w;
-    uint8_t *p_cmd_buf;
-    size_t   i_cmd_buf;
+    struct ts_cmd_vector cmds;
+    size_t   i_cmd_r;   /* Index of the next command to read */
+    size_t   i_cmd_first; /* Index of the first command that can be read
+                           * again when skipping back */
+
+    /* Indexes of the commands other than C_SEND, which must be executed
+     * even when skipped over */
+    struct VLC_VECTOR(size_t) controls;
+    size_t   i_control_r;
 };
 
 typedef struct
@@ -236,11 +265,14 @@ typedef struct
     /* */
     vlc_tick_t     i_buffering_delay;
 
-    /* */
-    ts_storage_t   *p_storage_r;
-    ts_storage_t   *p_storage_w;
+    /* Storages, from the one being read to the one being written */
+    struct VLC_VECTOR(ts_storage_t *) storages;
+    /* Storages read to the end, kept to skip back into them */
+    struct VLC_VECTOR(ts_storage_t *) played;
+    vlc_tick_t     i_played_max;
 
     vlc_tick_t     i_cmd_delay;
+    vlc_tick_t     i_skip;      /* Pending skip */
 
 } ts_thread_t;
 
@@ -257,6 +289,7 @@ typedef struct
     /* Configuration */
     int64_t        i_tmp_size_max;    /* Maximal temporary file size in byte */
     char           *psz_tmp_path;     /* Path for temporary files */
+    vlc_tick_t     i_played_max;      /* Played duration kept to skip back */
 
     /* Lock for all following fields */
     vlc_mutex_t    lock;
@@ -290,18 +323,26 @@ static bool         TsHasCmd( ts_thread_t * );
 static bool         TsIsUnused( ts_thread_t * );
 static int          TsChangePause( ts_thread_t *, bool b_source_paused, bool b_paused, vlc_tick_t i_date );
 static int          TsChangeRate( ts_thread_t *, float src_rate, float rate );
+static int          TsSkip( ts_thread_t *, vlc_tick_t i_skip );
 
 static void         *TsRun( void * );
 
-static ts_storage_t *TsStorageNew( const char *psz_path, int64_t i_tmp_size_max );
+static ts_storage_t *TsStorageNew( const char *psz_path, size_t i_size );
 static void         TsStorageDelete( ts_storage_t * );
-static void         TsStoragePack( ts_storage_t *p_storage );
+static void         TsStorageUnmap( ts_storage_t * );
+static size_t       TsStorageSizeofData( const ts_cmd_t *p_cmd );
 static bool         TsStorageIsFull( ts_storage_t *, const ts_cmd_t *p_cmd );
 static bool         TsStorageIsEmpty( ts_storage_t * );
-static void         TsStoragePushCmd( ts_storage_t *, const ts_cmd_t *p_cmd, bool b_flush );
+static vlc_tick_t   TsStorageGetDate( ts_storage_t * );
+static vlc_tick_t   TsStorageGetFirstDate( ts_storage_t * );
+static vlc_tick_t   TsStorageGetLastDate( ts_storage_t * );
+static size_t       TsStorageFind( ts_storage_t *, vlc_tick_t i_date );
+static void         TsStorageRewind( ts_storage_t *, vlc_tick_t i_date );
+static void         TsStoragePushCmd( ts_storage_t *, const ts_cmd_t *p_cmd );
 static void         TsStoragePopCmd( ts_storage_t *p_storage, ts_cmd_t *p_cmd, bool b_flush );
 
 static void CmdClean( ts_cmd_t * );
+static bool CmdIsReplayable( const ts_cmd_t * );
 
 static int  CmdInitAdd    ( ts_cmd_add_t *, input_source_t *, es_out_id_t *, const es_format_t *, bool b_copy );
 static void CmdInitSend   ( ts_cmd_send_t *, es_out_id_t *, block_t * );
@@ -361,6 +402,9 @@ es_out_t *input_EsOutTimeshiftNew( input_thread_t *p_input, es_out_t *p_next_out
     msg_Dbg( p_input, "using timeshift granularity of %d MiB",
              (int)p_sys->i_tmp_size_max/(1024*1024) );
 
+    p_sys->i_played_max = vlc_tick_from_sec(
+        __MAX( var_InheritInteger( p_input, "input-timeshift-rewind" ), 0 ) );
+
     p_sys->psz_tmp_path = var_InheritString( p_input, "input-timeshift-path" );
 #if defined (_WIN32) && !defined(VLC_WINSTORE_APP)
     if( p_sys->psz_tmp_path == NULL )
@@ -827,6 +871,14 @@ static int PrivControlLocked( es_out_t *p_tsout, int i_query, va_list args )
     {
         return ControlLockedSetFrameNext( p_tsout );
     }
+    case ES_OUT_PRIV_SKIP_TIMESHIFT:
+    {
+        const vlc_tick_t i_skip = va_arg( args, vlc_tick_t );
+
+        if( !p_sys->b_delayed )
+            return VLC_EGENERIC;
+        return TsSkip( p_sys->p_ts, i_skip );
+    }
     case ES_OUT_PRIV_GET_GROUP_FORCED:
         return es_out_vaPrivControl( p_sys->p_out, i_query, args );
     /* Invalid queries for this es_out level */
@@ -891,6 +943,7 @@ static int TsStart( es_out_t *p_out )
         return VLC_EGENERIC;
 
     p_ts->i_tmp_size_max = p_sys->i_tmp_size_max;
+    p_ts->i_played_max = p_sys->i_played_max;
     p_ts->psz_tmp_path = p_sys->psz_tmp_path;
     p_ts->p_input = p_sys->p_input;
     p_ts->p_out = p_sys->p_out;
@@ -906,8 +959,9 @@ static int TsStart( es_out_t *p_out )
     p_ts->i_rate_delay = 0;
     p_ts->i_buffering_delay = 0;
     p_ts->i_cmd_delay = 0;
-    p_ts->p_storage_r = NULL;
-    p_ts->p_storage_w = NULL;
+    p_ts->i_skip = 0;
+    vlc_vector_init( &p_ts->storages );
+    vlc_vector_init( &p_ts->played );
 
     p_sys->b_delayed = true;
     if( vlc_clone( &p_ts->thread, TsRun, p_ts, VLC_THREAD_PRIORITY_INPUT ) )
@@ -952,21 +1006,43 @@ static void TsStop( ts_thread_t *p_ts )
 
         CmdClean( &cmd );
     }
-    assert( !p_ts->p_storage_r || !p_ts->p_storage_r->p_next );
-    if( p_ts->p_storage_r )
-        TsStorageDelete( p_ts->p_storage_r );
+    ts_storage_t *p_storage;
+    vlc_vector_foreach( p_storage, &p_ts->storages )
+        TsStorageDelete( p_storage );
+    vlc_vector_destroy( &p_ts->storages );
+    vlc_vector_foreach( p_storage, &p_ts->played )
+        TsStorageDelete( p_storage );
+    vlc_vector_destroy( &p_ts->played );
     vlc_mutex_unlock( &p_ts->lock );
 
     TsDestroy( p_ts );
 }
+static ts_storage_t *TsGetStorageR( ts_thread_t *p_ts )
+{
+    return p_ts->storages.size > 0 ? p_ts->storages.data[0] : NULL;
+}
+static ts_storage_t *TsGetStorageW( ts_thread_t *p_ts )
+{
+    return p_ts->storages.size > 0 ?
+           p_ts->storages.data[p_ts->storages.size - 1] : NULL;
+}
 static void TsPushCmd( ts_thread_t *p_ts, ts_cmd_t *p_cmd )
 {
     vlc_mutex_lock( &p_ts->lock );
 
-    if( !p_ts->p_storage_w || TsStorageIsFull( p_ts->p_storage_w, p_cmd ) )
+    ts_storage_t *p_storage_w = TsGetStorageW( p_ts );
+    if( !p_storage_w || TsStorageIsFull( p_storage_w, p_cmd ) )
     {
-        ts_storage_t *p_storage = TsStorageNew( p_ts->psz_tmp_path, p_ts->i_tmp_size_max );
+        /* A single block may be larger than the granularity */
+        const size_t i_size = __MAX( (size_t)p_ts->i_tmp_size_max,
+                                     TsStorageSizeofData( p_cmd ) );
+        ts_storage_t *p_storage = TsStorageNew( p_ts->psz_tmp_path, i_size );
 
+        if( p_storage && !vlc_vector_push( &p_ts->storages, p_storage ) )
+        {
+            TsStorageDelete( p_storage );
+            p_storage = NULL;
+        }
         if( !p_storage )
         {
             CmdClean( p_cmd );
@@ -975,44 +1051,82 @@ static void TsPushCmd( ts_thread_t *p_ts, ts_cmd_t *p_cmd )
             return;
         }
 
-        if( !p_ts->p_storage_w )
-        {
-            p_ts->p_storage_r = p_ts->p_storage_w = p_storage;
-        }
-        else
-        {
-            TsStoragePack( p_ts->p_storage_w );
-            p_ts->p_storage_w->p_next = p_storage;
-            p_ts->p_storage_w = p_storage;
-        }
+        /* Only the storages being read and written are mapped */
+        if( p_storage_w && p_storage_w != TsGetStorageR( p_ts ) )
+            TsStorageUnmap( p_storage_w );
+        p_storage_w = p_storage;
     }
 
     /* TODO return error and warn the user (but only once) */
-    TsStoragePushCmd( p_ts->p_storage_w, p_cmd, p_ts->p_storage_r == p_ts->p_storage_w );
+    TsStoragePushCmd( p_storage_w, p_cmd );
 
     vlc_cond_signal( &p_ts->wait );
 
     vlc_mutex_unlock( &p_ts->lock );
 }
-static int TsPopCmdLocked( ts_thread_t *p_ts, ts_cmd_t *p_cmd, bool b_flush )
+/* Returns the date of the next command to read */
+static vlc_tick_t TsGetDateLocked( ts_thread_t *p_ts )
 {
-    vlc_mutex_assert( &p_ts->lock );
+    ts_storage_t *p_storage = TsGetStorageR( p_ts );
 
-    if( TsStorageIsEmpty( p_ts->p_storage_r ) )
-        return VLC_EGENERIC;
+    /* Without commands to read, playback is on the live stream */
+    if( TsStorageIsEmpty( p_storage ) )
+        return vlc_tick_now();
+    return TsStorageGetDate( p_storage );
+}
+static bool TsHasPlayedLocked( ts_thread_t *p_ts )
+{
+    ts_storage_t *p_storage = TsGetStorageR( p_ts );
 
-    TsStoragePopCmd( p_ts->p_storage_r, p_cmd, b_flush );
+    return p_ts->played.size > 0
+        || ( p_storage && p_storage->i_cmd_first < p_storage->i_cmd_r );
+}
+static void TsDropPlayedLocked( ts_thread_t *p_ts )
+{
+    ts_storage_t *p_storage;
 
-    while( TsStorageIsEmpty( p_ts->p_storage_r ) )
+    vlc_vector_foreach( p_storage, &p_ts->played )
+        TsStorageDelete( p_storage );
+    vlc_vector_clear( &p_ts->played );
+}
+static void TsDropStoragesLocked( ts_thread_t *p_ts )
+{
+    /* Storages read to the end are kept to skip back into them */
+    while( p_ts->storages.size > 1
+        && TsStorageIsEmpty( p_ts->storages.data[0] ) )
     {
-        ts_storage_t *p_next = p_ts->p_storage_r->p_next;
-        if( !p_next )
-            break;
+        ts_storage_t *p_storage = p_ts->storages.data[0];
 
-        TsStorageDelete( p_ts->p_storage_r );
-        p_ts->p_storage_r = p_next;
+        vlc_vector_remove( &p_ts->storages, 0 );
+        TsStorageUnmap( p_storage );
+        if( p_storage->i_cmd_first >= p_storage->cmds.size
+         || !vlc_vector_push( &p_ts->played, p_storage ) )
+            TsStorageDelete( p_storage );
     }
 
+    /* Dropping the ones out of the played duration limit only costs
+     * releasing their file */
+    const vlc_tick_t i_date = TsGetDateLocked( p_ts ) - p_ts->i_played_max;
+    size_t i_count = 0;
+    while( i_count < p_ts->played.size
+        && TsStorageGetLastDate( p_ts->played.data[i_count] ) <= i_date )
+        TsStorageDelete( p_ts->played.data[i_count++] );
+    vlc_vector_remove_slice( &p_ts->played, 0, i_count );
+}
+static int TsPopCmdLocked( ts_thread_t *p_ts, ts_cmd_t *p_cmd, bool b_flush )
+{
+    vlc_mutex_assert( &p_ts->lock );
+
+    if( TsStorageIsEmpty( TsGetStorageR( p_ts ) ) )
+        return VLC_EGENERIC;
+
+    TsStoragePopCmd( TsGetStorageR( p_ts ), p_cmd, b_flush );
+    /* Nothing before a command that cannot be executed twice can be read
+     * again */
+    if( !CmdIsReplayable( p_cmd ) )
+        TsDropPlayedLocked( p_ts );
+    TsDropStoragesLocked( p_ts );
+
     return VLC_SUCCESS;
 }
 static bool TsHasCmd( ts_thread_t *p_ts )
@@ -1020,7 +1134,7 @@ static bool TsHasCmd( ts_thread_t *p_ts )
     bool b_cmd;
 
     vlc_mutex_lock( &p_ts->lock );
-    b_cmd = !TsStorageIsEmpty( p_ts->p_storage_r );
+    b_cmd = !TsStorageIsEmpty( TsGetStorageR( p_ts ) );
     vlc_mutex_unlock( &p_ts->lock );
 
     return b_cmd;
@@ -1032,7 +1146,7 @@ static bool TsIsUnused( ts_thread_t *p_ts )
     vlc_mutex_lock( &p_ts->lock );
     b_unused = !p_ts->b_paused &&
                p_ts->rate == p_ts->rate_source &&
-               TsStorageIsEmpty( p_ts->p_storage_r );
+               TsStorageIsEmpty( TsGetStorageR( p_ts ) );
     vlc_mutex_unlock( &p_ts->lock );
 
     return b_unused;
@@ -1086,6 +1200,177 @@ static int TsChangeRate( ts_thread_t *p_ts, float src_rate, float rate )
 
     return i_ret;
 }
+static int TsSkip( ts_thread_t *p_ts, vlc_tick_t i_skip )
+{
+    int i_ret = VLC_EGENERIC;
+
+    vlc_mutex_lock( &p_ts->lock );
+    /* Skip up to the live stream, or back up to the oldest kept command */
+    if( ( i_skip > 0 && !TsStorageIsEmpty( TsGetStorageR( p_ts ) ) )
+     || ( i_skip < 0 && TsHasPlayedLocked( p_ts ) ) )
+    {
+        p_ts->i_skip += i_skip;
+        vlc_cond_signal( &p_ts->wait );
+        i_ret = VLC_SUCCESS;
+    }
+    vlc_mutex_unlock( &p_ts->lock );
+
+    return i_ret;
+}
+
+static void TsExecuteCmd( ts_thread_t *p_ts, ts_cmd_t *p_cmd )
+{
+    switch( p_cmd->header.i_type )
+    {
+    case C_ADD:
+        CmdExecuteAdd( p_ts->p_tsout, &p_cmd->add );
+        CmdCleanAdd( &p_cmd->add );
+        break;
+    case C_SEND:
+        CmdExecuteSend( p_ts->p_tsout, &p_cmd->send );
+        CmdCleanSend( &p_cmd->send );
+        break;
+    case C_CONTROL:
+        CmdExecuteControl( p_ts->p_tsout, &p_cmd->control );
+        CmdCleanControl( &p_cmd->control );
+        break;
+    case C_PRIVCONTROL:
+        CmdExecutePrivControl( p_ts->p_tsout, &p_cmd->privcontrol );
+        break;
+    case C_DEL:
+        CmdExecuteDel( p_ts->p_tsout, &p_cmd->del );
+        break;
+    default:
+        vlc_assert_unreachable();
+        break;
+    }
+}
+
+/* Skips the commands of a storage up to the given index. The data is simply
+ * not read. The commands that cannot be executed twice are added to p_cmds,
+ * to keep the elementary streams and the programs up to date. */
+static void TsSkipStorageLocked( ts_thread_t *p_ts, ts_storage_t *p_storage,
+                                 size_t i_end, struct ts_cmd_vector *p_cmds )
+{
+    assert( i_end >= p_storage->i_cmd_r && i_end <= p_storage->cmds.size );
+
+    while( p_storage->i_control_r < p_storage->controls.size
+        && p_storage->controls.data[p_storage->i_control_r] < i_end )
+    {
+        const size_t i_cmd = p_storage->controls.data[p_storage->i_control_r++];
+        ts_cmd_t *p_cmd = &p_storage->cmds.data[i_cmd];
+
+        /* Skipped clock references and times are kept to skip back */
+        if( CmdIsReplayable( p_cmd ) )
+            continue;
+
+        if( !vlc_vector_push( p_cmds, *p_cmd ) )
+            CmdClean( p_cmd );
+        p_storage->i_cmd_first = i_cmd + 1;
+        TsDropPlayedLocked( p_ts );
+    }
+    p_storage->i_cmd_r = i_end;
+}
+
+static void TsSkipForwardLocked( ts_thread_t *p_ts, vlc_tick_t i_target,
+                                 struct ts_cmd_vector *p_cmds )
+{
+    /* Look for the last storage starting before the target */
+    size_t i_low = 0, i_high = p_ts->storages.size;
+    while( i_high - i_low > 1 )
+    {
+        const size_t i_mid = i_low + (i_high - i_low) / 2;
+
+        if( TsStorageGetDate( p_ts->storages.data[i_mid] ) <= i_target )
+            i_low = i_mid;
+        else
+            i_high = i_mid;
+    }
+
+    ts_storage_t *p_storage = p_ts->storages.data[i_low];
+    while( TsGetStorageR( p_ts ) != p_storage )
+    {
+        ts_storage_t *p_skipped = TsGetStorageR( p_ts );
+
+        TsSkipStorageLocked( p_ts, p_skipped, p_skipped->cmds.size, p_cmds );
+        TsDropStoragesLocked( p_ts );
+    }
+    TsSkipStorageLocked( p_ts, p_storage,
+                         TsStorageFind( p_storage, i_target ), p_cmds );
+    TsDropStoragesLocked( p_ts );
+}
+
+static void TsSkipBackLocked( ts_thread_t *p_ts, vlc_tick_t i_target )
+{
+    ts_storage_t *p_storage_r = TsGetStorageR( p_ts );
+    size_t i_count = 0;
+
+    /* Look for the last played storage starting before the target, unless
+     * the target is in the storage being read */
+    if( p_ts->played.size > 0
+     && ( p_storage_r->i_cmd_first >= p_storage_r->i_cmd_r
+       || TsStorageGetFirstDate( p_storage_r ) > i_target ) )
+    {
+        size_t i_low = 0, i_high = p_ts->played.size;
+        while( i_high - i_low > 1 )
+        {
+            const size_t i_mid = i_low + (i_high - i_low) / 2;
+
+            if( TsStorageGetFirstDate( p_ts->played.data[i_mid] ) <= i_target )
+                i_low = i_mid;
+            else
+                i_high = i_mid;
+        }
+
+        /* Read them again from there */
+        i_count = p_ts->played.size - i_low;
+        if( vlc_vector_insert_all( &p_ts->storages, 0,
+                                   &p_ts->played.data[i_low], i_count ) )
+            vlc_vector_remove_slice( &p_ts->played, i_low, i_count );
+        else
+            i_count = 0;
+    }
+
+    for( size_t i = 1; i <= i_count; i++ )
+        TsStorageRewind( p_ts->storages.data[i], VLC_TICK_MIN );
+    TsStorageRewind( p_ts->storages.data[0], i_target );
+
+    /* Only the storages being read and written are mapped */
+    if( i_count > 0 && p_storage_r != TsGetStorageW( p_ts ) )
+        TsStorageUnmap( p_storage_r );
+}
+
+/* Moves the read position by the pending skip. The skipped commands that
+ * must still be executed are added to p_cmds. */
+static bool TsSkipLocked( ts_thread_t *p_ts, struct ts_cmd_vector *p_cmds )
+{
+    const vlc_tick_t i_skip = p_ts->i_skip;
+
+    p_ts->i_skip = 0;
+    if( i_skip > 0 ? TsStorageIsEmpty( TsGetStorageR( p_ts ) )
+                   : !TsHasPlayedLocked( p_ts ) )
+        return false;
+
+    const vlc_tick_t i_from = TsGetDateLocked( p_ts );
+    const vlc_tick_t i_target = i_from + i_skip;
+
+    if( i_skip > 0 )
+        TsSkipForwardLocked( p_ts, i_target, p_cmds );
+    else
+        TsSkipBackLocked( p_ts, i_target );
+
+    /* Resume playback from the next command to read, or from the live
+     * stream if everything was skipped */
+    const vlc_tick_t i_to = TsGetDateLocked( p_ts );
+
+    msg_Dbg( p_ts->p_input, "es out timeshift: skipped %"PRId64" ms",
+             MS_FROM_VLC_TICK( i_to - i_from ) );
+
+    p_ts->i_cmd_delay += p_ts->i_rate_delay - ( i_to - i_from );
+    p_ts->i_rate_date = -1;
+    p_ts->i_rate_delay = 0;
+    return true;
+}
 
 static void *TsRun( void *p_data )
 {
@@ -1098,6 +1383,26 @@ static void *TsRun( void *p_data )
         ts_cmd_t cmd;
         vlc_tick_t  i_deadline;
 
+        if( p_ts->i_skip != 0 )
+        {
+            struct ts_cmd_vector cmds = VLC_VECTOR_INITIALIZER;
+            const bool b_skipped = TsSkipLocked( p_ts, &cmds );
+
+            i_buffering_date = -1;
+            vlc_mutex_unlock( &p_ts->lock );
+
+            /* Execute the skipped commands and reset the clock without the
+             * lock, like any other command */
+            vlc_vector_foreach( cmd, &cmds )
+                TsExecuteCmd( p_ts, &cmd );
+            vlc_vector_destroy( &cmds );
+            if( b_skipped )
+                es_out_Control( p_ts->p_out, ES_OUT_RESET_PCR );
+
+            vlc_mutex_lock( &p_ts->lock );
+            continue;
+        }
+
         /* Pop a command to execute */
         bool b_buffering = es_out_GetBuffering( p_ts->p_out );
 
@@ -1164,30 +1469,7 @@ static void *TsRun( void *p_data )
         }
 
         /* Execute the command  */
-        switch( cmd.header.i_type )
-        {
-        case C_ADD:
-            CmdExecuteAdd( p_ts->p_tsout, &cmd.add );
-            CmdCleanAdd( &cmd.add );
-            break;
-        case C_SEND:
-            CmdExecuteSend( p_ts->p_tsout, &cmd.send );
-            CmdCleanSend( &cmd.send );
-            break;
-        case C_CONTROL:
-            CmdExecuteControl( p_ts->p_tsout, &cmd.control );
-            CmdCleanControl( &cmd.control );
-            break;
-        case C_PRIVCONTROL:
-            CmdExecutePrivControl( p_ts->p_tsout, &cmd.privcontrol );
-            break;
-        case C_DEL:
-            CmdExecuteDel( p_ts->p_tsout, &cmd.del );
-            break;
-        default:
-            vlc_assert_unreachable();
-            break;
-        }
+        TsExecuteCmd( p_ts, &cmd );
         vlc_mutex_lock( &p_ts->lock );
     }
     vlc_mutex_unlock( &p_ts->lock );
@@ -1197,8 +1479,7 @@ static void *TsRun( void *p_data )
 /*****************************************************************************
  *
  *****************************************************************************/
-#define MAX_COMMAND_SIZE sizeof(ts_cmd_t)
-#define TS_STORAGE_COMMAND_PREALLOC 30000
+#define TS_STORAGE_COMMAND_MAX 30000
 
 static const size_t TsStorageSizeofCommand[] =
 {
@@ -1209,7 +1490,7 @@ static const size_t TsStorageSizeofCommand[] =
     [C_PRIVCONTROL] = sizeof(ts_cmd_privcontrol_t)
 };
 
-static ts_storage_t *TsStorageNew( const char *psz_tmp_path, int64_t i_tmp_size_max )
+static ts_storage_t *TsStorageNew( const char *psz_tmp_path, size_t i_size )
 {
     ts_storage_t *p_storage = malloc( sizeof (*p_storage) );
     if( unlikely(p_storage == NULL) )
@@ -1223,21 +1504,30 @@ static ts_storage_t *TsStorageNew( const char *psz_tmp_path, int64_t i_tmp_size_
         return NULL;
     }
 
-    p_storage->p_filew = fdopen( fd, "w+b" );
-    if( p_storage->p_filew == NULL )
+#ifdef HAVE_MMAP
+    /* Allocate the whole file up front, so that writing to the mapping
+     * cannot fail for lack of space */
+# ifdef HAVE_POSIX_FALLOCATE
+    if( posix_fallocate( fd, 0, i_size ) != 0 )
+# else
+    if( ftruncate( fd, i_size ) != 0 )
+# endif
     {
         vlc_close( fd );
         vlc_unlink( psz_file );
         goto error;
     }
-
-    p_storage->p_filer = vlc_fopen( psz_file, "rb" );
-    if( p_storage->p_filer == NULL )
+    p_storage->fd = fd;
+    p_storage->p_map = NULL;
+#else
+    p_storage->p_file = fdopen( fd, "w+b" );
+    if( p_storage->p_file == NULL )
     {
-        fclose( p_storage->p_filew );
+        vlc_close( fd );
         vlc_unlink( psz_file );
         goto error;
     }
+#endif
 
 #ifndef _WIN32
     vlc_unlink( psz_file );
@@ -1245,24 +1535,18 @@ static ts_storage_t *TsStorageNew( const char *psz_tmp_path, int64_t i_tmp_size_
 #else
     p_storage->psz_file = psz_file;
 #endif
-    p_storage->p_next = NULL;
 
     /* */
-    p_storage->i_file_max = i_tmp_size_max;
+    p_storage->i_file_max = i_size;
     p_storage->i_file_size = 0;
 
     /* */
-    p_storage->p_cmd_buf = vlc_alloc( TS_STORAGE_COMMAND_PREALLOC, MAX_COMMAND_SIZE );
-    p_storage->i_cmd_buf = TS_STORAGE_COMMAND_PREALLOC * MAX_COMMAND_SIZE;
-    p_storage->p_cmd_w = p_storage->p_cmd_buf;
-    p_storage->p_cmd_r = p_storage->p_cmd_buf;
-    //fprintf( stderr, "\nSTORAGE name=%s size=%d KiB\n", p_storage->psz_file, p_storage->i_cmd_max * sizeof(*p_storage->p_cmd) /1024 );
+    vlc_vector_init( &p_storage->cmds );
+    p_storage->i_cmd_r = 0;
+    p_storage->i_cmd_first = 0;
+    vlc_vector_init( &p_storage->controls );
+    p_storage->i_control_r = 0;
 
-    if( !p_storage->p_cmd_buf )
-    {
-        TsStorageDelete( p_storage );
-        return NULL;
-    }
     return p_storage;
 error:
     free( psz_file );
@@ -1272,18 +1556,24 @@ error:
 
 static void TsStorageDelete( ts_storage_t *p_storage )
 {
-    while( p_storage->p_cmd_r < p_storage->p_cmd_w )
+    /* Only the commands other than C_SEND need cleaning. The ones already
+     * read were executed, unless they can be read again. */
+    for( size_t i = 0; i < p_storage->controls.size; i++ )
     {
-        ts_cmd_t cmd;
+        ts_cmd_t cmd = p_storage->cmds.data[p_storage->controls.data[i]];
 
-        TsStoragePopCmd( p_storage, &cmd, true );
-
-        CmdClean( &cmd );
+        if( i >= p_storage->i_control_r || CmdIsReplayable( &cmd ) )
+            CmdClean( &cmd );
     }
-    free( p_storage->p_cmd_buf );
+    vlc_vector_destroy( &p_storage->controls );
+    vlc_vector_destroy( &p_storage->cmds );
 
-    fclose( p_storage->p_filer );
-    fclose( p_storage->p_filew );
+#ifdef HAVE_MMAP
+    TsStorageUnmap( p_storage );
+    vlc_close( p_storage->fd );
+#else
+    fclose( p_storage->p_file );
+#endif
 #ifdef _WIN32
     vlc_unlink( p_storage->psz_file );
     free( p_storage->psz_file );
@@ -1291,41 +1581,157 @@ static void TsStorageDelete( ts_storage_t *p_storage )
     free( p_storage );
 }
 
-static void TsStoragePack( ts_storage_t *p_storage )
+#ifdef HAVE_MMAP
+static int TsStorageMap( ts_storage_t *p_storage )
 {
-    /* Try to release a bit of memory */
-    if( (size_t)(p_storage->p_cmd_w - p_storage->p_cmd_buf) == p_storage->i_cmd_buf )
-        return;
+    if( p_storage->p_map != NULL )
+        return VLC_SUCCESS;
+
+    void *p_map = mmap( NULL, p_storage->i_file_max, PROT_READ | PROT_WRITE,
+                        MAP_SHARED, p_storage->fd, 0 );
+    if( p_map == MAP_FAILED )
+        return VLC_EGENERIC;
+    p_storage->p_map = p_map;
+    return VLC_SUCCESS;
+}
+#endif
 
-    size_t i_realloc = p_storage->p_cmd_w - p_storage->p_cmd_buf;
-    uint8_t *p_realloc = realloc( p_storage->p_cmd_buf, i_realloc );
-    if( p_realloc )
+static void TsStorageUnmap( ts_storage_t *p_storage )
+{
+#ifdef HAVE_MMAP
+    if( p_storage->p_map != NULL )
     {
-        p_storage->p_cmd_r = p_realloc + (p_storage->p_cmd_r - p_storage->p_cmd_buf);
-        p_storage->p_cmd_w = p_realloc + i_realloc;
-        p_storage->i_cmd_buf = i_realloc;
-        p_storage->p_cmd_buf = p_realloc;
+        munmap( p_storage->p_map, p_storage->i_file_max );
+        p_storage->p_map = NULL;
     }
+#else
+    VLC_UNUSED( p_storage );
+#endif
+}
+
+static int TsStorageWrite( ts_storage_t *p_storage,
+                           const void *p_data, size_t i_data )
+{
+    assert( p_storage->i_file_size + i_data <= p_storage->i_file_max );
+    if( i_data == 0 )
+        return VLC_SUCCESS;
+
+#ifdef HAVE_MMAP
+    if( TsStorageMap( p_storage ) )
+        return VLC_EGENERIC;
+    memcpy( p_storage->p_map + p_storage->i_file_size, p_data, i_data );
+#else
+    if( fseek( p_storage->p_file, p_storage->i_file_size, SEEK_SET )
+     || fwrite( p_data, i_data, 1, p_storage->p_file ) != 1 )
+        return VLC_EGENERIC;
+#endif
+    p_storage->i_file_size += i_data;
+    return VLC_SUCCESS;
+}
+
+static int TsStorageRead( ts_storage_t *p_storage, size_t i_offset,
+                          void *p_data, size_t i_data )
+{
+    if( i_offset + i_data > p_storage->i_file_size )
+        return VLC_EGENERIC;
+    if( i_data == 0 )
+        return VLC_SUCCESS;
+
+#ifdef HAVE_MMAP
+    if( TsStorageMap( p_storage ) )
+        return VLC_EGENERIC;
+    memcpy( p_data, p_storage->p_map + i_offset, i_data );
+#else
+    if( fseek( p_storage->p_file, i_offset, SEEK_SET )
+     || fread( p_data, i_data, 1, p_storage->p_file ) != 1 )
+        return VLC_EGENERIC;
+#endif
+    return VLC_SUCCESS;
+}
+
+static size_t TsStorageSizeofData( const ts_cmd_t *p_cmd )
+{
+    if( p_cmd->header.i_type != C_SEND )
+        return 0;
+    return sizeof(ts_storage_block_t) + p_cmd->send.p_block->i_buffer;
 }
 
 static bool TsStorageIsFull( ts_storage_t *p_storage, const ts_cmd_t *p_cmd )
 {
-    if( p_cmd && p_cmd->header.i_type == C_SEND && p_storage->p_cmd_w )
+    if( p_cmd && p_storage->i_file_size + TsStorageSizeofData( p_cmd )
+                                                    > p_storage->i_file_max )
+        return true;
+    return p_storage->cmds.size >= TS_STORAGE_COMMAND_MAX;
+}
+
+static bool TsStorageIsEmpty( ts_storage_t *p_storage )
+{
+    return !p_storage || p_storage->i_cmd_r >= p_storage->cmds.size;
+}
+
+/* Returns the date of the next command to read */
+static vlc_tick_t TsStorageGetDate( ts_storage_t *p_storage )
+{
+    if( TsStorageIsEmpty( p_storage ) )
+        return VLC_TICK_MAX;
+    return p_storage->cmds.data[p_storage->i_cmd_r].header.i_date;
+}
+
+/* Returns the date of the first command that can be read again */
+static vlc_tick_t TsStorageGetFirstDate( ts_storage_t *p_storage )
+{
+    assert( p_storage->i_cmd_first < p_storage->cmds.size );
+    return p_storage->cmds.data[p_storage->i_cmd_first].header.i_date;
+}
+
+static vlc_tick_t TsStorageGetLastDate( ts_storage_t *p_storage )
+{
+    assert( p_storage->cmds.size > 0 );
+    return p_storage->cmds.data[p_storage->cmds.size - 1].header.i_date;
+}
+
+/* Returns the index of the first command to read dated at or after i_date */
+static size_t TsStorageFind( ts_storage_t *p_storage, vlc_tick_t i_date )
+{
+    size_t i_low = p_storage->i_cmd_r, i_high = p_storage->cmds.size;
+
+    while( i_low < i_high )
     {
-        size_t i_size = sizeof(*p_cmd->send.p_block) + p_cmd->send.p_block->i_buffer;
+        const size_t i_mid = i_low + (i_high - i_low) / 2;
 
-        if( p_storage->i_file_size + i_size >= p_storage->i_file_max )
-            return true;
+        if( p_storage->cmds.data[i_mid].header.i_date < i_date )
+            i_low = i_mid + 1;
+        else
+            i_high = i_mid;
     }
-    return (size_t)(p_storage->p_cmd_w - p_storage->p_cmd_buf) > p_storage->i_cmd_buf - MAX_COMMAND_SIZE;
+    return i_low;
 }
 
-static bool TsStorageIsEmpty( ts_storage_t *p_storage )
+/* Moves the read position back to the first command dated at or after
+ * i_date that can be read again */
+static void TsStorageRewind( ts_storage_t *p_storage, vlc_tick_t i_date )
 {
-    return !p_storage || p_storage->p_cmd_r >= p_storage->p_cmd_w;
+    const size_t i_cmd_r = p_storage->i_cmd_r;
+
+    assert( p_storage->i_cmd_first <= i_cmd_r );
+    p_storage->i_cmd_r = p_storage->i_cmd_first;
+    p_storage->i_cmd_r = __MIN( TsStorageFind( p_storage, i_date ), i_cmd_r );
+
+    /* Look for the first control left to read */
+    size_t i_low = 0, i_high = p_storage->i_control_r;
+    while( i_low < i_high )
+    {
+        const size_t i_mid = i_low + (i_high - i_low) / 2;
+
+        if( p_storage->controls.data[i_mid] < p_storage->i_cmd_r )
+            i_low = i_mid + 1;
+        else
+            i_high = i_mid;
+    }
+    p_storage->i_control_r = i_low;
 }
 
-static void TsStoragePushCmd( ts_storage_t *p_storage, const ts_cmd_t *p_cmd, bool b_flush )
+static void TsStoragePushCmd( ts_storage_t *p_storage, const ts_cmd_t *p_cmd )
 {
     assert( !TsStorageIsFull( p_storage, p_cmd ) );
     ts_cmd_t cmd;
@@ -1334,70 +1740,90 @@ static void TsStoragePushCmd( ts_storage_t *p_storage, const ts_cmd_t *p_cmd, bo
     if( cmd.header.i_type == C_SEND )
     {
         block_t *p_block = cmd.send.p_block;
-
-        cmd.send.p_block = NULL;
-        cmd.send.i_offset = ftell( p_storage->p_filew );
-
-        if( fwrite( p_block, sizeof(*p_block), 1, p_storage->p_filew ) != 1 )
+        const ts_storage_block_t header = {
+            .i_dts = p_block->i_dts,
+            .i_pts = p_block->i_pts,
+            .i_length = p_block->i_length,
+            .i_flags = p_block->i_flags,
+            .i_nb_samples = p_block->i_nb_samples,
+            .i_buffer = p_block->i_buffer,
+        };
+        const size_t i_offset = p_storage->i_file_size;
+
+        cmd.send.i_offset = i_offset;
+
+        int i_ret = TsStorageWrite( p_storage, &header, sizeof(header) );
+        if( i_ret == VLC_SUCCESS )
+            i_ret = TsStorageWrite( p_storage, p_block->p_buffer,
+                                    p_block->i_buffer );
+        block_Release( p_block );
+        if( i_ret != VLC_SUCCESS )
         {
-            block_Release( p_block );
+            p_storage->i_file_size = i_offset;
             return;
         }
-        p_storage->i_file_size += sizeof(*p_block);
-        if( p_block->i_buffer > 0 )
+    }
+    else if( !vlc_vector_push( &p_storage->controls, p_storage->cmds.size ) )
+    {
+        CmdClean( &cmd );
+        return;
+    }
+
+    if( !vlc_vector_push( &p_storage->cmds, cmd ) )
+    {
+        if( cmd.header.i_type != C_SEND )
         {
-            if( fwrite( p_block->p_buffer, p_block->i_buffer, 1, p_storage->p_filew ) != 1 )
-            {
-                block_Release( p_block );
-                return;
-            }
+            vlc_vector_remove( &p_storage->controls,
+                               p_storage->controls.size - 1 );
+            CmdClean( &cmd );
         }
-        p_storage->i_file_size += p_block->i_buffer;
-        block_Release( p_block );
-
-        if( b_flush )
-            fflush( p_storage->p_filew );
     }
-    size_t i_cmdsize = TsStorageSizeofCommand[ cmd.header.i_type ];
-    memcpy( p_storage->p_cmd_w, &cmd, i_cmdsize );
-    p_storage->p_cmd_w += i_cmdsize;
 }
 
 static void TsStoragePopCmd( ts_storage_t *p_storage, ts_cmd_t *p_cmd, bool b_flush )
 {
     assert( !TsStorageIsEmpty( p_storage ) );
 
-    p_cmd->header.i_type = p_storage->p_cmd_r[0];
-    size_t i_cmdsize = TsStorageSizeofCommand[ p_cmd->header.i_type ];
-    memcpy(p_cmd, p_storage->p_cmd_r, i_cmdsize);
-    p_storage->p_cmd_r += i_cmdsize;
+    *p_cmd = p_storage->cmds.data[p_storage->i_cmd_r++];
 
-    if( p_cmd->header.i_type == C_SEND )
+    if( p_cmd->header.i_type != C_SEND )
     {
-        block_t block;
+        assert( p_storage->controls.data[p_storage->i_control_r] == p_storage->i_cmd_r - 1 );
+        p_storage->i_control_r++;
+
+        /* The stored command keeps its own reference to be read again */
+        if( !CmdIsReplayable( p_cmd ) )
+            p_storage->i_cmd_first = p_storage->i_cmd_r;
+        else if( p_cmd->header.i_type == C_CONTROL && p_cmd->control.in )
+            input_source_Hold( p_cmd->control.in );
+        return;
+    }
+
+    const size_t i_offset = p_cmd->send.i_offset;
+    ts_storage_block_t header;
+    block_t *p_block = NULL;
 
-        if( !b_flush &&
-            !fseek( p_storage->p_filer, p_cmd->send.i_offset, SEEK_SET ) &&
-            fread( &block, sizeof(block), 1, p_storage->p_filer ) == 1 )
+    if( !b_flush &&
+        !TsStorageRead( p_storage, i_offset, &header, sizeof(header) ) )
+    {
+        p_block = block_Alloc( header.i_buffer );
+        if( p_block &&
+            TsStorageRead( p_storage, i_offset + sizeof(header),
+                           p_block->p_buffer, header.i_buffer ) )
         {
-            block_t *p_block = block_Alloc( block.i_buffer );
-            if( p_block )
-            {
-                p_block->i_dts      = block.i_dts;
-                p_block->i_pts      = block.i_pts;
-                p_block->i_flags    = block.i_flags;
-                p_block->i_length   = block.i_length;
-                p_block->i_nb_samples = block.i_nb_samples;
-                p_block->i_buffer = fread( p_block->p_buffer, 1, block.i_buffer, p_storage->p_filer );
-            }
-            p_cmd->send.p_block = p_block;
+            block_Release( p_block );
+            p_block = NULL;
         }
-        else
+        if( p_block )
         {
-            //perror( "TsStoragePopCmd" );
-            p_cmd->send.p_block = block_Alloc( 1 );
+            p_block->i_dts      = header.i_dts;
+            p_block->i_pts      = header.i_pts;
+            p_block->i_flags    = header.i_flags;
+            p_block->i_length   = header.i_length;
+            p_block->i_nb_samples = header.i_nb_samples;
         }
     }
+    p_cmd->send.p_block = p_block;
 }
 
 /*****************************************************************************
@@ -1426,6 +1852,25 @@ static void CmdClean( ts_cmd_t *p_cmd )
     }
 }
 
+/* Returns true if the command can be executed again when skipping back, as
+ * it owns nothing but a reference to its input source */
+static bool CmdIsReplayable( const ts_cmd_t *p_cmd )
+{
+    switch( p_cmd->header.i_type )
+    {
+    case C_SEND:
+        return true;
+    case C_CONTROL:
+        return p_cmd->control.i_query == ES_OUT_SET_PCR
+            || p_cmd->control.i_query == ES_OUT_SET_GROUP_PCR;
+    case C_PRIVCONTROL:
+        return p_cmd->privcontrol.i_query == ES_OUT_PRIV_SET_TIMES
+            || p_cmd->privcontrol.i_query == ES_OUT_PRIV_SET_JITTER;
+    default:
+        return false;
+    }
+}
+
 static int CmdInitAdd( ts_cmd_add_t *p_cmd, input_source_t *in,  es_out_id_t *p_es,
                        const es_format_t *p_fmt, bool b_copy )
 {
@@ -2019,6 +2019,15 @@ static bool Control( input_thread_t *p_input,
                 break;
             }
 
+            /* Jump within the timeshift buffer, if any */
+            if( !absolute && param.time.i_val != 0
+             && es_out_SkipTimeshift( priv->p_es_out,
+                                      param.time.i_val ) == VLC_SUCCESS )
+            {
+                b_force_update = true;
+                break;
+            }
+
             /* Reset the decoders states and clock sync (before calling the demuxer */
             es_out_Control( priv->p_es_out, ES_OUT_RESET_PCR );
 
@@ -34,6 +34,7 @@
 #include <libvlc.h>
 #include "input_interface.h"
 #include "misc/interrupt.h"
+#include "misc/latency.h"
 
 struct input_stats;
 
@@ -729,6 +730,11 @@ typedef struct input_rate_t
 
 struct input_stats {
     input_rate_t input_bitrate;
+    atomic_uintmax_t lost_packets;
+    struct vlc_latency_histogram receive_delay;
+    atomic_uintmax_t readahead_hits;
+    atomic_uintmax_t readahead_misses;
+    struct vlc_latency_histogram readahead_stall;
     input_rate_t demux_bitrate;
     atomic_uintmax_t demux_corrupted;
     atomic_uintmax_t demux_discontinuity;
@@ -739,6 +745,7 @@ struct input_stats {
     atomic_uintmax_t displayed_pictures;
     atomic_uintmax_t late_pictures;
     atomic_uintmax_t lost_pictures;
+    struct vlc_latency_histogram latency[INPUT_LATENCY_STAGE_COUNT];
 };
 
 struct input_stats *input_stats_Create(void);
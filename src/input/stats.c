@@ -58,6 +58,11 @@ struct input_stats *input_stats_Create(void)
         return NULL;
 
     input_rate_Init(&stats->input_bitrate);
+    atomic_init(&stats->lost_packets, 0);
+    vlc_latency_histogram_Init(&stats->receive_delay);
+    atomic_init(&stats->readahead_hits, 0);
+    atomic_init(&stats->readahead_misses, 0);
+    vlc_latency_histogram_Init(&stats->readahead_stall);
     input_rate_Init(&stats->demux_bitrate);
     atomic_init(&stats->demux_corrupted, 0);
     atomic_init(&stats->demux_discontinuity, 0);
@@ -68,6 +73,8 @@ struct input_stats *input_stats_Create(void)
     atomic_init(&stats->displayed_pictures, 0);
     atomic_init(&stats->late_pictures, 0);
     atomic_init(&stats->lost_pictures, 0);
+    for (size_t i = 0; i < INPUT_LATENCY_STAGE_COUNT; i++)
+        vlc_latency_histogram_Init(&stats->latency[i]);
     return stats;
 }
 
@@ -84,6 +91,15 @@ void input_stats_Compute(struct input_stats *stats, input_stats_t *st)
     st->i_read_bytes = stats->input_bitrate.value;
     st->f_input_bitrate = stats_GetRate(&stats->input_bitrate);
     vlc_mutex_unlock(&stats->input_bitrate.lock);
+    st->i_lost_packets = atomic_load_explicit(&stats->lost_packets,
+                                              memory_order_relaxed);
+    vlc_latency_histogram_Compute(&stats->receive_delay, &st->receive_delay);
+    st->i_readahead_hits = atomic_load_explicit(&stats->readahead_hits,
+                                                memory_order_relaxed);
+    st->i_readahead_misses = atomic_load_explicit(&stats->readahead_misses,
+                                                  memory_order_relaxed);
+    vlc_latency_histogram_Compute(&stats->readahead_stall,
+                                  &st->readahead_stall);
 
     vlc_mutex_lock(&stats->demux_bitrate.lock);
     st->i_demux_read_bytes = stats->demux_bitrate.value;
@@ -111,6 +127,8 @@ void input_stats_Compute(struct input_stats *stats, input_stats_t *st)
                                                     memory_order_relaxed);
     st->i_lost_pictures = atomic_load_explicit(&stats->lost_pictures,
                                                memory_order_relaxed);
+    for (size_t i = 0; i < INPUT_LATENCY_STAGE_COUNT; i++)
+        vlc_latency_histogram_Compute(&stats->latency[i], &st->latency[i]);
 }
 
 /** Update a counter element with new values
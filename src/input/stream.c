@@ -51,6 +51,9 @@ typedef struct stream_priv_t
     block_t *peek;
     uint64_t offset;
     bool eof;
+    bool map; /**< the source might support mapped blocks */
+    bool mapped; /**< the source has returned a mapped block */
+    struct input_stats *stats;
 
     /* UTF-16 and UTF-32 file reading */
     struct {
@@ -91,6 +94,9 @@ stream_t *vlc_stream_CustomNew(vlc_object_t *parent,
     priv->peek = NULL;
     priv->offset = 0;
     priv->eof = false;
+    priv->map = true;
+    priv->mapped = false;
+    priv->stats = NULL;
 
     /* UTF16 and UTF32 text file conversion */
     priv->text.conv = (vlc_iconv_t)(-1);
@@ -105,6 +111,34 @@ void *vlc_stream_Private(stream_t *stream)
     return ((stream_priv_t *)stream)->private_data;
 }
 
+void stream_SetStats(stream_t *s, struct input_stats *stats)
+{
+    ((stream_priv_t *)s)->stats = stats;
+}
+
+struct input_stats *stream_GetStats(stream_t *s)
+{
+    return ((stream_priv_t *)s)->stats;
+}
+
+void vlc_stream_ReportReadAhead(stream_t *s, vlc_tick_t stall)
+{
+    struct input_stats *stats = stream_GetStats(s);
+
+    if (stats == NULL)
+        return;
+
+    if (stall == 0)
+        atomic_fetch_add_explicit(&stats->readahead_hits, 1,
+                                  memory_order_relaxed);
+    else
+    {
+        atomic_fetch_add_explicit(&stats->readahead_misses, 1,
+                                  memory_order_relaxed);
+        vlc_latency_histogram_Add(&stats->readahead_stall, stall);
+    }
+}
+
 stream_t *vlc_stream_CommonNew(vlc_object_t *parent,
                                void (*destroy)(stream_t *))
 {
@@ -746,6 +780,33 @@ block_t *vlc_stream_Block( stream_t *s, size_t size )
     return block;
 }
 
+/* Below that size, copying is cheaper than referencing a mapping */
+#define STREAM_MAP_MIN_SIZE 16384
+
+block_t *vlc_stream_BlockMapped(stream_t *s, size_t size)
+{
+    stream_priv_t *priv = (stream_priv_t *)s;
+
+    if (priv->map && size >= STREAM_MAP_MIN_SIZE)
+    {
+        uint64_t offset = priv->offset;
+        block_t *block;
+
+        if (vlc_stream_Control(s, STREAM_GET_MAPPED_BLOCK, offset, size,
+                               &block) == VLC_SUCCESS)
+        {
+            priv->mapped = true;
+            if (vlc_stream_Seek(s, offset + block->i_buffer) == VLC_SUCCESS)
+                return block;
+            block_Release(block);
+        }
+        else if (!priv->mapped)
+            priv->map = false; /* not supported, do not ask again */
+    }
+
+    return vlc_stream_Block(s, size);
+}
+
 int vlc_stream_ReadDir( stream_t *s, input_item_node_t *p_node )
 {
     assert(s->pf_readdir != NULL);
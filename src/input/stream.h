@@ -36,6 +36,14 @@ void *vlc_stream_Private(stream_t *stream);
 /* */
 void stream_CommonDelete( stream_t *s );
 
+/**
+ * Sets the input statistics a stream reports to.
+ *
+ * Stream filters inherit the statistics of their source.
+ */
+void stream_SetStats(stream_t *s, struct input_stats *stats);
+struct input_stats *stream_GetStats(stream_t *s);
+
 stream_t *vlc_stream_AttachmentNew(vlc_object_t *p_this,
                                    input_attachment_t *attachement);
 
@@ -76,6 +76,7 @@ stream_t *vlc_stream_FilterNew( stream_t *p_source,
             s->psz_filepath = strdup( p_source->psz_filepath );
     }
     s->s = p_source;
+    stream_SetStats(s, stream_GetStats(p_source));
 
     /* */
     priv->module = module_need(s, "stream_filter", psz_stream_filter, true);
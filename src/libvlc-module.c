@@ -405,6 +405,11 @@ static const char *const screensaver_texts[] = {
     "picture quality, for instance deinterlacing, or distort " \
     "the video.")
 
+#define VIDEO_FILTER_THREADS_TEXT N_("Video filter threads")
+#define VIDEO_FILTER_THREADS_LONGTEXT N_( \
+    "Maximum number of threads used to run each video filter that supports " \
+    "it, on bands of the picture (0 = number of CPUs, 1 = disabled).")
+
 #define SNAP_PATH_TEXT N_("Video snapshot directory (or filename)")
 #define SNAP_PATH_LONGTEXT N_( \
     "Directory where the video snapshots will be stored.")
@@ -746,6 +751,11 @@ static const char* const ppsz_restore_playback_desc[] = {
     "This is the maximum size in bytes of the temporary files " \
     "that will be used to store the timeshifted streams." )
 
+#define INPUT_TIMESHIFT_REWIND_TEXT N_("Timeshift rewind duration")
+#define INPUT_TIMESHIFT_REWIND_LONGTEXT N_( \
+    "Duration in seconds of the already played data kept in the " \
+    "timeshift buffer, so that playback can jump back into it." )
+
 #define INPUT_TITLE_FORMAT_TEXT N_( "Change title according to current media" )
 #define INPUT_TITLE_FORMAT_LONGTEXT N_( "This option allows you to set the title according to what's being played<br>"  \
     "$a: Artist<br>$b: Album<br>$c: Copyright<br>$t: Title<br>$g: Genre<br>"  \
@@ -891,6 +901,11 @@ static const char* const ppsz_restore_playback_desc[] = {
     "However allocation of port numbers below 1025 is usually restricted " \
     "by the operating system." )
 
+#define HTTP_THREADS_TEXT N_( "HTTP server threads" )
+#define HTTP_THREADS_LONGTEXT N_( \
+    "Number of threads serving the clients of each HTTP, HTTPS and RTSP " \
+    "server. By default, there is one thread per CPU." )
+
 #define HTTPS_PORT_TEXT N_( "HTTPS server port" )
 #define HTTPS_PORT_LONGTEXT N_( \
     "The HTTPS server will listen on this TCP port. " \
@@ -986,6 +1001,12 @@ static const char* const ppsz_restore_playback_desc[] = {
     "VLC will fallback automatically to software decoders in case of " \
     "hardware decoder failure." )
 
+#define DEC_PIPELINE_TEXT N_("Pipelined decoding")
+#define DEC_PIPELINE_LONGTEXT N_( \
+    "Packetize, decode and output audio and video on separate threads. " \
+    "This can smooth the playback of high bitrate streams with software " \
+    "decoders that do not use threads themselves." )
+
 #define DEC_DEV_TEXT N_("Preferred decoder hardware device")
 #define DEC_DEV_LONGTEXT N_("This allows hardware decoding when available.")
 
@@ -1733,6 +1754,9 @@ vlc_module_begin ()
     set_subcategory( SUBCAT_VIDEO_VFILTER )
     add_module_list("video-filter", "video filter", NULL,
                     VIDEO_FILTER_TEXT, VIDEO_FILTER_LONGTEXT)
+    add_integer_with_range( "video-filter-threads", 0, 0, 16,
+                            VIDEO_FILTER_THREADS_TEXT,
+                            VIDEO_FILTER_THREADS_LONGTEXT )
 
     set_subcategory( SUBCAT_VIDEO_SPLITTER )
 
@@ -1890,6 +1914,9 @@ vlc_module_begin ()
         change_integer_range( 1, 65535 )
     add_integer( "https-port", 8443, HTTPS_PORT_TEXT, HTTPS_PORT_LONGTEXT )
         change_integer_range( 1, 65535 )
+    add_integer( "http-threads", 0, HTTP_THREADS_TEXT,
+                 HTTP_THREADS_LONGTEXT )
+        change_integer_range( 0, 16 )
     add_string( "rtsp-host", NULL, RTSP_HOST_TEXT, RTSP_HOST_LONGTEXT )
     add_integer( "rtsp-port", 554, RTSP_PORT_TEXT, RTSP_PORT_LONGTEXT )
         change_integer_range( 1, 65535 )
@@ -1983,6 +2010,8 @@ vlc_module_begin ()
                   INPUT_TIMESHIFT_PATH_TEXT, INPUT_TIMESHIFT_PATH_LONGTEXT)
     add_integer( "input-timeshift-granularity", -1, INPUT_TIMESHIFT_GRANULARITY_TEXT,
                  INPUT_TIMESHIFT_GRANULARITY_LONGTEXT )
+    add_integer( "input-timeshift-rewind", 300, INPUT_TIMESHIFT_REWIND_TEXT,
+                 INPUT_TIMESHIFT_REWIND_LONGTEXT )
 
     add_string( "input-title-format", "$Z", INPUT_TITLE_FORMAT_TEXT, INPUT_TITLE_FORMAT_LONGTEXT );
 
@@ -2002,6 +2031,8 @@ vlc_module_begin ()
 
     add_string( "codec", NULL, CODEC_TEXT, CODEC_LONGTEXT )
     add_bool( "hw-dec", true, HW_DEC_TEXT, HW_DEC_LONGTEXT )
+    add_bool( "decoder-pipeline", false, DEC_PIPELINE_TEXT,
+              DEC_PIPELINE_LONGTEXT )
     add_obsolete_string( "encoder" ) /* since 4.0.0 */
     add_module("dec-dev", "decoder device", "any", DEC_DEV_TEXT, DEC_DEV_LONGTEXT)
 
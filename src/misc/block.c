@@ -28,6 +28,8 @@
 #include <sys/stat.h>
 #include <assert.h>
 #include <errno.h>
+#include <stdatomic.h>
+#include <stdlib.h>
 #include <unistd.h>
 #include <fcntl.h>
 
@@ -71,6 +73,7 @@ block_t *block_Init(block_t *restrict b, const struct vlc_block_callbacks *cbs,
     b->i_pts =
     b->i_dts = VLC_TICK_INVALID;
     b->i_length = 0;
+    vlc_frame_trace_Init(&b->trace);
     b->cbs = cbs;
     return b;
 }
@@ -95,6 +98,7 @@ static void BlockMetaCopy( block_t *restrict out, const block_t *in )
     out->i_pts     = in->i_pts;
     out->i_flags   = in->i_flags;
     out->i_length  = in->i_length;
+    out->trace     = in->trace;
 }
 
 /** Initial memory alignment of data block.
@@ -105,6 +109,288 @@ static void BlockMetaCopy( block_t *restrict out, const block_t *in )
 /** Initial reserved header and footer size. */
 #define BLOCK_PADDING      32
 
+/*
+ * Pooled allocator
+ *
+ * Small and medium blocks are recycled rather than returned to the C run-time.
+ * Free blocks are kept in fixed-size magazines, sorted by power-of-two size
+ * class. Each thread caches up to two magazines per class, so that most
+ * allocations and releases do not need any synchronization at all. Full
+ * magazines are exchanged with a lock-free global depot when a thread runs
+ * out of (or has too many) free blocks, e.g. when blocks are allocated by the
+ * access thread and released by the decoder thread.
+ */
+
+/** Smallest pooled allocation, including the block_t header (256 bytes) */
+#define BLOCK_POOL_MIN_SHIFT 8
+/** Number of size classes (256 bytes to 64 KiB) */
+#define BLOCK_POOL_CLASSES   9
+/** Number of free blocks per magazine */
+#define BLOCK_MAGAZINE_SIZE  16
+/** Number of full magazines per size class in the global depot */
+#define BLOCK_DEPOT_SLOTS    8
+
+struct block_magazine
+{
+    unsigned count;
+    block_t *blocks[BLOCK_MAGAZINE_SIZE];
+};
+
+struct block_cache
+{
+    struct block_magazine *loaded[BLOCK_POOL_CLASSES];
+    struct block_magazine *previous[BLOCK_POOL_CLASSES];
+};
+
+static struct
+{
+    vlc_once_t once;
+    bool enabled;
+    vlc_threadvar_t cache;
+    /* Each slot holds either NULL or a full magazine. A slot is claimed with
+     * compare-and-swap and emptied with exchange, so there is no ABA issue. */
+    _Atomic(struct block_magazine *) depot[BLOCK_POOL_CLASSES]
+                                          [BLOCK_DEPOT_SLOTS];
+    atomic_uint_least64_t hits;
+    atomic_uint_least64_t misses;
+    atomic_size_t resident;
+} block_pool = { .once = VLC_STATIC_ONCE };
+
+static size_t block_pool_ClassSize(unsigned c)
+{
+    return (size_t)1 << (BLOCK_POOL_MIN_SHIFT + c);
+}
+
+static int block_pool_Class(size_t alloc)
+{
+    for (unsigned c = 0; c < BLOCK_POOL_CLASSES; c++)
+        if (alloc <= block_pool_ClassSize(c))
+            return c;
+    return -1;
+}
+
+static void block_magazine_Drain(struct block_magazine *mag, unsigned c)
+{
+    atomic_fetch_sub_explicit(&block_pool.resident,
+                              mag->count * block_pool_ClassSize(c),
+                              memory_order_relaxed);
+    while (mag->count > 0)
+        free(mag->blocks[--mag->count]);
+}
+
+static bool block_depot_Push(unsigned c, struct block_magazine *mag)
+{
+    for (unsigned i = 0; i < BLOCK_DEPOT_SLOTS; i++)
+    {
+        struct block_magazine *expected = NULL;
+
+        if (atomic_compare_exchange_strong_explicit(&block_pool.depot[c][i],
+                                                    &expected, mag,
+                                                    memory_order_release,
+                                                    memory_order_relaxed))
+            return true;
+    }
+    return false;
+}
+
+static struct block_magazine *block_depot_Pop(unsigned c)
+{
+    for (unsigned i = 0; i < BLOCK_DEPOT_SLOTS; i++)
+    {
+        if (atomic_load_explicit(&block_pool.depot[c][i],
+                                 memory_order_relaxed) == NULL)
+            continue;
+
+        struct block_magazine *mag =
+            atomic_exchange_explicit(&block_pool.depot[c][i], NULL,
+                                     memory_order_acquire);
+        if (mag != NULL)
+            return mag;
+    }
+    return NULL;
+}
+
+/** Returns a non-empty magazine to the depot, or frees its content. */
+static void block_magazine_Retire(struct block_magazine *mag, unsigned c)
+{
+    if (mag == NULL)
+        return;
+    if (mag->count > 0 && block_depot_Push(c, mag))
+        return;
+
+    block_magazine_Drain(mag, c);
+    free(mag);
+}
+
+static void block_cache_Destroy(void *data)
+{
+    struct block_cache *cache = data;
+
+    for (unsigned c = 0; c < BLOCK_POOL_CLASSES; c++)
+    {
+        block_magazine_Retire(cache->loaded[c], c);
+        block_magazine_Retire(cache->previous[c], c);
+    }
+    free(cache);
+}
+
+static void block_pool_Init(void *data)
+{
+    (void) data;
+
+#if defined(__SANITIZE_ADDRESS__)
+    /* Recycled blocks would hide use-after-free and overflow errors. */
+    block_pool.enabled = false;
+#elif defined(__has_feature)
+# if __has_feature(address_sanitizer)
+    block_pool.enabled = false;
+# else
+    block_pool.enabled = true;
+# endif
+#else
+    block_pool.enabled = true;
+#endif
+    const char *env = getenv("VLC_BLOCK_POOL");
+    if (env != NULL && !strcmp(env, "0"))
+        block_pool.enabled = false;
+
+    if (block_pool.enabled
+     && vlc_threadvar_create(&block_pool.cache, block_cache_Destroy))
+        block_pool.enabled = false;
+}
+
+static struct block_cache *block_cache_Get(void)
+{
+    vlc_once(&block_pool.once, block_pool_Init, NULL);
+    if (!block_pool.enabled)
+        return NULL;
+
+    struct block_cache *cache = vlc_threadvar_get(block_pool.cache);
+    if (unlikely(cache == NULL))
+    {
+        cache = calloc(1, sizeof (*cache));
+        if (unlikely(cache == NULL))
+            return NULL;
+        if (vlc_threadvar_set(block_pool.cache, cache))
+        {
+            free(cache);
+            return NULL;
+        }
+    }
+    return cache;
+}
+
+static block_t *block_pool_Get(struct block_cache *cache, unsigned c)
+{
+    struct block_magazine *mag = cache->loaded[c];
+
+    if (mag == NULL || mag->count == 0)
+    {
+        struct block_magazine *prev = cache->previous[c];
+
+        if (prev != NULL && prev->count > 0)
+        {   /* Swap the loaded and previous magazines */
+            cache->previous[c] = mag;
+            cache->loaded[c] = mag = prev;
+        }
+        else
+        {   /* Reload a full magazine from the depot */
+            struct block_magazine *full = block_depot_Pop(c);
+            if (full == NULL)
+            {
+                atomic_fetch_add_explicit(&block_pool.misses, 1,
+                                          memory_order_relaxed);
+                return NULL;
+            }
+
+            if (prev == NULL)
+                cache->previous[c] = mag;
+            else
+                free(mag);
+            cache->loaded[c] = mag = full;
+        }
+    }
+
+    assert(mag->count > 0);
+    atomic_fetch_add_explicit(&block_pool.hits, 1, memory_order_relaxed);
+    atomic_fetch_sub_explicit(&block_pool.resident, block_pool_ClassSize(c),
+                              memory_order_relaxed);
+    return mag->blocks[--mag->count];
+}
+
+static void block_pool_Release(block_t *block)
+{
+    const size_t alloc = sizeof (*block) + block->i_size;
+    const int c = block_pool_Class(alloc);
+
+    assert(block->p_start == (unsigned char *)(block + 1));
+    assert(c >= 0 && block_pool_ClassSize(c) == alloc);
+
+    struct block_cache *cache = block_cache_Get();
+    if (unlikely(cache == NULL))
+    {
+        free(block);
+        return;
+    }
+
+    struct block_magazine *mag = cache->loaded[c];
+
+    if (mag == NULL || mag->count == BLOCK_MAGAZINE_SIZE)
+    {
+        struct block_magazine *prev = cache->previous[c];
+
+        if (prev != NULL && prev->count < BLOCK_MAGAZINE_SIZE)
+        {   /* Swap the loaded and previous magazines */
+            cache->previous[c] = mag;
+            cache->loaded[c] = mag = prev;
+        }
+        else
+        {   /* Hand the previous magazine over to the depot */
+            struct block_magazine *empty = NULL;
+
+            if (prev != NULL && !block_depot_Push(c, prev))
+            {   /* Depot is full: trim the pool */
+                block_magazine_Drain(prev, c);
+                empty = prev;
+            }
+
+            if (empty == NULL)
+            {
+                empty = malloc(sizeof (*empty));
+                if (unlikely(empty == NULL))
+                {
+                    free(block);
+                    return;
+                }
+                empty->count = 0;
+            }
+
+            cache->previous[c] = mag;
+            cache->loaded[c] = mag = empty;
+        }
+    }
+
+    assert(mag->count < BLOCK_MAGAZINE_SIZE);
+    mag->blocks[mag->count++] = block;
+    atomic_fetch_add_explicit(&block_pool.resident, alloc,
+                              memory_order_relaxed);
+}
+
+static const struct vlc_block_callbacks block_pool_cbs =
+{
+    block_pool_Release,
+};
+
+void block_PoolGetStats(struct block_pool_stats *stats)
+{
+    stats->hits = atomic_load_explicit(&block_pool.hits,
+                                       memory_order_relaxed);
+    stats->misses = atomic_load_explicit(&block_pool.misses,
+                                         memory_order_relaxed);
+    stats->resident = atomic_load_explicit(&block_pool.resident,
+                                           memory_order_relaxed);
+}
+
 block_t *block_Alloc (size_t size)
 {
     if (unlikely(size >> 28))
@@ -114,16 +400,31 @@ block_t *block_Alloc (size_t size)
     }
 
     /* 2 * BLOCK_PADDING: pre + post padding */
-    const size_t alloc = sizeof (block_t) + BLOCK_ALIGN + (2 * BLOCK_PADDING)
-                       + size;
+    size_t alloc = sizeof (block_t) + BLOCK_ALIGN + (2 * BLOCK_PADDING)
+                 + size;
     if (unlikely(alloc <= size))
         return NULL;
 
-    block_t *b = malloc (alloc);
-    if (unlikely(b == NULL))
-        return NULL;
+    const struct vlc_block_callbacks *cbs = &block_generic_cbs;
+    block_t *b = NULL;
+    int c = block_pool_Class(alloc);
+    struct block_cache *cache = (c >= 0) ? block_cache_Get() : NULL;
+
+    if (cache != NULL)
+    {
+        b = block_pool_Get(cache, c);
+        alloc = block_pool_ClassSize(c);
+        cbs = &block_pool_cbs;
+    }
+
+    if (b == NULL)
+    {
+        b = malloc (alloc);
+        if (unlikely(b == NULL))
+            return NULL;
+    }
 
-    block_Init(b, &block_generic_cbs, b + 1, alloc - sizeof (*b));
+    block_Init(b, cbs, b + 1, alloc - sizeof (*b));
     static_assert ((BLOCK_PADDING % BLOCK_ALIGN) == 0,
                    "BLOCK_PADDING must be a multiple of BLOCK_ALIGN");
     b->p_buffer += BLOCK_PADDING + BLOCK_ALIGN - 1;
@@ -22,6 +22,8 @@
 # include "config.h"
 #endif
 
+#include <stdatomic.h>
+
 #include <vlc_executor.h>
 
 #include <vlc_atomic.h>
@@ -29,6 +31,29 @@
 #include <vlc_threads.h>
 #include "libvlc.h"
 
+#define PRIORITY_COUNT (VLC_EXECUTOR_PRIORITY_HIGH + 1)
+
+/**
+ * A queue of pending runnables.
+ *
+ * A standalone executor has one queue per worker (up to the number of CPUs).
+ * Workers take tasks from their own queue first, and steal from the other
+ * queues when it is empty, so that submitting and taking tasks does not
+ * serialize all threads on a single lock.
+ */
+struct vlc_executor_queue {
+    vlc_mutex_t lock;
+
+    /** The executor owning the queue */
+    vlc_executor_t *owner;
+
+    /** Lists of vlc_runnable, one per priority */
+    struct vlc_list tasks[PRIORITY_COUNT];
+
+    /** Number of queued runnables per priority, readable without the lock */
+    atomic_uint count[PRIORITY_COUNT];
+};
+
 /**
  * An executor can spawn several threads.
  *
@@ -44,8 +69,25 @@ struct vlc_executor_thread {
     /** The system thread */
     vlc_thread_t thread;
 
-    /** The current task executed by the thread, NULL if none */
-    struct vlc_runnable *current_task;
+    /** Index of the queue the thread takes tasks from first */
+    unsigned home;
+};
+
+/**
+ * A pump runs the tasks of a shared executor on the process-wide pool.
+ *
+ * There is one pump per unit of quota: at most `quota` tasks of a shared
+ * executor are running at the same time.
+ */
+struct vlc_executor_pump {
+    /** The shared executor owning the pump */
+    vlc_executor_t *owner;
+
+    /** True if the pump is submitted to (or running on) the pool */
+    bool active;
+
+    /** The runnable submitted to the pool */
+    struct vlc_runnable runnable;
 };
 
 /**
@@ -62,85 +104,179 @@ struct vlc_executor {
     struct vlc_list threads;
 
     /** Thread count (in a separate field to quickly compare to max_threads) */
-    unsigned nthreads;
+    atomic_uint nthreads;
 
     /* Number of tasks requested but not finished. */
-    unsigned unfinished;
+    atomic_uint unfinished;
 
     /** Wait for the executor to be idle (i.e. unfinished == 0) */
     vlc_cond_t idle_wait;
 
-    /** Queue of vlc_runnable */
-    struct vlc_list queue;
+    /** Queues of vlc_runnable */
+    struct vlc_executor_queue *queues;
+    unsigned nqueues;
+
+    /** Round-robin index of the queue for the next submission */
+    atomic_uint next_queue;
 
-    /** Wait for the queue to be non-empty */
+    /** Wait for a queue to be non-empty */
     vlc_cond_t queue_wait;
 
+    /** Number of threads waiting on queue_wait */
+    atomic_uint sleepers;
+
     /** True if executor deletion is requested */
-    bool closing;
+    atomic_bool closing;
+
+    /** Process-wide pool running the tasks, or NULL if standalone */
+    vlc_executor_t *pool;
+
+    /** Maximum number of tasks running at the same time on the pool */
+    unsigned quota;
+
+    /** Number of active pumps (protected by lock) */
+    unsigned running;
+
+    /** Wait for all pumps to be inactive (i.e. running == 0) */
+    vlc_cond_t running_wait;
+
+    /** Pumps (quota entries) */
+    struct vlc_executor_pump *pumps;
+
+    /** References from the owner and the active pumps */
+    vlc_atomic_rc_t rc;
 };
 
 static void
-QueuePush(vlc_executor_t *executor, struct vlc_runnable *runnable)
+QueueInit(struct vlc_executor_queue *queue, vlc_executor_t *owner)
 {
-    vlc_mutex_assert(&executor->lock);
-
-    vlc_list_append(&runnable->node, &executor->queue);
-    vlc_cond_signal(&executor->queue_wait);
+    vlc_mutex_init(&queue->lock);
+    queue->owner = owner;
+    for (unsigned i = 0; i < PRIORITY_COUNT; ++i)
+    {
+        vlc_list_init(&queue->tasks[i]);
+        atomic_init(&queue->count[i], 0);
+    }
 }
 
-static struct vlc_runnable *
-QueueTake(vlc_executor_t *executor)
+static bool
+QueueIsEmpty(struct vlc_executor_queue *queue)
 {
-    vlc_mutex_assert(&executor->lock);
+    for (unsigned i = 0; i < PRIORITY_COUNT; ++i)
+        if (atomic_load(&queue->count[i]))
+            return false;
+    return true;
+}
 
-    while (!executor->closing && vlc_list_is_empty(&executor->queue))
-        vlc_cond_wait(&executor->queue_wait, &executor->lock);
+static void
+QueuePush(struct vlc_executor_queue *queue, struct vlc_runnable *runnable,
+          enum vlc_executor_priority priority)
+{
+    assert(priority < PRIORITY_COUNT);
+
+    vlc_mutex_lock(&queue->lock);
+    runnable->queue = queue;
+    runnable->priority = priority;
+    vlc_list_append(&runnable->node, &queue->tasks[priority]);
+    atomic_fetch_add(&queue->count[priority], 1);
+    vlc_mutex_unlock(&queue->lock);
+}
 
-    if (executor->closing)
+static struct vlc_runnable *
+QueueTake(struct vlc_executor_queue *queue, unsigned priority)
+{
+    /* Do not lock queues which are known to be empty */
+    if (!atomic_load(&queue->count[priority]))
         return NULL;
 
+    vlc_mutex_lock(&queue->lock);
     struct vlc_runnable *runnable =
-        vlc_list_first_entry_or_null(&executor->queue, struct vlc_runnable,
-                                     node);
-    assert(runnable);
-    vlc_list_remove(&runnable->node);
+        vlc_list_first_entry_or_null(&queue->tasks[priority],
+                                     struct vlc_runnable, node);
+    if (runnable)
+    {
+        vlc_list_remove(&runnable->node);
 
-    /* Set links to NULL to know that it has been taken by a thread in
-     * vlc_executor_Cancel() */
-    runnable->node.prev = runnable->node.next = NULL;
+        /* Set links to NULL to know that it has been taken by a thread in
+         * vlc_executor_Cancel() */
+        runnable->node.prev = runnable->node.next = NULL;
+        atomic_fetch_sub(&queue->count[priority], 1);
+    }
+    vlc_mutex_unlock(&queue->lock);
 
     return runnable;
 }
 
+/**
+ * Take the highest priority runnable, from the home queue first, then from
+ * the other queues (work stealing).
+ */
+static struct vlc_runnable *
+TakeRunnable(vlc_executor_t *executor, unsigned home)
+{
+    for (unsigned priority = PRIORITY_COUNT; priority-- > 0;)
+        for (unsigned i = 0; i < executor->nqueues; ++i)
+        {
+            struct vlc_executor_queue *queue =
+                &executor->queues[(home + i) % executor->nqueues];
+
+            struct vlc_runnable *runnable = QueueTake(queue, priority);
+            if (runnable)
+                return runnable;
+        }
+
+    return NULL;
+}
+
+static void
+FinishRunnable(vlc_executor_t *executor)
+{
+    unsigned unfinished = atomic_fetch_sub(&executor->unfinished, 1);
+    assert(unfinished > 0);
+
+    if (unfinished == 1)
+    {
+        vlc_mutex_lock(&executor->lock);
+        vlc_cond_broadcast(&executor->idle_wait);
+        vlc_mutex_unlock(&executor->lock);
+    }
+}
+
 static void *
 ThreadRun(void *userdata)
 {
     struct vlc_executor_thread *thread = userdata;
     vlc_executor_t *executor = thread->owner;
 
-    vlc_mutex_lock(&executor->lock);
-
-    struct vlc_runnable *runnable;
-    /* When the executor is closing, QueueTake() returns NULL */
-    while ((runnable = QueueTake(executor)))
+    for (;;)
     {
-        thread->current_task = runnable;
-        vlc_mutex_unlock(&executor->lock);
+        struct vlc_runnable *runnable = TakeRunnable(executor, thread->home);
 
-        /* Execute the user-provided runnable, without the executor lock */
-        runnable->run(runnable->userdata);
+        if (!runnable)
+        {
+            vlc_mutex_lock(&executor->lock);
 
-        vlc_mutex_lock(&executor->lock);
-        thread->current_task = NULL;
+            /* The increment must be visible before the queues are scanned
+             * again, so that a concurrent submission either is found here, or
+             * sees a sleeper to wake up. */
+            atomic_fetch_add(&executor->sleepers, 1);
+            while (!atomic_load(&executor->closing)
+                && !(runnable = TakeRunnable(executor, thread->home)))
+                vlc_cond_wait(&executor->queue_wait, &executor->lock);
+            atomic_fetch_sub(&executor->sleepers, 1);
 
-        assert(executor->unfinished > 0);
-        --executor->unfinished;
-        if (!executor->unfinished)
-            vlc_cond_signal(&executor->idle_wait);
-    }
+            vlc_mutex_unlock(&executor->lock);
 
-    vlc_mutex_unlock(&executor->lock);
+            /* When the executor is closing, the queues are empty */
+            if (!runnable)
+                break;
+        }
+
+        /* Execute the user-provided runnable, without any lock */
+        runnable->run(runnable->userdata);
+
+        FinishRunnable(executor);
+    }
 
     return NULL;
 }
@@ -148,14 +284,17 @@ ThreadRun(void *userdata)
 static int
 SpawnThread(vlc_executor_t *executor)
 {
-    assert(executor->nthreads < executor->max_threads);
+    vlc_mutex_assert(&executor->lock);
+
+    unsigned nthreads = atomic_load(&executor->nthreads);
+    assert(nthreads < executor->max_threads);
 
     struct vlc_executor_thread *thread = malloc(sizeof(*thread));
     if (!thread)
         return VLC_ENOMEM;
 
     thread->owner = executor;
-    thread->current_task = NULL;
+    thread->home = nthreads % executor->nqueues;
 
     if (vlc_clone(&thread->thread, ThreadRun, thread, VLC_THREAD_PRIORITY_LOW))
     {
@@ -163,66 +302,327 @@ SpawnThread(vlc_executor_t *executor)
         return VLC_EGENERIC;
     }
 
-    executor->nthreads++;
+    atomic_store(&executor->nthreads, nthreads + 1);
     vlc_list_append(&thread->node, &executor->threads);
 
     return VLC_SUCCESS;
 }
 
-vlc_executor_t *
-vlc_executor_New(unsigned max_threads)
+static vlc_executor_t *
+ExecutorCreate(unsigned max_threads, unsigned nqueues)
 {
-    assert(max_threads);
+    assert(nqueues);
     vlc_executor_t *executor = malloc(sizeof(*executor));
     if (!executor)
         return NULL;
 
+    executor->queues = vlc_alloc(nqueues, sizeof(*executor->queues));
+    if (!executor->queues)
+    {
+        free(executor);
+        return NULL;
+    }
+
     vlc_mutex_init(&executor->lock);
 
     executor->max_threads = max_threads;
-    executor->nthreads = 0;
-    executor->unfinished = 0;
+    atomic_init(&executor->nthreads, 0);
+    atomic_init(&executor->unfinished, 0);
 
     vlc_list_init(&executor->threads);
-    vlc_list_init(&executor->queue);
+
+    executor->nqueues = nqueues;
+    for (unsigned i = 0; i < nqueues; ++i)
+        QueueInit(&executor->queues[i], executor);
+    atomic_init(&executor->next_queue, 0);
 
     vlc_cond_init(&executor->idle_wait);
     vlc_cond_init(&executor->queue_wait);
+    atomic_init(&executor->sleepers, 0);
+
+    atomic_init(&executor->closing, false);
 
-    executor->closing = false;
+    executor->pool = NULL;
+    executor->quota = 0;
+    executor->running = 0;
+    vlc_cond_init(&executor->running_wait);
+    executor->pumps = NULL;
+    vlc_atomic_rc_init(&executor->rc);
+
+    return executor;
+}
+
+static void
+ExecutorFree(vlc_executor_t *executor)
+{
+    free(executor->pumps);
+    free(executor->queues);
+    free(executor);
+}
+
+vlc_executor_t *
+vlc_executor_New(unsigned max_threads)
+{
+    assert(max_threads);
+
+    unsigned nqueues = vlc_GetCPUCount();
+    if (nqueues > max_threads)
+        nqueues = max_threads;
+    if (nqueues == 0)
+        nqueues = 1;
+
+    vlc_executor_t *executor = ExecutorCreate(max_threads, nqueues);
+    if (!executor)
+        return NULL;
 
     /* Create one thread on init so that vlc_executor_Submit() may never fail */
+    vlc_mutex_lock(&executor->lock);
     int ret = SpawnThread(executor);
+    vlc_mutex_unlock(&executor->lock);
     if (ret != VLC_SUCCESS)
     {
-        free(executor);
+        ExecutorFree(executor);
         return NULL;
     }
 
     return executor;
 }
 
-void
-vlc_executor_Submit(vlc_executor_t *executor, struct vlc_runnable *runnable)
+static void
+PoolSubmit(vlc_executor_t *executor, struct vlc_runnable *runnable,
+           enum vlc_executor_priority priority)
+{
+    assert(!atomic_load(&executor->closing));
+
+    unsigned unfinished = atomic_fetch_add(&executor->unfinished, 1) + 1;
+
+    unsigned index = atomic_fetch_add_explicit(&executor->next_queue, 1,
+                                               memory_order_relaxed);
+    QueuePush(&executor->queues[index % executor->nqueues], runnable,
+              priority);
+
+    /* Pairs with the sleepers increment in ThreadRun() */
+    if (atomic_load(&executor->sleepers))
+    {
+        vlc_mutex_lock(&executor->lock);
+        vlc_cond_signal(&executor->queue_wait);
+        vlc_mutex_unlock(&executor->lock);
+    }
+
+    if (unfinished > atomic_load(&executor->nthreads))
+    {
+        vlc_mutex_lock(&executor->lock);
+        if (atomic_load(&executor->nthreads) < executor->max_threads)
+            /* If it fails, this is not an error, there is at least one
+             * thread */
+            SpawnThread(executor);
+        vlc_mutex_unlock(&executor->lock);
+    }
+}
+
+/*
+ * Shared executors
+ */
+
+static vlc_mutex_t shared_lock = VLC_STATIC_MUTEX;
+static vlc_executor_t *shared_pool;
+static unsigned shared_clients;
+
+static vlc_executor_t *
+SharedPoolHold(unsigned quota)
+{
+    vlc_mutex_lock(&shared_lock);
+
+    if (!shared_pool)
+    {
+        unsigned nqueues = vlc_GetCPUCount();
+        if (nqueues == 0)
+            nqueues = 1;
+
+        /* Threads are spawned on demand, up to the sum of the quotas, so that
+         * every client may always run as many tasks as its quota. */
+        shared_pool = ExecutorCreate(quota, nqueues);
+        if (shared_pool)
+        {
+            /* As for vlc_executor_New(), there is always one thread */
+            vlc_mutex_lock(&shared_pool->lock);
+            int ret = SpawnThread(shared_pool);
+            vlc_mutex_unlock(&shared_pool->lock);
+            if (ret != VLC_SUCCESS)
+            {
+                ExecutorFree(shared_pool);
+                shared_pool = NULL;
+            }
+        }
+    }
+    else
+    {
+        vlc_mutex_lock(&shared_pool->lock);
+        shared_pool->max_threads += quota;
+        vlc_mutex_unlock(&shared_pool->lock);
+    }
+
+    vlc_executor_t *pool = shared_pool;
+    if (pool)
+        shared_clients++;
+
+    vlc_mutex_unlock(&shared_lock);
+    return pool;
+}
+
+static void
+PoolDelete(vlc_executor_t *executor);
+
+static void
+SharedPoolRelease(unsigned quota)
+{
+    vlc_mutex_lock(&shared_lock);
+    assert(shared_pool && shared_clients > 0);
+
+    if (--shared_clients == 0)
+    {
+        PoolDelete(shared_pool);
+        shared_pool = NULL;
+    }
+    else
+    {
+        vlc_mutex_lock(&shared_pool->lock);
+        assert(shared_pool->max_threads > quota);
+        shared_pool->max_threads -= quota;
+        vlc_mutex_unlock(&shared_pool->lock);
+    }
+
+    vlc_mutex_unlock(&shared_lock);
+}
+
+static void
+PumpRun(void *userdata)
 {
+    struct vlc_executor_pump *pump = userdata;
+    vlc_executor_t *executor = pump->owner;
+    struct vlc_executor_queue *queue = &executor->queues[0];
+
+    vlc_mutex_lock(&executor->lock);
+    struct vlc_runnable *runnable = TakeRunnable(executor, 0);
+    vlc_mutex_unlock(&executor->lock);
+
+    if (runnable)
+    {
+        runnable->run(runnable->userdata);
+        FinishRunnable(executor);
+    }
+
     vlc_mutex_lock(&executor->lock);
+    for (unsigned priority = PRIORITY_COUNT; priority-- > 0;)
+        if (atomic_load(&queue->count[priority]))
+        {
+            /* Yield to the pool between tasks, so that priorities are
+             * honored across all the executors sharing the pool. */
+            PoolSubmit(executor->pool, &pump->runnable, priority);
+            vlc_mutex_unlock(&executor->lock);
+            return;
+        }
+
+    pump->active = false;
+    assert(executor->running > 0);
+    if (--executor->running == 0)
+        vlc_cond_signal(&executor->running_wait);
+    vlc_mutex_unlock(&executor->lock);
+
+    if (vlc_atomic_rc_dec(&executor->rc))
+        ExecutorFree(executor);
+}
+
+vlc_executor_t *
+vlc_executor_NewShared(unsigned quota)
+{
+    assert(quota);
+
+    vlc_executor_t *pool = SharedPoolHold(quota);
+    if (!pool)
+        return NULL;
+
+    vlc_executor_t *executor = ExecutorCreate(0, 1);
+    if (!executor)
+        goto error;
+
+    executor->pumps = vlc_alloc(quota, sizeof(*executor->pumps));
+    if (!executor->pumps)
+    {
+        ExecutorFree(executor);
+        goto error;
+    }
+
+    for (unsigned i = 0; i < quota; ++i)
+    {
+        struct vlc_executor_pump *pump = &executor->pumps[i];
+        pump->owner = executor;
+        pump->active = false;
+        pump->runnable.run = PumpRun;
+        pump->runnable.userdata = pump;
+    }
+
+    executor->pool = pool;
+    executor->quota = quota;
+    return executor;
+
+error:
+    SharedPoolRelease(quota);
+    return NULL;
+}
 
-    assert(!executor->closing);
+static void
+SharedSubmit(vlc_executor_t *executor, struct vlc_runnable *runnable,
+             enum vlc_executor_priority priority)
+{
+    atomic_fetch_add(&executor->unfinished, 1);
 
-    QueuePush(executor, runnable);
+    vlc_mutex_lock(&executor->lock);
+    assert(!atomic_load(&executor->closing));
+
+    QueuePush(&executor->queues[0], runnable, priority);
 
-    if (++executor->unfinished > executor->nthreads
-            && executor->nthreads < executor->max_threads)
-        /* If it fails, this is not an error, there is at least one thread */
-        SpawnThread(executor);
+    if (executor->running < executor->quota)
+    {
+        struct vlc_executor_pump *pump = executor->pumps;
+        while (pump->active)
+            pump++;
+        assert(pump < executor->pumps + executor->quota);
+
+        pump->active = true;
+        executor->running++;
+        vlc_atomic_rc_inc(&executor->rc);
+        PoolSubmit(executor->pool, &pump->runnable, priority);
+    }
 
     vlc_mutex_unlock(&executor->lock);
 }
 
+void
+vlc_executor_SubmitPriority(vlc_executor_t *executor,
+                            struct vlc_runnable *runnable,
+                            enum vlc_executor_priority priority)
+{
+    if (executor->pool)
+        SharedSubmit(executor, runnable, priority);
+    else
+        PoolSubmit(executor, runnable, priority);
+}
+
+void
+vlc_executor_Submit(vlc_executor_t *executor, struct vlc_runnable *runnable)
+{
+    vlc_executor_SubmitPriority(executor, runnable,
+                                VLC_EXECUTOR_PRIORITY_NORMAL);
+}
+
 bool
 vlc_executor_Cancel(vlc_executor_t *executor, struct vlc_runnable *runnable)
 {
-    vlc_mutex_lock(&executor->lock);
+    struct vlc_executor_queue *queue = runnable->queue;
+    assert(queue->owner == executor);
+
+    vlc_mutex_lock(&queue->lock);
 
     /* Either both prev and next are set, either both are NULL */
     assert(!runnable->node.prev == !runnable->node.next);
@@ -231,14 +631,14 @@ vlc_executor_Cancel(vlc_executor_t *executor, struct vlc_runnable *runnable)
     if (in_queue)
     {
         vlc_list_remove(&runnable->node);
-
-        assert(executor->unfinished > 0);
-        --executor->unfinished;
-        if (!executor->unfinished)
-            vlc_cond_signal(&executor->idle_wait);
+        runnable->node.prev = runnable->node.next = NULL;
+        atomic_fetch_sub(&queue->count[runnable->priority], 1);
     }
 
-    vlc_mutex_unlock(&executor->lock);
+    vlc_mutex_unlock(&queue->lock);
+
+    if (in_queue)
+        FinishRunnable(executor);
 
     return in_queue;
 }
@@ -247,26 +647,27 @@ void
 vlc_executor_WaitIdle(vlc_executor_t *executor)
 {
     vlc_mutex_lock(&executor->lock);
-    while (executor->unfinished)
+    while (atomic_load(&executor->unfinished))
         vlc_cond_wait(&executor->idle_wait, &executor->lock);
     vlc_mutex_unlock(&executor->lock);
 }
 
-void
-vlc_executor_Delete(vlc_executor_t *executor)
+static void
+PoolDelete(vlc_executor_t *executor)
 {
     vlc_mutex_lock(&executor->lock);
 
-    executor->closing = true;
+    atomic_store(&executor->closing, true);
 
     /* All the tasks must be canceled on delete */
-    assert(vlc_list_is_empty(&executor->queue));
-
-    vlc_mutex_unlock(&executor->lock);
+    for (unsigned i = 0; i < executor->nqueues; ++i)
+        assert(QueueIsEmpty(&executor->queues[i]));
 
     /* "closing" is now true, this will wake up threads */
     vlc_cond_broadcast(&executor->queue_wait);
 
+    vlc_mutex_unlock(&executor->lock);
+
     /* The threads list may not be written at this point, so it is safe to read
      * it without mutex locked (the mutex must be released to join the
      * threads). */
@@ -278,11 +679,43 @@ vlc_executor_Delete(vlc_executor_t *executor)
         free(thread);
     }
 
-    /* The queue must still be empty (no runnable submitted a new runnable) */
-    assert(vlc_list_is_empty(&executor->queue));
+    /* The queues must still be empty (no runnable submitted a new runnable) */
+    for (unsigned i = 0; i < executor->nqueues; ++i)
+        assert(QueueIsEmpty(&executor->queues[i]));
 
     /* There are no tasks anymore */
-    assert(!executor->unfinished);
+    assert(!atomic_load(&executor->unfinished));
 
-    free(executor);
+    ExecutorFree(executor);
+}
+
+void
+vlc_executor_Delete(vlc_executor_t *executor)
+{
+    if (!executor->pool)
+    {
+        PoolDelete(executor);
+        return;
+    }
+
+    vlc_mutex_lock(&executor->lock);
+
+    atomic_store(&executor->closing, true);
+
+    /* All the tasks must be canceled on delete */
+    assert(QueueIsEmpty(&executor->queues[0]));
+
+    /* Wait for the end of the running tasks */
+    while (executor->running)
+        vlc_cond_wait(&executor->running_wait, &executor->lock);
+
+    vlc_mutex_unlock(&executor->lock);
+
+    assert(!atomic_load(&executor->unfinished));
+
+    unsigned quota = executor->quota;
+    if (vlc_atomic_rc_dec(&executor->rc))
+        ExecutorFree(executor);
+
+    SharedPoolRelease(quota);
 }
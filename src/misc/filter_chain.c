@@ -26,11 +26,18 @@
 #endif
 
 #include <vlc_filter.h>
+#include <vlc_executor.h>
 #include <vlc_modules.h>
 #include <vlc_mouse.h>
 #include <vlc_spu.h>
 #include <libvlc.h>
 #include <assert.h>
+#include <inttypes.h>
+
+/* Maximum number of bands a picture is split into */
+#define FILTER_SLICE_MAX 16
+/* Minimum height of a band, in lines of the first plane */
+#define FILTER_SLICE_MIN_LINES 64
 
 typedef struct chained_filter_t
 {
@@ -40,6 +47,12 @@ typedef struct chained_filter_t
     struct chained_filter_t *prev, *next;
     vlc_mouse_t mouse;
     vlc_picture_chain_t pending;
+    struct
+    {
+        uint64_t frames; /**< Number of pictures filtered */
+        vlc_tick_t total; /**< Wall-clock time spent filtering */
+        vlc_tick_t max; /**< Longest time spent on a single picture */
+    } timing;
 } chained_filter_t;
 
 /* */
@@ -56,6 +69,9 @@ struct filter_chain_t
     bool b_allow_fmt_out_change; /**< Each filter can change the output */
     const char *filter_cap; /**< Filter modules capability */
     const char *conv_cap; /**< Converter modules capability */
+
+    unsigned slices; /**< Maximum number of bands filtered in parallel */
+    vlc_executor_t *executor; /**< Band workers (created on first use) */
 };
 
 /**
@@ -83,6 +99,8 @@ static filter_chain_t *filter_chain_NewInner( vlc_object_t *obj,
     chain->b_allow_fmt_out_change = fmt_out_change;
     chain->filter_cap = cap;
     chain->conv_cap = conv_cap;
+    chain->slices = 1;
+    chain->executor = NULL;
     return chain;
 }
 
@@ -159,6 +177,11 @@ filter_chain_t *filter_chain_NewVideo( vlc_object_t *obj, bool allow_change,
     }
     else
         chain->parent_video_owner = (filter_owner_t){0};
+
+    int threads = var_InheritInteger( obj, "video-filter-threads" );
+    if( threads <= 0 )
+        threads = vlc_GetCPUCount();
+    chain->slices = VLC_CLIP( threads, 1, FILTER_SLICE_MAX );
     return chain;
 }
 
@@ -180,6 +203,8 @@ void filter_chain_Delete( filter_chain_t *p_chain )
         vlc_video_context_Release( p_chain->vctx_in );
     es_format_Clean( &p_chain->fmt_out );
 
+    if( p_chain->executor != NULL )
+        vlc_executor_Delete( p_chain->executor );
     free( p_chain );
 }
 /**
@@ -275,6 +300,9 @@ static filter_t *filter_chain_AppendInner( filter_chain_t *chain,
 
     vlc_mouse_Init( &chained->mouse );
     vlc_picture_chain_Init( &chained->pending );
+    chained->timing.frames = 0;
+    chained->timing.total = 0;
+    chained->timing.max = 0;
 
     msg_Dbg( chain->obj, "Filter '%s' (%p) appended to chain",
              (name != NULL) ? name : module_GetShortName(filter->p_module),
@@ -331,7 +359,15 @@ void filter_chain_DeleteFilter( filter_chain_t *chain, filter_t *filter )
     filter_Close( filter );
     module_unneed( filter, filter->p_module );
 
-    msg_Dbg( chain->obj, "Filter %p removed from chain", (void *)filter );
+    if( chained->timing.frames > 0 )
+        msg_Dbg( chain->obj, "Filter %p removed from chain (%"PRIu64" pictures,"
+                 " %"PRId64" us average, %"PRId64" us max)", (void *)filter,
+                 chained->timing.frames,
+                 US_FROM_VLC_TICK( chained->timing.total ) /
+                 (int64_t)chained->timing.frames,
+                 US_FROM_VLC_TICK( chained->timing.max ) );
+    else
+        msg_Dbg( chain->obj, "Filter %p removed from chain", (void *)filter );
     FilterDeletePictures( &chained->pending );
 
     es_format_Clean( &filter->fmt_out );
@@ -427,7 +463,15 @@ static picture_t *FilterChainVideoFilter( chained_filter_t *f, picture_t *p_pic
     for( ; f != NULL; f = f->next )
     {
         filter_t *p_filter = &f->filter;
+        vlc_tick_t start = vlc_tick_now();
+
         p_pic = p_filter->ops->filter_video( p_filter, p_pic );
+
+        vlc_tick_t duration = vlc_tick_now() - start;
+        f->timing.frames++;
+        f->timing.total += duration;
+        if( duration > f->timing.max )
+            f->timing.max = duration;
         if( !p_pic )
             break;
         if( !vlc_picture_chain_IsEmpty( &f->pending ) )
@@ -461,6 +505,86 @@ picture_t *filter_chain_VideoFilter( filter_chain_t *p_chain, picture_t *p_pic )
     return NULL;
 }
 
+struct filter_slice
+{
+    filter_t *filter;
+    picture_t *dst;
+    const picture_t *src;
+    unsigned first, count;
+    vlc_sem_t *done;
+    struct vlc_runnable runnable;
+};
+
+static void FilterSliceRun( void *data )
+{
+    struct filter_slice *slice = data;
+    filter_t *filter = slice->filter;
+
+    filter->ops->filter_slice( filter, slice->dst, slice->src,
+                               slice->first, slice->count );
+    vlc_sem_post( slice->done );
+}
+
+void filter_SliceVideo( filter_t *filter, picture_t *dst,
+                        const picture_t *src )
+{
+    const unsigned lines = src->p[0].i_visible_lines;
+    unsigned count = 1;
+    vlc_executor_t *executor = NULL;
+
+    assert( filter->ops->filter_slice != NULL );
+
+    /* Only chained filters have workers */
+    if( filter->owner.video == &filter_chain_video_cbs )
+    {
+        filter_chain_t *chain = filter->owner.sys;
+
+        count = __MIN( chain->slices, lines / FILTER_SLICE_MIN_LINES );
+        if( count > 1 && chain->executor == NULL )
+        {
+            /* The calling thread filters one of the bands itself */
+            chain->executor = vlc_executor_NewShared( chain->slices - 1 );
+            if( chain->executor == NULL )
+                chain->slices = 1;
+        }
+        executor = chain->executor;
+    }
+
+    if( count <= 1 || executor == NULL )
+    {
+        filter->ops->filter_slice( filter, dst, src, 0, lines );
+        return;
+    }
+
+    struct filter_slice slices[FILTER_SLICE_MAX];
+    vlc_sem_t done;
+
+    vlc_sem_init( &done, 0 );
+    for( unsigned i = 0; i < count; i++ )
+    {
+        /* Keep bands aligned on chroma subsampling */
+        unsigned first = (lines * i / count) & ~3u;
+        unsigned end = (i + 1 < count) ? (lines * (i + 1) / count) & ~3u
+                                       : lines;
+
+        slices[i].filter = filter;
+        slices[i].dst = dst;
+        slices[i].src = src;
+        slices[i].first = first;
+        slices[i].count = end - first;
+        slices[i].done = &done;
+        slices[i].runnable.run = FilterSliceRun;
+        slices[i].runnable.userdata = &slices[i];
+        if( i > 0 )
+            vlc_executor_SubmitPriority( executor, &slices[i].runnable,
+                                         VLC_EXECUTOR_PRIORITY_HIGH );
+    }
+
+    FilterSliceRun( &slices[0] );
+    for( unsigned i = 0; i < count; i++ )
+        vlc_sem_wait( &done );
+}
+
 void filter_chain_VideoFlush( filter_chain_t *p_chain )
 {
     for( chained_filter_t *f = p_chain->first; f != NULL; f = f->next )
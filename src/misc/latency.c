@@ -0,0 +1,158 @@
+/*****************************************************************************
+ * latency.c: latency histograms
+ *****************************************************************************
+ * Copyright (C) 2021 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc_common.h>
+#include <vlc_input_item.h>
+
+#include "latency.h"
+
+/* Values below 4 have their own bucket. Above, each octave [2^n, 2^(n+1)[ is
+ * split in 4 buckets, indexed by the 2 bits following the most significant
+ * one. */
+static unsigned BucketIndex(vlc_tick_t value)
+{
+    if (value < 4)
+        return value > 0 ? value : 0;
+
+    unsigned msb = 63 - vlc_clzll(value);
+    unsigned index = 4 * (msb - 1) + ((value >> (msb - 2)) & 3);
+
+    return index < VLC_LATENCY_BUCKETS ? index : VLC_LATENCY_BUCKETS - 1;
+}
+
+/* Upper bound of the values counted in a bucket */
+static vlc_tick_t BucketValue(unsigned index)
+{
+    if (index < 4)
+        return index;
+
+    unsigned msb = index / 4 + 1;
+    vlc_tick_t low = (vlc_tick_t)(4 + index % 4) << (msb - 2);
+
+    return low + ((vlc_tick_t)1 << (msb - 2)) - 1;
+}
+
+static void UpdateMax(struct vlc_latency_histogram *h, vlc_tick_t value)
+{
+    vlc_tick_t max = atomic_load_explicit(&h->max, memory_order_relaxed);
+
+    while (value > max
+        && !atomic_compare_exchange_weak_explicit(&h->max, &max, value,
+                                                  memory_order_relaxed,
+                                                  memory_order_relaxed));
+}
+
+void vlc_latency_histogram_Init(struct vlc_latency_histogram *h)
+{
+    for (size_t i = 0; i < VLC_LATENCY_BUCKETS; i++)
+        atomic_init(&h->buckets[i], 0);
+    atomic_init(&h->count, 0);
+    atomic_init(&h->max, 0);
+}
+
+void vlc_latency_histogram_Add(struct vlc_latency_histogram *h,
+                               vlc_tick_t value)
+{
+    if (value < 0)
+        value = 0;
+
+    atomic_fetch_add_explicit(&h->buckets[BucketIndex(value)], 1,
+                              memory_order_relaxed);
+    atomic_fetch_add_explicit(&h->count, 1, memory_order_relaxed);
+    UpdateMax(h, value);
+}
+
+void vlc_latency_histogram_Move(struct vlc_latency_histogram *restrict dst,
+                                struct vlc_latency_histogram *restrict src)
+{
+    if (atomic_load_explicit(&src->count, memory_order_relaxed) == 0)
+        return;
+
+    uint_least64_t count = atomic_exchange_explicit(&src->count, 0,
+                                                    memory_order_relaxed);
+    atomic_fetch_add_explicit(&dst->count, count, memory_order_relaxed);
+
+    /* Most buckets are empty, skip them without dirtying their cache line */
+    for (size_t i = 0; i < VLC_LATENCY_BUCKETS; i++)
+        if (atomic_load_explicit(&src->buckets[i], memory_order_relaxed) != 0)
+        {
+            uint_least64_t n = atomic_exchange_explicit(&src->buckets[i], 0,
+                                                        memory_order_relaxed);
+            atomic_fetch_add_explicit(&dst->buckets[i], n,
+                                      memory_order_relaxed);
+        }
+
+    UpdateMax(dst, atomic_exchange_explicit(&src->max, 0,
+                                            memory_order_relaxed));
+}
+
+void vlc_latency_histogram_Compute(struct vlc_latency_histogram *h,
+                                   struct input_latency_stats *stats)
+{
+    uint_least64_t buckets[VLC_LATENCY_BUCKETS];
+    uint_least64_t count = 0;
+
+    /* Count from the buckets, as the total might be updated concurrently */
+    for (size_t i = 0; i < VLC_LATENCY_BUCKETS; i++)
+    {
+        buckets[i] = atomic_load_explicit(&h->buckets[i],
+                                          memory_order_relaxed);
+        count += buckets[i];
+    }
+
+    stats->count = count;
+    stats->max = atomic_load_explicit(&h->max, memory_order_relaxed);
+    stats->p50 = stats->p99 = VLC_TICK_INVALID;
+    if (count == 0)
+        return;
+
+    /* Rank of the percentiles, rounded up */
+    const uint_least64_t rank50 = (count + 1) / 2;
+    const uint_least64_t rank99 = count - count / 100;
+    uint_least64_t sum = 0;
+    bool has_p50 = false;
+
+    for (size_t i = 0; i < VLC_LATENCY_BUCKETS; i++)
+    {
+        if (buckets[i] == 0)
+            continue;
+
+        sum += buckets[i];
+
+        vlc_tick_t value = BucketValue(i);
+        if (value > stats->max)
+            value = stats->max;
+
+        if (!has_p50 && sum >= rank50)
+        {
+            stats->p50 = value;
+            has_p50 = true;
+        }
+        if (sum >= rank99)
+        {
+            stats->p99 = value;
+            break;
+        }
+    }
+}
@@ -0,0 +1,64 @@
+/*****************************************************************************
+ * latency.h: latency histograms
+ *****************************************************************************
+ * Copyright (C) 2021 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef LIBVLC_MISC_LATENCY_H
+# define LIBVLC_MISC_LATENCY_H
+# include <stdatomic.h>
+# include <stdint.h>
+
+struct input_latency_stats;
+
+/*
+ * Latency histogram
+ *
+ * Samples are counted in logarithmic buckets, four per octave, so that a
+ * percentile is known with a relative error below 20% whatever its
+ * magnitude. Every operation is lock-free: samples may be added from any
+ * thread while the histogram is being read or moved.
+ */
+#define VLC_LATENCY_BUCKETS 128
+
+struct vlc_latency_histogram
+{
+    atomic_uint_least64_t buckets[VLC_LATENCY_BUCKETS];
+    atomic_uint_least64_t count;
+    _Atomic vlc_tick_t max;
+};
+
+void vlc_latency_histogram_Init(struct vlc_latency_histogram *);
+
+/**
+ * Adds a sample. Negative values are counted as zero.
+ */
+void vlc_latency_histogram_Add(struct vlc_latency_histogram *, vlc_tick_t);
+
+/**
+ * Adds all the samples of a histogram to another one, and resets the former.
+ */
+void vlc_latency_histogram_Move(struct vlc_latency_histogram *restrict dst,
+                                struct vlc_latency_histogram *restrict src);
+
+/**
+ * Computes the latency distribution of a histogram.
+ */
+void vlc_latency_histogram_Compute(struct vlc_latency_histogram *,
+                                   struct input_latency_stats *);
+
+#endif
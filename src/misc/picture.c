@@ -94,6 +94,7 @@ void picture_Reset( picture_t *p_picture )
     p_picture->date = VLC_TICK_INVALID;
     p_picture->b_force = false;
     p_picture->b_still = false;
+    vlc_frame_trace_Init( &p_picture->trace );
     p_picture->b_progressive = false;
     p_picture->i_nb_fields = 2;
     p_picture->b_top_field_first = false;
@@ -391,6 +392,7 @@ void picture_CopyProperties( picture_t *p_dst, const picture_t *p_src )
     p_dst->date = p_src->date;
     p_dst->b_force = p_src->b_force;
     p_dst->b_still = p_src->b_still;
+    p_dst->trace = p_src->trace;
 
     p_dst->b_progressive = p_src->b_progressive;
     p_dst->i_nb_fields = p_src->i_nb_fields;
@@ -27,7 +27,9 @@
 #endif
 #include <assert.h>
 #include <limits.h>
+#include <stdalign.h>
 #include <stdatomic.h>
+#include <stdint.h>
 #include <stdlib.h>
 
 #include <vlc_common.h>
@@ -35,19 +37,27 @@
 #include <vlc_atomic.h>
 #include "picture.h"
 
-#define POOL_MAX (CHAR_BIT * sizeof (unsigned long long))
+#define POOL_WORD_BITS (CHAR_BIT * sizeof (unsigned long long))
 
-static_assert ((POOL_MAX & (POOL_MAX - 1)) == 0, "Not a power of two");
+struct picture_pool_slot {
+    picture_pool_t *pool;
+    picture_t      *picture;
+    unsigned        offset;
+};
 
 struct picture_pool_t {
     vlc_mutex_t lock;
     vlc_cond_t  wait;
 
-    bool               canceled;
-    unsigned long long available;
+    atomic_bool        canceled;
+    atomic_uint        waiters;
+    atomic_uint        hint;
     vlc_atomic_rc_t    refs;
-    unsigned short     picture_count;
-    picture_t  *picture[];
+    unsigned           picture_count;
+    unsigned           word_count;
+    /* Bitmap of available pictures: bit set means the picture is free. */
+    atomic_ullong     *available;
+    struct picture_pool_slot slot[];
 };
 
 static void picture_pool_Destroy(picture_pool_t *pool)
@@ -55,31 +65,39 @@ static void picture_pool_Destroy(picture_pool_t *pool)
     if (!vlc_atomic_rc_dec(&pool->refs))
         return;
 
-    aligned_free(pool);
+    free(pool);
 }
 
 void picture_pool_Release(picture_pool_t *pool)
 {
     for (unsigned i = 0; i < pool->picture_count; i++)
-        picture_Release(pool->picture[i]);
+        picture_Release(pool->slot[i].picture);
     picture_pool_Destroy(pool);
 }
 
 static void picture_pool_ReleaseClone(picture_t *clone)
 {
     picture_priv_t *priv = (picture_priv_t *)clone;
-    uintptr_t sys = (uintptr_t)priv->gc.opaque;
-    picture_pool_t *pool = (void *)(sys & ~(POOL_MAX - 1));
-    unsigned offset = sys & (POOL_MAX - 1);
-    picture_t *picture = pool->picture[offset];
+    struct picture_pool_slot *slot = priv->gc.opaque;
+    picture_pool_t *pool = slot->pool;
+    unsigned long long bit = 1ULL << (slot->offset % POOL_WORD_BITS);
+    atomic_ullong *word = &pool->available[slot->offset / POOL_WORD_BITS];
 
-    picture_Release(picture);
+    picture_Release(slot->picture);
 
-    vlc_mutex_lock(&pool->lock);
-    assert(!(pool->available & (1ULL << offset)));
-    pool->available |= 1ULL << offset;
-    vlc_cond_signal(&pool->wait);
-    vlc_mutex_unlock(&pool->lock);
+    unsigned long long prev = atomic_fetch_or(word, bit);
+    assert(!(prev & bit));
+    (void) prev;
+
+    /* Only bother with the lock if somebody is (about to be) waiting.
+     * The sequentially consistent fetch-or above and the load below pair with
+     * the increment and bitmap scan in picture_pool_Wait(). */
+    if (atomic_load(&pool->waiters) > 0)
+    {
+        vlc_mutex_lock(&pool->lock);
+        vlc_cond_signal(&pool->wait);
+        vlc_mutex_unlock(&pool->lock);
+    }
 
     picture_pool_Destroy(pool);
 }
@@ -87,11 +105,10 @@ static void picture_pool_ReleaseClone(picture_t *clone)
 static picture_t *picture_pool_ClonePicture(picture_pool_t *pool,
                                             unsigned offset)
 {
-    picture_t *picture = pool->picture[offset];
-    uintptr_t sys = ((uintptr_t)pool) + offset;
+    struct picture_pool_slot *slot = &pool->slot[offset];
 
-    picture_t *clone = picture_InternalClone(picture, picture_pool_ReleaseClone,
-                                 (void*)sys);
+    picture_t *clone = picture_InternalClone(slot->picture,
+                                             picture_pool_ReleaseClone, slot);
     if (clone != NULL) {
         assert(!picture_HasChainedPics(clone));
         vlc_atomic_rc_inc(&pool->refs);
@@ -99,29 +116,86 @@ static picture_t *picture_pool_ClonePicture(picture_pool_t *pool,
     return clone;
 }
 
+/**
+ * Claims one free picture without locking.
+ *
+ * @return the picture offset, or -1 if the pool is exhausted
+ */
+static int picture_pool_Claim(picture_pool_t *pool)
+{
+    const unsigned words = pool->word_count;
+    unsigned start = atomic_load_explicit(&pool->hint, memory_order_relaxed);
+
+    for (unsigned n = 0; n < words; n++)
+    {
+        unsigned w = (start + n) % words;
+        atomic_ullong *word = &pool->available[w];
+        unsigned long long available = atomic_load(word);
+
+        while (available != 0)
+        {
+            unsigned long long bit = available & -available;
+
+            if (atomic_compare_exchange_weak(word, &available,
+                                             available & ~bit))
+            {
+                if (w != start)
+                    atomic_store_explicit(&pool->hint, w,
+                                          memory_order_relaxed);
+                return w * POOL_WORD_BITS + ctz(bit);
+            }
+        }
+    }
+    return -1;
+}
+
 picture_pool_t *picture_pool_New(unsigned count, picture_t *const *tab)
 {
-    if (unlikely(count > POOL_MAX))
+    picture_pool_t *pool;
+    size_t size;
+
+    if (unlikely(mul_overflow(count, sizeof (pool->slot[0]), &size)))
         return NULL;
 
-    picture_pool_t *pool;
-    size_t size = sizeof (*pool) + count * sizeof (picture_t *);
+    unsigned words = (count + POOL_WORD_BITS - 1) / POOL_WORD_BITS;
+    if (unlikely(words == 0))
+        words = 1;
 
-    size += (-size) & (POOL_MAX - 1);
-    pool = aligned_alloc(POOL_MAX, size);
+    size += sizeof (*pool);
+    size += (-size) & (alignof (atomic_ullong) - 1);
+
+    size_t offset = size;
+    size += words * sizeof (atomic_ullong);
+
+    pool = malloc(size);
     if (unlikely(pool == NULL))
         return NULL;
 
     vlc_mutex_init(&pool->lock);
     vlc_cond_init(&pool->wait);
-    if (count == POOL_MAX)
-        pool->available = ~0ULL;
-    else
-        pool->available = (1ULL << count) - 1;
+    atomic_init(&pool->canceled, false);
+    atomic_init(&pool->waiters, 0);
+    atomic_init(&pool->hint, 0);
     vlc_atomic_rc_init(&pool->refs);
     pool->picture_count = count;
-    memcpy(pool->picture, tab, count * sizeof (picture_t *));
-    pool->canceled = false;
+    pool->word_count = words;
+    pool->available = (atomic_ullong *)(((char *)pool) + offset);
+
+    for (unsigned i = 0; i < words; i++)
+    {
+        unsigned left = count - i * POOL_WORD_BITS;
+        unsigned long long mask = (left >= POOL_WORD_BITS)
+            ? ~0ULL : (1ULL << left) - 1;
+
+        atomic_init(&pool->available[i], mask);
+    }
+
+    for (unsigned i = 0; i < count; i++)
+    {
+        pool->slot[i].pool = pool;
+        pool->slot[i].picture = tab[i];
+        pool->slot[i].offset = i;
+    }
     return pool;
 }
 
@@ -180,49 +254,42 @@ error:
 
 picture_t *picture_pool_Get(picture_pool_t *pool)
 {
-    unsigned long long available;
-
-    vlc_mutex_lock(&pool->lock);
     assert(vlc_atomic_rc_get(&pool->refs) > 0);
-    available = pool->available;
-
-    while (available != 0)
-    {
-        int i = ctz(available);
 
-        if (unlikely(pool->canceled))
-            break;
-
-        pool->available &= ~(1ULL << i);
-        vlc_mutex_unlock(&pool->lock);
-        available &= ~(1ULL << i);
+    if (unlikely(atomic_load(&pool->canceled)))
+        return NULL;
 
-        return picture_pool_ClonePicture(pool, i);
-    }
+    int i = picture_pool_Claim(pool);
+    if (i < 0)
+        return NULL;
 
-    vlc_mutex_unlock(&pool->lock);
-    return NULL;
+    return picture_pool_ClonePicture(pool, i);
 }
 
 picture_t *picture_pool_Wait(picture_pool_t *pool)
 {
-    vlc_mutex_lock(&pool->lock);
     assert(vlc_atomic_rc_get(&pool->refs) > 0);
 
-    while (pool->available == 0)
+    int i = picture_pool_Claim(pool);
+    if (likely(i >= 0))
+        return picture_pool_ClonePicture(pool, i);
+
+    /* Slow path: the pool is exhausted */
+    vlc_mutex_lock(&pool->lock);
+    atomic_fetch_add(&pool->waiters, 1);
+
+    while ((i = picture_pool_Claim(pool)) < 0)
     {
-        if (pool->canceled)
-        {
-            vlc_mutex_unlock(&pool->lock);
-            return NULL;
-        }
+        if (atomic_load(&pool->canceled))
+            break;
         vlc_cond_wait(&pool->wait, &pool->lock);
     }
 
-    int i = ctz(pool->available);
-    pool->available &= ~(1ULL << i);
+    atomic_fetch_sub(&pool->waiters, 1);
     vlc_mutex_unlock(&pool->lock);
 
+    if (i < 0)
+        return NULL;
     return picture_pool_ClonePicture(pool, i);
 }
 
@@ -231,7 +298,7 @@ void picture_pool_Cancel(picture_pool_t *pool, bool canceled)
     vlc_mutex_lock(&pool->lock);
     assert(vlc_atomic_rc_get(&pool->refs) > 0);
 
-    pool->canceled = canceled;
+    atomic_store(&pool->canceled, canceled);
     if (canceled)
         vlc_cond_broadcast(&pool->wait);
     vlc_mutex_unlock(&pool->lock);
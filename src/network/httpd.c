@@ -33,6 +33,7 @@
 
 #include <assert.h>
 
+#include <vlc_atomic.h>
 #include <vlc_list.h>
 #include <vlc_network.h>
 #include <vlc_tls.h>
@@ -61,6 +62,19 @@
 #   include <sys/socket.h>
 #endif
 
+#ifdef __linux__
+#   include <netinet/in.h>
+#   include <linux/errqueue.h>
+#   include <sys/epoll.h>
+#   include <sys/eventfd.h>
+#   if defined(MSG_ZEROCOPY) && defined(SO_ZEROCOPY)
+#       define HTTPD_ZEROCOPY 1
+#   endif
+#   ifdef EPOLLEXCLUSIVE
+#       define HTTPD_EPOLL 1
+#   endif
+#endif
+
 #if defined(_WIN32)
 /* We need HUGE buffer otherwise TCP throughput is very limited */
 #define HTTPD_CL_BUFSIZE 1000000
@@ -68,10 +82,61 @@
 #define HTTPD_CL_BUFSIZE 10000
 #endif
 
+/* Maximum number of stream segments sent at once */
+#define HTTPD_CL_SEGMENTS 16
+/* Smaller stream blocks are gathered into segments of this size */
+#define HTTPD_SEGMENT_SIZE 16384
+
+#ifdef HTTPD_ZEROCOPY
+/* Below this size, zero-copy costs more than it saves */
+#define HTTPD_ZEROCOPY_MIN 16384
+/* Maximum number of segments pinned by the kernel per client */
+#define HTTPD_ZEROCOPY_PINS 64
+#endif
+
+#ifdef HTTPD_EPOLL
+/* Maximum number of worker threads per host */
+#define HTTPD_MAX_WORKERS 16
+/* Maximum number of events handled per wake-up */
+#define HTTPD_EPOLL_EVENTS 64
+#endif
+
+/* A block of a stream, shared by all the clients sending it */
+struct httpd_segment
+{
+    block_t *block;
+    int64_t pos; /* absolute position of the first byte */
+    size_t room; /* bytes left to gather more blocks in */
+    bool shared; /* referenced by clients, cannot grow anymore */
+    vlc_atomic_rc_t rc;
+    struct vlc_list node; /* in httpd_stream_t.segments */
+};
+
 static void httpd_ClientDestroy(httpd_client_t *cl);
-static void httpd_AppendData(httpd_stream_t *stream, uint8_t *p_data, int i_data);
+static void httpd_SegmentRelease(struct httpd_segment *seg);
+
+/* Thread serving a share of the clients of a host */
+struct httpd_worker
+{
+    httpd_host_t *host;
+    vlc_thread_t thread;
 
-/* each host run in his own thread */
+    /* protects the clients, which are only touched by the worker thread
+     * and when their url is deleted */
+    vlc_mutex_t lock;
+    size_t client_count;
+    struct vlc_list clients;
+
+#ifdef HTTPD_EPOLL
+    int epfd;
+    int wakefd;              /* signaled when stream data is available */
+    struct vlc_list ready;   /* clients to serve again without waiting */
+    struct vlc_list waiting; /* clients waiting for stream data */
+    vlc_tick_t timeout_date; /* next time the timeouts are checked */
+#endif
+};
+
+/* each host run in its own worker threads */
 struct httpd_host_t
 {
     struct vlc_object_t obj;
@@ -85,7 +150,11 @@ struct httpd_host_t
     unsigned     nfd;
     unsigned     port;
 
-    vlc_thread_t thread;
+    struct httpd_worker *workers;
+    unsigned worker_count;
+
+    /* protects the urls, and serializes the callbacks but those of the
+     * streams, which are thread-safe */
     vlc_mutex_t lock;
 
     /* all registered url (becarefull that 2 httpd_url_t could point at the same url)
@@ -94,8 +163,6 @@ struct httpd_host_t
      * */
     struct vlc_list urls;
 
-    size_t client_count;
-    struct vlc_list clients;
     unsigned timeout_sec;
 
     /* TLS data */
@@ -113,6 +180,9 @@ struct httpd_url_t
     char      *psz_user;
     char      *psz_password;
 
+    /* callbacks may run concurrently from several workers */
+    bool       b_concurrent;
+
     struct
     {
         httpd_callback_t     cb;
@@ -143,6 +213,12 @@ struct httpd_client_t
     vlc_tls_t   *sock;
 
     struct vlc_list node;
+#ifdef HTTPD_EPOLL
+    struct httpd_worker *worker;
+    struct vlc_list queue_node; /* in the ready or waiting worker list */
+    bool     queued;
+    uint32_t epoll_events;      /* events registered with epoll */
+#endif
 
     bool    b_stream_mode;
     uint8_t i_state;
@@ -161,6 +237,25 @@ struct httpd_client_t
      */
     int64_t i_keyframe_wait_to_pass;
 
+    /* Stream segments to send, referenced rather than copied to p_buffer.
+     * The first one is sent from seg_offset. */
+    struct httpd_segment *seg[HTTPD_CL_SEGMENTS];
+    unsigned seg_count;
+    size_t   seg_offset;
+
+#ifdef HTTPD_ZEROCOPY
+    /* Segments pinned by the kernel until it notifies the completion of
+     * the zero-copy send with the given sequence number */
+    struct
+    {
+        struct httpd_segment *seg;
+        uint32_t id;
+    } *zc_pins;
+    unsigned zc_count;
+    uint32_t zc_next_id;
+    bool     zc_copied; /* the kernel copies anyway, stop using zero-copy */
+#endif
+
     /* */
     httpd_message_t query;  /* client -> httpd */
     httpd_message_t answer; /* httpd -> client */
@@ -612,17 +707,77 @@ struct httpd_stream_t
     bool        b_has_keyframes;
     int64_t     i_last_keyframe_seen_pos;
 
-    /* circular buffer */
-    int         i_buffer_size;      /* buffer size, can't be reallocated smaller */
-    uint8_t     *p_buffer;          /* buffer */
+    /* Retained blocks, oldest first. Clients reference them by position;
+     * a client falling behind the oldest one is disconnected. */
+    struct vlc_list segments;
+    size_t      i_retained;         /* bytes retained */
+    size_t      i_window;           /* maximum bytes retained */
     int64_t     i_buffer_pos;       /* absolute position from beginning */
     int64_t     i_buffer_last_pos;  /* a new connection will start with that */
+#ifdef HTTPD_EPOLL
+    unsigned    waiters;            /* workers with clients waiting for data */
+#endif
 
     /* custom headers */
     size_t        i_http_headers;
     httpd_header * p_http_headers;
 };
 
+static void httpd_SegmentRelease(struct httpd_segment *seg)
+{
+    if (vlc_atomic_rc_dec(&seg->rc)) {
+        block_Release(seg->block);
+        free(seg);
+    }
+}
+
+static struct httpd_segment *httpd_SegmentHold(struct httpd_segment *seg)
+{
+    vlc_atomic_rc_inc(&seg->rc);
+    return seg;
+}
+
+/* Creates a segment owning a block, or a copy of it if it is small */
+static struct httpd_segment *httpd_SegmentNew(block_t *block)
+{
+    struct httpd_segment *seg = malloc(sizeof (*seg));
+    if (unlikely(seg == NULL))
+        return NULL;
+
+    seg->room = 0;
+    if (block->i_buffer < HTTPD_SEGMENT_SIZE) {
+        block_t *copy = block_Alloc(HTTPD_SEGMENT_SIZE);
+        if (unlikely(copy == NULL)) {
+            free(seg);
+            return NULL;
+        }
+        memcpy(copy->p_buffer, block->p_buffer, block->i_buffer);
+        copy->i_buffer = block->i_buffer;
+        seg->room = HTTPD_SEGMENT_SIZE - block->i_buffer;
+        block_Release(block);
+        block = copy;
+    }
+
+    seg->block = block;
+    seg->shared = false;
+    vlc_atomic_rc_init(&seg->rc);
+    return seg;
+}
+
+/* Finds the retained segment containing a position (stream lock held) */
+static struct httpd_segment *httpd_StreamFind(httpd_stream_t *stream,
+                                              int64_t pos)
+{
+    struct httpd_segment *seg;
+
+    /* Most clients are close to the live edge: search from the newest */
+    vlc_list_reverse_foreach(seg, &stream->segments, node)
+        if (seg->pos <= pos)
+            return (pos < seg->pos + (int64_t)seg->block->i_buffer) ? seg
+                                                                    : NULL;
+    return NULL;
+}
+
 static int httpd_StreamCallBack(httpd_callback_sys_t *p_sys,
                                  httpd_client_t *cl, httpd_message_t *answer,
                                  const httpd_message_t *query)
@@ -633,47 +788,59 @@ static int httpd_StreamCallBack(httpd_callback_sys_t *p_sys,
         return VLC_SUCCESS;
 
     if (answer->i_body_offset > 0) {
-        int     i_pos;
+        assert(cl->seg_count == 0);
+        vlc_mutex_lock(&stream->lock);
 
         if (answer->i_body_offset >= stream->i_buffer_pos)
-            return VLC_EGENERIC;    /* wait, no data available */
+            goto wait;    /* wait, no data available */
 
         if (cl->i_keyframe_wait_to_pass >= 0) {
-            if (stream->i_last_keyframe_seen_pos <= cl->i_keyframe_wait_to_pass)
+            if (stream->i_last_keyframe_seen_pos <= cl->i_keyframe_wait_to_pass
+             || httpd_StreamFind(stream, stream->i_last_keyframe_seen_pos) == NULL)
                 /* still waiting for the next keyframe */
-                return VLC_EGENERIC;
+                goto wait;
 
             /* seek to the new keyframe */
             answer->i_body_offset = stream->i_last_keyframe_seen_pos;
             cl->i_keyframe_wait_to_pass = -1;
         }
 
-        if (answer->i_body_offset + stream->i_buffer_size < stream->i_buffer_pos)
-            answer->i_body_offset = stream->i_buffer_last_pos; /* this client isn't fast enough */
-
-        i_pos   = answer->i_body_offset % stream->i_buffer_size;
-        int64_t i_write = stream->i_buffer_pos - answer->i_body_offset;
-
-        if (i_write > HTTPD_CL_BUFSIZE)
-            i_write = HTTPD_CL_BUFSIZE;
-        else if (i_write <= 0)
-            return VLC_EGENERIC;    /* wait, no data available */
+        struct httpd_segment *seg = httpd_StreamFind(stream,
+                                                     answer->i_body_offset);
+        if (seg == NULL) {
+            /* This client isn't fast enough: the data it needs was dropped.
+             * Skipping data would corrupt the stream, close it instead. */
+            vlc_mutex_unlock(&stream->lock);
+            msg_Dbg(stream->url->host, "client too slow, disconnecting");
+            cl->i_state = HTTPD_CLIENT_DEAD;
+            return VLC_EGENERIC;
+        }
 
-        /* Don't go past the end of the circular buffer */
-        i_write = __MIN(i_write, stream->i_buffer_size - i_pos);
+        /* Reference the segments, without copying their data */
+        cl->seg_offset = answer->i_body_offset - seg->pos;
+        do {
+            /* the client reads the segment size without the stream lock */
+            seg->shared = true;
+            cl->seg[cl->seg_count++] = httpd_SegmentHold(seg);
+            answer->i_body_offset = seg->pos + seg->block->i_buffer;
+            seg = vlc_list_next_entry_or_null(&stream->segments, seg,
+                                              struct httpd_segment, node);
+        } while (seg != NULL && cl->seg_count < HTTPD_CL_SEGMENTS);
+        vlc_mutex_unlock(&stream->lock);
 
         /* using HTTPD_MSG_ANSWER -> data available */
         answer->i_proto  = HTTPD_PROTO_HTTP;
         answer->i_version= 0;
         answer->i_type   = HTTPD_MSG_ANSWER;
 
-        answer->i_body = i_write;
-        answer->p_body = xmalloc(i_write);
-        memcpy(answer->p_body, &stream->p_buffer[i_pos], i_write);
-
-        answer->i_body_offset += i_write;
-
         return VLC_SUCCESS;
+wait:
+#ifdef HTTPD_EPOLL
+        /* httpd_StreamSend() will wake the worker of the client up */
+        stream->waiters |= 1u << (cl->worker - stream->url->host->workers);
+#endif
+        vlc_mutex_unlock(&stream->lock);
+        return VLC_EGENERIC;
     } else {
         answer->i_proto  = HTTPD_PROTO_HTTP;
         answer->i_version= 0;
@@ -757,7 +924,6 @@ httpd_stream_t *httpd_StreamNew(httpd_host_t *host,
         return NULL;
 
     stream->psz_mime = NULL;
-    stream->p_buffer = NULL;
 
     stream->url = httpd_UrlNew(host, psz_url, psz_user, psz_password);
     if (!stream->url)
@@ -773,11 +939,9 @@ httpd_stream_t *httpd_StreamNew(httpd_host_t *host,
 
     stream->i_header = 0;
     stream->p_header = NULL;
-    stream->i_buffer_size = 5000000;    /* 5 Mo per stream */
-
-    stream->p_buffer = malloc(stream->i_buffer_size);
-    if (stream->p_buffer == NULL)
-        goto error;
+    vlc_list_init(&stream->segments);
+    stream->i_retained = 0;
+    stream->i_window = 5000000;    /* 5 Mo per stream */
 
     /* We set to 1 to make life simpler
      * (this way i_body_offset can never be 0) */
@@ -785,9 +949,14 @@ httpd_stream_t *httpd_StreamNew(httpd_host_t *host,
     stream->i_buffer_last_pos = 1;
     stream->b_has_keyframes = false;
     stream->i_last_keyframe_seen_pos = 0;
+#ifdef HTTPD_EPOLL
+    stream->waiters = 0;
+#endif
     stream->i_http_headers = 0;
     stream->p_http_headers = NULL;
 
+    /* the stream state is protected by its own lock */
+    stream->url->b_concurrent = true;
     httpd_UrlCatch(stream->url, HTTPD_MSG_HEAD, httpd_StreamCallBack,
                     (httpd_callback_sys_t*)stream);
     httpd_UrlCatch(stream->url, HTTPD_MSG_GET, httpd_StreamCallBack,
@@ -824,63 +993,109 @@ int httpd_StreamHeader(httpd_stream_t *stream, uint8_t *p_data, int i_data)
     return VLC_SUCCESS;
 }
 
-static void httpd_AppendData(httpd_stream_t *stream, uint8_t *p_data, int i_data)
+int httpd_StreamSend(httpd_stream_t *stream, block_t *p_block)
 {
-    int i_pos = stream->i_buffer_pos % stream->i_buffer_size;
-    int i_count = i_data;
-    while (i_count > 0) {
-        int i_copy = __MIN(i_count, stream->i_buffer_size - i_pos);
+    if (!p_block)
+        return VLC_SUCCESS;
+    if (p_block->i_buffer == 0) {
+        block_Release(p_block);
+        return VLC_SUCCESS;
+    }
 
-        /* Ok, we can't go past the end of our buffer */
-        memcpy(&stream->p_buffer[i_pos], p_data, i_copy);
+    const size_t len = p_block->i_buffer;
+    const bool b_keyframe = (p_block->i_flags & BLOCK_FLAG_TYPE_I) != 0;
 
-        i_pos = (i_pos + i_copy) % stream->i_buffer_size;
-        i_count -= i_copy;
-        p_data  += i_copy;
-    }
+    vlc_mutex_lock(&stream->lock);
 
-    stream->i_buffer_pos += i_data;
-}
+    /* Small blocks, such as TS packets, are gathered into the last segment
+     * while no client sends it, so that they are sent in larger chunks. */
+    struct httpd_segment *seg =
+        vlc_list_last_entry_or_null(&stream->segments,
+                                    struct httpd_segment, node);
 
-int httpd_StreamSend(httpd_stream_t *stream, const block_t *p_block)
-{
-    if (!p_block || !p_block->p_buffer)
-        return VLC_SUCCESS;
+    if (seg != NULL && !seg->shared && seg->room >= len) {
+        block_t *block = seg->block;
 
-    vlc_mutex_lock(&stream->lock);
+        memcpy(block->p_buffer + block->i_buffer, p_block->p_buffer, len);
+        block->i_buffer += len;
+        seg->room -= len;
+        block_Release(p_block);
+    } else {
+        vlc_mutex_unlock(&stream->lock);
+        seg = httpd_SegmentNew(p_block);
+        if (unlikely(seg == NULL)) {
+            block_Release(p_block);
+            return VLC_ENOMEM;
+        }
+        vlc_mutex_lock(&stream->lock);
+
+        seg->pos = stream->i_buffer_pos;
+        vlc_list_append(&seg->node, &stream->segments);
+    }
 
     /* save this pointer (to be used by new connection) */
     stream->i_buffer_last_pos = stream->i_buffer_pos;
 
-    if (p_block->i_flags & BLOCK_FLAG_TYPE_I) {
+    if (b_keyframe) {
         stream->b_has_keyframes = true;
         stream->i_last_keyframe_seen_pos = stream->i_buffer_pos;
     }
 
-    httpd_AppendData(stream, p_block->p_buffer, p_block->i_buffer);
+    stream->i_buffer_pos += len;
+    stream->i_retained += len;
+
+    /* Drop the oldest segments out of the window. Clients still sending
+     * them keep their own references. */
+    while (stream->i_retained > stream->i_window) {
+        struct httpd_segment *old =
+            vlc_list_first_entry_or_null(&stream->segments,
+                                         struct httpd_segment, node);
+        if (old == seg)
+            break; /* always keep the last block */
+
+        vlc_list_remove(&old->node);
+        stream->i_retained -= old->block->i_buffer;
+        httpd_SegmentRelease(old);
+    }
 
+#ifdef HTTPD_EPOLL
+    unsigned waiters = stream->waiters;
+    stream->waiters = 0;
+#endif
     vlc_mutex_unlock(&stream->lock);
+
+#ifdef HTTPD_EPOLL
+    /* Wake up the workers with clients waiting for this data */
+    httpd_host_t *host = stream->url->host;
+
+    for (unsigned i = 0; waiters != 0; i++, waiters >>= 1)
+        if (waiters & 1)
+            eventfd_write(host->workers[i].wakefd, 1);
+#endif
     return VLC_SUCCESS;
 }
 
 void httpd_StreamDelete(httpd_stream_t *stream)
 {
+    struct httpd_segment *seg;
+
     httpd_UrlDelete(stream->url);
     for (size_t i = 0; i < stream->i_http_headers; i++) {
         free(stream->p_http_headers[i].name);
         free(stream->p_http_headers[i].value);
     }
+    vlc_list_foreach(seg, &stream->segments, node)
+        httpd_SegmentRelease(seg);
     free(stream->p_http_headers);
     free(stream->psz_mime);
     free(stream->p_header);
-    free(stream->p_buffer);
     free(stream);
 }
 
 /*****************************************************************************
  * Low level
  *****************************************************************************/
-static void* httpd_HostThread(void *);
+static void* httpd_WorkerThread(void *);
 static httpd_host_t *httpd_HostCreate(vlc_object_t *, const char *,
                                       const char *, vlc_tls_server_t *,
                                       unsigned);
@@ -927,6 +1142,88 @@ static struct httpd
     struct vlc_list hosts;
 } httpd = { VLC_STATIC_MUTEX, VLC_LIST_INITIALIZER(&httpd.hosts) };
 
+static unsigned httpd_WorkerCount(vlc_object_t *obj)
+{
+#ifdef HTTPD_EPOLL
+    int64_t count = var_InheritInteger(obj, "http-threads");
+
+    if (count <= 0)
+        count = vlc_GetCPUCount();
+    return VLC_CLIP(count, 1, HTTPD_MAX_WORKERS);
+#else
+    VLC_UNUSED(obj);
+    return 1;
+#endif
+}
+
+static int httpd_WorkerInit(httpd_host_t *host, struct httpd_worker *w)
+{
+    w->host = host;
+    vlc_mutex_init(&w->lock);
+    w->client_count = 0;
+    vlc_list_init(&w->clients);
+
+#ifdef HTTPD_EPOLL
+    vlc_list_init(&w->ready);
+    vlc_list_init(&w->waiting);
+    w->timeout_date = VLC_TICK_INVALID;
+
+    w->epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (w->epfd == -1)
+        return -1;
+
+    w->wakefd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (w->wakefd == -1) {
+        vlc_close(w->epfd);
+        return -1;
+    }
+
+    struct epoll_event wev = { .events = EPOLLIN, .data.ptr = w };
+    if (epoll_ctl(w->epfd, EPOLL_CTL_ADD, w->wakefd, &wev))
+        goto error;
+
+    /* Every worker waits for connections on every listening socket, but only
+     * one of them is woken up per connection. */
+    for (unsigned i = 0; i < host->nfd; i++) {
+        struct epoll_event ev = {
+            .events = EPOLLIN | EPOLLEXCLUSIVE,
+            .data.ptr = NULL,
+        };
+
+        if (epoll_ctl(w->epfd, EPOLL_CTL_ADD, host->fds[i], &ev))
+            goto error;
+    }
+#endif
+
+    if (vlc_clone(&w->thread, httpd_WorkerThread, w,
+                  VLC_THREAD_PRIORITY_LOW))
+        goto error;
+    return 0;
+
+error:
+#ifdef HTTPD_EPOLL
+    vlc_close(w->wakefd);
+    vlc_close(w->epfd);
+#endif
+    return -1;
+}
+
+static void httpd_WorkerClean(struct httpd_worker *w)
+{
+    httpd_client_t *client;
+
+    vlc_join(w->thread, NULL);
+
+    vlc_list_foreach(client, &w->clients, node) {
+        msg_Warn(w->host, "client still connected");
+        httpd_ClientDestroy(client);
+    }
+#ifdef HTTPD_EPOLL
+    vlc_close(w->wakefd);
+    vlc_close(w->epfd);
+#endif
+}
+
 static httpd_host_t *httpd_HostCreate(vlc_object_t *p_this,
                                        const char *hostvar,
                                        const char *portvar,
@@ -962,6 +1259,8 @@ static httpd_host_t *httpd_HostCreate(vlc_object_t *p_this,
 
     vlc_mutex_init(&host->lock);
     atomic_init(&host->ref, 1);
+    host->workers = NULL;
+    host->worker_count = 0;
 
     char *hostname = var_InheritString(p_this, hostvar);
 
@@ -976,17 +1275,25 @@ static httpd_host_t *httpd_HostCreate(vlc_object_t *p_this,
 
     host->port     = port;
     vlc_list_init(&host->urls);
-    host->client_count = 0;
-    vlc_list_init(&host->clients);
     host->timeout_sec = timeout_sec;
     host->p_tls    = p_tls;
 
-    /* create the thread */
-    if (vlc_clone(&host->thread, httpd_HostThread, host,
-                   VLC_THREAD_PRIORITY_LOW)) {
+    /* create the threads */
+    unsigned count = httpd_WorkerCount(p_this);
+
+    host->workers = vlc_alloc(count, sizeof (*host->workers));
+    if (unlikely(host->workers == NULL))
+        goto error;
+
+    while (host->worker_count < count
+        && httpd_WorkerInit(host, &host->workers[host->worker_count]) == 0)
+        host->worker_count++;
+
+    if (host->worker_count == 0) {
         msg_Err(p_this, "cannot spawn http host thread");
         goto error;
     }
+    msg_Dbg(p_this, "HTTP host served by %u thread(s)", host->worker_count);
 
     /* now add it to httpd */
     vlc_list_append(&host->node, &httpd.hosts);
@@ -998,6 +1305,7 @@ error:
     vlc_mutex_unlock(&httpd.mutex);
 
     if (host) {
+        free(host->workers);
         net_ListenClose(host->fds);
         vlc_object_delete(host);
     }
@@ -1009,8 +1317,6 @@ error:
 /* delete a host */
 void httpd_HostDelete(httpd_host_t *host)
 {
-    httpd_client_t *client;
-
     vlc_mutex_lock(&httpd.mutex);
 
     if (atomic_fetch_sub_explicit(&host->ref, 1, memory_order_relaxed) > 1) {
@@ -1021,16 +1327,14 @@ void httpd_HostDelete(httpd_host_t *host)
     }
 
     vlc_list_remove(&host->node);
-    vlc_cancel(host->thread);
-    vlc_join(host->thread, NULL);
+    for (unsigned i = 0; i < host->worker_count; i++)
+        vlc_cancel(host->workers[i].thread);
+    for (unsigned i = 0; i < host->worker_count; i++)
+        httpd_WorkerClean(&host->workers[i]);
+    free(host->workers);
 
     msg_Dbg(host, "HTTP host removed");
 
-    vlc_list_foreach(client, &host->clients, node) {
-        msg_Warn(host, "client still connected");
-        httpd_ClientDestroy(client);
-    }
-
     assert(vlc_list_is_empty(&host->urls));
     vlc_tls_ServerDelete(host->p_tls);
     net_ListenClose(host->fds);
@@ -1064,6 +1368,7 @@ httpd_url_t *httpd_UrlNew(httpd_host_t *host, const char *psz_url,
     url->psz_password = NULL;
 
     url->host = host;
+    url->b_concurrent = false;
 
     vlc_mutex_init(&url->lock);
 
@@ -1118,22 +1423,55 @@ void httpd_UrlDelete(httpd_url_t *url)
 
     vlc_mutex_lock(&host->lock);
     vlc_list_remove(&url->node);
+    vlc_mutex_unlock(&host->lock);
+
+    /* The url cannot be found anymore, close the clients it still serves */
+    for (unsigned i = 0; i < host->worker_count; i++) {
+        struct httpd_worker *w = &host->workers[i];
+
+        vlc_mutex_lock(&w->lock);
+        vlc_list_foreach(client, &w->clients, node) {
+            if (client->url != url)
+                continue;
+
+            msg_Warn(host, "force closing connections");
+#ifdef HTTPD_EPOLL
+            /* The worker may be about to handle events of the client:
+             * hang up the connection and let the worker destroy it. */
+            client->url = NULL;
+            client->i_state = HTTPD_CLIENT_DEAD;
+            shutdown(vlc_tls_GetFD(client->sock), SHUT_RDWR);
+#else
+            w->client_count--;
+            httpd_ClientDestroy(client);
+#endif
+        }
+        vlc_mutex_unlock(&w->lock);
+    }
 
     free(url->psz_url);
     free(url->psz_user);
     free(url->psz_password);
+    free(url);
+}
 
-    vlc_list_foreach(client, &host->clients, node) {
-        if (client->url != url)
-            continue;
+/* Calls back a url. Unless the url handles concurrent clients, the callbacks
+ * are serialized across the workers of the host. */
+static int httpd_UrlCallBack(httpd_url_t *url, httpd_client_t *cl, int i_msg,
+                             httpd_message_t *answer,
+                             const httpd_message_t *query)
+{
+    httpd_host_t *host = url->host;
+    int ret;
 
-        /* TODO complete it */
-        msg_Warn(host, "force closing connections");
-        host->client_count--;
-        httpd_ClientDestroy(client);
-    }
-    free(url);
+    if (url->b_concurrent)
+        return url->catch[i_msg].cb(url->catch[i_msg].p_sys, cl,
+                                    answer, query);
+
+    vlc_mutex_lock(&host->lock);
+    ret = url->catch[i_msg].cb(url->catch[i_msg].p_sys, cl, answer, query);
     vlc_mutex_unlock(&host->lock);
+    return ret;
 }
 
 static void httpd_MsgInit(httpd_message_t *msg)
@@ -1222,6 +1560,14 @@ static void httpd_ClientDestroy(httpd_client_t *cl)
     httpd_MsgClean(&cl->answer);
     httpd_MsgClean(&cl->query);
 
+    for (unsigned i = 0; i < cl->seg_count; i++)
+        httpd_SegmentRelease(cl->seg[i]);
+#ifdef HTTPD_ZEROCOPY
+    /* The kernel holds its own references to the pinned pages */
+    for (unsigned i = 0; i < cl->zc_count; i++)
+        httpd_SegmentRelease(cl->zc_pins[i].seg);
+    free(cl->zc_pins);
+#endif
     free(cl->p_buffer);
     free(cl);
 }
@@ -1240,6 +1586,18 @@ static httpd_client_t *httpd_ClientNew(vlc_tls_t *sock)
     cl->p_buffer = xmalloc(cl->i_buffer_size);
     cl->i_keyframe_wait_to_pass = -1;
     cl->b_stream_mode = false;
+    cl->seg_count = 0;
+    cl->seg_offset = 0;
+#ifdef HTTPD_ZEROCOPY
+    cl->zc_pins = NULL;
+    cl->zc_count = 0;
+    cl->zc_next_id = 0;
+    cl->zc_copied = false;
+#endif
+#ifdef HTTPD_EPOLL
+    cl->queued = false;
+    cl->epoll_events = 0;
+#endif
 
     httpd_MsgInit(&cl->query);
     httpd_MsgInit(&cl->answer);
@@ -1262,6 +1620,144 @@ ssize_t httpd_NetSend (httpd_client_t *cl, const uint8_t *p, size_t i_len)
     return sock->ops->writev(sock, &iov, 1);
 }
 
+#ifdef HTTPD_ZEROCOPY
+/* Enables zero-copy sending on a plain TCP client socket */
+static void httpd_ZeroCopyInit(httpd_client_t *cl, int fd)
+{
+    if (setsockopt(fd, SOL_SOCKET, SO_ZEROCOPY, &(int){ 1 }, sizeof (int)))
+        return;
+
+    cl->zc_pins = malloc(HTTPD_ZEROCOPY_PINS * sizeof (*cl->zc_pins));
+}
+
+/* Unpins the segments whose zero-copy send completed */
+static void httpd_ZeroCopyReap(httpd_client_t *cl)
+{
+    int fd = vlc_tls_GetFD(cl->sock);
+    int saved_errno = errno;
+
+    while (cl->zc_count > 0) {
+        union {
+            char buf[CMSG_SPACE(sizeof (struct sock_extended_err)
+                                + sizeof (struct sockaddr_in6))];
+            struct cmsghdr align;
+        } control;
+        struct msghdr msg = {
+            .msg_control = &control,
+            .msg_controllen = sizeof (control),
+        };
+
+        if (recvmsg(fd, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) < 0)
+            break;
+
+        for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg != NULL;
+             cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+            if (!(cmsg->cmsg_level == SOL_IP && cmsg->cmsg_type == IP_RECVERR)
+             && !(cmsg->cmsg_level == SOL_IPV6
+               && cmsg->cmsg_type == IPV6_RECVERR))
+                continue;
+
+            const struct sock_extended_err *serr = (void *)CMSG_DATA(cmsg);
+            if (serr->ee_origin != SO_EE_ORIGIN_ZEROCOPY || serr->ee_errno != 0)
+                continue;
+
+            /* The kernel copied the data anyway (e.g. over loopback): stop
+             * paying for the page pinning and the notifications. */
+            if (serr->ee_code & SO_EE_CODE_ZEROCOPY_COPIED)
+                cl->zc_copied = true;
+
+            /* Completed sends, in the range [ee_info, ee_data] */
+            const uint32_t lo = serr->ee_info, span = serr->ee_data - lo;
+            for (unsigned i = 0; i < cl->zc_count;)
+                if (cl->zc_pins[i].id - lo <= span) {
+                    httpd_SegmentRelease(cl->zc_pins[i].seg);
+                    cl->zc_pins[i] = cl->zc_pins[--cl->zc_count];
+                } else
+                    i++;
+        }
+    }
+    errno = saved_errno;
+}
+
+static ssize_t httpd_ZeroCopySend(httpd_client_t *cl, const struct iovec *iov,
+                                  unsigned count)
+{
+    struct msghdr msg = {
+        .msg_iov = (struct iovec *)iov,
+        .msg_iovlen = count,
+    };
+
+    ssize_t val = vlc_sendmsg(vlc_tls_GetFD(cl->sock), &msg, MSG_ZEROCOPY);
+    if (val < 0)
+        return val;
+
+    /* Pin the segments, at least partially, sent by this call */
+    const uint32_t id = cl->zc_next_id++;
+    size_t sent = 0;
+    for (unsigned i = 0; i < count && sent < (size_t)val; i++) {
+        cl->zc_pins[cl->zc_count].seg = httpd_SegmentHold(cl->seg[i]);
+        cl->zc_pins[cl->zc_count].id = id;
+        cl->zc_count++;
+        sent += iov[i].iov_len;
+    }
+    return val;
+}
+#endif
+
+/* Sends the referenced stream segments */
+static ssize_t httpd_ClientSendSegments(httpd_client_t *cl)
+{
+    struct iovec iov[HTTPD_CL_SEGMENTS];
+    size_t offset = cl->seg_offset, total = 0;
+    ssize_t val = -1;
+
+    for (unsigned i = 0; i < cl->seg_count; i++) {
+        const block_t *block = cl->seg[i]->block;
+
+        iov[i].iov_base = block->p_buffer + offset;
+        iov[i].iov_len = block->i_buffer - offset;
+        total += iov[i].iov_len;
+        offset = 0;
+    }
+
+#ifdef HTTPD_ZEROCOPY
+    if (cl->zc_pins != NULL) {
+        httpd_ZeroCopyReap(cl);
+
+        if (!cl->zc_copied && total >= HTTPD_ZEROCOPY_MIN
+         && cl->zc_count + cl->seg_count <= HTTPD_ZEROCOPY_PINS) {
+            val = httpd_ZeroCopySend(cl, iov, cl->seg_count);
+            /* Out of pinnable memory: fall back to copying */
+            if (val < 0 && errno != ENOBUFS)
+                return val;
+        }
+    }
+#else
+    (void) total;
+#endif
+    if (val < 0) {
+        vlc_tls_t *sock = cl->sock;
+
+        val = sock->ops->writev(sock, iov, cl->seg_count);
+        if (val < 0)
+            return val;
+    }
+
+    /* Release the segments sent completely */
+    size_t sent = cl->seg_offset + val;
+    unsigned done = 0;
+
+    while (done < cl->seg_count && sent >= cl->seg[done]->block->i_buffer) {
+        sent -= cl->seg[done]->block->i_buffer;
+        httpd_SegmentRelease(cl->seg[done]);
+        done++;
+    }
+    cl->seg_count -= done;
+    memmove(cl->seg, cl->seg + done, cl->seg_count * sizeof (cl->seg[0]));
+    cl->seg_offset = sent;
+    return val;
+}
+
 
 static const struct
 {
@@ -1605,8 +2101,14 @@ static int httpd_ClientSend(httpd_client_t *cl)
         cl->i_buffer_size = (uint8_t*)p - cl->p_buffer;
     }
 
-    i_len = httpd_NetSend(cl, &cl->p_buffer[cl->i_buffer],
-                           cl->i_buffer_size - cl->i_buffer);
+    /* Stream segments are sent once the buffer is empty */
+    bool b_segments = cl->i_buffer >= cl->i_buffer_size && cl->seg_count > 0;
+
+    if (b_segments)
+        i_len = httpd_ClientSendSegments(cl);
+    else
+        i_len = httpd_NetSend(cl, &cl->p_buffer[cl->i_buffer],
+                               cl->i_buffer_size - cl->i_buffer);
 
     if (i_len < 0) {
 #if defined(_WIN32)
@@ -1621,7 +2123,11 @@ static int httpd_ClientSend(httpd_client_t *cl)
         return 0;
     }
 
-    cl->i_buffer += i_len;
+    if (b_segments) {
+        if (cl->seg_count > 0)
+            return 0; /* more segments to send */
+    } else
+        cl->i_buffer += i_len;
 
     if (cl->i_buffer >= cl->i_buffer_size) {
         if (cl->answer.i_body == 0  && cl->answer.i_body_offset > 0) {
@@ -1632,11 +2138,14 @@ static int httpd_ClientSend(httpd_client_t *cl)
             httpd_MsgClean(&cl->answer);
             cl->answer.i_body_offset = i_offset;
 
-            cl->url->catch[i_msg].cb(cl->url->catch[i_msg].p_sys, cl,
-                                     &cl->answer, &cl->query);
+            httpd_UrlCallBack(cl->url, cl, i_msg, &cl->answer, &cl->query);
+            if (cl->i_state == HTTPD_CLIENT_DEAD)
+                return 0;
         }
 
-        if (cl->answer.i_body > 0) {
+        if (cl->seg_count > 0) {
+            /* the stream segments are sent by the next call */
+        } else if (cl->answer.i_body > 0) {
             /* send the body data */
             free(cl->p_buffer);
             cl->p_buffer = cl->answer.p_body;
@@ -1702,277 +2211,544 @@ auth_failed:
     return false;
 }
 
-static void httpdLoop(httpd_host_t *host)
+/**
+ * Serves a client: performs its pending I/O, then advances its state.
+ *
+ * On return, pufd is set to the socket and the events to wait for before
+ * serving the client again. No events means that the client waits for more
+ * stream data.
+ *
+ * \return -1 if the client is dead, 0 if it made some progress, 1 otherwise
+ */
+static int httpd_ClientServe(httpd_host_t *host, httpd_client_t *cl,
+                             vlc_tick_t now, struct pollfd *pufd)
 {
-    struct pollfd ufd[host->nfd + host->client_count];
-    unsigned nfd;
-    for (nfd = 0; nfd < host->nfd; nfd++) {
-        ufd[nfd].fd = host->fds[nfd];
-        ufd[nfd].events = POLLIN;
-        ufd[nfd].revents = 0;
+    int val = -1;
+
+    switch (cl->i_state) {
+        case HTTPD_CLIENT_RECEIVING:
+            val = httpd_ClientRecv(cl);
+            break;
+        case HTTPD_CLIENT_SENDING:
+            val = httpd_ClientSend(cl);
+            break;
+        case HTTPD_CLIENT_TLS_HS_IN:
+        case HTTPD_CLIENT_TLS_HS_OUT:
+            httpd_ClientTlsHandshake(host, cl);
+            break;
     }
 
-    vlc_mutex_lock(&host->lock);
-    /* add all socket that should be read/write and close dead connection */
-    vlc_tick_t now = vlc_tick_now();
-    int delay = -1;
-    httpd_client_t *cl;
+    if (cl->i_state == HTTPD_CLIENT_DEAD
+     || (host->timeout_sec > 0 && cl->i_timeout_date < now))
+        return -1;
 
-    int canc = vlc_savecancel();
-    vlc_list_foreach(cl, &host->clients, node) {
-        int val = -1;
+    if (val == 0)
+        cl->i_timeout_date = now + VLC_TICK_FROM_SEC(host->timeout_sec);
 
-        switch (cl->i_state) {
-            case HTTPD_CLIENT_RECEIVING:
-                val = httpd_ClientRecv(cl);
-                break;
-            case HTTPD_CLIENT_SENDING:
-                val = httpd_ClientSend(cl);
-                break;
-            case HTTPD_CLIENT_TLS_HS_IN:
-            case HTTPD_CLIENT_TLS_HS_OUT:
-                httpd_ClientTlsHandshake(host, cl);
-                break;
-        }
+    pufd->events = pufd->revents = 0;
 
-        if (cl->i_state == HTTPD_CLIENT_DEAD
-         || (host->timeout_sec > 0 && cl->i_timeout_date < now)) {
-            host->client_count--;
-            httpd_ClientDestroy(cl);
-            continue;
-        }
+    switch (cl->i_state) {
+        case HTTPD_CLIENT_RECEIVING:
+        case HTTPD_CLIENT_TLS_HS_IN:
+            pufd->events = POLLIN;
+            break;
 
-        if (val == 0) {
-            cl->i_timeout_date = now + VLC_TICK_FROM_SEC(host->timeout_sec);
-            delay = 0;
-        }
+        case HTTPD_CLIENT_SENDING:
+        case HTTPD_CLIENT_TLS_HS_OUT:
+            pufd->events = POLLOUT;
+            break;
 
-        struct pollfd *pufd = ufd + nfd;
-        assert (pufd < ufd + ARRAY_SIZE (ufd));
+        case HTTPD_CLIENT_RECEIVE_DONE: {
+            httpd_message_t *answer = &cl->answer;
+            httpd_message_t *query  = &cl->query;
+
+            httpd_MsgInit(answer);
+
+            /* Handle what we received */
+            switch (query->i_type) {
+                case HTTPD_MSG_ANSWER:
+                    cl->url     = NULL;
+                    cl->i_state = HTTPD_CLIENT_DEAD;
+                    break;
+
+                case HTTPD_MSG_OPTIONS:
+                    answer->i_type   = HTTPD_MSG_ANSWER;
+                    answer->i_proto  = query->i_proto;
+                    answer->i_status = 200;
+                    answer->i_body = 0;
+                    answer->p_body = NULL;
+
+                    httpd_MsgAdd(answer, "Server", "VLC/%s", VERSION);
+                    httpd_MsgAdd(answer, "Content-Length", "0");
+
+                    switch(query->i_proto) {
+                    case HTTPD_PROTO_HTTP:
+                        answer->i_version = 1;
+                        httpd_MsgAdd(answer, "Allow", "GET,HEAD,POST,OPTIONS");
+                        break;
 
-        pufd->events = pufd->revents = 0;
+                    case HTTPD_PROTO_RTSP:
+                        answer->i_version = 0;
 
-        switch (cl->i_state) {
-            case HTTPD_CLIENT_RECEIVING:
-            case HTTPD_CLIENT_TLS_HS_IN:
-                pufd->events = POLLIN;
-                break;
+                        const char *p = httpd_MsgGet(query, "Cseq");
+                        if (p)
+                            httpd_MsgAdd(answer, "Cseq", "%s", p);
+                        p = httpd_MsgGet(query, "Timestamp");
+                        if (p)
+                            httpd_MsgAdd(answer, "Timestamp", "%s", p);
 
-            case HTTPD_CLIENT_SENDING:
-            case HTTPD_CLIENT_TLS_HS_OUT:
-                pufd->events = POLLOUT;
-                break;
+                        p = httpd_MsgGet(query, "Require");
+                        if (p) {
+                            answer->i_status = 551;
+                            httpd_MsgAdd(query, "Unsupported", "%s", p);
+                        }
 
-            case HTTPD_CLIENT_RECEIVE_DONE: {
-                httpd_message_t *answer = &cl->answer;
-                httpd_message_t *query  = &cl->query;
+                        httpd_MsgAdd(answer, "Public", "DESCRIBE,SETUP,"
+                                "TEARDOWN,PLAY,PAUSE,GET_PARAMETER");
+                        break;
+                    }
 
-                httpd_MsgInit(answer);
+                    if (httpd_MsgGet(&cl->query, "Connection") != NULL)
+                        httpd_MsgAdd(answer, "Connection", "close");
 
-                /* Handle what we received */
-                switch (query->i_type) {
-                    case HTTPD_MSG_ANSWER:
-                        cl->url     = NULL;
-                        cl->i_state = HTTPD_CLIENT_DEAD;
-                        break;
+                    cl->i_buffer = -1;  /* Force the creation of the answer in
+                                         * httpd_ClientSend */
+                    cl->i_state = HTTPD_CLIENT_SENDING;
+                    break;
 
-                    case HTTPD_MSG_OPTIONS:
+                case HTTPD_MSG_NONE:
+                    if (query->i_proto == HTTPD_PROTO_NONE) {
+                        cl->url = NULL;
+                        cl->i_state = HTTPD_CLIENT_DEAD;
+                    } else {
+                        /* unimplemented */
+                        answer->i_proto  = query->i_proto ;
                         answer->i_type   = HTTPD_MSG_ANSWER;
-                        answer->i_proto  = query->i_proto;
-                        answer->i_status = 200;
-                        answer->i_body = 0;
-                        answer->p_body = NULL;
+                        answer->i_version= 0;
+                        answer->i_status = 501;
 
-                        httpd_MsgAdd(answer, "Server", "VLC/%s", VERSION);
-                        httpd_MsgAdd(answer, "Content-Length", "0");
+                        char *p;
+                        answer->i_body = httpd_HtmlError (&p, 501, NULL);
+                        answer->p_body = (uint8_t *)p;
+                        httpd_MsgAdd(answer, "Content-Length", "%d", answer->i_body);
+                        httpd_MsgAdd(answer, "Connection", "close");
 
-                        switch(query->i_proto) {
-                        case HTTPD_PROTO_HTTP:
-                            answer->i_version = 1;
-                            httpd_MsgAdd(answer, "Allow", "GET,HEAD,POST,OPTIONS");
-                            break;
-
-                        case HTTPD_PROTO_RTSP:
-                            answer->i_version = 0;
+                        cl->i_buffer = -1;  /* Force the creation of the answer in httpd_ClientSend */
+                        cl->i_state = HTTPD_CLIENT_SENDING;
+                    }
+                    break;
 
-                            const char *p = httpd_MsgGet(query, "Cseq");
-                            if (p)
-                                httpd_MsgAdd(answer, "Cseq", "%s", p);
-                            p = httpd_MsgGet(query, "Timestamp");
-                            if (p)
-                                httpd_MsgAdd(answer, "Timestamp", "%s", p);
+                default: {
+                    httpd_url_t *url;
+                    int i_msg = query->i_type;
+                    bool b_auth_failed = false;
 
-                            p = httpd_MsgGet(query, "Require");
-                            if (p) {
-                                answer->i_status = 551;
-                                httpd_MsgAdd(query, "Unsupported", "%s", p);
-                            }
+                    /* Search the url and trigger callbacks */
+                    vlc_mutex_lock(&host->lock);
+                    vlc_list_foreach(url, &host->urls, node) {
+                        if (strcmp(url->psz_url, query->psz_url))
+                            continue;
+                        if (!url->catch[i_msg].cb)
+                            continue;
 
-                            httpd_MsgAdd(answer, "Public", "DESCRIBE,SETUP,"
-                                    "TEARDOWN,PLAY,PAUSE,GET_PARAMETER");
-                            break;
+                        if (answer) {
+                            b_auth_failed = !httpdAuthOk(url->psz_user,
+                               url->psz_password,
+                               httpd_MsgGet(query, "Authorization")); /* BASIC id */
+                            if (b_auth_failed)
+                               break;
                         }
 
-                        if (httpd_MsgGet(&cl->query, "Connection") != NULL)
-                            httpd_MsgAdd(answer, "Connection", "close");
+                        if (url->catch[i_msg].cb(url->catch[i_msg].p_sys, cl, answer, query))
+                            continue;
 
-                        cl->i_buffer = -1;  /* Force the creation of the answer in
-                                             * httpd_ClientSend */
-                        cl->i_state = HTTPD_CLIENT_SENDING;
-                        break;
+                        if (answer->i_proto == HTTPD_PROTO_NONE)
+                            cl->i_buffer = cl->i_buffer_size; /* Raw answer from a CGI */
+                        else
+                            cl->i_buffer = -1;
 
-                    case HTTPD_MSG_NONE:
-                        if (query->i_proto == HTTPD_PROTO_NONE) {
-                            cl->url = NULL;
-                            cl->i_state = HTTPD_CLIENT_DEAD;
-                        } else {
-                            /* unimplemented */
-                            answer->i_proto  = query->i_proto ;
-                            answer->i_type   = HTTPD_MSG_ANSWER;
-                            answer->i_version= 0;
-                            answer->i_status = 501;
-
-                            char *p;
-                            answer->i_body = httpd_HtmlError (&p, 501, NULL);
-                            answer->p_body = (uint8_t *)p;
-                            httpd_MsgAdd(answer, "Content-Length", "%d", answer->i_body);
+                        /* only one url can answer */
+                        answer = NULL;
+                        if (!cl->url)
+                            cl->url = url;
+                    }
+                    vlc_mutex_unlock(&host->lock);
+
+                    if (answer) {
+                        answer->i_proto  = query->i_proto;
+                        answer->i_type   = HTTPD_MSG_ANSWER;
+                        answer->i_version= 0;
+
+                       if (b_auth_failed) {
+                            httpd_MsgAdd(answer, "WWW-Authenticate",
+                                    "Basic realm=\"VLC stream\"");
+                            answer->i_status = 401;
+                        } else
+                            answer->i_status = 404; /* no url registered */
+
+                        char *p;
+                        answer->i_body = httpd_HtmlError (&p, answer->i_status,
+                                query->psz_url);
+                        answer->p_body = (uint8_t *)p;
+
+                        cl->i_buffer = -1;  /* Force the creation of the answer in httpd_ClientSend */
+                        httpd_MsgAdd(answer, "Content-Length", "%d", answer->i_body);
+                        httpd_MsgAdd(answer, "Content-Type", "%s", "text/html");
+                        if (httpd_MsgGet(&cl->query, "Connection") != NULL)
                             httpd_MsgAdd(answer, "Connection", "close");
+                    }
 
-                            cl->i_buffer = -1;  /* Force the creation of the answer in httpd_ClientSend */
-                            cl->i_state = HTTPD_CLIENT_SENDING;
-                        }
-                        break;
+                    cl->i_state = HTTPD_CLIENT_SENDING;
+                }
+            }
+            break;
+        }
 
-                    default: {
-                        httpd_url_t *url;
-                        int i_msg = query->i_type;
-                        bool b_auth_failed = false;
-
-                        /* Search the url and trigger callbacks */
-                        vlc_list_foreach(url, &host->urls, node) {
-                            if (strcmp(url->psz_url, query->psz_url))
-                                continue;
-                            if (!url->catch[i_msg].cb)
-                                continue;
-
-                            if (answer) {
-                                b_auth_failed = !httpdAuthOk(url->psz_user,
-                                   url->psz_password,
-                                   httpd_MsgGet(query, "Authorization")); /* BASIC id */
-                                if (b_auth_failed)
-                                   break;
-                            }
-
-                            if (url->catch[i_msg].cb(url->catch[i_msg].p_sys, cl, answer, query))
-                                continue;
-
-                            if (answer->i_proto == HTTPD_PROTO_NONE)
-                                cl->i_buffer = cl->i_buffer_size; /* Raw answer from a CGI */
-                            else
-                                cl->i_buffer = -1;
-
-                            /* only one url can answer */
-                            answer = NULL;
-                            if (!cl->url)
-                                cl->url = url;
-                        }
+        case HTTPD_CLIENT_SEND_DONE:
+            if (!cl->b_stream_mode || cl->answer.i_body_offset == 0) {
+                bool do_close = false;
 
-                        if (answer) {
-                            answer->i_proto  = query->i_proto;
-                            answer->i_type   = HTTPD_MSG_ANSWER;
-                            answer->i_version= 0;
-
-                           if (b_auth_failed) {
-                                httpd_MsgAdd(answer, "WWW-Authenticate",
-                                        "Basic realm=\"VLC stream\"");
-                                answer->i_status = 401;
-                            } else
-                                answer->i_status = 404; /* no url registered */
-
-                            char *p;
-                            answer->i_body = httpd_HtmlError (&p, answer->i_status,
-                                    query->psz_url);
-                            answer->p_body = (uint8_t *)p;
-
-                            cl->i_buffer = -1;  /* Force the creation of the answer in httpd_ClientSend */
-                            httpd_MsgAdd(answer, "Content-Length", "%d", answer->i_body);
-                            httpd_MsgAdd(answer, "Content-Type", "%s", "text/html");
-                            if (httpd_MsgGet(&cl->query, "Connection") != NULL)
-                                httpd_MsgAdd(answer, "Connection", "close");
-                        }
+                cl->url = NULL;
 
-                        cl->i_state = HTTPD_CLIENT_SENDING;
-                    }
+                if (cl->query.i_proto != HTTPD_PROTO_HTTP
+                 || cl->query.i_version > 0)
+                {
+                    const char *psz_connection = httpd_MsgGet(&cl->answer,
+                                                             "Connection");
+                    if (psz_connection != NULL)
+                        do_close = !strcasecmp(psz_connection, "close");
                 }
-                break;
+                else
+                    do_close = true;
+
+                if (!do_close) {
+                    httpd_MsgClean(&cl->query);
+                    httpd_MsgInit(&cl->query);
+
+                    cl->i_buffer = 0;
+                    cl->i_buffer_size = 1000;
+                    free(cl->p_buffer);
+                    // Allocate an extra byte for the null terminating byte
+                    cl->p_buffer = xmalloc(cl->i_buffer_size + 1);
+                    cl->i_state = HTTPD_CLIENT_RECEIVING;
+                } else
+                    cl->i_state = HTTPD_CLIENT_DEAD;
+                httpd_MsgClean(&cl->answer);
+            } else {
+                int64_t i_offset = cl->answer.i_body_offset;
+                httpd_MsgClean(&cl->answer);
+
+                cl->answer.i_body_offset = i_offset;
+                free(cl->p_buffer);
+                cl->p_buffer = NULL;
+                cl->i_buffer = 0;
+                cl->i_buffer_size = 0;
+
+                cl->i_state = HTTPD_CLIENT_WAITING;
             }
+            break;
 
-            case HTTPD_CLIENT_SEND_DONE:
-                if (!cl->b_stream_mode || cl->answer.i_body_offset == 0) {
-                    bool do_close = false;
+        case HTTPD_CLIENT_WAITING: {
+            int64_t i_offset = cl->answer.i_body_offset;
+            int i_msg = cl->query.i_type;
 
-                    cl->url = NULL;
+            httpd_MsgInit(&cl->answer);
+            cl->answer.i_body_offset = i_offset;
 
-                    if (cl->query.i_proto != HTTPD_PROTO_HTTP
-                     || cl->query.i_version > 0)
-                    {
-                        const char *psz_connection = httpd_MsgGet(&cl->answer,
-                                                                 "Connection");
-                        if (psz_connection != NULL)
-                            do_close = !strcasecmp(psz_connection, "close");
-                    }
-                    else
-                        do_close = true;
-
-                    if (!do_close) {
-                        httpd_MsgClean(&cl->query);
-                        httpd_MsgInit(&cl->query);
-
-                        cl->i_buffer = 0;
-                        cl->i_buffer_size = 1000;
-                        free(cl->p_buffer);
-                        // Allocate an extra byte for the null terminating byte
-                        cl->p_buffer = xmalloc(cl->i_buffer_size + 1);
-                        cl->i_state = HTTPD_CLIENT_RECEIVING;
-                    } else
-                        cl->i_state = HTTPD_CLIENT_DEAD;
-                    httpd_MsgClean(&cl->answer);
-                } else {
-                    int64_t i_offset = cl->answer.i_body_offset;
-                    httpd_MsgClean(&cl->answer);
+            httpd_UrlCallBack(cl->url, cl, i_msg, &cl->answer, &cl->query);
+            if (cl->answer.i_type != HTTPD_MSG_NONE) {
+                /* we have new data, so re-enter send mode */
+                cl->i_buffer      = 0;
+                cl->p_buffer      = cl->answer.p_body;
+                cl->i_buffer_size = cl->answer.i_body;
+                cl->answer.p_body = NULL;
+                cl->answer.i_body = 0;
+                cl->i_state = HTTPD_CLIENT_SENDING;
+            }
+        }
+    }
 
-                    cl->answer.i_body_offset = i_offset;
-                    free(cl->p_buffer);
-                    cl->p_buffer = NULL;
-                    cl->i_buffer = 0;
-                    cl->i_buffer_size = 0;
+    pufd->fd = vlc_tls_GetPollFD(cl->sock, &pufd->events);
+    return val == 0 ? 0 : 1;
+}
 
-                    cl->i_state = HTTPD_CLIENT_WAITING;
-                }
+/* Creates a client for an accepted connection */
+static httpd_client_t *httpd_ClientAccept(httpd_host_t *host, int fd,
+                                          vlc_tick_t now)
+{
+    setsockopt (fd, SOL_SOCKET, SO_REUSEADDR,
+            &(int){ 1 }, sizeof(int));
+
+    vlc_tls_t *sk = vlc_tls_SocketOpen(fd);
+    if (unlikely(sk == NULL))
+    {
+        vlc_close(fd);
+        return NULL;
+    }
+
+    if (host->p_tls != NULL)
+    {
+        const char *alpn[] = { "http/1.1", NULL };
+        vlc_tls_t *tls;
+
+        tls = vlc_tls_ServerSessionCreate(host->p_tls, sk, alpn);
+        if (tls == NULL)
+        {
+            vlc_tls_SessionDelete(sk);
+            return NULL;
+        }
+        sk = tls;
+    }
+
+    httpd_client_t *cl = httpd_ClientNew(sk);
+
+    if (unlikely(cl == NULL))
+    {
+        vlc_tls_Close(sk);
+        return NULL;
+    }
+
+    if (host->p_tls != NULL)
+        cl->i_state = HTTPD_CLIENT_TLS_HS_OUT;
+#ifdef HTTPD_ZEROCOPY
+    else
+        httpd_ZeroCopyInit(cl, fd);
+#endif
+
+    cl->i_timeout_date = now + VLC_TICK_FROM_SEC(host->timeout_sec);
+    return cl;
+}
+
+#ifdef HTTPD_EPOLL
+static void httpd_WorkerRemove(struct httpd_worker *w, httpd_client_t *cl)
+{
+    if (cl->queued)
+        vlc_list_remove(&cl->queue_node);
+    epoll_ctl(w->epfd, EPOLL_CTL_DEL, vlc_tls_GetFD(cl->sock), NULL);
+    w->client_count--;
+    httpd_ClientDestroy(cl);
+}
+
+static void httpd_WorkerQueue(httpd_client_t *cl, struct vlc_list *list)
+{
+    if (cl->queued)
+        vlc_list_remove(&cl->queue_node);
+    vlc_list_append(&cl->queue_node, list);
+    cl->queued = true;
+}
+
+/* Handles an error condition reported on a client socket */
+static void httpd_ClientError(httpd_client_t *cl)
+{
+    int fd = vlc_tls_GetFD(cl->sock);
+    int err = 0;
+
+#ifdef HTTPD_ZEROCOPY
+    /* zero-copy completions are reported through the error queue */
+    httpd_ZeroCopyReap(cl);
+#endif
+    if (getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &(socklen_t){ sizeof (err) })
+     || err != 0)
+        cl->i_state = HTTPD_CLIENT_DEAD;
+}
+
+static void httpd_WorkerAccept(struct httpd_worker *w, vlc_tick_t now)
+{
+    httpd_host_t *host = w->host;
+
+    for (unsigned i = 0; i < host->nfd; i++)
+        /* Leave some connections to the other workers */
+        for (unsigned n = 0; n < HTTPD_EPOLL_EVENTS; n++) {
+            int fd = vlc_accept(host->fds[i], NULL, NULL, true);
+            if (fd == -1)
                 break;
 
-            case HTTPD_CLIENT_WAITING: {
-                int64_t i_offset = cl->answer.i_body_offset;
-                int i_msg = cl->query.i_type;
+            httpd_client_t *cl = httpd_ClientAccept(host, fd, now);
+            if (cl == NULL)
+                continue;
 
-                httpd_MsgInit(&cl->answer);
-                cl->answer.i_body_offset = i_offset;
+            struct epoll_event ev = { .events = 0, .data.ptr = cl };
 
-                cl->url->catch[i_msg].cb(cl->url->catch[i_msg].p_sys, cl,
-                        &cl->answer, &cl->query);
-                if (cl->answer.i_type != HTTPD_MSG_NONE) {
-                    /* we have new data, so re-enter send mode */
-                    cl->i_buffer      = 0;
-                    cl->p_buffer      = cl->answer.p_body;
-                    cl->i_buffer_size = cl->answer.i_body;
-                    cl->answer.p_body = NULL;
-                    cl->answer.i_body = 0;
-                    cl->i_state = HTTPD_CLIENT_SENDING;
-                }
+            cl->worker = w;
+            w->client_count++;
+            vlc_list_append(&cl->node, &w->clients);
+
+            if (epoll_ctl(w->epfd, EPOLL_CTL_ADD, fd, &ev)) {
+                w->client_count--;
+                httpd_ClientDestroy(cl);
+                continue;
             }
+            /* Registers the events to wait for */
+            httpd_WorkerQueue(cl, &w->ready);
+        }
+}
+
+static void httpd_WorkerServe(struct httpd_worker *w, httpd_client_t *cl,
+                              vlc_tick_t now, struct vlc_list *again)
+{
+    struct pollfd ufd;
+    int val = httpd_ClientServe(w->host, cl, now, &ufd);
+
+    if (val < 0) {
+        httpd_WorkerRemove(w, cl);
+        return;
+    }
+
+    uint32_t events = 0;
+    if (ufd.events & POLLIN)
+        events |= EPOLLIN;
+    if (ufd.events & POLLOUT)
+        events |= EPOLLOUT;
+
+    if (events != cl->epoll_events) {
+        struct epoll_event ev = { .events = events, .data.ptr = cl };
+
+        if (epoll_ctl(w->epfd, EPOLL_CTL_MOD, ufd.fd, &ev)) {
+            httpd_WorkerRemove(w, cl);
+            return;
+        }
+        cl->epoll_events = events;
+    }
+
+    if (val == 0)
+        httpd_WorkerQueue(cl, again);
+    else if (events == 0)
+        /* until httpd_StreamSend() signals more stream data */
+        httpd_WorkerQueue(cl, &w->waiting);
+}
+
+/* Returns the delay until the next timer of the worker, in milliseconds */
+static int httpd_WorkerDelay(struct httpd_worker *w, vlc_tick_t now)
+{
+    vlc_tick_t deadline = VLC_TICK_MAX;
+
+    if (!vlc_list_is_empty(&w->ready))
+        return 0;
+    if (w->host->timeout_sec > 0 && w->client_count > 0
+     && w->timeout_date < deadline)
+        deadline = w->timeout_date;
+
+    if (deadline == VLC_TICK_MAX)
+        return -1;
+    if (deadline <= now)
+        return 0;
+    return MS_FROM_VLC_TICK(deadline - now + VLC_TICK_FROM_MS(1) - 1);
+}
+
+/*
+ * Clients are registered with the epoll instance of their worker, so that a
+ * wake-up only costs as much as the clients it concerns. All the workers wait
+ * on the listening sockets, and the kernel wakes only one of them up per
+ * incoming connection.
+ */
+static void httpdLoop(struct httpd_worker *w)
+{
+    httpd_host_t *host = w->host;
+    struct epoll_event ev[HTTPD_EPOLL_EVENTS];
+    httpd_client_t *cl;
+    int n;
+
+    vlc_mutex_lock(&w->lock);
+    int delay = httpd_WorkerDelay(w, vlc_tick_now());
+    vlc_mutex_unlock(&w->lock);
+
+    while ((n = epoll_wait(w->epfd, ev, ARRAY_SIZE(ev), delay)) < 0)
+    {
+        if (errno != EINTR)
+            msg_Err(host, "polling error: %s", vlc_strerror_c(errno));
+    }
+
+    int canc = vlc_savecancel();
+    vlc_mutex_lock(&w->lock);
+
+    vlc_tick_t now = vlc_tick_now();
+    bool b_accept = false, b_wake = false;
+
+    for (int i = 0; i < n; i++) {
+        if (ev[i].data.ptr == w) { /* stream data signaled */
+            b_wake = true;
+            continue;
+        }
+
+        cl = ev[i].data.ptr;
+
+        if (cl == NULL) { /* listening socket */
+            b_accept = true;
+            continue;
+        }
+
+        if (ev[i].events & EPOLLHUP)
+            cl->i_state = HTTPD_CLIENT_DEAD;
+        else if (ev[i].events & EPOLLERR)
+            httpd_ClientError(cl);
+        httpd_WorkerQueue(cl, &w->ready);
+    }
+
+    if (b_accept)
+        httpd_WorkerAccept(w, now);
+
+    if (b_wake) {
+        eventfd_read(w->wakefd, &(eventfd_t){ 0 });
+        vlc_list_foreach(cl, &w->waiting, queue_node)
+            httpd_WorkerQueue(cl, &w->ready);
+    }
+
+    struct vlc_list again;
+    vlc_list_init(&again);
+
+    vlc_list_foreach(cl, &w->ready, queue_node) {
+        vlc_list_remove(&cl->queue_node);
+        cl->queued = false;
+        httpd_WorkerServe(w, cl, now, &again);
+    }
+
+    /* clients which made some progress are served again after polling */
+    vlc_list_foreach(cl, &again, queue_node)
+        httpd_WorkerQueue(cl, &w->ready);
+
+    if (host->timeout_sec > 0 && w->timeout_date <= now) {
+        vlc_list_foreach(cl, &w->clients, node)
+            if (cl->i_timeout_date < now)
+                httpd_WorkerRemove(w, cl);
+        w->timeout_date = now + VLC_TICK_FROM_SEC(1);
+    }
+
+    vlc_mutex_unlock(&w->lock);
+    vlc_restorecancel(canc);
+}
+
+#else
+static void httpdLoop(struct httpd_worker *w)
+{
+    httpd_host_t *host = w->host;
+    struct pollfd ufd[host->nfd + w->client_count];
+    unsigned nfd;
+    for (nfd = 0; nfd < host->nfd; nfd++) {
+        ufd[nfd].fd = host->fds[nfd];
+        ufd[nfd].events = POLLIN;
+        ufd[nfd].revents = 0;
+    }
+
+    vlc_mutex_lock(&w->lock);
+    /* add all socket that should be read/write and close dead connection */
+    vlc_tick_t now = vlc_tick_now();
+    int delay = -1;
+    httpd_client_t *cl;
+
+    int canc = vlc_savecancel();
+    vlc_list_foreach(cl, &w->clients, node) {
+        struct pollfd *pufd = ufd + nfd;
+        assert (pufd < ufd + ARRAY_SIZE (ufd));
+
+        int val = httpd_ClientServe(host, cl, now, pufd);
+        if (val < 0) {
+            w->client_count--;
+            httpd_ClientDestroy(cl);
+            continue;
         }
 
-        pufd->fd = vlc_tls_GetPollFD(cl->sock, &pufd->events);
+        if (val == 0)
+            delay = 0;
 
         if (pufd->events != 0)
             nfd++;
@@ -1980,7 +2756,7 @@ static void httpdLoop(httpd_host_t *host)
         else if (delay != 0)
             delay = 20;
     }
-    vlc_mutex_unlock(&host->lock);
+    vlc_mutex_unlock(&w->lock);
     vlc_restorecancel(canc);
 
     while (poll(ufd, nfd, delay) < 0)
@@ -1990,11 +2766,10 @@ static void httpdLoop(httpd_host_t *host)
     }
 
     canc = vlc_savecancel();
-    vlc_mutex_lock(&host->lock);
+    vlc_mutex_lock(&w->lock);
 
     /* Handle client sockets */
     now = vlc_tick_now();
-    nfd = host->nfd;
 
     /* Handle server sockets (accept new connections) */
     for (nfd = 0; nfd < host->nfd; nfd++) {
@@ -2009,56 +2784,26 @@ static void httpdLoop(httpd_host_t *host)
         fd = vlc_accept (fd, NULL, NULL, true);
         if (fd == -1)
             continue;
-        setsockopt (fd, SOL_SOCKET, SO_REUSEADDR,
-                &(int){ 1 }, sizeof(int));
-
-        vlc_tls_t *sk = vlc_tls_SocketOpen(fd);
-        if (unlikely(sk == NULL))
-        {
-            vlc_close(fd);
-            continue;
-        }
 
-        if (host->p_tls != NULL)
-        {
-            const char *alpn[] = { "http/1.1", NULL };
-            vlc_tls_t *tls;
-
-            tls = vlc_tls_ServerSessionCreate(host->p_tls, sk, alpn);
-            if (tls == NULL)
-            {
-                vlc_tls_SessionDelete(sk);
-                continue;
-            }
-            sk = tls;
-        }
-
-        cl = httpd_ClientNew(sk);
-
-        if (unlikely(cl == NULL))
-        {
-            vlc_tls_Close(sk);
+        cl = httpd_ClientAccept(host, fd, now);
+        if (cl == NULL)
             continue;
-        }
-
-        if (host->p_tls != NULL)
-            cl->i_state = HTTPD_CLIENT_TLS_HS_OUT;
 
-        cl->i_timeout_date = now + VLC_TICK_FROM_SEC(host->timeout_sec);
-        host->client_count++;
-        vlc_list_append(&cl->node, &host->clients);
+        w->client_count++;
+        vlc_list_append(&cl->node, &w->clients);
     }
 
-    vlc_mutex_unlock(&host->lock);
+    vlc_mutex_unlock(&w->lock);
     vlc_restorecancel(canc);
 }
+#endif
 
-static void* httpd_HostThread(void *data)
+static void* httpd_WorkerThread(void *data)
 {
-    httpd_host_t *host = data;
+    struct httpd_worker *w = data;
 
-    while (atomic_load_explicit(&host->ref, memory_order_relaxed) > 0)
-        httpdLoop(host);
+    while (atomic_load_explicit(&w->host->ref, memory_order_relaxed) > 0)
+        httpdLoop(w);
     return NULL;
 }
 
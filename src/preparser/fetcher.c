@@ -139,7 +139,12 @@ Submit(input_fetcher_t *fetcher, vlc_executor_t *executor, input_item_t *item,
         return VLC_ENOMEM;
 
     FetcherAddTask(fetcher, task);
-    vlc_executor_Submit(task->executor, &task->runnable);
+
+    /* Local lookups are cheap, do not queue them behind network requests */
+    enum vlc_executor_priority priority =
+        executor == fetcher->executor_local ? VLC_EXECUTOR_PRIORITY_HIGH
+                                            : VLC_EXECUTOR_PRIORITY_NORMAL;
+    vlc_executor_SubmitPriority(task->executor, &task->runnable, priority);
 
     return VLC_SUCCESS;
 }
@@ -438,14 +443,14 @@ input_fetcher_t* input_fetcher_New( vlc_object_t* owner )
     if (max_threads < 1)
         max_threads = 1;
 
-    fetcher->executor_local = vlc_executor_New(max_threads);
+    fetcher->executor_local = vlc_executor_NewShared(max_threads);
     if (!fetcher->executor_local)
     {
         free(fetcher);
         return NULL;
     }
 
-    fetcher->executor_network = vlc_executor_New(max_threads);
+    fetcher->executor_network = vlc_executor_NewShared(max_threads);
     if (!fetcher->executor_network)
     {
         vlc_executor_Delete(fetcher->executor_local);
@@ -453,7 +458,7 @@ input_fetcher_t* input_fetcher_New( vlc_object_t* owner )
         return NULL;
     }
 
-    fetcher->executor_downloader = vlc_executor_New(max_threads);
+    fetcher->executor_downloader = vlc_executor_NewShared(max_threads);
     if (!fetcher->executor_downloader)
     {
         vlc_executor_Delete(fetcher->executor_network);
@@ -281,7 +281,7 @@ input_preparser_t* input_preparser_New( vlc_object_t *parent )
     if (max_threads < 1)
         max_threads = 1;
 
-    preparser->executor = vlc_executor_New(max_threads);
+    preparser->executor = vlc_executor_NewShared(max_threads);
     if (!preparser->executor)
     {
         free(preparser);
@@ -23,6 +23,7 @@
 #endif
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #undef NDEBUG
 #include <assert.h>
@@ -86,11 +87,90 @@ static void test_block (void)
     //assert (block == NULL);
 }
 
+static void *test_block_pool_Thread(void *data)
+{
+    block_fifo_t *fifo = data;
+    block_t *block;
+
+    while ((block = block_FifoGet(fifo)) != NULL)
+    {
+        if (block->i_buffer == 0)
+        {
+            block_Release(block);
+            break;
+        }
+        assert(block->p_buffer[0] == (block->i_buffer & 0xff));
+        block_Release(block);
+    }
+    return NULL;
+}
+
+static void test_block_pool(void)
+{
+    struct block_pool_stats before, after;
+    block_t *blocks[64];
+
+    block_PoolGetStats(&before);
+
+    /* Same-thread recycling */
+    for (unsigned round = 0; round < 4; round++)
+    {
+        for (size_t i = 0; i < ARRAY_SIZE(blocks); i++)
+        {
+            size_t size = 188 * (i + 1);
+
+            blocks[i] = block_Alloc(size);
+            assert(blocks[i] != NULL);
+            assert(blocks[i]->i_buffer == size);
+            assert(((uintptr_t)blocks[i]->p_buffer % 32) == 0);
+            memset(blocks[i]->p_buffer, i, size);
+        }
+        for (size_t i = 0; i < ARRAY_SIZE(blocks); i++)
+            block_Release(blocks[i]);
+    }
+
+    /* Cross-thread recycling through the depot */
+    block_fifo_t *fifo = block_FifoNew();
+    vlc_thread_t th;
+
+    assert(fifo != NULL);
+    if (vlc_clone(&th, test_block_pool_Thread, fifo,
+                  VLC_THREAD_PRIORITY_LOW) == 0)
+    {
+        for (unsigned i = 0; i < 10000; i++)
+        {
+            size_t size = 1 + (i * 1316) % 50000;
+            block_t *block = block_Alloc(size);
+
+            assert(block != NULL);
+            block->p_buffer[0] = size & 0xff;
+            block_FifoPut(fifo, block);
+        }
+        block_FifoPut(fifo, block_Alloc(0));
+        vlc_join(th, NULL);
+    }
+    block_FifoRelease(fifo);
+
+    block_PoolGetStats(&after);
+    assert(after.hits >= before.hits);
+    assert(after.misses >= before.misses);
+
+    const char *env = getenv("VLC_BLOCK_POOL");
+    if (env == NULL || strcmp(env, "0"))
+    {
+#if !defined(__SANITIZE_ADDRESS__)
+        assert(after.hits > before.hits);
+        assert(after.resident > 0);
+#endif
+    }
+}
+
 int main (void)
 {
     test_block_File(false);
     test_block_File(true);
     test_block ();
+    test_block_pool ();
     return 0;
 }
 
@@ -25,6 +25,9 @@
 #undef NDEBUG
 
 #include <assert.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
 
 #include <vlc_common.h>
 #include <vlc_executor.h>
@@ -248,9 +251,8 @@ static void DoublerRun(void *userdata)
     free(task);
 }
 
-static void test_task_chain(void)
+static void test_task_chain(vlc_executor_t *executor)
 {
-    vlc_executor_t *executor = vlc_executor_New(4);
     assert(executor);
 
     /* Numbers from 0 to 99 */
@@ -271,12 +273,193 @@ static void test_task_chain(void)
         assert(array[i] == 2 * i);
 }
 
+struct priority_data
+{
+    vlc_sem_t blocker;
+    vlc_mutex_t lock;
+    int order[3];
+    int count;
+};
+
+struct priority_task
+{
+    struct priority_data *data;
+    int id;
+    struct vlc_runnable runnable;
+};
+
+static void RunBlocker(void *userdata)
+{
+    struct priority_task *task = userdata;
+    vlc_sem_wait(&task->data->blocker);
+}
+
+static void RunRecord(void *userdata)
+{
+    struct priority_task *task = userdata;
+    struct priority_data *data = task->data;
+
+    vlc_mutex_lock(&data->lock);
+    assert(data->count < 3);
+    data->order[data->count++] = task->id;
+    vlc_mutex_unlock(&data->lock);
+}
+
+static void test_priority(vlc_executor_t *executor)
+{
+    assert(executor);
+
+    struct priority_data data;
+    vlc_sem_init(&data.blocker, 0);
+    vlc_mutex_init(&data.lock);
+    data.count = 0;
+
+    struct priority_task blocker = {
+        .data = &data,
+        .runnable = { .run = RunBlocker, .userdata = &blocker },
+    };
+    struct priority_task tasks[3];
+    for (int i = 0; i < 3; ++i)
+    {
+        tasks[i].data = &data;
+        tasks[i].id = i;
+        tasks[i].runnable.run = RunRecord;
+        tasks[i].runnable.userdata = &tasks[i];
+    }
+
+    /* Occupy the only thread, then queue tasks by increasing priority */
+    vlc_executor_Submit(executor, &blocker.runnable);
+    vlc_executor_SubmitPriority(executor, &tasks[0].runnable,
+                                VLC_EXECUTOR_PRIORITY_LOW);
+    vlc_executor_SubmitPriority(executor, &tasks[1].runnable,
+                                VLC_EXECUTOR_PRIORITY_NORMAL);
+    vlc_executor_SubmitPriority(executor, &tasks[2].runnable,
+                                VLC_EXECUTOR_PRIORITY_HIGH);
+
+    vlc_sem_post(&data.blocker);
+    vlc_executor_WaitIdle(executor);
+    vlc_executor_Delete(executor);
+
+    /* Whether the blocker was started before or after the other tasks were
+     * queued, they must run in priority order */
+    assert(data.count == 3);
+    assert(data.order[0] == 2);
+    assert(data.order[1] == 1);
+    assert(data.order[2] == 0);
+}
+
+struct quota_data
+{
+    vlc_mutex_t lock;
+    unsigned running;
+    unsigned max_running;
+    unsigned ended;
+};
+
+static void RunQuota(void *userdata)
+{
+    struct quota_data *data = userdata;
+
+    vlc_mutex_lock(&data->lock);
+    if (++data->running > data->max_running)
+        data->max_running = data->running;
+    vlc_mutex_unlock(&data->lock);
+
+    vlc_tick_t delay = VLC_TICK_FROM_MS(10);
+    vlc_tick_sleep(delay);
+
+    vlc_mutex_lock(&data->lock);
+    data->running--;
+    data->ended++;
+    vlc_mutex_unlock(&data->lock);
+}
+
+static void test_shared_quota(void)
+{
+    vlc_executor_t *executors[2] = {
+        vlc_executor_NewShared(2),
+        vlc_executor_NewShared(3),
+    };
+    const unsigned quotas[2] = { 2, 3 };
+    struct quota_data data[2];
+    struct vlc_runnable runnables[2][20];
+
+    for (int i = 0; i < 2; ++i)
+    {
+        assert(executors[i]);
+        vlc_mutex_init(&data[i].lock);
+        data[i].running = data[i].max_running = data[i].ended = 0;
+
+        for (int j = 0; j < 20; ++j)
+        {
+            runnables[i][j].run = RunQuota;
+            runnables[i][j].userdata = &data[i];
+            vlc_executor_Submit(executors[i], &runnables[i][j]);
+        }
+    }
+
+    for (int i = 0; i < 2; ++i)
+    {
+        vlc_executor_WaitIdle(executors[i]);
+        vlc_executor_Delete(executors[i]);
+
+        assert(data[i].ended == 20);
+        assert(data[i].max_running >= 1);
+        assert(data[i].max_running <= quotas[i]);
+    }
+}
+
+static void RunNothing(void *userdata)
+{
+    atomic_uint *counter = userdata;
+    atomic_fetch_add_explicit(counter, 1, memory_order_relaxed);
+}
+
+#define BENCH_TASKS 100000
+
+static void bench_throughput(const char *name, vlc_executor_t *executor)
+{
+    assert(executor);
+
+    struct vlc_runnable *runnables = malloc(BENCH_TASKS * sizeof(*runnables));
+    assert(runnables);
+
+    atomic_uint counter = ATOMIC_VAR_INIT(0);
+    vlc_tick_t start = vlc_tick_now();
+
+    for (int i = 0; i < BENCH_TASKS; ++i)
+    {
+        runnables[i].run = RunNothing;
+        runnables[i].userdata = &counter;
+        vlc_executor_Submit(executor, &runnables[i]);
+    }
+    vlc_executor_WaitIdle(executor);
+
+    vlc_tick_t elapsed = vlc_tick_now() - start;
+    vlc_executor_Delete(executor);
+
+    assert(atomic_load(&counter) == BENCH_TASKS);
+    printf("%-16s %d tasks in %"PRId64" us (%.0f tasks/s)\n", name,
+           BENCH_TASKS, US_FROM_VLC_TICK(elapsed),
+           BENCH_TASKS / secf_from_vlc_tick(elapsed > 0 ? elapsed : 1));
+    free(runnables);
+}
+
 int main(void)
 {
     test_single_runnable();
     test_multiple_runnables();
     test_blocking_delete();
     test_cancel();
-    test_task_chain();
+    test_task_chain(vlc_executor_New(4));
+    test_task_chain(vlc_executor_NewShared(4));
+    test_priority(vlc_executor_New(1));
+    test_priority(vlc_executor_NewShared(1));
+    test_shared_quota();
+
+    unsigned cpus = vlc_GetCPUCount();
+    bench_throughput("1 thread:", vlc_executor_New(1));
+    bench_throughput("per-CPU threads:", vlc_executor_New(cpus ? cpus : 1));
+    bench_throughput("shared pool:", vlc_executor_NewShared(cpus ? cpus : 1));
     return 0;
 }
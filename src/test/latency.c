@@ -0,0 +1,122 @@
+/*****************************************************************************
+ * latency.c: Test for latency histograms
+ *****************************************************************************
+ * Copyright (C) 2021 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#undef NDEBUG
+#include <assert.h>
+
+#include <vlc_common.h>
+#include <vlc_input_item.h>
+
+#include "../misc/latency.h"
+
+const char vlc_module_name[] = "test_latency";
+
+static void assert_near(vlc_tick_t value, vlc_tick_t expected)
+{
+    /* Four buckets per octave */
+    assert(value >= expected - expected / 5);
+    assert(value <= expected + expected / 5);
+}
+
+static void test_empty(void)
+{
+    struct vlc_latency_histogram h;
+    struct input_latency_stats stats;
+
+    vlc_latency_histogram_Init(&h);
+    vlc_latency_histogram_Compute(&h, &stats);
+    assert(stats.count == 0);
+    assert(stats.p50 == VLC_TICK_INVALID);
+    assert(stats.p99 == VLC_TICK_INVALID);
+    assert(stats.max == 0);
+}
+
+static void test_percentiles(void)
+{
+    struct vlc_latency_histogram h;
+    struct input_latency_stats stats;
+
+    vlc_latency_histogram_Init(&h);
+    for (vlc_tick_t i = 1; i <= 10000; i++)
+        vlc_latency_histogram_Add(&h, VLC_TICK_FROM_US(i));
+
+    vlc_latency_histogram_Compute(&h, &stats);
+    assert(stats.count == 10000);
+    assert(stats.max == VLC_TICK_FROM_US(10000));
+    assert_near(stats.p50, VLC_TICK_FROM_US(5000));
+    assert_near(stats.p99, VLC_TICK_FROM_US(9900));
+    assert(stats.p99 <= stats.max);
+
+    /* Small, negative and huge values */
+    vlc_latency_histogram_Init(&h);
+    vlc_latency_histogram_Add(&h, -5);
+    vlc_latency_histogram_Add(&h, 0);
+    vlc_latency_histogram_Add(&h, 3);
+    vlc_latency_histogram_Compute(&h, &stats);
+    assert(stats.count == 3);
+    assert(stats.p50 == 0);
+    assert(stats.p99 == 3);
+    assert(stats.max == 3);
+
+    vlc_latency_histogram_Add(&h, VLC_TICK_MAX);
+    vlc_latency_histogram_Compute(&h, &stats);
+    assert(stats.count == 4);
+    assert(stats.max == VLC_TICK_MAX);
+    assert(stats.p99 > VLC_TICK_FROM_SEC(3600));
+}
+
+static void test_move(void)
+{
+    struct vlc_latency_histogram src, dst;
+    struct input_latency_stats stats;
+
+    vlc_latency_histogram_Init(&src);
+    vlc_latency_histogram_Init(&dst);
+
+    for (int i = 0; i < 100; i++)
+        vlc_latency_histogram_Add(&src, VLC_TICK_FROM_MS(10));
+    vlc_latency_histogram_Move(&dst, &src);
+
+    for (int i = 0; i < 100; i++)
+        vlc_latency_histogram_Add(&src, VLC_TICK_FROM_MS(40));
+    vlc_latency_histogram_Move(&dst, &src);
+
+    vlc_latency_histogram_Compute(&src, &stats);
+    assert(stats.count == 0);
+    assert(stats.max == 0);
+
+    vlc_latency_histogram_Compute(&dst, &stats);
+    assert(stats.count == 200);
+    assert(stats.max == VLC_TICK_FROM_MS(40));
+    assert_near(stats.p50, VLC_TICK_FROM_MS(10));
+    assert(stats.p99 == VLC_TICK_FROM_MS(40));
+}
+
+int main(void)
+{
+    test_empty();
+    test_percentiles();
+    test_move();
+    return 0;
+}
@@ -23,6 +23,8 @@
 #endif
 
 #include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
 #undef NDEBUG
 #include <assert.h>
 
@@ -108,6 +110,81 @@ static void test(bool zombie)
             picture_Release(pics[i]);
 }
 
+static void test_large(unsigned count)
+{
+    picture_t **pics = malloc(count * sizeof (*pics));
+    assert(pics != NULL);
+
+    pool = picture_pool_NewFromFormat(&fmt, count);
+    assert(pool != NULL);
+
+    for (unsigned i = 0; i < count; i++) {
+        pics[i] = picture_pool_Get(pool);
+        assert(pics[i] != NULL);
+        for (unsigned j = 0; j < i; j++)
+            assert(pics[j]->p[0].p_pixels != pics[i]->p[0].p_pixels);
+    }
+    assert(picture_pool_Get(pool) == NULL);
+
+    for (unsigned i = 0; i < count; i += 3)
+        picture_Release(pics[i]);
+    for (unsigned i = 0; i < count; i += 3) {
+        pics[i] = picture_pool_Wait(pool);
+        assert(pics[i] != NULL);
+    }
+    assert(picture_pool_Get(pool) == NULL);
+
+    for (unsigned i = 0; i < count; i++)
+        picture_Release(pics[i]);
+    picture_pool_Release(pool);
+    free(pics);
+}
+
+#define BENCH_THREADS    4
+#define BENCH_ITERATIONS 20000
+
+static void *bench_thread(void *data)
+{
+    bool wait = *(bool *)data;
+
+    for (unsigned i = 0; i < BENCH_ITERATIONS; i++) {
+        picture_t *a = wait ? picture_pool_Wait(pool) : picture_pool_Get(pool);
+        picture_t *b = wait ? picture_pool_Wait(pool) : picture_pool_Get(pool);
+
+        if (a != NULL)
+            picture_Release(a);
+        if (b != NULL)
+            picture_Release(b);
+    }
+    return NULL;
+}
+
+static void bench(unsigned count, bool wait)
+{
+    vlc_thread_t th[BENCH_THREADS];
+
+    pool = picture_pool_NewFromFormat(&fmt, count);
+    assert(pool != NULL);
+
+    vlc_tick_t start = vlc_tick_now();
+
+    for (unsigned i = 0; i < BENCH_THREADS; i++)
+        assert(vlc_clone(&th[i], bench_thread, &wait,
+                         VLC_THREAD_PRIORITY_LOW) == 0);
+    for (unsigned i = 0; i < BENCH_THREADS; i++)
+        vlc_join(th[i], NULL);
+
+    vlc_tick_t elapsed = vlc_tick_now() - start;
+    unsigned long long ops = 2ULL * BENCH_THREADS * BENCH_ITERATIONS;
+
+    printf("%u threads, %3u pictures, %s: %llu get/release in %"PRId64
+           " us (%.0f ops/s)\n", BENCH_THREADS, count,
+           wait ? "wait" : "get ", ops, US_FROM_VLC_TICK(elapsed),
+           ops / secf_from_vlc_tick(elapsed > 0 ? elapsed : 1));
+
+    picture_pool_Release(pool);
+}
+
 int main(void)
 {
     video_format_Setup(&fmt, VLC_CODEC_I420, 320, 200, 320, 200, 1, 1);
@@ -124,5 +201,14 @@ int main(void)
     test(false);
     test(true);
 
+    test_large(64);
+    test_large(65);
+    test_large(300);
+
+    bench(8, false);
+    bench(8, true);
+    bench(256, false);
+    bench(256, true);
+
     return 0;
 }
@@ -23,6 +23,8 @@
 #ifndef LIBVLC_VOUT_STATISTIC_H
 # define LIBVLC_VOUT_STATISTIC_H
 # include <stdatomic.h>
+# include <vlc_input_item.h>
+# include "../misc/latency.h"
 
 /* NOTE: Both statistics are atomic on their own, so one might be older than
  * the other one. Currently, only one of them is updated at a time, so this
@@ -31,6 +33,7 @@ typedef struct {
     atomic_uint displayed;
     atomic_uint lost;
     atomic_uint late;
+    struct vlc_latency_histogram latency[INPUT_LATENCY_STAGE_COUNT];
 } vout_statistic_t;
 
 static inline void vout_statistic_Init(vout_statistic_t *stat)
@@ -38,6 +41,8 @@ static inline void vout_statistic_Init(vout_statistic_t *stat)
     atomic_init(&stat->displayed, 0);
     atomic_init(&stat->lost, 0);
     atomic_init(&stat->late, 0);
+    for (size_t i = 0; i < INPUT_LATENCY_STAGE_COUNT; i++)
+        vlc_latency_histogram_Init(&stat->latency[i]);
 }
 
 static inline void vout_statistic_Clean(vout_statistic_t *stat)
@@ -48,12 +53,15 @@ static inline void vout_statistic_Clean(vout_statistic_t *stat)
 static inline void vout_statistic_GetReset(vout_statistic_t *stat,
                                            unsigned *restrict displayed,
                                            unsigned *restrict lost,
-                                           unsigned *restrict late)
+                                           unsigned *restrict late,
+                                           struct vlc_latency_histogram *latency)
 {
     *displayed = atomic_exchange_explicit(&stat->displayed, 0,
                                           memory_order_relaxed);
     *lost = atomic_exchange_explicit(&stat->lost, 0, memory_order_relaxed);
     *late = atomic_exchange_explicit(&stat->late, 0, memory_order_relaxed);
+    for (size_t i = 0; i < INPUT_LATENCY_STAGE_COUNT; i++)
+        vlc_latency_histogram_Move(&latency[i], &stat->latency[i]);
 }
 
 static inline void vout_statistic_AddDisplayed(vout_statistic_t *stat,
@@ -73,4 +81,11 @@ static inline void vout_statistic_AddLate(vout_statistic_t *stat, int late)
     atomic_fetch_add_explicit(&stat->late, late, memory_order_relaxed);
 }
 
+static inline void vout_statistic_AddLatency(vout_statistic_t *stat,
+                                             enum input_latency_stage stage,
+                                             vlc_tick_t latency)
+{
+    vlc_latency_histogram_Add(&stat->latency[stage], latency);
+}
+
 #endif
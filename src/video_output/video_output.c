@@ -49,6 +49,7 @@
 #include <vlc_plugin.h>
 #include <vlc_codec.h>
 #include <vlc_atomic.h>
+#include <vlc_tracer.h>
 
 #include <libvlc.h>
 #include "vout_private.h"
@@ -107,6 +108,7 @@ typedef struct vout_thread_sys_t
         bool        is_interlaced;
         picture_t   *decoded; // decoded picture before passed through chain_static
         picture_t   *current;
+        bool        is_traced; // latency of the current picture accounted
     } displayed;
 
     struct {
@@ -330,11 +332,12 @@ static void vout_UpdateWindowSizeLocked(vout_thread_sys_t *vout)
 
 /* */
 void vout_GetResetStatistic(vout_thread_t *vout, unsigned *restrict displayed,
-                            unsigned *restrict lost, unsigned *restrict late)
+                            unsigned *restrict lost, unsigned *restrict late,
+                            struct vlc_latency_histogram *latency)
 {
     vout_thread_sys_t *sys = VOUT_THREAD_TO_SYS(vout);
     assert(!sys->dummy);
-    vout_statistic_GetReset( &sys->statistic, displayed, lost, late );
+    vout_statistic_GetReset( &sys->statistic, displayed, lost, late, latency );
 }
 
 bool vout_IsEmpty(vout_thread_t *vout)
@@ -1043,6 +1046,9 @@ static picture_t *PreparePicture(vout_thread_sys_t *vout, bool reuse_decoded,
 
     vlc_mutex_unlock(&sys->filter.lock);
 
+    if (picture != NULL)
+        picture->trace.filtered = vlc_tick_now();
+
     return picture;
 }
 
@@ -1293,6 +1299,58 @@ static int PrerenderPicture(vout_thread_sys_t *sys, picture_t *filtered,
     return VLC_SUCCESS;
 }
 
+static void AccountLatency(vout_thread_sys_t *sys, const picture_t *pic,
+                           vlc_tick_t displayed)
+{
+    const struct vlc_frame_trace *trace = &pic->trace;
+    const vlc_tick_t dates[] = {
+        trace->demux, trace->decode, trace->decoded, trace->filtered, displayed,
+    };
+    static_assert(ARRAY_SIZE(dates) == INPUT_LATENCY_TOTAL + 1,
+                  "one date per stage boundary");
+    vlc_tick_t latency[INPUT_LATENCY_STAGE_COUNT];
+
+    /* A stage is skipped if one of its boundaries was not reached, e.g. if
+     * the decoder could not match its output with its input. */
+    for (size_t i = 0; i < INPUT_LATENCY_TOTAL; i++)
+    {
+        if (dates[i] != VLC_TICK_INVALID && dates[i + 1] != VLC_TICK_INVALID)
+        {
+            latency[i] = dates[i + 1] - dates[i];
+            vout_statistic_AddLatency(&sys->statistic, i, latency[i]);
+        }
+        else
+            latency[i] = -1;
+    }
+
+    if (trace->demux != VLC_TICK_INVALID)
+    {
+        latency[INPUT_LATENCY_TOTAL] = displayed - trace->demux;
+        vout_statistic_AddLatency(&sys->statistic, INPUT_LATENCY_TOTAL,
+                                  latency[INPUT_LATENCY_TOTAL]);
+    }
+    else
+        latency[INPUT_LATENCY_TOTAL] = -1;
+
+    struct vlc_tracer *tracer = vlc_object_get_tracer(VLC_OBJECT(&sys->obj));
+    if (tracer != NULL)
+    {
+        /* Latencies in nanoseconds, -1 if unknown */
+        vlc_tick_t ns[INPUT_LATENCY_STAGE_COUNT];
+        for (size_t i = 0; i < INPUT_LATENCY_STAGE_COUNT; i++)
+            ns[i] = latency[i] >= 0 ? NS_FROM_VLC_TICK(latency[i]) : -1;
+
+        vlc_tracer_Trace(tracer, VLC_TRACE("type", "LATENCY"),
+                         VLC_TRACE("pts", NS_FROM_VLC_TICK(pic->date)),
+                         VLC_TRACE("demux", ns[INPUT_LATENCY_DEMUX]),
+                         VLC_TRACE("decode", ns[INPUT_LATENCY_DECODE]),
+                         VLC_TRACE("filter", ns[INPUT_LATENCY_FILTER]),
+                         VLC_TRACE("display", ns[INPUT_LATENCY_DISPLAY]),
+                         VLC_TRACE("total", ns[INPUT_LATENCY_TOTAL]),
+                         VLC_TRACE_END);
+    }
+}
+
 static int RenderPicture(vout_thread_sys_t *sys, bool render_now)
 {
     vout_display_t *vd = sys->display;
@@ -1397,6 +1455,13 @@ static int RenderPicture(vout_thread_sys_t *sys, bool render_now)
 
     vout_statistic_AddDisplayed(&sys->statistic, 1);
 
+    /* Pictures displayed again are accounted only once */
+    if (!sys->displayed.is_traced)
+    {
+        AccountLatency(sys, sys->displayed.current, vlc_tick_now());
+        sys->displayed.is_traced = true;
+    }
+
     return VLC_SUCCESS;
 }
 
@@ -1423,6 +1488,7 @@ static int DisplayNextFrame(vout_thread_sys_t *sys)
         if (likely(sys->displayed.current != NULL))
             picture_Release(sys->displayed.current);
         sys->displayed.current = next;
+        sys->displayed.is_traced = false;
     }
 
     if (!sys->displayed.current)
@@ -1503,6 +1569,7 @@ static int DisplayPicture(vout_thread_sys_t *vout, vlc_tick_t *deadline)
         if (likely(dropped_current_frame))
             picture_Release(sys->displayed.current);
         sys->displayed.current = next;
+        sys->displayed.is_traced = false;
     }
     else if (likely(sys->displayed.date != VLC_TICK_INVALID))
     {
@@ -1768,6 +1835,7 @@ static int vout_Start(vout_thread_sys_t *vout, vlc_video_context *vctx, const vo
     assert(sys->private.display_pool != NULL && sys->private.private_pool != NULL);
 
     sys->displayed.current       = NULL;
+    sys->displayed.is_traced     = false;
     sys->displayed.decoded       = NULL;
     sys->displayed.date          = VLC_TICK_INVALID;
     sys->displayed.timestamp     = VLC_TICK_INVALID;
@@ -0,0 +1,162 @@
+/*****************************************************************************
+ * uring.c: io_uring file input tests
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#undef NDEBUG
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <vlc_common.h>
+#include <vlc_access.h>
+#include <vlc_block.h>
+#include <vlc_stream.h>
+#include <vlc_url.h>
+
+#include "../../libvlc/test.h"
+#include "../../../lib/libvlc_internal.h"
+
+/* Not a multiple of the read size, nor of the direct I/O alignment */
+#define SIZE    3000123
+#define HELD    8
+
+static uint8_t *data;
+static block_t *held[HELD];
+static unsigned held_count;
+
+/* Reads from the offset, holding some blocks for a while, so that the
+ * buffers are released out of order, and reused after the seeks */
+static size_t ReadAt(stream_t *s, uint64_t offset, size_t length)
+{
+    size_t total = 0;
+
+    assert(vlc_stream_Seek(s, offset) == VLC_SUCCESS);
+    while (total < length)
+    {
+        block_t *block = vlc_stream_ReadBlock(s);
+        if (block == NULL)
+        {
+            if (vlc_stream_Eof(s))
+                break;
+            continue;
+        }
+
+        size_t size = __MIN(block->i_buffer, length - total);
+        assert(offset + total + size <= SIZE);
+        assert(!memcmp(block->p_buffer, data + offset + total, size));
+        total += size;
+
+        if (rand() % 4 == 0 && held_count < HELD)
+            held[held_count++] = block;
+        else
+            block_Release(block);
+        if (held_count > 0 && rand() % 3 == 0)
+            block_Release(held[--held_count]);
+    }
+    return total;
+}
+
+static int test_read(vlc_object_t *obj, const char *url)
+{
+    stream_t *s = vlc_access_NewMRL(obj, url);
+    assert(s != NULL);
+
+    /* Unlike the file input, this one only reads blocks */
+    if (s->pf_block == NULL)
+    {
+        vlc_stream_Delete(s);
+        return 77; /* io_uring is not available */
+    }
+
+    uint64_t size;
+    assert(vlc_stream_GetSize(s, &size) == VLC_SUCCESS && size == SIZE);
+
+    /* Sequential, past the end */
+    assert(ReadAt(s, 0, SIZE + 100) == SIZE);
+
+    /* Random, including before and past the end */
+    for (unsigned i = 0; i < 2000; i++)
+    {
+        uint64_t offset = rand() % (SIZE + 10);
+        size_t length = rand() % 300000;
+        size_t expected = 0;
+
+        if (offset < SIZE)
+            expected = __MIN(SIZE - offset, length);
+        assert(ReadAt(s, offset, length) == expected);
+    }
+
+    /* The blocks outlive the input */
+    vlc_stream_Delete(s);
+    while (held_count > 0)
+        block_Release(held[--held_count]);
+    return 0;
+}
+
+int main(void)
+{
+    char path[] = "/tmp/vlc-test-uring-XXXXXX";
+    int fd = mkstemp(path);
+    if (fd == -1)
+        return 77;
+
+    data = malloc(SIZE);
+    assert(data != NULL);
+    srand(42);
+    for (size_t i = 0; i < SIZE; i++)
+        data[i] = rand();
+    assert(write(fd, data, SIZE) == SIZE);
+    close(fd);
+
+    char *url = vlc_path2uri(path, NULL);
+    assert(url != NULL);
+
+    test_init();
+
+    libvlc_instance_t *vlc = libvlc_new(test_defaults_nargs,
+                                        test_defaults_args);
+    assert(vlc != NULL);
+    vlc_object_t *obj = VLC_OBJECT(vlc->p_libvlc_int);
+
+    /* Small reads, to go through the buffers many times */
+    var_Create(obj, "uring", VLC_VAR_BOOL);
+    var_SetBool(obj, "uring", true);
+    var_Create(obj, "uring-block-size", VLC_VAR_INTEGER);
+    var_SetInteger(obj, "uring-block-size", 64);
+    var_Create(obj, "uring-direct", VLC_VAR_BOOL);
+
+    int ret = test_read(obj, url);
+    if (ret == 0)
+    {
+        /* Direct I/O, if the file system supports it */
+        var_SetBool(obj, "uring-direct", true);
+        ret = test_read(obj, url);
+    }
+
+    libvlc_release(vlc);
+    free(url);
+    free(data);
+    unlink(path);
+    return ret;
+}
@@ -0,0 +1,180 @@
+/*****************************************************************************
+ * mp4_tts.c: MP4 stts and ctts runs walking tests
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#undef NDEBUG
+
+#include <assert.h>
+
+#include <vlc_common.h>
+
+#include "../../../modules/demux/mp4/mp4.h"
+
+/* stts: 3 x 10, 1 x 20, 4 x 30, 2 x 40 */
+static const uint32_t stts_count[] = { 3, 1, 4, 2 };
+static const int32_t  stts_delta[] = { 10, 20, 30, 40 };
+/* ctts: 2 x -5, 5 x 7, 3 x 0, with a -5 shift (cslg) */
+static const uint32_t ctts_count[] = { 2, 5, 3 };
+static const int32_t  ctts_offset[] = { -5, 7, 0 };
+#define CTS_SHIFT 5
+
+#define SAMPLES 10
+/* chunks starting inside runs, spanning several, and ending on their end */
+static const uint32_t chunk_samples[] = { 2, 5, 1, 2 };
+#define CHUNKS ARRAY_SIZE(chunk_samples)
+
+static void Expand(const uint32_t *counts, const int32_t *values,
+                   size_t runs, int32_t *out)
+{
+    size_t n = 0;
+    for (size_t i = 0; i < runs; i++)
+        for (uint32_t j = 0; j < counts[i]; j++)
+            out[n++] = values[i];
+    assert(n == SAMPLES);
+}
+
+static void test_iter(const mp4_tts_t *tts)
+{
+    mp4_tts_iter_t it;
+    mp4_tts_pos_t pos = { 0, 0 };
+    int32_t value;
+
+    /* Walking stops on the sample count, even inside a run */
+    MP4_TTSIterInit(&it, tts, &pos, 2);
+    assert(MP4_TTSIterNext(&it, &value) == 2 && value == 10);
+    assert(MP4_TTSIterNext(&it, &value) == 0);
+    assert(it.pos.i_index == 0 && it.pos.i_skip == 2);
+
+    /* Then resumes there, across runs */
+    pos = it.pos;
+    MP4_TTSIterInit(&it, tts, &pos, 6);
+    assert(MP4_TTSIterNext(&it, &value) == 1 && value == 10);
+    assert(MP4_TTSIterNext(&it, &value) == 1 && value == 20);
+    assert(MP4_TTSIterNext(&it, &value) == 4 && value == 30);
+    assert(MP4_TTSIterNext(&it, &value) == 0);
+    assert(it.pos.i_index == 3 && it.pos.i_skip == 0);
+    assert(it.i_left == 0);
+
+    /* And stops at the end of the table */
+    pos = it.pos;
+    MP4_TTSIterInit(&it, tts, &pos, 5);
+    assert(MP4_TTSIterNext(&it, &value) == 2 && value == 40);
+    assert(MP4_TTSIterNext(&it, &value) == 0);
+    assert(it.i_left == 3);
+
+    /* Empty runs are skipped */
+    static const uint32_t counts[] = { 0, 2 };
+    static const int32_t values[] = { 1, 2 };
+    const mp4_tts_t holes = { counts, values, 2 };
+    pos = (mp4_tts_pos_t) { 0, 0 };
+    MP4_TTSIterInit(&it, &holes, &pos, 5);
+    assert(MP4_TTSIterNext(&it, &value) == 2 && value == 2);
+    assert(MP4_TTSIterNext(&it, &value) == 0);
+}
+
+static void test_chunks(mp4_track_t *track)
+{
+    int32_t deltas[SAMPLES], offsets[SAMPLES];
+    mp4_chunk_t chunks[CHUNKS];
+
+    Expand(stts_count, stts_delta, ARRAY_SIZE(stts_count), deltas);
+    Expand(ctts_count, ctts_offset, ARRAY_SIZE(ctts_count), offsets);
+
+    stime_t next_dts = 0;
+    uint32_t first = 0;
+    for (size_t i = 0; i < CHUNKS; i++)
+    {
+        chunks[i].i_sample_first = first;
+        chunks[i].i_sample_count = chunk_samples[i];
+        first += chunk_samples[i];
+    }
+    assert(first == SAMPLES);
+
+    track->chunk = chunks;
+    track->i_chunk_count = CHUNKS;
+    track->i_chunk_timed = 0;
+    track->i_first_dts = 0;
+
+    /* Indexed on demand, up to the requested chunk only */
+    MP4_TrackIndexChunks(track, 1);
+    assert(track->i_chunk_timed == 2);
+    MP4_TrackIndexChunks(track, 0);
+    assert(track->i_chunk_timed == 2);
+    /* and not past the last chunk */
+    MP4_TrackIndexChunks(track, CHUNKS + 10);
+    assert(track->i_chunk_timed == CHUNKS);
+
+    for (size_t i = 0; i < CHUNKS; i++)
+    {
+        const mp4_chunk_t *ck = &chunks[i];
+        stime_t duration = 0;
+
+        assert(ck->i_first_dts == (uint64_t)next_dts);
+        for (uint32_t j = 0; j < ck->i_sample_count; j++)
+            duration += deltas[ck->i_sample_first + j];
+        assert(ck->i_duration == (uint64_t)duration);
+        next_dts += duration;
+    }
+    assert(track->i_first_dts == (uint64_t)next_dts);
+
+    /* Every sample matches the expanded tables */
+    stime_t expected_dts = 0;
+    for (size_t i = 0; i < CHUNKS; i++)
+    {
+        const mp4_chunk_t *ck = &chunks[i];
+        for (uint32_t j = 0; j < ck->i_sample_count; j++)
+        {
+            const uint32_t sample = ck->i_sample_first + j;
+            stime_t delta;
+
+            assert(MP4_ChunkGetSampleDTS(track, ck, j) == expected_dts);
+            assert(MP4_ChunkGetSampleCTSDelta(track, ck, j, &delta));
+            assert(delta == offsets[sample] + CTS_SHIFT);
+
+            expected_dts += deltas[sample];
+        }
+        /* past the chunk samples */
+        stime_t delta;
+        assert(!MP4_ChunkGetSampleCTSDelta(track, ck, ck->i_sample_count, &delta));
+    }
+
+    /* Without ctts, there is no pts offset */
+    track->ctts = (mp4_tts_t) { NULL, NULL, 0 };
+    stime_t delta;
+    assert(!MP4_ChunkGetSampleCTSDelta(track, &chunks[0], 0, &delta));
+}
+
+int main(void)
+{
+    mp4_track_t *track = calloc(1, sizeof (*track));
+    assert(track != NULL);
+
+    track->stts = (mp4_tts_t) { stts_count, stts_delta, ARRAY_SIZE(stts_count) };
+    track->ctts = (mp4_tts_t) { ctts_count, ctts_offset, ARRAY_SIZE(ctts_count) };
+    track->i_cts_shift = CTS_SHIFT;
+
+    test_iter(&track->stts);
+    test_chunks(track);
+
+    free(track);
+    return 0;
+}
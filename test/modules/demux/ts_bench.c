@@ -0,0 +1,426 @@
+/*****************************************************************************
+ * ts_bench.c: TS demuxer ingest benchmark
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * Feeds a synthetic multi-program transport stream through the TS demuxer
+ * from memory, with each packet read configuration, and reports the
+ * packets demuxed per second:
+ *
+ *   test_modules_demux_ts_bench [-p programs] [-s MiB] [-r runs]
+ *
+ * All the programs are demuxed; the elementary streams are discarded.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include "../../libvlc/test.h"
+#include "../lib/libvlc_internal.h"
+
+#include <vlc_common.h>
+#include <vlc_demux.h>
+#include <vlc_es_out.h>
+#include <vlc_stream.h>
+#include <vlc_tick.h>
+
+#include <unistd.h>
+
+#define TS_SIZE 188
+#define PMT_PID(prog) (0x100 + (prog))
+#define VIDEO_PID(prog) (0x200 + 2 * (prog))
+#define AUDIO_PID(prog) (0x201 + 2 * (prog))
+
+static const struct
+{
+    const char *name;
+    const char *arg;
+} configs[] = {
+    { "per packet", "--ts-bulk-read=0" },
+    { "bulk",       "--ts-bulk-read=224" },
+};
+
+/*****************************************************************************
+ * Stream generation
+ *****************************************************************************/
+
+struct ts_writer
+{
+    uint8_t *buf;
+    size_t size;
+    size_t offset;
+    uint8_t cc[0x2000];
+};
+
+static uint32_t Crc32(const uint8_t *p, size_t len)
+{
+    uint32_t crc = 0xffffffff;
+
+    while (len--)
+    {
+        crc ^= (uint32_t)*p++ << 24;
+        for (int i = 0; i < 8; i++)
+            crc = (crc << 1) ^ ((crc & 0x80000000) ? 0x04c11db7 : 0);
+    }
+    return crc;
+}
+
+/* Writes one packet, with up to 184 bytes of payload */
+static size_t PutPacket(struct ts_writer *w, uint16_t pid, bool unit_start,
+                        const uint8_t *data, size_t len, int64_t pcr)
+{
+    uint8_t *p = &w->buf[w->offset];
+    size_t af_len = 0;
+
+    if (pcr >= 0)
+        af_len = 8;
+    if (len > TS_SIZE - 4 - af_len)
+        len = TS_SIZE - 4 - af_len;
+    if (len < TS_SIZE - 4 - af_len)
+        af_len = TS_SIZE - 4 - len;
+
+    p[0] = 0x47;
+    p[1] = (unit_start ? 0x40 : 0) | (pid >> 8);
+    p[2] = pid;
+    p[3] = (af_len ? 0x30 : 0x10) | w->cc[pid];
+    w->cc[pid] = (w->cc[pid] + 1) & 0xf;
+
+    uint8_t *payload = &p[4];
+    if (af_len)
+    {
+        payload[0] = af_len - 1;
+        if (af_len > 1)
+        {
+            memset(&payload[1], 0xff, af_len - 1);
+            payload[1] = 0;
+            if (pcr >= 0)
+            {
+                payload[1] = 0x10;
+                payload[2] = pcr >> 25;
+                payload[3] = pcr >> 17;
+                payload[4] = pcr >> 9;
+                payload[5] = pcr >> 1;
+                payload[6] = ((pcr & 1) << 7) | 0x7e;
+                payload[7] = 0;
+            }
+        }
+        payload += af_len;
+    }
+    memcpy(payload, data, len);
+
+    w->offset += TS_SIZE;
+    return len;
+}
+
+static void PutSection(struct ts_writer *w, uint16_t pid, uint8_t *section,
+                       size_t len)
+{
+    /* Pointer field, and the section length and CRC filled in */
+    section[0] = 0;
+    SetWBE(&section[2], 0xb000 | (len - 4 + 4));
+    SetDWBE(&section[len], Crc32(&section[1], len - 1));
+    PutPacket(w, pid, true, section, len + 4, -1);
+}
+
+static void PutTables(struct ts_writer *w, unsigned programs)
+{
+    uint8_t s[TS_SIZE];
+    size_t len = 9;
+
+    /* PAT */
+    s[1] = 0x00;
+    SetWBE(&s[4], 1);
+    s[6] = 0xc1; s[7] = 0; s[8] = 0;
+    for (unsigned i = 0; i < programs; i++, len += 4)
+    {
+        SetWBE(&s[len], i + 1);
+        SetWBE(&s[len + 2], 0xe000 | PMT_PID(i));
+    }
+    PutSection(w, 0, s, len);
+
+    /* PMTs: one MPEG-2 video and one MPEG audio stream each */
+    for (unsigned i = 0; i < programs; i++)
+    {
+        s[1] = 0x02;
+        SetWBE(&s[4], i + 1);
+        s[6] = 0xc1; s[7] = 0; s[8] = 0;
+        SetWBE(&s[9], 0xe000 | VIDEO_PID(i));
+        SetWBE(&s[11], 0xf000);
+        s[13] = 0x02;
+        SetWBE(&s[14], 0xe000 | VIDEO_PID(i));
+        SetWBE(&s[16], 0xf000);
+        s[18] = 0x03;
+        SetWBE(&s[19], 0xe000 | AUDIO_PID(i));
+        SetWBE(&s[21], 0xf000);
+        PutSection(w, PMT_PID(i), s, 23);
+    }
+}
+
+static void PutPES(struct ts_writer *w, uint16_t pid, uint8_t stream_id,
+                   int64_t pts, size_t size, int64_t pcr)
+{
+    uint8_t pes[TS_SIZE * 64];
+
+    assert(size + 14 <= sizeof (pes));
+    pes[0] = 0; pes[1] = 0; pes[2] = 1;
+    pes[3] = stream_id;
+    SetWBE(&pes[4], size + 8);
+    pes[6] = 0x80;
+    pes[7] = 0x80;
+    pes[8] = 5;
+    pes[9] = 0x21 | ((pts >> 29) & 0x0e);
+    SetWBE(&pes[10], ((pts >> 14) & 0xfffe) | 1);
+    SetWBE(&pes[12], ((pts << 1) & 0xfffe) | 1);
+    for (size_t i = 0; i < size; i++)
+        pes[14 + i] = i;
+
+    size_t len = size + 14;
+    const uint8_t *p = pes;
+    bool start = true;
+
+    while (len > 0 && w->offset + TS_SIZE <= w->size)
+    {
+        size_t done = PutPacket(w, pid, start, p, len, start ? pcr : -1);
+        p += done;
+        len -= done;
+        start = false;
+    }
+}
+
+static void Generate(struct ts_writer *w, unsigned programs)
+{
+    /* 25 fps video of 40 packets per frame, and 4 packets of audio */
+    const int64_t frame = 90000 / 25;
+    int64_t pts = 90000;
+
+    for (unsigned n = 0; w->offset + TS_SIZE * (programs + 1) <= w->size; n++)
+    {
+        if (n % 10 == 0)
+            PutTables(w, programs);
+
+        for (unsigned i = 0; i < programs; i++)
+        {
+            PutPES(w, VIDEO_PID(i), 0xe0, pts, 40 * 184 - 14,
+                   (pts - 9000) * 300);
+            PutPES(w, AUDIO_PID(i), 0xc0, pts, 4 * 184 - 14, -1);
+        }
+        pts += frame;
+    }
+
+    /* Pad the end with null packets */
+    while (w->offset + TS_SIZE <= w->size)
+        PutPacket(w, 0x1fff, false, NULL, 0, -1);
+}
+
+/*****************************************************************************
+ * ES output: counts and discards
+ *****************************************************************************/
+
+struct bench_es_out
+{
+    es_out_t out;
+    uint64_t bytes;
+};
+
+static es_out_id_t *EsOutAdd(es_out_t *out, input_source_t *in,
+                             const es_format_t *fmt)
+{
+    (void) out; (void) in; (void) fmt;
+    /* Any non-NULL unique pointer will do */
+    return malloc(1);
+}
+
+static int EsOutSend(es_out_t *out, es_out_id_t *id, block_t *block)
+{
+    struct bench_es_out *ctx = container_of(out, struct bench_es_out, out);
+
+    (void) id;
+    for (block_t *b = block; b != NULL; b = b->p_next)
+        ctx->bytes += b->i_buffer;
+    block_ChainRelease(block);
+    return VLC_SUCCESS;
+}
+
+static void EsOutDel(es_out_t *out, es_out_id_t *id)
+{
+    (void) out;
+    free(id);
+}
+
+static int EsOutControl(es_out_t *out, input_source_t *in, int query,
+                        va_list args)
+{
+    (void) out; (void) in;
+
+    switch (query)
+    {
+        case ES_OUT_GET_ES_STATE:
+            va_arg(args, es_out_id_t *);
+            *va_arg(args, bool *) = true;
+            return VLC_SUCCESS;
+        case ES_OUT_GET_EMPTY:
+            *va_arg(args, bool *) = true;
+            return VLC_SUCCESS;
+        case ES_OUT_SET_ES:
+        case ES_OUT_SET_ES_DEFAULT:
+        case ES_OUT_SET_ES_STATE:
+        case ES_OUT_SET_ES_CAT_POLICY:
+        case ES_OUT_SET_GROUP:
+        case ES_OUT_SET_PCR:
+        case ES_OUT_SET_GROUP_PCR:
+        case ES_OUT_RESET_PCR:
+        case ES_OUT_SET_ES_FMT:
+        case ES_OUT_SET_NEXT_DISPLAY_TIME:
+        case ES_OUT_SET_GROUP_META:
+        case ES_OUT_SET_GROUP_EPG:
+        case ES_OUT_SET_GROUP_EPG_EVENT:
+        case ES_OUT_SET_EPG_TIME:
+        case ES_OUT_DEL_GROUP:
+        case ES_OUT_SET_ES_SCRAMBLED_STATE:
+        case ES_OUT_SET_META:
+            return VLC_SUCCESS;
+        default:
+            return VLC_EGENERIC;
+    }
+}
+
+static void EsOutDestroy(es_out_t *out)
+{
+    (void) out;
+}
+
+static const struct es_out_callbacks es_out_cbs =
+{
+    .add = EsOutAdd,
+    .send = EsOutSend,
+    .del = EsOutDel,
+    .control = EsOutControl,
+    .destroy = EsOutDestroy,
+};
+
+/*****************************************************************************
+ * Benchmark
+ *****************************************************************************/
+
+static uint64_t Run(libvlc_instance_t *vlc, uint8_t *buf, size_t size)
+{
+    vlc_object_t *obj = VLC_OBJECT(vlc->p_libvlc_int);
+    struct bench_es_out out = { .out = { .cbs = &es_out_cbs }, .bytes = 0 };
+
+    stream_t *s = vlc_stream_MemoryNew(obj, buf, size, true);
+    assert(s != NULL);
+
+    demux_t *demux = demux_New(obj, "ts", "vlc://nop", s, &out.out);
+    assert(demux != NULL);
+
+    /* Demux every program, not only the first one */
+    demux_Control(demux, DEMUX_SET_GROUP_ALL);
+
+    while (demux_Demux(demux) == VLC_DEMUXER_SUCCESS);
+
+    demux_Delete(demux);
+    vlc_stream_Delete(s);
+    return out.bytes;
+}
+
+int main(int argc, char **argv)
+{
+    unsigned programs = 8;
+    size_t size = 256;
+    unsigned runs = 3;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "p:s:r:")) != -1)
+    {
+        switch (opt)
+        {
+            case 'p':
+                programs = atoi(optarg);
+                break;
+            case 's':
+                size = strtoul(optarg, NULL, 10);
+                break;
+            case 'r':
+                runs = atoi(optarg);
+                break;
+            default:
+                fprintf(stderr, "usage: %s [-p programs] [-s MiB]"
+                        " [-r runs]\n", argv[0]);
+                return 1;
+        }
+    }
+    if (programs == 0 || programs > 40 || size == 0 || runs == 0)
+        return 1;
+
+    test_init();
+    alarm(0);
+
+    struct ts_writer *w = calloc(1, sizeof (*w));
+    assert(w != NULL);
+    w->size = (size << 20) / TS_SIZE * TS_SIZE;
+    w->buf = malloc(w->size);
+    assert(w->buf != NULL);
+
+    test_log("Generating %zu MiB of TS with %u programs...\n", size,
+             programs);
+    Generate(w, programs);
+
+    const double packets = w->size / TS_SIZE;
+    uint64_t expected = 0;
+
+    printf("%-12s %14s %10s %14s\n", "reads", "packets/s", "MiB/s",
+           "ES bytes");
+
+    for (size_t c = 0; c < ARRAY_SIZE(configs); c++)
+    {
+        const char *args[] = {
+            "--ignore-config", "-I", "dummy", "--no-media-library",
+            configs[c].arg,
+        };
+        libvlc_instance_t *vlc = libvlc_new(ARRAY_SIZE(args), args);
+        assert(vlc != NULL);
+
+        vlc_tick_t best = INT64_MAX;
+        uint64_t bytes = 0;
+
+        for (unsigned r = 0; r < runs; r++)
+        {
+            vlc_tick_t start = vlc_tick_now();
+            bytes = Run(vlc, w->buf, w->size);
+            vlc_tick_t elapsed = vlc_tick_now() - start;
+            if (elapsed < best)
+                best = elapsed;
+        }
+
+        /* Every configuration must output the same elementary streams */
+        if (c == 0)
+            expected = bytes;
+        assert(bytes == expected);
+
+        const double seconds = secf_from_vlc_tick(best);
+        printf("%-12s %14.0f %10.1f %14"PRIu64"\n", configs[c].name,
+               packets / seconds, w->size / seconds / (1 << 20), bytes);
+        libvlc_release(vlc);
+    }
+
+    free(w->buf);
+    free(w);
+    return 0;
+}
@@ -0,0 +1,299 @@
+/*****************************************************************************
+ * ts_index.c: Transport Stream seek index tests
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#undef NDEBUG
+
+#include <assert.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utime.h>
+
+#include <vlc_common.h>
+#include <vlc_configuration.h>
+#include <vlc_fs.h>
+
+#include "../../../modules/demux/mpeg/timestamps.h"
+#include "../../../modules/demux/mpeg/ts_index.h"
+
+#include "../../libvlc/test.h"
+#include "../../../lib/libvlc_internal.h"
+
+const char vlc_module_name[] = "test_ts_index";
+
+#define URL     "file:///test.ts"
+#define SIZE    (INT64_C(1) << 30)
+#define SPACING TO_SCALE_NZ(VLC_TICK_FROM_MS(400))
+
+static uint8_t peek[4096];
+static char *index_dir;
+
+static ts_index_t *Open(vlc_object_t *obj, uint64_t size)
+{
+    ts_index_t *index = ts_index_New(obj, URL, size, peek, sizeof (peek));
+    assert(index != NULL);
+    return index;
+}
+
+/* Returns the number of indexes in the cache, and the path of one */
+static unsigned ListCache(char **path)
+{
+    unsigned count = 0;
+    DIR *dir = vlc_opendir(index_dir);
+    if (dir == NULL)
+        return 0;
+
+    const char *name;
+    while ((name = vlc_readdir(dir)) != NULL)
+    {
+        if (name[0] == '.')
+            continue;
+        if (path != NULL && count == 0)
+            assert(asprintf(path, "%s/%s", index_dir, name) != -1);
+        count++;
+    }
+    closedir(dir);
+    return count;
+}
+
+static void AssertFilled(const ts_index_t *index)
+{
+    const ts_index_entry_t *entry, *next;
+
+    entry = ts_index_Find(index, 1, SPACING + SPACING / 2, &next);
+    assert(entry != NULL && entry->i_pcr == SPACING && entry->i_pos == 1880);
+    assert(next != NULL && next->i_pcr == 3 * SPACING && next->i_pos == 5640);
+
+    /* before the first entry */
+    entry = ts_index_Find(index, 1, -1, &next);
+    assert(entry == NULL && next != NULL && next->i_pos == 188);
+
+    /* after the last entry */
+    entry = ts_index_Find(index, 1, 10 * SPACING, &next);
+    assert(entry != NULL && entry->i_pos == 5640 && next == NULL);
+
+    entry = ts_index_Find(index, 2, 0, &next);
+    assert(entry == NULL && next == NULL);
+
+    ts_index_bounds_t bounds;
+    assert(ts_index_GetBounds(index, 1, &bounds));
+    assert(bounds.i_first == 42 && bounds.i_last_dts_byte == SIZE - 188);
+    assert(!ts_index_GetBounds(index, 2, &bounds));
+}
+
+static void AssertEmpty(const ts_index_t *index)
+{
+    const ts_index_entry_t *next;
+    ts_index_bounds_t bounds;
+
+    assert(ts_index_Find(index, 1, SPACING, &next) == NULL && next == NULL);
+    assert(!ts_index_GetBounds(index, 1, &bounds));
+}
+
+static void test_add_find(vlc_object_t *obj)
+{
+    ts_index_t *index = Open(obj, SIZE);
+    AssertEmpty(index);
+
+    ts_index_Add(index, 1, 0, 188);
+    ts_index_Add(index, 1, 3 * SPACING, 5640);
+    /* inserted between, by position */
+    ts_index_Add(index, 1, SPACING, 1880);
+    /* too close to its neighbours */
+    ts_index_Add(index, 1, SPACING + 1, 2068);
+    ts_index_Add(index, 1, 3 * SPACING - 1, 5452);
+    /* same position */
+    ts_index_Add(index, 1, 2 * SPACING, 1880);
+
+    const ts_index_bounds_t bounds = {
+        .i_first = 42, .i_first_dts = 43,
+        .i_last_dts = 44, .i_last_dts_byte = SIZE - 188,
+    };
+    ts_index_SetBounds(index, 1, &bounds);
+
+    AssertFilled(index);
+    ts_index_Delete(obj, index);
+    assert(ListCache(NULL) == 1);
+}
+
+static void test_load(vlc_object_t *obj)
+{
+    /* Same file */
+    ts_index_t *index = Open(obj, SIZE);
+    AssertFilled(index);
+    ts_index_Delete(obj, index);
+
+    /* Another file */
+    index = Open(obj, SIZE + 188);
+    AssertEmpty(index);
+    ts_index_Delete(obj, index);
+    assert(ListCache(NULL) == 1);
+}
+
+static void test_corrupt(vlc_object_t *obj)
+{
+    char *path;
+    struct stat st;
+
+    assert(ListCache(&path) == 1);
+    assert(stat(path, &st) == 0);
+
+    /* Truncated in the entries, then in the header */
+    const off_t sizes[] = { st.st_size - 1, st.st_size / 2, 10, 0 };
+    for (size_t i = 0; i < ARRAY_SIZE(sizes); i++)
+    {
+        assert(truncate(path, sizes[i]) == 0);
+        ts_index_t *index = Open(obj, SIZE);
+        AssertEmpty(index);
+        ts_index_Delete(obj, index);
+    }
+
+    /* Garbage */
+    FILE *file = fopen(path, "wb");
+    assert(file != NULL);
+    for (unsigned i = 0; i < 1000; i++)
+        fputc(i * 7, file);
+    fclose(file);
+
+    ts_index_t *index = Open(obj, SIZE);
+    AssertEmpty(index);
+    ts_index_Delete(obj, index);
+
+    /* Rebuilt and overwritten */
+    test_add_find(obj);
+    index = Open(obj, SIZE);
+    AssertFilled(index);
+    ts_index_Delete(obj, index);
+
+    free(path);
+}
+
+static void test_prune(vlc_object_t *obj)
+{
+    const time_t now = time(NULL);
+
+    /* Stale indexes, one out of age, the others older than the current */
+    for (unsigned i = 0; i < TS_INDEX_CACHE_MAX_FILES + 10; i++)
+    {
+        char *path;
+        assert(asprintf(&path, "%s/stale%03u", index_dir, i) != -1);
+        FILE *file = fopen(path, "wb");
+        assert(file != NULL);
+        fclose(file);
+
+        time_t mtime = now - 3600 - i;
+        if (i == 0)
+            mtime = now - TS_INDEX_CACHE_MAX_AGE - 3600;
+        const struct utimbuf times = { mtime, mtime };
+        assert(utime(path, &times) == 0);
+        free(path);
+    }
+
+    /* Pruned when saving */
+    ts_index_t *index = Open(obj, SIZE + 2 * 188);
+    ts_index_Add(index, 1, 0, 188);
+    ts_index_Delete(obj, index);
+    assert(ListCache(NULL) == TS_INDEX_CACHE_MAX_FILES);
+
+    /* Dropped the out of age and oldest ones, kept the recent ones */
+    char *path;
+    struct stat st;
+    assert(asprintf(&path, "%s/stale%03u", index_dir, 0) != -1);
+    assert(stat(path, &st) != 0);
+    free(path);
+    assert(asprintf(&path, "%s/stale%03u", index_dir,
+                    TS_INDEX_CACHE_MAX_FILES + 9) != -1);
+    assert(stat(path, &st) != 0);
+    free(path);
+    assert(asprintf(&path, "%s/stale%03u", index_dir, 1) != -1);
+    assert(stat(path, &st) == 0);
+    free(path);
+
+    index = Open(obj, SIZE + 2 * 188);
+    const ts_index_entry_t *next;
+    assert(ts_index_Find(index, 1, 0, &next) != NULL);
+    ts_index_Delete(obj, index);
+    index = Open(obj, SIZE);
+    AssertFilled(index);
+    ts_index_Delete(obj, index);
+}
+
+static void Cleanup(void)
+{
+    DIR *dir = vlc_opendir(index_dir);
+    if (dir != NULL)
+    {
+        const char *name;
+        while ((name = vlc_readdir(dir)) != NULL)
+        {
+            char *path;
+            if (name[0] == '.' ||
+                asprintf(&path, "%s/%s", index_dir, name) == -1)
+                continue;
+            unlink(path);
+            free(path);
+        }
+        closedir(dir);
+    }
+    rmdir(index_dir);
+}
+
+int main(void)
+{
+    char tmpdir[] = "/tmp/vlc-test-ts-index-XXXXXX";
+    if (mkdtemp(tmpdir) == NULL)
+        return 77;
+    setenv("XDG_CACHE_HOME", tmpdir, 1);
+
+    test_init();
+
+    libvlc_instance_t *vlc = libvlc_new(test_defaults_nargs,
+                                        test_defaults_args);
+    assert(vlc != NULL);
+    vlc_object_t *obj = VLC_OBJECT(vlc->p_libvlc_int);
+
+    char *cachedir = config_GetUserDir(VLC_CACHE_DIR);
+    assert(cachedir != NULL);
+    int ret = 77; /* the cache is not under XDG_CACHE_HOME */
+    if (!strncmp(cachedir, tmpdir, strlen(tmpdir)))
+    {
+        assert(asprintf(&index_dir, "%s/ts-index", cachedir) != -1);
+        for (size_t i = 0; i < sizeof (peek); i++)
+            peek[i] = i;
+
+        test_add_find(obj);
+        test_load(obj);
+        test_corrupt(obj);
+        test_prune(obj);
+
+        Cleanup();
+        free(index_dir);
+        ret = 0;
+    }
+
+    rmdir(cachedir);
+    free(cachedir);
+    rmdir(tmpdir);
+    libvlc_release(vlc);
+    return ret;
+}
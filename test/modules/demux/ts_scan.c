@@ -0,0 +1,149 @@
+/*****************************************************************************
+ * ts_scan.c: TS packet header scanner tests
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <vlc_common.h>
+#include <vlc_cpu.h>
+
+#include "../../../modules/demux/mpeg/ts_scan.h"
+
+#include "../../libvlc/test.h"
+
+#define COUNT 67 /* not a multiple of any vector width */
+
+#ifdef TS_SCAN_SSE2
+static bool HasSSE2(void) { return vlc_CPU_SSE2(); }
+#endif
+#ifdef TS_SCAN_AVX2
+static bool HasAVX2(void) { return vlc_CPU_AVX2(); }
+#endif
+#ifdef TS_SCAN_NEON
+static bool HasNEON(void) { return vlc_CPU_ARM_NEON(); }
+#endif
+static bool HasC(void) { return true; }
+
+static const struct
+{
+    const char *name;
+    ts_scan_packets_fn scan;
+    bool (*available)(void);
+} scanners[] = {
+#ifdef TS_SCAN_SSE2
+    { "SSE2", ts_scan_packets_sse2, HasSSE2 },
+#endif
+#ifdef TS_SCAN_AVX2
+    { "AVX2", ts_scan_packets_avx2, HasAVX2 },
+#endif
+#ifdef TS_SCAN_NEON
+    { "NEON", ts_scan_packets_neon, HasNEON },
+#endif
+    { "C", ts_scan_packets_c, HasC },
+};
+
+static void Fill(uint8_t *buf, size_t stride)
+{
+    for (size_t i = 0; i < COUNT * stride; i++)
+        buf[i] = rand();
+    for (size_t i = 0; i < COUNT; i++)
+        buf[i * stride] = 0x47;
+}
+
+static int Check(const uint8_t *buf, size_t stride, size_t count,
+                 size_t expected)
+{
+    uint16_t pids[COUNT];
+
+    for (size_t i = 0; i < ARRAY_SIZE(scanners); i++)
+    {
+        if (!scanners[i].available())
+            continue;
+
+        memset(pids, 0xff, sizeof (pids));
+        size_t n = scanners[i].scan(buf, stride, count, pids);
+        if (n != expected)
+        {
+            fprintf(stderr, "%s: stride %zu, %zu packets: %zu in sync, "
+                    "expected %zu\n", scanners[i].name, stride, count, n,
+                    expected);
+            return 1;
+        }
+
+        for (size_t j = 0; j < n; j++)
+        {
+            const uint8_t *p = &buf[j * stride];
+            unsigned pid = ((p[1] & 0x1f) << 8) | p[2];
+            if (pids[j] != pid)
+            {
+                fprintf(stderr, "%s: stride %zu, packet %zu: PID %u, "
+                        "expected %u\n", scanners[i].name, stride, j,
+                        pids[j], pid);
+                return 1;
+            }
+        }
+        for (size_t j = count; j < COUNT; j++)
+            if (pids[j] != 0xffff)
+            {
+                fprintf(stderr, "%s: wrote past %zu packets\n",
+                        scanners[i].name, count);
+                return 1;
+            }
+    }
+    return 0;
+}
+
+int main(void)
+{
+    static const size_t strides[] = { 188, 192, 204 };
+    static uint8_t buf[COUNT * 204];
+
+    test_init();
+    srand(0);
+
+    for (size_t s = 0; s < ARRAY_SIZE(strides); s++)
+    {
+        const size_t stride = strides[s];
+
+        /* All in sync, any count */
+        Fill(buf, stride);
+        for (size_t count = 0; count <= COUNT; count++)
+            if (Check(buf, stride, count, count))
+                return 1;
+
+        /* Sync lost at every position */
+        for (size_t bad = 0; bad < COUNT; bad++)
+        {
+            Fill(buf, stride);
+            buf[bad * stride] ^= 1 << (rand() % 8);
+            if (Check(buf, stride, COUNT, bad))
+                return 1;
+        }
+
+        /* Only the first bad packet counts */
+        Fill(buf, stride);
+        buf[9 * stride] = 0;
+        buf[3 * stride] = 0xb8;
+        if (Check(buf, stride, COUNT, 3))
+            return 1;
+    }
+
+    return 0;
+}
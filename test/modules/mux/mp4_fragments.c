@@ -0,0 +1,446 @@
+/*****************************************************************************
+ * mp4_fragments.c: mp4 fragments and chunks boundaries tests
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#undef NDEBUG
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <vlc_common.h>
+#include <vlc_block.h>
+#include <vlc_fs.h>
+#include <vlc_sout.h>
+
+#include "../../libvlc/test.h"
+#include "../../../lib/libvlc_internal.h"
+
+#define FRAME_LENGTH VLC_TICK_FROM_MS(40)
+#define FRAMES       500 /* 20s */
+#define TIMESCALE    90000 /* of the 25fps video track */
+#define FRAME_TICKS  (TIMESCALE / 25)
+#define MAX_WRITES   (4 * FRAMES)
+#define MAX_MOOFS    FRAMES
+
+/* What the muxer wrote, block by block */
+static struct
+{
+    uint8_t *data;
+    size_t size;
+    struct
+    {
+        size_t offset;
+        uint32_t flags;
+    } writes[MAX_WRITES];
+    size_t count;
+} out;
+
+struct moof
+{
+    uint64_t time;
+    uint32_t samples;
+    bool fragment_start;
+};
+
+static ssize_t CaptureWrite(sout_access_out_t *access, block_t *chain)
+{
+    ssize_t total = 0;
+    (void) access;
+
+    for (block_t *block = chain; block != NULL; block = block->p_next)
+    {
+        assert(out.count < MAX_WRITES);
+        out.writes[out.count].offset = out.size;
+        out.writes[out.count].flags = block->i_flags;
+        out.count++;
+
+        out.data = realloc(out.data, out.size + block->i_buffer);
+        assert(out.data != NULL);
+        memcpy(&out.data[out.size], block->p_buffer, block->i_buffer);
+        out.size += block->i_buffer;
+        total += block->i_buffer;
+    }
+    block_ChainRelease(chain);
+    return total;
+}
+
+static const uint8_t *FindBox(const uint8_t *p, size_t size, const char *type,
+                              size_t *box_size)
+{
+    while (size >= 8)
+    {
+        uint32_t len = GetDWBE(p);
+        assert(len >= 8 && len <= size);
+        if (!memcmp(&p[4], type, 4))
+        {
+            *box_size = len;
+            return p;
+        }
+        p += len;
+        size -= len;
+    }
+    return NULL;
+}
+
+/* Returns the flags of the write starting at the offset */
+static uint32_t GetWriteFlags(size_t offset)
+{
+    for (size_t i = 0; i < out.count; i++)
+        if (out.writes[i].offset == offset)
+            return out.writes[i].flags;
+    assert(!"box not written on its own");
+    return 0;
+}
+
+static void ParseMoof(const uint8_t *moof, size_t size, struct moof *entry)
+{
+    size_t traf_size, box_size;
+    const uint8_t *traf = FindBox(&moof[8], size - 8, "traf", &traf_size);
+    assert(traf != NULL);
+    traf += 8;
+    traf_size -= 8;
+
+    /* CMAF requires the moof as base offset */
+    const uint8_t *tfhd = FindBox(traf, traf_size, "tfhd", &box_size);
+    assert(tfhd != NULL && (GetDWBE(&tfhd[8]) & 0x020000));
+
+    const uint8_t *tfdt = FindBox(traf, traf_size, "tfdt", &box_size);
+    assert(tfdt != NULL && tfdt[8] == 1);
+    entry->time = GetQWBE(&tfdt[12]);
+
+    const uint8_t *trun = FindBox(traf, traf_size, "trun", &box_size);
+    assert(trun != NULL && (GetDWBE(&trun[8]) & 0x1));
+    entry->samples = GetDWBE(&trun[12]);
+    /* the data follows the mdat header */
+    assert(GetDWBE(&trun[16]) == size + 8);
+}
+
+/* Returns the moofs written, checking the boxes layout on the way */
+static size_t Parse(struct moof *moofs)
+{
+    const uint8_t *p = out.data;
+    size_t left = out.size;
+    size_t count = 0;
+
+    /* The header is written at once, for the HTTP outputs */
+    assert(left >= 16 && !memcmp(&p[4], "ftyp", 4) && !memcmp(&p[8], "cmfc", 4));
+    assert(GetWriteFlags(0) & BLOCK_FLAG_HEADER);
+    size_t size = GetDWBE(p);
+    assert(left > size + 8 && !memcmp(&p[size + 4], "moov", 4));
+    size += GetDWBE(&p[size]);
+    p += size;
+    left -= size;
+
+    while (left > 0)
+    {
+        assert(left >= 8 && !memcmp(&p[4], "moof", 4));
+        size = GetDWBE(p);
+        assert(count < MAX_MOOFS);
+        struct moof *moof = &moofs[count++];
+        ParseMoof(p, size, moof);
+        moof->fragment_start = GetWriteFlags(p - out.data) & BLOCK_FLAG_TYPE_I;
+        p += size;
+        left -= size;
+
+        assert(left >= 8 && !memcmp(&p[4], "mdat", 4));
+        size = GetDWBE(p);
+        assert(size <= left);
+        p += size;
+        left -= size;
+    }
+
+    /* The moofs follow each other and hold all the frames */
+    uint64_t time = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        assert(moofs[i].time == time);
+        assert(moofs[i].samples > 0);
+        time += (uint64_t)moofs[i].samples * FRAME_TICKS;
+    }
+    assert(time == (uint64_t)FRAMES * FRAME_TICKS);
+    return count;
+}
+
+static void Send(sout_mux_t *mux, sout_input_t *input, unsigned gop)
+{
+    for (unsigned i = 0; i < FRAMES; i++)
+    {
+        block_t *block = block_Alloc(100 + i % 7);
+        assert(block != NULL);
+        memset(block->p_buffer, i, block->i_buffer);
+        block->i_dts = block->i_pts = VLC_TICK_0 + i * FRAME_LENGTH;
+        block->i_length = FRAME_LENGTH;
+        block->i_flags = (gop && i % gop == 0) ? BLOCK_FLAG_TYPE_I
+                                               : BLOCK_FLAG_TYPE_P;
+        assert(sout_MuxSendBuffer(mux, input, block) == VLC_SUCCESS);
+    }
+}
+
+static void InitVideo(es_format_t *fmt)
+{
+    es_format_Init(fmt, VIDEO_ES, VLC_CODEC_MP4V);
+    fmt->video.i_width = fmt->video.i_visible_width = 320;
+    fmt->video.i_height = fmt->video.i_visible_height = 240;
+    fmt->video.i_frame_rate = 25;
+    fmt->video.i_frame_rate_base = 1;
+}
+
+/* Muxes FRAMES frames of 40ms, with a keyframe every gop frames, or none
+ * if gop is 0, then returns the moofs written */
+static size_t Run(sout_access_out_t *access, const char *chain, unsigned gop,
+                  struct moof *moofs)
+{
+    out.size = out.count = 0;
+
+    sout_mux_t *mux = sout_MuxNew(access, chain);
+    assert(mux != NULL);
+
+    es_format_t fmt;
+    InitVideo(&fmt);
+    sout_input_t *input = sout_MuxAddStream(mux, &fmt);
+    assert(input != NULL);
+
+    Send(mux, input, gop);
+
+    sout_MuxDeleteStream(mux, input);
+    sout_MuxDelete(mux);
+    es_format_Clean(&fmt);
+
+    return Parse(moofs);
+}
+
+static void test_unchunked(sout_access_out_t *access)
+{
+    struct moof moofs[MAX_MOOFS];
+
+    /* Keyframes every 400ms: fragments are cut on the last one within 1s */
+    size_t count = Run(access, "cmaf{frag-duration=1000}", 10, moofs);
+    for (size_t i = 0; i < count; i++)
+    {
+        assert(moofs[i].fragment_start);
+        assert(moofs[i].time % (10 * FRAME_TICKS) == 0);
+        if (i < count - 1)
+            assert(moofs[i].samples == 20);
+    }
+}
+
+static void test_chunked(sout_access_out_t *access)
+{
+    struct moof moofs[MAX_MOOFS];
+
+    /* Keyframes every 2s: fragments start on each of them */
+    size_t count = Run(access, "cmaf{frag-duration=1000,chunk-duration=200}",
+                       50, moofs);
+    unsigned fragments = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        assert(moofs[i].samples <= 5);
+        bool keyframe = moofs[i].time % (50 * FRAME_TICKS) == 0;
+        assert(moofs[i].fragment_start == keyframe);
+        fragments += moofs[i].fragment_start;
+    }
+    assert(fragments == FRAMES / 50);
+
+    /* Without keyframes, fragments are cut on duration */
+    count = Run(access, "cmaf{frag-duration=1000,chunk-duration=200}",
+                0, moofs);
+    fragments = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        assert(moofs[i].samples <= 5);
+        if (moofs[i].fragment_start)
+        {
+            assert(moofs[i].time % (25 * FRAME_TICKS) == 0);
+            fragments++;
+        }
+    }
+    assert(fragments == FRAMES / 25);
+}
+
+static void test_tracks(sout_access_out_t *access)
+{
+    out.size = out.count = 0;
+
+    sout_mux_t *mux = sout_MuxNew(access, "cmaf");
+    assert(mux != NULL);
+
+    es_format_t video, audio;
+    InitVideo(&video);
+    es_format_Init(&audio, AUDIO_ES, VLC_CODEC_MP4A);
+    audio.audio.i_rate = 48000;
+    audio.audio.i_channels = 2;
+
+    sout_input_t *input = sout_MuxAddStream(mux, &video);
+    assert(input != NULL);
+
+    /* A second track fails the whole output, not only that track */
+    assert(sout_MuxAddStream(mux, &audio) == NULL);
+    block_t *block = block_Alloc(100);
+    assert(block != NULL);
+    block->i_dts = block->i_pts = VLC_TICK_0;
+    block->i_flags = BLOCK_FLAG_TYPE_I;
+    assert(sout_MuxSendBuffer(mux, input, block) != VLC_SUCCESS);
+
+    sout_MuxDeleteStream(mux, input);
+    sout_MuxDelete(mux);
+    es_format_Clean(&video);
+    es_format_Clean(&audio);
+}
+
+static void test_livehttp(vlc_object_t *obj)
+{
+    char dir[] = "/tmp/vlc-test-mp4-fragments-XXXXXX";
+    if (mkdtemp(dir) == NULL)
+        return;
+
+    char *access_chain, *path;
+    assert(asprintf(&access_chain, "livehttp{seglen=2,index=%s/index.m3u8,"
+                    "index-url=seg-###.m4s}", dir) != -1);
+    assert(asprintf(&path, "%s/seg-###.m4s", dir) != -1);
+
+    sout_access_out_t *access = sout_AccessOutNew(obj, access_chain, path);
+    free(access_chain);
+    free(path);
+    if (access == NULL) /* not built */
+    {
+        rmdir(dir);
+        return;
+    }
+
+    sout_mux_t *mux = sout_MuxNew(access,
+                                  "cmaf{frag-duration=1000,chunk-duration=200}");
+    assert(mux != NULL);
+    es_format_t fmt;
+    InitVideo(&fmt);
+    sout_input_t *input = sout_MuxAddStream(mux, &fmt);
+    assert(input != NULL);
+
+    Send(mux, input, 50);
+
+    sout_MuxDeleteStream(mux, input);
+    sout_MuxDelete(mux);
+    sout_AccessOutDelete(access);
+    es_format_Clean(&fmt);
+
+    /* The playlist references the init segment, then the segments */
+    assert(asprintf(&path, "%s/index.m3u8", dir) != -1);
+    FILE *index = vlc_fopen(path, "rt");
+    assert(index != NULL);
+    free(path);
+
+    char *line = NULL;
+    size_t line_size = 0;
+    bool version = false, map = false;
+    double duration = 0.;
+    unsigned segments = 0;
+    while (getline(&line, &line_size, index) != -1)
+    {
+        line[strcspn(line, "\n")] = '\0';
+        if (!strcmp(line, "#EXT-X-VERSION:6"))
+            version = true;
+        else if (!strcmp(line, "#EXT-X-MAP:URI=\"seg-init.m4s\""))
+            map = true;
+        else if (!strncmp(line, "#EXTINF:", 8))
+            duration += atof(&line[8]);
+        else if (line[0] != '#' && line[0] != '\0')
+        {
+            /* Each segment starts a fragment, on a keyframe */
+            uint8_t buf[256];
+            assert(asprintf(&path, "%s/%s", dir, line) != -1);
+            FILE *segment = vlc_fopen(path, "rb");
+            assert(segment != NULL);
+            size_t size = fread(buf, 1, sizeof (buf), segment);
+            fclose(segment);
+            free(path);
+
+            struct moof moof;
+            assert(size >= 8 && !memcmp(&buf[4], "moof", 4));
+            assert(GetDWBE(buf) <= size);
+            ParseMoof(buf, GetDWBE(buf), &moof);
+            assert(moof.time % (50 * FRAME_TICKS) == 0);
+            segments++;
+        }
+    }
+    free(line);
+    fclose(index);
+    assert(version && map);
+    assert(segments > 1);
+    assert(duration > 19.9 && duration < 20.1);
+
+    /* The init segment only holds the header */
+    assert(asprintf(&path, "%s/seg-init.m4s", dir) != -1);
+    FILE *init = vlc_fopen(path, "rb");
+    assert(init != NULL);
+    free(path);
+    uint8_t buf[8];
+    assert(fread(buf, 1, sizeof (buf), init) == sizeof (buf));
+    assert(!memcmp(&buf[4], "ftyp", 4));
+    assert(fseek(init, GetDWBE(buf), SEEK_SET) == 0);
+    assert(fread(buf, 1, sizeof (buf), init) == sizeof (buf));
+    assert(!memcmp(&buf[4], "moov", 4));
+    assert(fseek(init, GetDWBE(buf) - 8, SEEK_CUR) == 0);
+    assert(fread(buf, 1, 1, init) == 0);
+    fclose(init);
+
+    DIR *d = vlc_opendir(dir);
+    assert(d != NULL);
+    const char *name;
+    while ((name = vlc_readdir(d)) != NULL)
+    {
+        if (name[0] == '.' || asprintf(&path, "%s/%s", dir, name) == -1)
+            continue;
+        unlink(path);
+        free(path);
+    }
+    closedir(d);
+    rmdir(dir);
+}
+
+int main(void)
+{
+    test_init();
+
+    libvlc_instance_t *vlc = libvlc_new(test_defaults_nargs,
+                                        test_defaults_args);
+    assert(vlc != NULL);
+    vlc_object_t *obj = VLC_OBJECT(vlc->p_libvlc_int);
+
+    /* Mux the frames as soon as they are sent */
+    var_Create(obj, "sout-mux-caching", VLC_VAR_INTEGER);
+    var_SetInteger(obj, "sout-mux-caching", 0);
+
+    sout_access_out_t *access = vlc_object_create(obj, sizeof (*access));
+    assert(access != NULL);
+    access->pf_write = CaptureWrite;
+
+    test_unchunked(access);
+    test_chunked(access);
+    test_tracks(access);
+    test_livehttp(obj);
+
+    vlc_object_delete(access);
+    free(out.data);
+    libvlc_release(vlc);
+    return 0;
+}
@@ -0,0 +1,283 @@
+/*****************************************************************************
+ * prefetch.c: prefetch stream filter read-ahead window tests
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#undef NDEBUG
+
+#include <assert.h>
+#include <stdlib.h>
+
+#include <vlc_common.h>
+#include <vlc_stream.h>
+
+#include "../../libvlc/test.h"
+#include "../../../lib/libvlc_internal.h"
+
+#define SIZE        (UINT64_C(1) << 30)
+#define BUFFER_KIB  1024
+#define BUFFER_SIZE (BUFFER_KIB * 1024)
+#define WINDOW_MIN  (BUFFER_SIZE / 16)
+#define TIMEOUT     VLC_TICK_FROM_SEC(5)
+#define SETTLE      VLC_TICK_FROM_MS(100)
+
+/* Upstream source, whose reads block while the gate is closed */
+static struct
+{
+    vlc_mutex_t lock;
+    vlc_cond_t wait;
+    uint64_t offset;
+    bool closed;
+} source;
+
+static uint8_t Pattern(uint64_t offset)
+{
+    return offset % 251;
+}
+
+static ssize_t SourceRead(stream_t *s, void *buf, size_t len)
+{
+    uint8_t *p = buf;
+    (void) s;
+
+    vlc_mutex_lock(&source.lock);
+    while (source.closed)
+        vlc_cond_wait(&source.wait, &source.lock);
+
+    if (len > SIZE - source.offset)
+        len = SIZE - source.offset;
+    for (size_t i = 0; i < len; i++)
+        p[i] = Pattern(source.offset + i);
+    source.offset += len;
+    vlc_cond_broadcast(&source.wait);
+    vlc_mutex_unlock(&source.lock);
+    return len;
+}
+
+static int SourceSeek(stream_t *s, uint64_t offset)
+{
+    (void) s;
+    vlc_mutex_lock(&source.lock);
+    source.offset = offset;
+    vlc_mutex_unlock(&source.lock);
+    return VLC_SUCCESS;
+}
+
+static int SourceControl(stream_t *s, int query, va_list args)
+{
+    (void) s;
+    switch (query)
+    {
+        case STREAM_CAN_SEEK:
+        case STREAM_CAN_CONTROL_PACE:
+            *va_arg(args, bool *) = true;
+            break;
+        case STREAM_CAN_FASTSEEK:
+        case STREAM_CAN_PAUSE:
+            *va_arg(args, bool *) = false;
+            break;
+        case STREAM_GET_SIZE:
+            *va_arg(args, uint64_t *) = SIZE;
+            break;
+        case STREAM_GET_PTS_DELAY:
+            *va_arg(args, vlc_tick_t *) = 0;
+            break;
+        default:
+            return VLC_EGENERIC;
+    }
+    return VLC_SUCCESS;
+}
+
+static void SourceDestroy(stream_t *s)
+{
+    (void) s;
+}
+
+static void SetGate(bool closed)
+{
+    vlc_mutex_lock(&source.lock);
+    source.closed = closed;
+    vlc_cond_broadcast(&source.wait);
+    vlc_mutex_unlock(&source.lock);
+}
+
+static void *Opener(void *data)
+{
+    (void) data;
+    vlc_tick_sleep(VLC_TICK_FROM_MS(50));
+    SetGate(false);
+    return NULL;
+}
+
+/* Returns the upstream offset, once the filter has read up to the minimum
+ * and stopped */
+static uint64_t WaitUpstream(uint64_t min)
+{
+    const vlc_tick_t deadline = vlc_tick_now() + TIMEOUT;
+    uint64_t offset;
+
+    vlc_mutex_lock(&source.lock);
+    while (source.offset < min)
+        assert(vlc_cond_timedwait(&source.wait, &source.lock, deadline) == 0);
+    vlc_mutex_unlock(&source.lock);
+
+    vlc_tick_sleep(SETTLE);
+    vlc_mutex_lock(&source.lock);
+    offset = source.offset;
+    vlc_mutex_unlock(&source.lock);
+    return offset;
+}
+
+static void AssertUpstream(uint64_t expected)
+{
+    assert(WaitUpstream(expected) == expected);
+}
+
+/* Checks that the filter reads the whole window ahead of the reader */
+static void AssertAhead(stream_t *s, size_t window)
+{
+    AssertUpstream(vlc_stream_Tell(s) + window);
+}
+
+static void ReadCheck(stream_t *s, size_t length)
+{
+    static uint8_t buf[BUFFER_SIZE];
+    uint64_t offset = vlc_stream_Tell(s);
+
+    assert(length <= sizeof (buf));
+    assert(vlc_stream_Read(s, buf, length) == (ssize_t)length);
+    for (size_t i = 0; i < length; i++)
+        assert(buf[i] == Pattern(offset + i));
+}
+
+/* Drains the read-ahead while upstream is stalled, so that the next read
+ * has to wait for it, then checks the window read ahead of it */
+static void Miss(stream_t *s, size_t window, size_t expected)
+{
+    vlc_thread_t th;
+
+    SetGate(true);
+    ReadCheck(s, window);
+    assert(vlc_clone(&th, Opener, NULL, VLC_THREAD_PRIORITY_LOW) == 0);
+    ReadCheck(s, 1);
+    vlc_join(th, NULL);
+
+    /* The refill may complete before the waiting byte is consumed */
+    const uint64_t offset = vlc_stream_Tell(s) + expected;
+    const uint64_t upstream = WaitUpstream(offset - 1);
+    assert(upstream == offset - 1 || upstream == offset);
+}
+
+static void test_window(stream_t *s)
+{
+    /* Starts small */
+    AssertAhead(s, WINDOW_MIN);
+
+    /* Refilled only once half of it is read, and not widened by reads
+     * served from the buffer */
+    ReadCheck(s, WINDOW_MIN / 4);
+    AssertUpstream(WINDOW_MIN);
+    ReadCheck(s, WINDOW_MIN / 2);
+    AssertAhead(s, WINDOW_MIN);
+
+    /* Each miss doubles it, up to the buffer size */
+    size_t window = WINDOW_MIN;
+    while (window < BUFFER_SIZE)
+    {
+        Miss(s, window, 2 * window);
+        window *= 2;
+    }
+    Miss(s, window, BUFFER_SIZE);
+
+    /* Each seek out of the buffer halves it, forward and backward */
+    assert(vlc_stream_Seek(s, vlc_stream_Tell(s) + 16 * BUFFER_SIZE) == 0);
+    window /= 2;
+    AssertAhead(s, window);
+    ReadCheck(s, 1000);
+
+    assert(vlc_stream_Seek(s, 1000) == 0);
+    window /= 2;
+    AssertAhead(s, window);
+    ReadCheck(s, 1000);
+
+    /* The read right after the seek may wait, but does not widen it */
+    assert(vlc_stream_Seek(s, SIZE / 2) == 0);
+    window /= 2;
+    ReadCheck(s, 1000);
+    AssertUpstream(SIZE / 2 + window);
+
+    /* Seeks within the buffer keep it */
+    const uint64_t offset = vlc_stream_Tell(s) + window / 2;
+    assert(vlc_stream_Seek(s, offset) == 0);
+    AssertAhead(s, window);
+    ReadCheck(s, 1000);
+    assert(vlc_stream_Seek(s, offset - 1000) == 0);
+    ReadCheck(s, 1000);
+    AssertUpstream(offset + window);
+
+    /* Down to the minimum */
+    for (unsigned i = 1; i <= 8; i++)
+        assert(vlc_stream_Seek(s, i * UINT64_C(4) * BUFFER_SIZE) == 0);
+    AssertAhead(s, WINDOW_MIN);
+    ReadCheck(s, WINDOW_MIN / 2);
+
+    /* Up to the end of the stream */
+    assert(vlc_stream_Seek(s, SIZE - 1000) == 0);
+    ReadCheck(s, 1000);
+    assert(vlc_stream_Read(s, (uint8_t[1]){ 0 }, 1) == 0);
+    assert(vlc_stream_Eof(s));
+}
+
+int main(void)
+{
+    test_init();
+
+    libvlc_instance_t *vlc = libvlc_new(test_defaults_nargs,
+                                        test_defaults_args);
+    assert(vlc != NULL);
+    vlc_object_t *obj = VLC_OBJECT(vlc->p_libvlc_int);
+
+    var_Create(obj, "prefetch-buffer-size", VLC_VAR_INTEGER);
+    var_SetInteger(obj, "prefetch-buffer-size", BUFFER_KIB);
+
+    vlc_mutex_init(&source.lock);
+    vlc_cond_init(&source.wait);
+
+    stream_t *src = vlc_stream_CommonNew(obj, SourceDestroy);
+    assert(src != NULL);
+    src->pf_read = SourceRead;
+    src->pf_seek = SourceSeek;
+    src->pf_control = SourceControl;
+
+    stream_t *s = vlc_stream_FilterNew(src, "prefetch");
+    int ret = 77; /* the prefetch module is not available */
+    if (s != NULL)
+    {
+        test_window(s);
+        vlc_stream_Delete(s);
+        ret = 0;
+    }
+    else
+        vlc_stream_Delete(src);
+
+    libvlc_release(vlc);
+    return ret;
+}
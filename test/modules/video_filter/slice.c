@@ -0,0 +1,198 @@
+/*****************************************************************************
+ * slice.c: video filters run over bands in parallel
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#undef NDEBUG
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vlc_common.h>
+#include <vlc_filter.h>
+#include <vlc_picture.h>
+
+#include "../../libvlc/test.h"
+#include "../../../lib/libvlc_internal.h"
+
+#define THREADS 4
+
+static picture_t *BufferNew(filter_t *filter)
+{
+    return picture_NewFromFormat(&filter->fmt_out.video);
+}
+
+static const struct filter_video_callbacks owner_cbs =
+{
+    .buffer_new = BufferNew,
+};
+
+static picture_t *NewPicture(const video_format_t *fmt, unsigned bits)
+{
+    picture_t *pic = picture_NewFromFormat(fmt);
+    assert(pic != NULL);
+
+    for (int i = 0; i < pic->i_planes; i++)
+    {
+        const plane_t *p = &pic->p[i];
+
+        for (int y = 0; y < p->i_lines; y++)
+        {
+            uint8_t *line = &p->p_pixels[y * p->i_pitch];
+
+            if (bits > 8)
+                for (int x = 0; x < p->i_pitch / 2; x++)
+                    ((uint16_t *)line)[x] = rand() & ((1 << bits) - 1);
+            else
+                for (int x = 0; x < p->i_pitch; x++)
+                    line[x] = rand();
+        }
+    }
+    return pic;
+}
+
+/* Filters the picture with the given number of threads */
+static picture_t *Filter(vlc_object_t *obj, const char *name,
+                         const video_format_t *fmt, picture_t *in,
+                         int threads)
+{
+    const filter_owner_t owner = { .video = &owner_cbs };
+    es_format_t es;
+
+    var_SetInteger(obj, "video-filter-threads", threads);
+    es_format_Init(&es, VIDEO_ES, fmt->i_chroma);
+    video_format_Copy(&es.video, fmt);
+
+    filter_chain_t *chain = filter_chain_NewVideo(obj, false, &owner);
+    assert(chain != NULL);
+    filter_chain_Reset(chain, &es, NULL, &es);
+
+    picture_t *out = NULL;
+    if (filter_chain_AppendFilter(chain, name, NULL, &es) != NULL)
+    {
+        out = filter_chain_VideoFilter(chain, picture_Hold(in));
+        assert(out != NULL);
+    }
+
+    filter_chain_Delete(chain);
+    es_format_Clean(&es);
+    return out;
+}
+
+static void AssertEqual(const picture_t *a, const picture_t *b)
+{
+    assert(a->i_planes == b->i_planes);
+    for (int i = 0; i < a->i_planes; i++)
+    {
+        const plane_t *pa = &a->p[i], *pb = &b->p[i];
+
+        assert(pa->i_visible_lines == pb->i_visible_lines);
+        assert(pa->i_visible_pitch == pb->i_visible_pitch);
+        for (int y = 0; y < pa->i_visible_lines; y++)
+            assert(!memcmp(&pa->p_pixels[y * pa->i_pitch],
+                           &pb->p_pixels[y * pb->i_pitch],
+                           pa->i_visible_pitch));
+    }
+}
+
+/* Returns whether the filter could be tested */
+static bool test_filter(vlc_object_t *obj, const char *name,
+                        vlc_fourcc_t chroma, unsigned bits,
+                        unsigned width, unsigned height)
+{
+    video_format_t fmt;
+
+    video_format_Setup(&fmt, chroma, width, height, width, height, 1, 1);
+
+    picture_t *in = NewPicture(&fmt, bits);
+    picture_t *whole = Filter(obj, name, &fmt, in, 1);
+    if (whole == NULL)
+    {
+        picture_Release(in);
+        video_format_Clean(&fmt);
+        return false;
+    }
+
+    picture_t *sliced = Filter(obj, name, &fmt, in, THREADS);
+    assert(sliced != NULL);
+    AssertEqual(whole, sliced);
+
+    picture_Release(sliced);
+    picture_Release(whole);
+    picture_Release(in);
+    video_format_Clean(&fmt);
+    return true;
+}
+
+static const struct
+{
+    vlc_fourcc_t chroma;
+    unsigned bits;
+} chromas[] =
+{
+    { VLC_CODEC_I420, 8 },
+    { VLC_CODEC_I422, 8 },
+    { VLC_CODEC_I444, 8 },
+    { VLC_CODEC_I420_10L, 10 },
+};
+
+/* Heights cut into several bands, not all on a chroma line boundary */
+static const unsigned heights[] = { 480, 270, 330 };
+
+int main(void)
+{
+    test_init();
+
+    libvlc_instance_t *vlc = libvlc_new(test_defaults_nargs,
+                                        test_defaults_args);
+    assert(vlc != NULL);
+    vlc_object_t *obj = VLC_OBJECT(vlc->p_libvlc_int);
+
+    var_Create(obj, "video-filter-threads", VLC_VAR_INTEGER);
+
+    /* Strong enough for every pixel to change */
+    var_Create(obj, "sharpen-sigma", VLC_VAR_FLOAT);
+    var_SetFloat(obj, "sharpen-sigma", 1.5f);
+    var_Create(obj, "contrast", VLC_VAR_FLOAT);
+    var_SetFloat(obj, "contrast", 1.3f);
+    var_Create(obj, "brightness", VLC_VAR_FLOAT);
+    var_SetFloat(obj, "brightness", 1.2f);
+    var_Create(obj, "hue", VLC_VAR_FLOAT);
+    var_SetFloat(obj, "hue", 30.f);
+    var_Create(obj, "saturation", VLC_VAR_FLOAT);
+    var_SetFloat(obj, "saturation", 1.7f);
+    var_Create(obj, "gamma", VLC_VAR_FLOAT);
+    var_SetFloat(obj, "gamma", 1.4f);
+
+    static const char *const filters[] = { "sharpen", "adjust" };
+    unsigned tested = 0;
+
+    srand(42);
+    for (size_t f = 0; f < ARRAY_SIZE(filters); f++)
+        for (size_t c = 0; c < ARRAY_SIZE(chromas); c++)
+            for (size_t h = 0; h < ARRAY_SIZE(heights); h++)
+                tested += test_filter(obj, filters[f], chromas[c].chroma,
+                                      chromas[c].bits, 640, heights[h]);
+
+    libvlc_release(vlc);
+    return tested > 0 ? 0 : 77;
+}
@@ -0,0 +1,239 @@
+/*****************************************************************************
+ * file_bench.c: compares the throughput of the local file inputs
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * Reads several files at once, from the page cache or from the disk, with
+ * each file input configuration, and reports the aggregate throughput and
+ * the CPU time used:
+ *
+ *   test_src_input_file_bench [-n files] [-s MiB] [-r read KiB] [-c] [dir]
+ *
+ * The files are created in dir (the temporary directory by default) and
+ * evicted from the page cache before each run, unless -c is given.
+ */
+
+#include "../../libvlc/test.h"
+#include "../lib/libvlc_internal.h"
+
+#include <vlc_access.h>
+#include <vlc_rand.h>
+#include <vlc_url.h>
+#include <vlc_fs.h>
+
+#include <fcntl.h>
+#include <inttypes.h>
+#include <sys/resource.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#define MAX_FILES 64
+
+struct reader
+{
+    libvlc_instance_t *vlc;
+    const char *url;
+    size_t read_size;
+    uint64_t total;
+};
+
+static const struct
+{
+    const char *name;
+    const char *argv[2];
+} configs[] = {
+    { "read()",          { "--no-uring", "--no-uring-direct" } },
+    { "io_uring",        { "--uring", "--no-uring-direct" } },
+    { "io_uring direct", { "--uring", "--uring-direct" } },
+};
+
+static void *Read(void *data)
+{
+    struct reader *reader = data;
+    stream_t *s = vlc_access_NewMRL(VLC_OBJECT(reader->vlc->p_libvlc_int),
+                                    reader->url);
+    assert(s != NULL);
+
+    void *buf = malloc(reader->read_size);
+    assert(buf != NULL);
+
+    ssize_t val;
+    while ((val = vlc_stream_Read(s, buf, reader->read_size)) > 0)
+        reader->total += val;
+
+    free(buf);
+    vlc_stream_Delete(s);
+    return NULL;
+}
+
+static void CreateFile(const char *path, uint64_t size)
+{
+    uint8_t buf[65536];
+    int fd = vlc_open(path, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+    assert(fd != -1);
+
+    for (uint64_t written = 0; written < size;)
+    {
+        size_t len = __MIN(size - written, sizeof (buf));
+
+        vlc_rand_bytes(buf, len);
+        ssize_t val = write(fd, buf, len);
+        assert(val > 0);
+        written += val;
+    }
+    fsync(fd);
+    vlc_close(fd);
+}
+
+static void Evict(const char *path)
+{
+#ifdef HAVE_POSIX_FADVISE
+    int fd = vlc_open(path, O_RDONLY);
+    if (fd != -1)
+    {
+        posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+        vlc_close(fd);
+    }
+#else
+    (void)path;
+#endif
+}
+
+static double TimeSec(const struct timeval *tv)
+{
+    return tv->tv_sec + tv->tv_usec / 1e6;
+}
+
+int main(int argc, char **argv)
+{
+    unsigned count = 8;
+    uint64_t size = 256;
+    size_t read_size = 1024;
+    bool cached = false;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:s:r:c")) != -1)
+    {
+        switch (opt)
+        {
+            case 'n':
+                count = atoi(optarg);
+                break;
+            case 's':
+                size = strtoull(optarg, NULL, 10);
+                break;
+            case 'r':
+                read_size = atoi(optarg);
+                break;
+            case 'c':
+                cached = true;
+                break;
+            default:
+                fprintf(stderr, "usage: %s [-n files] [-s MiB] [-r read KiB]"
+                        " [-c] [dir]\n", argv[0]);
+                return 1;
+        }
+    }
+    if (count == 0 || count > MAX_FILES || size == 0 || read_size == 0)
+        return 1;
+    size <<= 20;
+    read_size <<= 10;
+
+    const char *dir = (optind < argc) ? argv[optind] : getenv("TMPDIR");
+    if (dir == NULL)
+        dir = "/tmp";
+
+    test_init();
+    alarm(0);
+
+    char *paths[MAX_FILES], *urls[MAX_FILES];
+
+    test_log("Creating %u files of %"PRIu64" MiB in %s...\n", count,
+             size >> 20, dir);
+    for (unsigned i = 0; i < count; i++)
+    {
+        if (asprintf(&paths[i], "%s/vlc_file_bench_%u", dir, i) == -1)
+            abort();
+        CreateFile(paths[i], size);
+        urls[i] = vlc_path2uri(paths[i], NULL);
+        assert(urls[i] != NULL);
+    }
+
+    printf("%-16s %10s %10s %8s\n", "input", "MiB/s", "CPU s", "CPU %");
+
+    for (size_t c = 0; c < ARRAY_SIZE(configs); c++)
+    {
+        const char *args[] = {
+            "--ignore-config", "-I", "dummy", "--no-media-library",
+            configs[c].argv[0], configs[c].argv[1],
+        };
+        libvlc_instance_t *vlc = libvlc_new(ARRAY_SIZE(args), args);
+        assert(vlc != NULL);
+
+        if (!cached)
+            for (unsigned i = 0; i < count; i++)
+                Evict(paths[i]);
+
+        struct reader readers[MAX_FILES];
+        vlc_thread_t threads[MAX_FILES];
+        struct rusage ru_start, ru_end;
+        struct timeval start, end;
+
+        getrusage(RUSAGE_SELF, &ru_start);
+        gettimeofday(&start, NULL);
+
+        for (unsigned i = 0; i < count; i++)
+        {
+            readers[i].vlc = vlc;
+            readers[i].url = urls[i];
+            readers[i].read_size = read_size;
+            readers[i].total = 0;
+            if (vlc_clone(&threads[i], Read, &readers[i],
+                          VLC_THREAD_PRIORITY_LOW))
+                abort();
+        }
+
+        uint64_t total = 0;
+        for (unsigned i = 0; i < count; i++)
+        {
+            vlc_join(threads[i], NULL);
+            assert(readers[i].total == size);
+            total += readers[i].total;
+        }
+
+        gettimeofday(&end, NULL);
+        getrusage(RUSAGE_SELF, &ru_end);
+
+        double elapsed = TimeSec(&end) - TimeSec(&start);
+        double cpu = TimeSec(&ru_end.ru_utime) - TimeSec(&ru_start.ru_utime)
+                   + TimeSec(&ru_end.ru_stime) - TimeSec(&ru_start.ru_stime);
+
+        printf("%-16s %10.1f %10.2f %8.1f\n", configs[c].name,
+               total / elapsed / (1 << 20), cpu, 100. * cpu / elapsed);
+        libvlc_release(vlc);
+    }
+
+    for (unsigned i = 0; i < count; i++)
+    {
+        unlink(paths[i]);
+        free(urls[i]);
+        free(paths[i]);
+    }
+    return 0;
+}
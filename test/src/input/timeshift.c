@@ -0,0 +1,336 @@
+/*****************************************************************************
+ * timeshift.c: timeshift skip tests
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#undef NDEBUG
+
+#include <assert.h>
+#include <string.h>
+
+#include <vlc_common.h>
+#include <vlc_block.h>
+#include <vlc_es_out.h>
+
+#include "../../../src/input/input_internal.h"
+#include "../../../src/input/es_out.h"
+#include "../../../lib/libvlc_internal.h"
+#include "../../libvlc/test.h"
+
+const char vlc_module_name[] = "test_timeshift";
+
+#define BLOCKS      100
+#define BLOCK_SIZE  (64 * 1024) /* 16 blocks per 1 MiB storage */
+#define SPACING     VLC_TICK_FROM_MS(10)
+#define ADD_BLOCK   20          /* the second ES is added before this one */
+#define MAX_EVENTS  1024
+#define TIMEOUT     VLC_TICK_FROM_SEC(5)
+
+/* The input internals used by the timeshift */
+input_source_t *input_source_Hold(input_source_t *in)
+{
+    return in;
+}
+
+void input_source_Release(input_source_t *in)
+{
+    (void) in;
+}
+
+bool input_CanPaceControl(input_thread_t *input)
+{
+    (void) input;
+    return false;
+}
+
+int input_ControlPush(input_thread_t *input, int type,
+                      const input_control_param_t *param)
+{
+    (void) input; (void) type; (void) param;
+    return VLC_SUCCESS;
+}
+
+/* Events received by the next es_out */
+enum event_type
+{
+    EVENT_ADD,
+    EVENT_SEND,
+    EVENT_RESET_PCR,
+};
+
+struct event
+{
+    enum event_type type;
+    int value;
+};
+
+static struct
+{
+    es_out_t out;
+    vlc_mutex_t lock;
+    vlc_cond_t wait;
+    struct event events[MAX_EVENTS];
+    size_t count;
+    char ids[3];
+} sink;
+
+/* Dates of the commands of the blocks, within [before, after] */
+static vlc_tick_t before[BLOCKS], after[BLOCKS];
+
+static void PushEvent(enum event_type type, int value)
+{
+    vlc_mutex_lock(&sink.lock);
+    assert(sink.count < MAX_EVENTS);
+    sink.events[sink.count++] = (struct event) { type, value };
+    vlc_cond_signal(&sink.wait);
+    vlc_mutex_unlock(&sink.lock);
+}
+
+static es_out_id_t *SinkAdd(es_out_t *out, input_source_t *in,
+                            const es_format_t *fmt)
+{
+    (void) out; (void) in;
+    assert(fmt->i_id > 0 && (size_t)fmt->i_id < ARRAY_SIZE(sink.ids));
+    PushEvent(EVENT_ADD, fmt->i_id);
+    return (es_out_id_t *)&sink.ids[fmt->i_id];
+}
+
+static int SinkSend(es_out_t *out, es_out_id_t *id, block_t *block)
+{
+    (void) out; (void) id;
+    const int index = block->i_pts - VLC_TICK_0;
+
+    assert(index >= 0 && index < BLOCKS);
+    assert(block->i_buffer == BLOCK_SIZE);
+    assert(block->p_buffer[0] == (uint8_t)index);
+    assert(block->p_buffer[BLOCK_SIZE - 1] == (uint8_t)index);
+    block_Release(block);
+
+    PushEvent(EVENT_SEND, index);
+    return VLC_SUCCESS;
+}
+
+static void SinkDel(es_out_t *out, es_out_id_t *id)
+{
+    (void) out; (void) id;
+}
+
+static int SinkControl(es_out_t *out, input_source_t *in, int query,
+                       va_list args)
+{
+    (void) out; (void) in; (void) args;
+    if (query == ES_OUT_RESET_PCR)
+        PushEvent(EVENT_RESET_PCR, 0);
+    return VLC_SUCCESS;
+}
+
+static int SinkPrivControl(es_out_t *out, int query, va_list args)
+{
+    (void) out;
+    if (query == ES_OUT_PRIV_GET_BUFFERING)
+        *va_arg(args, bool *) = false;
+    return VLC_SUCCESS;
+}
+
+static const struct es_out_callbacks sink_cbs =
+{
+    .add = SinkAdd,
+    .send = SinkSend,
+    .del = SinkDel,
+    .control = SinkControl,
+    .priv_control = SinkPrivControl,
+};
+
+/* Returns the index of the first event of the type from the given index */
+static size_t WaitEvent(enum event_type type, size_t from)
+{
+    const vlc_tick_t deadline = vlc_tick_now() + TIMEOUT;
+
+    vlc_mutex_lock(&sink.lock);
+    for (;;)
+    {
+        while (from < sink.count && sink.events[from].type != type)
+            from++;
+        if (from < sink.count)
+            break;
+        assert(vlc_cond_timedwait(&sink.wait, &sink.lock, deadline) == 0);
+    }
+    vlc_mutex_unlock(&sink.lock);
+    return from;
+}
+
+static size_t GetEventCount(void)
+{
+    vlc_mutex_lock(&sink.lock);
+    size_t count = sink.count;
+    vlc_mutex_unlock(&sink.lock);
+    return count;
+}
+
+static int GetEventValue(size_t index)
+{
+    vlc_mutex_lock(&sink.lock);
+    int value = sink.events[index].value;
+    vlc_mutex_unlock(&sink.lock);
+    return value;
+}
+
+static bool HasEvent(enum event_type type, size_t from, size_t to)
+{
+    bool found = false;
+
+    vlc_mutex_lock(&sink.lock);
+    for (size_t i = from; i < to && i < sink.count; i++)
+        found |= sink.events[i].type == type;
+    vlc_mutex_unlock(&sink.lock);
+    return found;
+}
+
+static void SetPaused(es_out_t *out, bool paused)
+{
+    assert(es_out_SetPauseState(out, false, paused, vlc_tick_now()) == 0);
+    if (paused) /* let the command being waited for be executed */
+        vlc_tick_sleep(VLC_TICK_FROM_MS(100));
+}
+
+/* Skips while paused, then returns the first block played */
+static int Skip(es_out_t *out, vlc_tick_t skip, size_t *reset)
+{
+    size_t from = GetEventCount();
+
+    assert(es_out_SkipTimeshift(out, skip) == VLC_SUCCESS);
+    *reset = WaitEvent(EVENT_RESET_PCR, from);
+    SetPaused(out, false);
+    return GetEventValue(WaitEvent(EVENT_SEND, *reset));
+}
+
+static void test_skip(es_out_t *out)
+{
+    es_format_t fmt;
+    es_format_Init(&fmt, VIDEO_ES, VLC_CODEC_H264);
+    fmt.i_id = 1;
+
+    es_out_id_t *id = es_out_Add(out, &fmt);
+    assert(id != NULL);
+    assert(WaitEvent(EVENT_ADD, 0) == 0);
+
+    /* Buffer the blocks while paused */
+    SetPaused(out, true);
+    for (int i = 0; i < BLOCKS; i++)
+    {
+        if (i == ADD_BLOCK)
+        {
+            fmt.i_id = 2;
+            assert(es_out_Add(out, &fmt) != NULL);
+        }
+
+        block_t *block = block_Alloc(BLOCK_SIZE);
+        assert(block != NULL);
+        memset(block->p_buffer, i, BLOCK_SIZE);
+        block->i_pts = block->i_dts = VLC_TICK_0 + i;
+
+        before[i] = vlc_tick_now();
+        assert(es_out_Send(out, id, block) == VLC_SUCCESS);
+        after[i] = vlc_tick_now();
+        vlc_tick_sleep(SPACING);
+    }
+    assert(GetEventCount() == 1);
+
+    /* Nothing was played yet */
+    assert(es_out_SkipTimeshift(out, -VLC_TICK_FROM_SEC(1)) != VLC_SUCCESS);
+
+    /* Forward: the ES added in between is added, before the PCR reset */
+    const vlc_tick_t forward = VLC_TICK_FROM_MS(300);
+    size_t reset;
+    int index = Skip(out, forward, &reset);
+    assert(index > ADD_BLOCK);
+    assert(after[index] >= before[0] + forward);
+    assert(before[index - 1] < after[0] + forward);
+    assert(HasEvent(EVENT_ADD, 1, reset));
+
+    /* Backward, within the played blocks */
+    const size_t played = WaitEvent(EVENT_SEND, reset) + 20;
+    while (GetEventCount() <= played)
+        WaitEvent(EVENT_SEND, GetEventCount());
+    SetPaused(out, true);
+    const int next = GetEventValue(GetEventCount() - 1) + 1;
+    const vlc_tick_t backward = VLC_TICK_FROM_MS(150);
+
+    index = Skip(out, -backward, &reset);
+    assert(index < next);
+    assert(after[index] >= before[next] - backward);
+    assert(before[index - 1] < after[next] - backward);
+
+    /* Backward, up to the added ES, which is not added twice */
+    SetPaused(out, true);
+    index = Skip(out, -VLC_TICK_FROM_SEC(10), &reset);
+    assert(index == ADD_BLOCK);
+    assert(!HasEvent(EVENT_ADD, reset, GetEventCount()));
+
+    /* Forward, past the last block */
+    SetPaused(out, true);
+    size_t from = GetEventCount();
+    assert(es_out_SkipTimeshift(out, VLC_TICK_FROM_SEC(10)) == VLC_SUCCESS);
+    reset = WaitEvent(EVENT_RESET_PCR, from);
+    assert(!HasEvent(EVENT_SEND, reset, GetEventCount()));
+    assert(es_out_SkipTimeshift(out, 1) != VLC_SUCCESS);
+
+    /* Then back into the played blocks, relative to the live stream, far
+     * enough for the skip to be handled late */
+    const vlc_tick_t start = vlc_tick_now();
+    const vlc_tick_t rewind = start - before[BLOCKS / 2];
+    index = Skip(out, -rewind, &reset);
+    assert(after[index] >= start - rewind);
+    assert(index == 0 || before[index - 1] < vlc_tick_now() - rewind);
+    assert(index < BLOCKS);
+
+    es_format_Clean(&fmt);
+}
+
+int main(void)
+{
+    test_init();
+
+    libvlc_instance_t *vlc = libvlc_new(test_defaults_nargs,
+                                        test_defaults_args);
+    assert(vlc != NULL);
+
+    input_thread_t *input = vlc_object_create(vlc->p_libvlc_int,
+                                              sizeof (*input));
+    assert(input != NULL);
+    /* Several storages */
+    var_Create(input, "input-timeshift-granularity", VLC_VAR_INTEGER);
+    var_SetInteger(input, "input-timeshift-granularity", 1024 * 1024);
+
+    vlc_mutex_init(&sink.lock);
+    vlc_cond_init(&sink.wait);
+    sink.out.cbs = &sink_cbs;
+
+    es_out_t *out = input_EsOutTimeshiftNew(input, &sink.out, 1.f);
+    assert(out != NULL);
+
+    test_skip(out);
+
+    es_out_Delete(out);
+    vlc_object_delete(input);
+    libvlc_release(vlc);
+    return 0;
+}
@@ -0,0 +1,314 @@
+/*****************************************************************************
+ * httpd.c: HTTP server load test
+ *****************************************************************************
+ * Copyright (C) 2021 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * Connects many concurrent clients to a live HTTP stream, and checks that
+ * every one of them receives the stream without discontinuity. The stream is
+ * sent first in large blocks, then in TS packets as the TS muxer does.
+ *
+ * Usage: test_src_network_httpd [clients [seconds]]
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#undef NDEBUG
+#include <assert.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <sys/types.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <poll.h>
+#include <unistd.h>
+
+#include <vlc_common.h>
+#include <vlc_block.h>
+#include <vlc_httpd.h>
+#include <vlc_network.h>
+#include "../../../lib/libvlc_internal.h"
+
+#include <vlc/vlc.h>
+
+/* A typical live stream: 16 KiB every 20 ms, i.e. about 6.5 Mbit/s */
+#define BURST_SIZE  16384
+#define BURST_DELAY VLC_TICK_FROM_MS(20)
+
+/* Stream bytes follow a sequence, so that receivers detect gaps */
+#define SEQUENCE 251
+
+struct feeder
+{
+    httpd_stream_t *stream;
+    size_t block_size;
+    vlc_thread_t thread;
+    vlc_sem_t stop;
+};
+
+struct client
+{
+    int fd;
+    bool b_header;     /* HTTP header received */
+    size_t header_len;
+    int next;          /* expected value of the next byte, -1 if unknown */
+    uint64_t received; /* stream bytes */
+    unsigned discontinuities;
+    bool b_closed;     /* disconnected by the server */
+};
+
+static void *Feed(void *data)
+{
+    struct feeder *feeder = data;
+    vlc_tick_t deadline = vlc_tick_now();
+    unsigned value = 0;
+
+    do
+    {
+        for (size_t sent = 0; sent < BURST_SIZE; sent += feeder->block_size)
+        {
+            block_t *block = block_Alloc(feeder->block_size);
+            assert(block != NULL);
+
+            for (size_t i = 0; i < block->i_buffer; i++)
+            {
+                block->p_buffer[i] = value;
+                value = (value + 1) % SEQUENCE;
+            }
+            httpd_StreamSend(feeder->stream, block);
+        }
+        deadline += BURST_DELAY;
+    }
+    while (vlc_sem_timedwait(&feeder->stop, deadline));
+
+    return NULL;
+}
+
+static int Connect(unsigned port)
+{
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(port),
+        .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+    };
+    static const char request[] = "GET /stream HTTP/1.1\r\n"
+                                  "Host: localhost\r\n\r\n";
+
+    int fd = vlc_socket(AF_INET, SOCK_STREAM, 0, false);
+    if (fd == -1)
+        return -1;
+
+    if (connect(fd, (struct sockaddr *)&addr, sizeof (addr))
+     || send(fd, request, sizeof (request) - 1, 0)
+                                            != (ssize_t)sizeof (request) - 1)
+    {
+        vlc_close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static bool Receive(struct client *cl)
+{
+    uint8_t buf[65536];
+    ssize_t len = recv(cl->fd, buf, sizeof (buf), MSG_DONTWAIT);
+
+    if (len <= 0)
+    {
+        if (len == -1 && errno == EAGAIN)
+            return true;
+        cl->b_closed = true;
+        return false;
+    }
+
+    const uint8_t *p = buf;
+
+    if (!cl->b_header)
+    {   /* Skip the header, up to the empty line */
+        static const char eoh[] = "\r\n\r\n";
+
+        while (len > 0 && cl->header_len < 4)
+        {
+            cl->header_len = (*p == eoh[cl->header_len])
+                           ? cl->header_len + 1 : (*p == '\r');
+            p++;
+            len--;
+        }
+        if (cl->header_len < 4)
+            return true;
+        cl->b_header = true;
+    }
+
+    for (ssize_t i = 0; i < len; i++)
+    {
+        if (cl->next >= 0 && p[i] != cl->next)
+            cl->discontinuities++;
+        cl->next = (p[i] + 1) % SEQUENCE;
+    }
+    cl->received += len;
+    return true;
+}
+
+static int Test(httpd_host_t *host, unsigned port, unsigned count,
+                unsigned duration, size_t block_size)
+{
+    struct feeder feeder;
+
+    feeder.stream = httpd_StreamNew(host, "/stream",
+                                    "application/octet-stream", NULL, NULL);
+    assert(feeder.stream != NULL);
+    feeder.block_size = block_size;
+    vlc_sem_init(&feeder.stop, 0);
+    if (vlc_clone(&feeder.thread, Feed, &feeder, VLC_THREAD_PRIORITY_LOW))
+        abort();
+
+    struct client *clients = calloc(count, sizeof (*clients));
+    struct pollfd *ufd = calloc(count, sizeof (*ufd));
+    assert(clients != NULL && ufd != NULL);
+
+    vlc_tick_t start = vlc_tick_now();
+
+    for (unsigned i = 0; i < count; i++)
+    {
+        clients[i].fd = Connect(port);
+        if (clients[i].fd == -1)
+        {
+            fprintf(stderr, "cannot connect client %u: %s\n", i,
+                    vlc_strerror_c(errno));
+            count = i;
+            goto error;
+        }
+        clients[i].next = -1;
+        ufd[i].fd = clients[i].fd;
+        ufd[i].events = POLLIN;
+    }
+
+    vlc_tick_t connected = vlc_tick_now();
+    vlc_tick_t end = connected + VLC_TICK_FROM_SEC(duration);
+
+    while (vlc_tick_now() < end)
+    {
+        int val = poll(ufd, count, 100);
+        assert(val >= 0 || errno == EINTR);
+
+        for (unsigned i = 0; i < count; i++)
+            if (ufd[i].revents && !Receive(&clients[i]))
+                ufd[i].fd = -1;
+    }
+
+    uint64_t total = 0, min = UINT64_MAX;
+    unsigned discontinuities = 0, starved = 0, closed = 0;
+
+    for (unsigned i = 0; i < count; i++)
+    {
+        total += clients[i].received;
+        if (clients[i].received < min)
+            min = clients[i].received;
+        if (clients[i].received == 0)
+            starved++;
+        if (clients[i].b_closed)
+            closed++;
+        discontinuities += clients[i].discontinuities;
+        vlc_close(clients[i].fd);
+    }
+
+    printf("%zu bytes blocks: %u clients connected in %"PRId64" ms\n",
+           block_size, count, MS_FROM_VLC_TICK(connected - start));
+    printf("%"PRIu64" bytes received in %u s (%"PRIu64" kB/s), "
+           "at least %"PRIu64" bytes per client\n", total, duration,
+           total / (1000 * duration), min);
+    printf("%u starved and %u disconnected client(s), %u discontinuities\n",
+           starved, closed, discontinuities);
+
+    vlc_sem_post(&feeder.stop);
+    vlc_join(feeder.thread, NULL);
+    httpd_StreamDelete(feeder.stream);
+    free(ufd);
+    free(clients);
+
+    assert(starved == 0);
+    assert(closed == 0);
+    assert(discontinuities == 0);
+    return 0;
+
+error:
+    for (unsigned i = 0; i < count; i++)
+        vlc_close(clients[i].fd);
+    vlc_sem_post(&feeder.stop);
+    vlc_join(feeder.thread, NULL);
+    httpd_StreamDelete(feeder.stream);
+    free(ufd);
+    free(clients);
+    return 1;
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned count = (argc > 1) ? strtoul(argv[1], NULL, 10) : 200;
+    unsigned duration = (argc > 2) ? strtoul(argv[2], NULL, 10) : 2;
+    struct rlimit lim;
+
+    setenv("VLC_PLUGIN_PATH", "../modules", 1);
+    alarm(2 * duration + 30);
+
+    /* Each client uses two file descriptors: one on each side */
+    if (getrlimit(RLIMIT_NOFILE, &lim) == 0 && lim.rlim_cur < lim.rlim_max)
+    {
+        lim.rlim_cur = lim.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &lim);
+    }
+
+    static const char *const args[] = {
+        "-v", "--ignore-config", "--http-host=127.0.0.1",
+    };
+    libvlc_instance_t *vlc = libvlc_new(ARRAY_SIZE(args), args);
+    assert(vlc != NULL);
+
+    vlc_object_t *obj = VLC_OBJECT(vlc->p_libvlc_int);
+    httpd_host_t *host = NULL;
+    unsigned port;
+
+    /* Find a free port */
+    var_Create(obj, "http-port", VLC_VAR_INTEGER);
+    for (port = 18080; port < 18180 && host == NULL; port++)
+    {
+        var_SetInteger(obj, "http-port", port);
+        host = vlc_http_HostNew(obj);
+    }
+    if (host == NULL)
+    {
+        libvlc_release(vlc);
+        return 77;
+    }
+    port--;
+
+    int ret = Test(host, port, count, duration, BURST_SIZE);
+    if (ret == 0) /* TS packets */
+        ret = Test(host, port, count, duration, 188);
+
+    httpd_HostDelete(host);
+    libvlc_release(vlc);
+    return ret;
+}
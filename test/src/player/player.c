@@ -2074,6 +2074,7 @@ enum ctx_flags
     DISABLE_AUDIO_OUTPUT = 1 << 1,
     DISABLE_VIDEO        = 1 << 2,
     DISABLE_AUDIO        = 1 << 3,
+    DECODER_PIPELINE     = 1 << 4,
 };
 
 static void
@@ -2092,6 +2093,8 @@ ctx_init(struct ctx *ctx, enum ctx_flags flags)
         (flags & DISABLE_AUDIO_OUTPUT) ? "--aout=none" : "--aout=dummy",
         (flags & DISABLE_VIDEO) ? "--no-video" : "--video",
         (flags & DISABLE_AUDIO) ? "--no-audio" : "--audio",
+        (flags & DECODER_PIPELINE) ? "--decoder-pipeline"
+                                   : "--no-decoder-pipeline",
         "--text-renderer=tdummy",
     };
     libvlc_instance_t *vlc = libvlc_new(ARRAY_SIZE(argv), argv);
@@ -2892,6 +2895,15 @@ main(void)
     test_es_selection_override(&ctx);
     test_audio_loudness_meter(&ctx);
 
+    ctx_destroy(&ctx);
+    /* Test with --decoder-pipeline: buffering at start, flush on seeks,
+     * drain at the end of the media */
+    ctx_init(&ctx, DECODER_PIPELINE);
+    test_next_media(&ctx);
+    test_seeks(&ctx);
+    test_pause(&ctx);
+    test_tracks(&ctx, true);
+
     ctx_destroy(&ctx);
     return 0;
 }